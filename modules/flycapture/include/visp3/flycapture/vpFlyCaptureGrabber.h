@@ -42,11 +42,14 @@
 #include <visp3/core/vpConfig.h>
 #include <visp3/core/vpFrameGrabber.h>
 #include <visp3/flycapture/vpConfigFlycapture.h>
+#include <visp3/flycapture/vpFlyCaptureStatistics.h>
 
 #ifdef VISP_HAVE_FLYCAPTURE
 
 #include <FlyCapture2.h>
 
+class vpFlyCaptureAsyncCapture;
+
 /*!
   \file vpFlyCaptureGrabber.h
   \brief Wrapper over PointGrey FlyCapture SDK to capture images from PointGrey cameras.
@@ -137,12 +140,70 @@ int main()
   }
   delete [] g;
 #endif
+}
+  \endcode
+
+  Since the cameras are retrieved one after the other, their frames may be captured at different times. To capture
+  sets of simultaneous frames, see vpFlyCaptureMultiGrabber.
+
+  For color cameras, the conversion of the Bayer frames can be matched to what is needed. acquireRaw() returns the
+  Bayer mosaic without conversion, to be converted later with demosaic(). Once setDemosaicMethod() is called with
+  DEMOSAIC_BILINEAR or DEMOSAIC_HALF_SIZE, acquire() converts the raw Bayer frames with ViSP on several threads
+  rather than with the SDK; the camera is set to send raw frames with setFormat7VideoMode() and
+  FlyCapture2::PIXEL_FORMAT_RAW8.
+
+  When the processing time of a frame gets close to the frame period, the capture can be done by a dedicated thread
+  that fills a ring of preallocated images, so that waiting for the next frame overlaps the processing of the
+  current one. acquireNext() returns the frames in order, acquireLatest() returns the most recent one and skips
+  the older ones. When all the images of the ring hold frames not yet read, the policy given to startAsyncCapture()
+  selects the frame that is dropped.
+
+  \code
+#include <visp3/core/vpImage.h>
+#include <visp3/flycapture/vpFlyCaptureGrabber.h>
+
+int main()
+{
+#if defined(VISP_HAVE_FLYCAPTURE)
+  vpImage<unsigned char> I;
+  FlyCapture2::TimeStamp timestamp;
+  vpFlyCaptureGrabber g;
+  g.startAsyncCapture(false, 4, vpFlyCaptureGrabber::DROP_OLDEST);
+
+  for(int i=0; i< 100; i++) {
+    if (! g.acquireNext(I, timestamp, 1000)) // Wait at most 1 second
+      break;
+    // Process I while the next frames are captured
+  }
+  std::cout << "Dropped frames: " << g.getAsyncDroppedFrames() << std::endl;
+  g.stopAsyncCapture();
+#endif
 }
   \endcode
  */
 class VISP_EXPORT vpFlyCaptureGrabber : public vpFrameGrabber
 {
+  friend class vpFlyCaptureAsyncCapture;
+  friend class vpFlyCaptureMultiGrabber;
+
 public:
+  /*!
+    Frame dropped by the asynchronous capture when all the images of the ring hold frames not yet read.
+  */
+  typedef enum {
+    DROP_OLDEST, //!< The oldest frame not yet read is overwritten by the new one.
+    DROP_NEWEST  //!< The new frame is dropped, the frames not yet read are kept.
+  } vpAsyncDropPolicy;
+
+  /*!
+    Conversion of the raw Bayer frames (FlyCapture2::PIXEL_FORMAT_RAW8) by acquire().
+  */
+  typedef enum {
+    DEMOSAIC_SDK,      //!< Conversion by FlyCapture2::Image::Convert().
+    DEMOSAIC_BILINEAR, //!< Multithreaded bilinear interpolation at full resolution.
+    DEMOSAIC_HALF_SIZE //!< One pixel per 2x2 Bayer cell, the image size is half the sensor size.
+  } vpDemosaicMethod;
+
   vpFlyCaptureGrabber();
   virtual ~vpFlyCaptureGrabber();
 
@@ -150,14 +211,40 @@ public:
   void acquire(vpImage<unsigned char> &I, FlyCapture2::TimeStamp &timestamp);
   void acquire(vpImage<vpRGBa> &I);
   void acquire(vpImage<vpRGBa> &I, FlyCapture2::TimeStamp &timestamp);
+  void acquireRaw(vpImage<unsigned char> &I);
+  void acquireRaw(vpImage<unsigned char> &I, FlyCapture2::TimeStamp &timestamp);
+  bool acquireLatest(vpImage<unsigned char> &I, FlyCapture2::TimeStamp &timestamp, int timeout_ms=-1);
+  bool acquireLatest(vpImage<vpRGBa> &I, FlyCapture2::TimeStamp &timestamp, int timeout_ms=-1);
+  bool acquireNext(vpImage<unsigned char> &I, FlyCapture2::TimeStamp &timestamp, int timeout_ms=-1);
+  bool acquireNext(vpImage<vpRGBa> &I, FlyCapture2::TimeStamp &timestamp, int timeout_ms=-1);
 
   void close();
   void connect();
+  static void demosaic(const vpImage<unsigned char> &bayer, FlyCapture2::BayerTileFormat bayerFormat,
+                       vpImage<vpRGBa> &I, vpDemosaicMethod method=DEMOSAIC_BILINEAR, unsigned int nbThreads=0);
+  static void demosaic(const vpImage<unsigned char> &bayer, FlyCapture2::BayerTileFormat bayerFormat,
+                       vpImage<unsigned char> &I, vpDemosaicMethod method=DEMOSAIC_BILINEAR,
+                       unsigned int nbThreads=0);
   void disconnect();
+  void enableStatistics(bool on=true);
 
+  unsigned int getAsyncCapturedFrames() const;
+  unsigned int getAsyncDroppedFrames() const;
+  unsigned int getAsyncSkippedFrames() const;
+  /*!
+    Return the Bayer tile format of the last frame returned by acquireRaw(), FlyCapture2::NONE if the frame is not
+    a Bayer mosaic.
+   */
+  FlyCapture2::BayerTileFormat getBayerTileFormat() const {
+    return m_bayerFormat;
+  }
   float getBrightness();
   std::ostream &getCameraInfo(std::ostream &os); // Cannot be const since FlyCapture2::Camera::GetCameraInfo() isn't
   FlyCapture2::Camera *getCameraHandler();
+  //! Return the conversion of the raw Bayer frames by acquire().
+  vpDemosaicMethod getDemosaicMethod() const {
+    return m_demosaicMethod;
+  }
   /*! Return the index of the active camera. */
   unsigned int getCameraIndex() const {
    return m_index;
@@ -170,8 +257,17 @@ public:
   static unsigned int getNumCameras();
   unsigned int getSharpness();
   float getShutter();
+  vpFlyCaptureStatistics getStatistics() const;
 
+  //! Return true if the asynchronous capture thread is running.
+  bool isAsyncCaptureStarted() const {
+    return m_async != NULL;
+  }
   bool isCameraPowerAvailable();
+  //! Return true if the timing statistics are enabled, see enableStatistics().
+  bool isStatisticsEnabled() const {
+    return m_statsEnabled;
+  }
   //! Return true if the camera is connected.
   bool isConnected() const {
     return m_connected;
@@ -186,7 +282,9 @@ public:
   void open(vpImage<vpRGBa> &I);
 
   float setBrightness(bool brightness_auto, float brightness_value=0);
+  void resetStatistics();
   void setCameraIndex(unsigned int index);
+  void setDemosaicMethod(vpDemosaicMethod method, unsigned int nbThreads=0);
   void setCameraPower(bool on);
   void setCameraSerial(unsigned int serial);
   float setExposure(bool exposure_on, bool exposure_auto, float exposure_value=0);
@@ -200,7 +298,9 @@ public:
   void setVideoModeAndFrameRate(FlyCapture2::VideoMode video_mode,
                                 FlyCapture2::FrameRate frame_rate);
 
+  void startAsyncCapture(bool color=false, unsigned int nbBuffers=4, vpAsyncDropPolicy policy=DROP_OLDEST);
   void startCapture();
+  void stopAsyncCapture();
   void stopCapture();
 
 protected:
@@ -212,6 +312,11 @@ protected:
   FlyCapture2::Property getProperty(FlyCapture2::PropertyType prop_type);
   FlyCapture2::PropertyInfo getPropertyInfo(FlyCapture2::PropertyType prop_type);
   void open();
+  template <class Type>
+  bool acquireAsync(vpImage<Type> &I, FlyCapture2::TimeStamp &timestamp, int timeout_ms, bool latest);
+  void runAsyncCapture();
+  void updateStatistics(vpFlyCaptureStatistics &stats, double t_start, double t_retrieved,
+                        const FlyCapture2::Image &rawImage);
   void setProperty(const FlyCapture2::PropertyType &prop_type,
                    bool on, bool auto_on, float value,
                    PropertyValue prop_value=ABS_VALUE);
@@ -224,6 +329,18 @@ protected:
   FlyCapture2::Image m_rawImage; //!< Image buffer
   bool m_connected; //!< true if camera connected
   bool m_capture; //!< true is capture started
+  vpFlyCaptureAsyncCapture *m_async; //!< Ring buffer and thread of the asynchronous capture, NULL if not started
+  vpDemosaicMethod m_demosaicMethod; //!< Conversion of the raw Bayer frames
+  unsigned int m_demosaicThreads; //!< Number of threads of the in-library conversion, 0 for the number of processors
+  FlyCapture2::BayerTileFormat m_bayerFormat; //!< Bayer tile format of the last raw frame
+  bool m_statsEnabled; //!< true if the timing statistics are recorded
+  vpFlyCaptureStatistics m_stats; //!< Timing statistics
+  FlyCapture2::EmbeddedImageInfo m_embeddedInfo; //!< Embedded image info of the camera before enableStatistics()
+  bool m_embeddedInfoChanged; //!< true if enableStatistics() changed the embedded image info of the camera
+
+private:
+  vpFlyCaptureGrabber(const vpFlyCaptureGrabber &);
+  vpFlyCaptureGrabber &operator=(const vpFlyCaptureGrabber &);
 };
 
 #endif
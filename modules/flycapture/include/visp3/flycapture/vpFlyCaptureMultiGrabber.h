@@ -0,0 +1,168 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Synchronized capture from multiple PointGrey cameras.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+#ifndef __vpFlyCaptureMultiGrabber_h_
+#define __vpFlyCaptureMultiGrabber_h_
+
+#include <vector>
+#include <visp3/core/vpConfig.h>
+#include <visp3/flycapture/vpFlyCaptureGrabber.h>
+
+#ifdef VISP_HAVE_FLYCAPTURE
+
+/*!
+  \file vpFlyCaptureMultiGrabber.h
+  \brief Synchronized capture from multiple PointGrey cameras using FlyCapture SDK.
+*/
+/*!
+  \class vpFlyCaptureMultiGrabber
+  \ingroup group_sensor_camera
+
+  Allows to grab sets of simultaneous images from multiple PointGrey cameras using FlyCapture SDK.
+
+  The capture of all the cameras is started at once with FlyCapture2::Camera::StartSyncCapture(), then each camera
+  is retrieved by its own thread (see vpFlyCaptureGrabber::startAsyncCapture()). acquire() returns a frame of each
+  camera, the frames being matched by their FlyCapture2::TimeStamp: a set is only returned when all its frames were
+  captured within setTolerance() milliseconds, older frames without match being discarded. getLastSpread() gives
+  how far apart the frames of the last set were.
+
+  The following example shows how to capture sets of images from all the cameras found on the bus.
+  \code
+#include <visp3/core/vpImage.h>
+#include <visp3/io/vpImageIo.h>
+#include <visp3/flycapture/vpFlyCaptureMultiGrabber.h>
+
+int main()
+{
+#if defined(VISP_HAVE_FLYCAPTURE)
+  int nframes = 100;
+  char filename[255];
+  std::vector< vpImage<unsigned char> > I;
+  std::vector<FlyCapture2::TimeStamp> timestamps;
+  vpFlyCaptureMultiGrabber g; // All the cameras of the bus
+
+  g.open();
+  for(int i=0; i< nframes; i++) {
+    if (! g.acquire(I, timestamps, 1000))
+      break;
+    std::cout << "Frames captured within " << g.getLastSpread() << " ms" << std::endl;
+    for(unsigned int cam=0; cam < g.getNumCameras(); cam++) {
+      sprintf(filename, "image-camera%d-%04d.pgm", cam, i);
+      vpImageIo::write(I[cam], filename);
+    }
+  }
+  g.close();
+#endif
+}
+  \endcode
+
+  To select the cameras, use setCameraIndexes() before open(). The settings of each camera are modified through
+  getGrabber().
+ */
+class VISP_EXPORT vpFlyCaptureMultiGrabber
+{
+public:
+  vpFlyCaptureMultiGrabber();
+  virtual ~vpFlyCaptureMultiGrabber();
+
+  bool acquire(std::vector< vpImage<unsigned char> > &I, std::vector<FlyCapture2::TimeStamp> &timestamps,
+               int timeout_ms=-1);
+  bool acquire(std::vector< vpImage<vpRGBa> > &I, std::vector<FlyCapture2::TimeStamp> &timestamps,
+               int timeout_ms=-1);
+
+  void close();
+
+  //! Return the number of frames discarded by acquire() since open() because they had no match in the other cameras.
+  unsigned int getDiscardedFrames() const {
+    return m_discardedFrames;
+  }
+  vpFlyCaptureGrabber &getGrabber(unsigned int cam);
+  //! Return the time in milliseconds between the first and the last frames of the last set returned by acquire().
+  double getLastSpread() const {
+    return m_lastSpread;
+  }
+  //! Return the largest time in milliseconds between the first and the last frames of the sets returned by acquire().
+  double getMaxSpread() const {
+    return m_maxSpread;
+  }
+  //! Return the number of sets returned by acquire() since open().
+  unsigned int getMatchedSets() const {
+    return m_matchedSets;
+  }
+  //! Return the number of cameras of the group.
+  unsigned int getNumCameras() const {
+    return (unsigned int) m_grabbers.size();
+  }
+  //! Return the maximum time in milliseconds between the frames of a set.
+  double getTolerance() const {
+    return m_tolerance;
+  }
+  //! Return true if the capture of the cameras is started.
+  bool isOpen() const {
+    return m_open;
+  }
+
+  void open(bool color=false, unsigned int nbBuffers=4);
+
+  void setCameraIndexes(const std::vector<unsigned int> &indexes);
+  void setTolerance(double tolerance_ms);
+
+protected:
+  void createGrabbers();
+  void createGrabbers(const std::vector<unsigned int> &indexes);
+  template <class Type>
+  bool acquireSet(std::vector< vpImage<Type> > &I, std::vector<FlyCapture2::TimeStamp> &timestamps,
+                  int timeout_ms);
+
+protected:
+  std::vector<vpFlyCaptureGrabber *> m_grabbers; //!< One grabber per camera
+  double m_tolerance; //!< Maximum time between the frames of a set in ms, negative for half the frame period
+  double m_lastSpread; //!< Time between the frames of the last set in ms
+  double m_maxSpread; //!< Largest time between the frames of a set in ms
+  unsigned int m_matchedSets; //!< Number of sets returned by acquire()
+  unsigned int m_discardedFrames; //!< Number of frames discarded without match
+  bool m_color; //!< true if color images are captured
+  bool m_open; //!< true if the capture is started
+
+private:
+  vpFlyCaptureMultiGrabber(const vpFlyCaptureMultiGrabber &);
+  vpFlyCaptureMultiGrabber &operator=(const vpFlyCaptureMultiGrabber &);
+};
+
+#endif
+#endif
@@ -0,0 +1,169 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Capture timing statistics of PointGrey cameras.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+#ifndef __vpFlyCaptureStatistics_h_
+#define __vpFlyCaptureStatistics_h_
+
+#include <ostream>
+#include <visp3/core/vpConfig.h>
+#include <visp3/flycapture/vpConfigFlycapture.h>
+
+#ifdef VISP_HAVE_FLYCAPTURE
+
+/*!
+  \file vpFlyCaptureStatistics.h
+  \brief Capture timing statistics of PointGrey cameras.
+*/
+/*!
+  \class vpFlyCaptureStatistics
+  \ingroup group_sensor_camera
+
+  Timing statistics of the frames acquired by vpFlyCaptureGrabber, see vpFlyCaptureGrabber::enableStatistics().
+
+  For each stage of the acquisition the durations are accumulated in a histogram with one bin per power of 2
+  microseconds, so that recording a frame only costs a few additions:
+  - STAGE_RETRIEVE: time spent in FlyCapture2::Camera::RetrieveBuffer(), including the wait for the frame;
+  - STAGE_CONVERT: conversion or copy of the frame into the vpImage, or into the ring of the asynchronous capture;
+  - STAGE_COPY: copy of a frame out of the ring of the asynchronous capture, not recorded otherwise;
+  - STAGE_RECEIVE_DELAY: time between the sensor timestamp of the frame and its reception by the host. The camera
+    and the host clocks have an unknown offset, so that the delay is given relative to the smallest one observed.
+
+  The frames lost by the camera or the transfer are counted from the embedded frame counter of the camera.
+
+  \code
+#include <visp3/flycapture/vpFlyCaptureGrabber.h>
+
+int main()
+{
+#if defined(VISP_HAVE_FLYCAPTURE)
+  vpImage<unsigned char> I;
+  vpFlyCaptureGrabber g;
+  g.enableStatistics();
+  for(int i=0; i< 100; i++)
+    g.acquire(I);
+  vpFlyCaptureStatistics stats = g.getStatistics();
+  std::cout << stats << std::endl;
+  std::cout << "Frames lost by the camera: " << stats.getDroppedFrames() << std::endl;
+#endif
+}
+  \endcode
+ */
+class VISP_EXPORT vpFlyCaptureStatistics
+{
+  friend class vpFlyCaptureGrabber;
+  friend class vpFlyCaptureAsyncCapture;
+
+public:
+  /*!
+    Stage of the acquisition of a frame.
+  */
+  typedef enum {
+    STAGE_RETRIEVE,      //!< FlyCapture2::Camera::RetrieveBuffer().
+    STAGE_CONVERT,       //!< Conversion of the frame.
+    STAGE_COPY,          //!< Copy out of the ring of the asynchronous capture.
+    STAGE_RECEIVE_DELAY, //!< Sensor to host delay, relative to the smallest one.
+    STAGE_COUNT          //!< Number of stages.
+  } vpStage;
+
+  //! Number of bins of the histograms, bin k counts the durations in [2^k, 2^(k+1)[ microseconds.
+  static const unsigned int NB_BINS = 24;
+
+  vpFlyCaptureStatistics();
+
+  //! Return the number of durations recorded for a stage.
+  unsigned int getCount(vpStage stage) const {
+    return m_count[stage];
+  }
+  //! Return the number of frames lost by the camera, from its embedded frame counter.
+  unsigned int getDroppedFrames() const {
+    return m_droppedFrames;
+  }
+  double getEffectiveFrameRate() const;
+  //! Return the number of frames recorded.
+  unsigned int getFrames() const {
+    return m_frames;
+  }
+  unsigned int getHistogram(vpStage stage, unsigned int bin) const;
+  //! Return the longest duration of a stage in milliseconds.
+  double getMax(vpStage stage) const {
+    return m_max[stage];
+  }
+  double getMean(vpStage stage) const;
+  //! Return the shortest duration of a stage in milliseconds.
+  double getMin(vpStage stage) const {
+    return m_count[stage] ? m_min[stage] : 0.;
+  }
+  //! Return the frame rate of the camera when the statistics were enabled, see vpFlyCaptureGrabber::getFrameRate().
+  double getNominalFrameRate() const {
+    return m_nominalFrameRate;
+  }
+  double getPercentile(vpStage stage, double percent) const;
+  //! Return true if the dropped frames are counted, that is if the camera has an embedded frame counter.
+  bool hasFrameCounter() const {
+    return m_hasFrameCounter;
+  }
+
+  void reset();
+
+  friend VISP_EXPORT std::ostream &operator<<(std::ostream &os, const vpFlyCaptureStatistics &stats);
+
+protected:
+  void addSample(vpStage stage, double duration_ms);
+  void addFrame(double host_ms, double sensor_ms, unsigned int frameCounter);
+
+protected:
+  unsigned int m_histogram[STAGE_COUNT][NB_BINS]; //!< Histogram of the durations of each stage
+  unsigned int m_count[STAGE_COUNT]; //!< Number of durations of each stage
+  double m_sum[STAGE_COUNT]; //!< Sum of the durations of each stage in ms
+  double m_min[STAGE_COUNT]; //!< Shortest duration of each stage in ms
+  double m_max[STAGE_COUNT]; //!< Longest duration of each stage in ms
+  unsigned int m_frames; //!< Number of frames
+  unsigned int m_droppedFrames; //!< Frames lost according to the frame counter
+  unsigned int m_lastFrameCounter; //!< Frame counter of the last frame
+  bool m_hasFrameCounter; //!< true if the frame counter is embedded in the frames
+  bool m_hasTimeStamp; //!< true if the sensor timestamp is embedded in the frames
+  double m_nominalFrameRate; //!< Frame rate of the camera in fps
+  double m_firstHostTime; //!< Reception of the first frame by the host in ms
+  double m_lastHostTime; //!< Reception of the last frame by the host in ms
+  double m_lastSensorTime; //!< Sensor timestamp of the last frame in ms, modulo 128 s
+  double m_sensorTimeWrap; //!< Multiple of 128 s added to the sensor timestamps
+  double m_minReceiveDelay; //!< Smallest difference between the host and the sensor times in ms
+};
+
+#endif
+#endif
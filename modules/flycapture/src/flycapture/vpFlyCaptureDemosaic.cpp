@@ -0,0 +1,417 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Conversion of raw Bayer images.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpFlyCaptureDemosaic.cpp
+  \brief Conversion of raw Bayer images to color or gray level images.
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include <visp3/core/vpException.h>
+#include <visp3/flycapture/vpFlyCaptureGrabber.h>
+
+#include "vpFlyCaptureDemosaic.h"
+#include "vpFlyCaptureLock.h"
+
+#ifdef VISP_HAVE_FLYCAPTURE
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+#  include <visp3/core/vpThread.h>
+#  define VP_FLYCAPTURE_HAVE_THREADS 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#  include <emmintrin.h>
+#  define VP_FLYCAPTURE_HAVE_SSE2 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+//Minimal number of output rows converted by a thread
+const unsigned int DEMOSAIC_MIN_ROWS = 32;
+
+struct vpBayerImage {
+  const unsigned char *bitmap;
+  unsigned int rows;
+  unsigned int cols;
+  unsigned int stride;
+  //Row and column offsets that bring the Bayer pattern to RGGB
+  unsigned int dy;
+  unsigned int dx;
+
+  const unsigned char *row(const unsigned int i) const {
+    return bitmap + i*stride;
+  }
+};
+
+//Mirror the neighbor index across the border, which keeps the Bayer pattern
+inline unsigned int reflect(const int k, const unsigned int n) {
+  return k < 0 ? 1 : ((unsigned int) k >= n ? n - 2 : (unsigned int) k);
+}
+
+//Luminance with the weights 0.299, 0.587 and 0.114 in 8 bits fixed point
+inline unsigned char rgbToGray(const unsigned int R, const unsigned int G, const unsigned int B) {
+  return (unsigned char) ((77*R + 150*G + 29*B + 128) >> 8);
+}
+
+inline void storePixel(vpRGBa &dst, const unsigned char R, const unsigned char G, const unsigned char B) {
+  dst.R = R;
+  dst.G = G;
+  dst.B = B;
+  dst.A = 255;
+}
+
+inline void storePixel(unsigned char &dst, const unsigned char R, const unsigned char G, const unsigned char B) {
+  dst = rgbToGray(R, G, B);
+}
+
+/*
+  Bilinear interpolation at pixel j of the current row, jm and jp being the indexes of the left and right neighbors.
+  At a red or blue site the green is the mean of the 4 horizontal and vertical neighbors and the other color the
+  mean of the 4 diagonal neighbors. At a green site the color of the row is the mean of the left and right neighbors
+  and the other color the mean of the up and down neighbors.
+*/
+template <class Type>
+inline void bilinearPixel(const unsigned char *up, const unsigned char *cur, const unsigned char *down,
+                          const unsigned int j, const unsigned int jm, const unsigned int jp,
+                          const bool redRow, const bool colorSite, Type &dst) {
+  unsigned char own, green, other;
+  if (colorSite) {
+    own = cur[j];
+    green = (unsigned char) ((cur[jm] + cur[jp] + up[j] + down[j] + 2) >> 2);
+    other = (unsigned char) ((up[jm] + up[jp] + down[jm] + down[jp] + 2) >> 2);
+  }
+  else {
+    own = (unsigned char) ((cur[jm] + cur[jp] + 1) >> 1);
+    green = cur[j];
+    other = (unsigned char) ((up[j] + down[j] + 1) >> 1);
+  }
+
+  if (redRow)
+    storePixel(dst, own, green, other);
+  else
+    storePixel(dst, other, green, own);
+}
+
+#if defined(VP_FLYCAPTURE_HAVE_SSE2)
+inline __m128i mean4(const __m128i &a, const __m128i &b, const __m128i &c, const __m128i &d) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i two = _mm_set1_epi16(2);
+  __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                             _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+  __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+                             _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+  lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+  hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+  return _mm_packus_epi16(lo, hi);
+}
+
+inline __m128i select(const __m128i &mask, const __m128i &a, const __m128i &b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+inline void storePixels(vpRGBa *dst, const __m128i &R, const __m128i &G, const __m128i &B) {
+  const __m128i A = _mm_set1_epi8((char) 255);
+  const __m128i rg_lo = _mm_unpacklo_epi8(R, G);
+  const __m128i rg_hi = _mm_unpackhi_epi8(R, G);
+  const __m128i ba_lo = _mm_unpacklo_epi8(B, A);
+  const __m128i ba_hi = _mm_unpackhi_epi8(B, A);
+  __m128i *p = (__m128i *) dst;
+  _mm_storeu_si128(p, _mm_unpacklo_epi16(rg_lo, ba_lo));
+  _mm_storeu_si128(p + 1, _mm_unpackhi_epi16(rg_lo, ba_lo));
+  _mm_storeu_si128(p + 2, _mm_unpacklo_epi16(rg_hi, ba_hi));
+  _mm_storeu_si128(p + 3, _mm_unpackhi_epi16(rg_hi, ba_hi));
+}
+
+inline __m128i gray8(const __m128i &R, const __m128i &G, const __m128i &B, const __m128i &zero) {
+  const __m128i wr = _mm_set1_epi16(77);
+  const __m128i wg = _mm_set1_epi16(150);
+  const __m128i wb = _mm_set1_epi16(29);
+  const __m128i half = _mm_set1_epi16(128);
+  //The weighted sum is at most 255*256 and fits in unsigned 16 bits
+  __m128i y = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(R, zero), wr), _mm_mullo_epi16(_mm_unpacklo_epi8(G, zero), wg));
+  y = _mm_add_epi16(_mm_add_epi16(y, _mm_mullo_epi16(_mm_unpacklo_epi8(B, zero), wb)), half);
+  return _mm_srli_epi16(y, 8);
+}
+
+inline void storePixels(unsigned char *dst, const __m128i &R, const __m128i &G, const __m128i &B) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lo = gray8(R, G, B, zero);
+  const __m128i hi = gray8(_mm_unpackhi_epi64(R, R), _mm_unpackhi_epi64(G, G), _mm_unpackhi_epi64(B, B), zero);
+  _mm_storeu_si128((__m128i *) dst, _mm_packus_epi16(lo, hi));
+}
+
+/*
+  Interpolate the pixels of an interior row 16 at a time, starting at column j >= 1 and as long as the right
+  neighbors are in the row. Return the next column to interpolate.
+*/
+template <class Type>
+unsigned int bilinearRowSse2(const unsigned char *up, const unsigned char *cur, const unsigned char *down,
+                             const unsigned int cols, unsigned int j, const bool redRow, const bool colorSiteFirst,
+                             Type *dst) {
+  //Lanes holding a red or blue site, the parity of j does not change
+  const __m128i even = _mm_set1_epi16(0x00FF);
+  const __m128i colorMask = colorSiteFirst ? even : _mm_xor_si128(even, _mm_set1_epi8((char) 0xFF));
+
+  for (; j + 17 <= cols; j += 16) {
+    const __m128i l = _mm_loadu_si128((const __m128i *) (cur + j - 1));
+    const __m128i c = _mm_loadu_si128((const __m128i *) (cur + j));
+    const __m128i r = _mm_loadu_si128((const __m128i *) (cur + j + 1));
+    const __m128i u = _mm_loadu_si128((const __m128i *) (up + j));
+    const __m128i d = _mm_loadu_si128((const __m128i *) (down + j));
+    const __m128i ul = _mm_loadu_si128((const __m128i *) (up + j - 1));
+    const __m128i ur = _mm_loadu_si128((const __m128i *) (up + j + 1));
+    const __m128i dl = _mm_loadu_si128((const __m128i *) (down + j - 1));
+    const __m128i dr = _mm_loadu_si128((const __m128i *) (down + j + 1));
+
+    //_mm_avg_epu8 rounds as (a + b + 1) >> 1
+    const __m128i own = select(colorMask, c, _mm_avg_epu8(l, r));
+    const __m128i green = select(colorMask, mean4(l, r, u, d), c);
+    const __m128i other = select(colorMask, mean4(ul, ur, dl, dr), _mm_avg_epu8(u, d));
+
+    if (redRow)
+      storePixels(dst + j, own, green, other);
+    else
+      storePixels(dst + j, other, green, own);
+  }
+
+  return j;
+}
+#endif
+
+template <class Type>
+void bilinearRow(const vpBayerImage &bayer, const unsigned int i, Type *dst) {
+  const unsigned int cols = bayer.cols;
+  const unsigned char *up = bayer.row(reflect((int) i - 1, bayer.rows));
+  const unsigned char *cur = bayer.row(i);
+  const unsigned char *down = bayer.row(reflect((int) i + 1, bayer.rows));
+  const bool redRow = ((i + bayer.dy) & 1) == 0;
+  const unsigned int rowParity = (i + bayer.dy) & 1;
+
+  bilinearPixel(up, cur, down, 0, 1, 1, redRow, (bayer.dx & 1) == rowParity, dst[0]);
+
+  unsigned int j = 1;
+#if defined(VP_FLYCAPTURE_HAVE_SSE2)
+  j = bilinearRowSse2(up, cur, down, cols, j, redRow, ((j + bayer.dx) & 1) == rowParity, dst);
+#endif
+  for (; j + 1 < cols; j++) {
+    bilinearPixel(up, cur, down, j, j - 1, j + 1, redRow, ((j + bayer.dx) & 1) == rowParity, dst[j]);
+  }
+
+  bilinearPixel(up, cur, down, cols - 1, cols - 2, cols - 2, redRow, ((cols - 1 + bayer.dx) & 1) == rowParity,
+                dst[cols - 1]);
+}
+
+template <class Type>
+void halfSizeRow(const vpBayerImage &bayer, const unsigned int y, Type *dst) {
+  //The red site is at row dy and column dx of each 2x2 cell, the blue site at the opposite corner
+  const unsigned char *redRow = bayer.row(2*y + bayer.dy);
+  const unsigned char *blueRow = bayer.row(2*y + 1 - bayer.dy);
+  const unsigned int dx = bayer.dx;
+  for (unsigned int x = 0; x < bayer.cols / 2; x++) {
+    const unsigned char R = redRow[2*x + dx];
+    const unsigned char G = (unsigned char) ((redRow[2*x + 1 - dx] + blueRow[2*x + dx] + 1) >> 1);
+    const unsigned char B = blueRow[2*x + 1 - dx];
+    storePixel(dst[x], R, G, B);
+  }
+}
+
+template <class Type>
+struct vpDemosaicJob {
+  const vpBayerImage *bayer;
+  bool halfSize;
+  Type *dst;
+  unsigned int dstCols;
+  unsigned int begin;
+  unsigned int end;
+};
+
+template <class Type>
+void runDemosaicJob(const vpDemosaicJob<Type> &job) {
+  for (unsigned int i = job.begin; i < job.end; i++) {
+    if (job.halfSize)
+      halfSizeRow(*job.bayer, i, job.dst + i*job.dstCols);
+    else
+      bilinearRow(*job.bayer, i, job.dst + i*job.dstCols);
+  }
+}
+
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+template <class Type>
+vpThread::Return demosaicThread(vpThread::Args args) {
+  runDemosaicJob(*((vpDemosaicJob<Type> *) args));
+  return 0;
+}
+#endif
+
+template <class Type>
+void demosaic(const unsigned char *bitmap, const unsigned int rows, const unsigned int cols, const unsigned int stride,
+              const FlyCapture2::BayerTileFormat &bayerFormat, const bool halfSize, unsigned int nbThreads,
+              Type *dst) {
+  vpBayerImage bayer;
+  bayer.bitmap = bitmap;
+  bayer.rows = rows;
+  bayer.cols = cols;
+  bayer.stride = stride;
+  switch (bayerFormat) {
+  case FlyCapture2::RGGB:
+    bayer.dy = 0;
+    bayer.dx = 0;
+    break;
+  case FlyCapture2::GRBG:
+    bayer.dy = 0;
+    bayer.dx = 1;
+    break;
+  case FlyCapture2::GBRG:
+    bayer.dy = 1;
+    bayer.dx = 0;
+    break;
+  case FlyCapture2::BGGR:
+    bayer.dy = 1;
+    bayer.dx = 1;
+    break;
+  default:
+    throw (vpException(vpException::badValue, "The image has no Bayer tile format"));
+  }
+  if (rows < 2 || cols < 2) {
+    throw (vpException(vpException::badValue,
+                       "Cannot convert a %dx%d Bayer image, at least 2x2 is needed", cols, rows));
+  }
+
+  vpDemosaicJob<Type> job;
+  job.bayer = &bayer;
+  job.halfSize = halfSize;
+  job.dst = dst;
+  job.dstCols = halfSize ? cols / 2 : cols;
+  job.begin = 0;
+  job.end = halfSize ? rows / 2 : rows;
+
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+  if (nbThreads == 0)
+    nbThreads = vpFlyCaptureLock::getNbProcessors();
+  nbThreads = std::max(1u, std::min(nbThreads, job.end / DEMOSAIC_MIN_ROWS));
+
+  if (nbThreads > 1) {
+    std::vector< vpDemosaicJob<Type> > jobs(nbThreads, job);
+    for (unsigned int k = 0; k < nbThreads; k++) {
+      jobs[k].begin = (unsigned int) ((unsigned long long) job.end * k / nbThreads);
+      jobs[k].end = (unsigned int) ((unsigned long long) job.end * (k+1) / nbThreads);
+    }
+
+    //The last rows are converted by the calling thread
+    std::vector<vpThread *> threads;
+    for (unsigned int k = 0; k + 1 < nbThreads; k++) {
+      threads.push_back(new vpThread(demosaicThread<Type>, (vpThread::Args) &jobs[k]));
+    }
+    runDemosaicJob(jobs[nbThreads - 1]);
+
+    for (size_t k = 0; k < threads.size(); k++) {
+      threads[k]->join();
+      delete threads[k];
+    }
+    return;
+  }
+#else
+  (void)nbThreads;
+#endif
+
+  runDemosaicJob(job);
+}
+}
+
+void vpDemosaicBayer(const unsigned char *bayer, unsigned int rows, unsigned int cols, unsigned int stride,
+                     FlyCapture2::BayerTileFormat bayerFormat, bool halfSize, unsigned int nbThreads, vpRGBa *dst)
+{
+  demosaic(bayer, rows, cols, stride, bayerFormat, halfSize, nbThreads, dst);
+}
+
+void vpDemosaicBayer(const unsigned char *bayer, unsigned int rows, unsigned int cols, unsigned int stride,
+                     FlyCapture2::BayerTileFormat bayerFormat, bool halfSize, unsigned int nbThreads,
+                     unsigned char *dst)
+{
+  demosaic(bayer, rows, cols, stride, bayerFormat, halfSize, nbThreads, dst);
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Convert a raw Bayer image, as returned by acquireRaw(), into a color image.
+
+  \param bayer : Raw Bayer image.
+  \param bayerFormat : Bayer tile format of \e bayer, see getBayerTileFormat().
+  \param I : Color image. With DEMOSAIC_HALF_SIZE its size is half the size of \e bayer.
+  \param method : Conversion method; DEMOSAIC_SDK is handled as DEMOSAIC_BILINEAR.
+  \param nbThreads : Number of threads converting the rows, 0 for the number of processors.
+
+  \exception vpException::badValue : If \e bayerFormat is FlyCapture2::NONE or if \e bayer is smaller than 2x2.
+ */
+void vpFlyCaptureGrabber::demosaic(const vpImage<unsigned char> &bayer, FlyCapture2::BayerTileFormat bayerFormat,
+                                   vpImage<vpRGBa> &I, vpDemosaicMethod method, unsigned int nbThreads)
+{
+  const bool halfSize = (method == DEMOSAIC_HALF_SIZE);
+  I.resize(halfSize ? bayer.getHeight() / 2 : bayer.getHeight(), halfSize ? bayer.getWidth() / 2 : bayer.getWidth());
+  vpDemosaicBayer(bayer.bitmap, bayer.getHeight(), bayer.getWidth(), bayer.getWidth(), bayerFormat, halfSize,
+                  nbThreads, I.bitmap);
+}
+
+/*!
+  Convert a raw Bayer image, as returned by acquireRaw(), into a gray level image, without computing the
+  intermediate color image.
+
+  \param bayer : Raw Bayer image.
+  \param bayerFormat : Bayer tile format of \e bayer, see getBayerTileFormat().
+  \param I : Gray level image. With DEMOSAIC_HALF_SIZE its size is half the size of \e bayer.
+  \param method : Conversion method; DEMOSAIC_SDK is handled as DEMOSAIC_BILINEAR.
+  \param nbThreads : Number of threads converting the rows, 0 for the number of processors.
+
+  \exception vpException::badValue : If \e bayerFormat is FlyCapture2::NONE or if \e bayer is smaller than 2x2.
+ */
+void vpFlyCaptureGrabber::demosaic(const vpImage<unsigned char> &bayer, FlyCapture2::BayerTileFormat bayerFormat,
+                                   vpImage<unsigned char> &I, vpDemosaicMethod method, unsigned int nbThreads)
+{
+  const bool halfSize = (method == DEMOSAIC_HALF_SIZE);
+  I.resize(halfSize ? bayer.getHeight() / 2 : bayer.getHeight(), halfSize ? bayer.getWidth() / 2 : bayer.getWidth());
+  vpDemosaicBayer(bayer.bitmap, bayer.getHeight(), bayer.getWidth(), bayer.getWidth(), bayerFormat, halfSize,
+                  nbThreads, I.bitmap);
+}
+
+#elif !defined(VISP_BUILD_SHARED_LIBS)
+// Work arround to avoid warning: libvisp_flycapture.a(vpFlyCaptureDemosaic.cpp.o) has no symbols
+void dummy_vpFlyCaptureDemosaic() {};
+#endif
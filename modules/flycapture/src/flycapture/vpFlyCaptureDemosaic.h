@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Conversion of raw Bayer images.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpFlyCaptureDemosaic.h
+  \brief Conversion of raw Bayer images to color or gray level images (private header).
+*/
+
+#ifndef __vpFlyCaptureDemosaic_h_
+#define __vpFlyCaptureDemosaic_h_
+
+#include <visp3/core/vpConfig.h>
+#include <visp3/core/vpRGBa.h>
+#include <visp3/flycapture/vpConfigFlycapture.h>
+
+#ifdef VISP_HAVE_FLYCAPTURE
+
+#include <FlyCapture2.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/*
+  Convert the rows x cols Bayer image with the given row stride in bytes. With halfSize each 2x2 Bayer cell gives one
+  pixel and dst has (rows/2) x (cols/2) pixels, otherwise the missing colors are interpolated bilinearly and dst has
+  rows x cols pixels. The rows are split over nbThreads threads, 0 for the number of processors.
+*/
+void vpDemosaicBayer(const unsigned char *bayer, unsigned int rows, unsigned int cols, unsigned int stride,
+                     FlyCapture2::BayerTileFormat bayerFormat, bool halfSize, unsigned int nbThreads, vpRGBa *dst);
+void vpDemosaicBayer(const unsigned char *bayer, unsigned int rows, unsigned int cols, unsigned int stride,
+                     FlyCapture2::BayerTileFormat bayerFormat, bool halfSize, unsigned int nbThreads,
+                     unsigned char *dst);
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif
+#endif
@@ -47,11 +47,239 @@
 
 #include <visp3/core/vpTime.h>
 
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include "vpFlyCaptureDemosaic.h"
+#include "vpFlyCaptureLock.h"
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+#  include <visp3/core/vpThread.h>
+#  define VP_FLYCAPTURE_HAVE_THREADS 1
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+/*
+  Sensor time in ms, modulo 128 s, of a frame from its 1394 cycle time: 7 bits of seconds, 13 bits of 8 kHz cycles
+  and 12 bits of 1/3072 cycle offsets. The timestamp embedded in the pixels is used when it is switched on.
+*/
+double getSensorTimeMs(const FlyCapture2::Image &rawImage, const bool embedded)
+{
+  unsigned int seconds, cycleCount, cycleOffset;
+  if (embedded) {
+    const unsigned int ts = rawImage.GetMetadata().embeddedTimeStamp;
+    seconds = (ts >> 25) & 0x7F;
+    cycleCount = (ts >> 12) & 0x1FFF;
+    cycleOffset = ts & 0xFFF;
+  }
+  else {
+    const FlyCapture2::TimeStamp ts = rawImage.GetTimeStamp();
+    seconds = ts.cycleSeconds & 0x7F;
+    cycleCount = ts.cycleCount;
+    cycleOffset = ts.cycleOffset;
+  }
+  return seconds * 1000. + cycleCount / 8. + cycleOffset / (8. * 3072.);
+}
+
+/*
+  Convert the raw image straight into the bitmap of I, wrapped in a FlyCapture2::Image, so that neither an
+  intermediate image is allocated nor the converted pixels copied. When the raw pixel format is already the
+  expected one the conversion is skipped and the rows are just copied. Unless the SDK is asked for, the raw Bayer
+  frames are converted by ViSP.
+*/
+template <class Type>
+FlyCapture2::Error convertRawImage(const FlyCapture2::Image &rawImage, const FlyCapture2::PixelFormat &format,
+                                   const vpFlyCaptureGrabber::vpDemosaicMethod &method,
+                                   const unsigned int nbThreads, vpImage<Type> &I)
+{
+  const unsigned int rows = rawImage.GetRows();
+  const unsigned int cols = rawImage.GetCols();
+  const unsigned int stride = cols * (unsigned int) sizeof(Type);
+
+  if (method != vpFlyCaptureGrabber::DEMOSAIC_SDK && rawImage.GetPixelFormat() == FlyCapture2::PIXEL_FORMAT_RAW8
+      && rawImage.GetBayerTileFormat() != FlyCapture2::NONE) {
+    const bool halfSize = (method == vpFlyCaptureGrabber::DEMOSAIC_HALF_SIZE);
+    I.resize(halfSize ? rows / 2 : rows, halfSize ? cols / 2 : cols);
+    vpDemosaicBayer(rawImage.GetData(), rows, cols, rawImage.GetStride(), rawImage.GetBayerTileFormat(), halfSize,
+                    nbThreads, I.bitmap);
+    return FlyCapture2::Error();
+  }
+
+  I.resize(rows, cols);
+  unsigned char *bitmap = (unsigned char *) I.bitmap;
+
+  if (rawImage.GetPixelFormat() == format) {
+    const unsigned char *data = rawImage.GetData();
+    const unsigned int rawStride = rawImage.GetStride();
+    if (rawStride == stride) {
+      memcpy(bitmap, data, rows*stride);
+    }
+    else {
+      for (unsigned int i = 0; i < rows; i++) {
+        memcpy(bitmap + i*stride, data + i*rawStride, stride);
+      }
+    }
+    return FlyCapture2::Error();
+  }
+
+  FlyCapture2::Image convertedImage(rows, cols, stride, bitmap, rows*stride, format);
+  return rawImage.Convert( format, &convertedImage );
+}
+
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+/*
+  Errors of RetrieveBuffer() after which the capture goes on: a grab timeout or an image with lost packets. The
+  other errors, as a disconnected camera, are persistent.
+*/
+bool isTransientError(const FlyCapture2::Error &error)
+{
+  return (error == FlyCapture2::PGRERROR_TIMEOUT || error == FlyCapture2::PGRERROR_IMAGE_CONSISTENCY_ERROR);
+}
+
+// Consecutive transient errors after which the capture thread waits before retrying
+const unsigned int asyncMaxErrorsBeforeBackoff = 10;
+// Waiting time in ms before retrying, doubled at each error up to asyncMaxBackoffMs
+const double asyncMinBackoffMs = 1.;
+const double asyncMaxBackoffMs = 100.;
+#endif
+}
+
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+/*
+  Ring of preallocated images filled by the capture thread. A slot is either free, being written by the capture
+  thread, ready (waiting to be read, oldest first) or being copied by a consumer, so that the capture thread and
+  the consumers never access the same image.
+*/
+class vpFlyCaptureAsyncCapture
+{
+public:
+  struct vpSlot {
+    vpImage<unsigned char> m_gray;
+    vpImage<vpRGBa> m_color;
+    FlyCapture2::TimeStamp m_timestamp;
+  };
+
+  vpFlyCaptureAsyncCapture(vpFlyCaptureGrabber &grabber, const bool color, const unsigned int nbBuffers,
+                           const vpFlyCaptureGrabber::vpAsyncDropPolicy &policy)
+    : m_grabber(grabber), m_color(color), m_policy(policy), m_lock(), m_slots(nbBuffers), m_free(), m_ready(),
+      m_stop(false), m_running(true), m_error(), m_captured(0), m_dropped(0), m_skipped(0),
+      m_demosaicMethod(grabber.m_demosaicMethod), m_demosaicThreads(grabber.m_demosaicThreads),
+      m_statistics(grabber.m_statsEnabled), m_rawImage(),
+      m_thread()
+  {
+    for (unsigned int i = 0; i < nbBuffers; i++) {
+      m_free.push_back(nbBuffers - 1 - i);
+      if (grabber.getHeight() > 0 && grabber.getWidth() > 0) {
+        if (color)
+          m_slots[i].m_color.resize(grabber.getHeight(), grabber.getWidth());
+        else
+          m_slots[i].m_gray.resize(grabber.getHeight(), grabber.getWidth());
+      }
+    }
+  }
+
+  void start() {
+    m_thread.create(vpFlyCaptureAsyncCapture::run, (vpThread::Args) this);
+  }
+
+  static vpThread::Return run(vpThread::Args args) {
+    vpFlyCaptureAsyncCapture *async = (vpFlyCaptureAsyncCapture *) args;
+    async->m_grabber.runAsyncCapture();
+    return 0;
+  }
+
+  //! Copy the oldest (or the most recent) ready frame, waiting at most timeout_ms milliseconds (forever if negative).
+  template <class Type>
+  bool read(vpImage<Type> &I, FlyCapture2::TimeStamp &timestamp, const int timeout_ms, const bool latest) {
+    unsigned int slot = 0;
+    {
+      vpFlyCaptureLock::vpScopedLock lock(m_lock);
+      const double t_start = vpTime::measureTimeMs();
+      while (m_ready.empty() && m_running) {
+        double remaining = -1.0;
+        if (timeout_ms >= 0) {
+          remaining = timeout_ms - (vpTime::measureTimeMs() - t_start);
+          if (remaining <= 0)
+            return false;
+        }
+        m_lock.wait(remaining);
+      }
+
+      if (m_ready.empty()) {
+        // The capture thread stopped
+        if (m_error != FlyCapture2::PGRERROR_OK) {
+          throw (vpException(vpException::fatalError,
+                             "Asynchronous capture of camera with guid 0x%lx stopped on error: %s",
+                             m_grabber.m_guid, m_error.GetDescription()));
+        }
+        return false;
+      }
+
+      if (latest) {
+        while (m_ready.size() > 1) {
+          m_free.push_back(m_ready.front());
+          m_ready.pop_front();
+          m_skipped++;
+        }
+      }
+      slot = m_ready.front();
+      m_ready.pop_front();
+    }
+
+    const double t_start = m_statistics ? vpTime::measureTimeMs() : 0.;
+    I = getImage(m_slots[slot], I);
+    timestamp = m_slots[slot].m_timestamp;
+
+    vpFlyCaptureLock::vpScopedLock lock(m_lock);
+    m_free.push_back(slot);
+    if (m_statistics) {
+      m_grabber.m_stats.addSample(vpFlyCaptureStatistics::STAGE_COPY, vpTime::measureTimeMs() - t_start);
+    }
+    return true;
+  }
+
+  vpImage<unsigned char> &getImage(vpSlot &slot, const vpImage<unsigned char> &) {
+    return slot.m_gray;
+  }
+  vpImage<vpRGBa> &getImage(vpSlot &slot, const vpImage<vpRGBa> &) {
+    return slot.m_color;
+  }
+
+  vpFlyCaptureGrabber &m_grabber;
+  const bool m_color;
+  const vpFlyCaptureGrabber::vpAsyncDropPolicy m_policy;
+  vpFlyCaptureLock m_lock;
+  std::vector<vpSlot> m_slots;
+  std::vector<unsigned int> m_free;   // Free slots
+  std::deque<unsigned int> m_ready;   // Slots holding a frame not yet read, the oldest first
+  bool m_stop;                        // Stop requested by stopAsyncCapture()
+  bool m_running;                     // False once the capture thread exits
+  FlyCapture2::Error m_error;         // Persistent error that stopped the capture thread
+  unsigned int m_captured;
+  unsigned int m_dropped;
+  unsigned int m_skipped;
+  const vpFlyCaptureGrabber::vpDemosaicMethod m_demosaicMethod;
+  const unsigned int m_demosaicThreads;
+  const bool m_statistics;            // Statistics enabled when the capture started
+  FlyCapture2::Image m_rawImage; // Only used by the capture thread
+  vpThread m_thread;
+};
+#else
+class vpFlyCaptureAsyncCapture
+{
+};
+#endif
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /*!
    Default constructor that consider the first camera found on the bus as active.
  */
 vpFlyCaptureGrabber::vpFlyCaptureGrabber()
-  : m_camera(), m_guid(), m_index(0), m_numCameras(0), m_rawImage(), m_connected(false), m_capture(false)
+  : m_camera(), m_guid(), m_index(0), m_numCameras(0), m_rawImage(), m_connected(false), m_capture(false),
+    m_async(NULL), m_demosaicMethod(DEMOSAIC_SDK), m_demosaicThreads(0), m_bayerFormat(FlyCapture2::NONE),
+    m_statsEnabled(false), m_stats(), m_embeddedInfo(), m_embeddedInfoChanged(false)
 {
   m_numCameras = this->getNumCameras();
 }
@@ -1000,6 +1228,8 @@ void vpFlyCaptureGrabber::startCapture()
  */
 void vpFlyCaptureGrabber::stopCapture()
 {
+  this->stopAsyncCapture();
+
   if (m_capture == true) {
 
     FlyCapture2::Error error;
@@ -1061,6 +1291,8 @@ void vpFlyCaptureGrabber::connect()
  */
 void vpFlyCaptureGrabber::disconnect()
 {
+  this->stopAsyncCapture();
+
   if (m_connected == true) {
 
     FlyCapture2::Error error;
@@ -1116,9 +1348,18 @@ void vpFlyCaptureGrabber::acquire(vpImage<unsigned char> &I)
 */
 void vpFlyCaptureGrabber::acquire(vpImage<unsigned char> &I, FlyCapture2::TimeStamp &timestamp)
 {
+  if (m_async != NULL) {
+    if (! this->acquireNext(I, timestamp)) {
+      throw (vpException(vpException::fatalError,
+                         "Asynchronous capture stopped for camera with guid 0x%lx", m_guid));
+    }
+    return;
+  }
+
   this->open();
 
   FlyCapture2::Error error;
+  const double t_start = m_statsEnabled ? vpTime::measureTimeMs() : 0.;
   // Retrieve an image
   error = m_camera.RetrieveBuffer( &m_rawImage );
   if (error != FlyCapture2::PGRERROR_OK) {
@@ -1127,24 +1368,22 @@ void vpFlyCaptureGrabber::acquire(vpImage<unsigned char> &I, FlyCapture2::TimeSt
                        "Cannot retrieve image for camera with guid 0x%lx",
                        m_guid) );
   }
+  const double t_retrieved = m_statsEnabled ? vpTime::measureTimeMs() : 0.;
   timestamp = m_rawImage.GetTimeStamp();
 
-  // Create a converted image
-  FlyCapture2::Image convertedImage;
-
-  // Convert the raw image
-  error = m_rawImage.Convert( FlyCapture2::PIXEL_FORMAT_MONO8, &convertedImage );
+  // Convert the raw image into I
+  error = convertRawImage(m_rawImage, FlyCapture2::PIXEL_FORMAT_MONO8, m_demosaicMethod, m_demosaicThreads, I);
   if (error != FlyCapture2::PGRERROR_OK) {
     error.PrintErrorTrace();
     throw (vpException(vpException::fatalError,
                        "Cannot convert image for camera with guid 0x%lx",
                        m_guid) );
   }
-  height = convertedImage.GetRows();
-  width = convertedImage.GetCols();
-  unsigned char *data = convertedImage.GetData();
-  I.resize(height, width);
-  memcpy(I.bitmap, data, height*width);
+  if (m_statsEnabled) {
+    this->updateStatistics(m_stats, t_start, t_retrieved, m_rawImage);
+  }
+  height = I.getHeight();
+  width = I.getWidth();
 }
 
 /*!
@@ -1167,9 +1406,18 @@ void vpFlyCaptureGrabber::acquire(vpImage<vpRGBa> &I)
 */
 void vpFlyCaptureGrabber::acquire(vpImage<vpRGBa> &I, FlyCapture2::TimeStamp &timestamp)
 {
+  if (m_async != NULL) {
+    if (! this->acquireNext(I, timestamp)) {
+      throw (vpException(vpException::fatalError,
+                         "Asynchronous capture stopped for camera with guid 0x%lx", m_guid));
+    }
+    return;
+  }
+
   this->open();
 
   FlyCapture2::Error error;
+  const double t_start = m_statsEnabled ? vpTime::measureTimeMs() : 0.;
   // Retrieve an image
   error = m_camera.RetrieveBuffer( &m_rawImage );
   if (error != FlyCapture2::PGRERROR_OK) {
@@ -1178,27 +1426,561 @@ void vpFlyCaptureGrabber::acquire(vpImage<vpRGBa> &I, FlyCapture2::TimeStamp &ti
                        "Cannot retrieve image for camera with guid 0x%lx",
                        m_guid) );
   }
+  const double t_retrieved = m_statsEnabled ? vpTime::measureTimeMs() : 0.;
   timestamp = m_rawImage.GetTimeStamp();
 
-  // Create a converted image
-  FlyCapture2::Image convertedImage;
-
-  // Convert the raw image
-  error = m_rawImage.Convert( FlyCapture2::PIXEL_FORMAT_RGBU, &convertedImage );
+  // Convert the raw image into I
+  error = convertRawImage(m_rawImage, FlyCapture2::PIXEL_FORMAT_RGBU, m_demosaicMethod, m_demosaicThreads, I);
   if (error != FlyCapture2::PGRERROR_OK) {
     error.PrintErrorTrace();
     throw (vpException(vpException::fatalError,
                        "Cannot convert image for camera with guid 0x%lx",
                        m_guid) );
   }
-  height = convertedImage.GetRows();
-  width = convertedImage.GetCols();
-  unsigned char *data = convertedImage.GetData();
-  I.resize(height, width);
-  unsigned int bps = convertedImage.GetBitsPerPixel();
-  memcpy(I.bitmap, data, width*height*bps/8);
+  if (m_statsEnabled) {
+    this->updateStatistics(m_stats, t_start, t_retrieved, m_rawImage);
+  }
+  height = I.getHeight();
+  width = I.getWidth();
+}
+
+/*!
+  Acquire a raw image from the active camera, without conversion. When the camera sends Bayer frames, for example
+  after setFormat7VideoMode() with FlyCapture2::PIXEL_FORMAT_RAW8, the image is the Bayer mosaic; its tile format is
+  given by getBayerTileFormat() and demosaic() converts it.
+
+  \param I : Image data structure (8 bits image).
+
+  \exception vpException::badValue : If the pixels of the camera do not have 8 bits.
+*/
+void vpFlyCaptureGrabber::acquireRaw(vpImage<unsigned char> &I)
+{
+  FlyCapture2::TimeStamp timestamp;
+  this->acquireRaw(I, timestamp);
+}
+
+/*!
+  Acquire a raw image from the active camera, without conversion. When the camera sends Bayer frames, for example
+  after setFormat7VideoMode() with FlyCapture2::PIXEL_FORMAT_RAW8, the image is the Bayer mosaic; its tile format is
+  given by getBayerTileFormat() and demosaic() converts it.
+
+  \param I : Image data structure (8 bits image).
+
+  \param timestamp : The acquisition timestamp.
+
+  \exception vpException::badValue : If the pixels of the camera do not have 8 bits.
+  \exception vpException::fatalError : If the asynchronous capture is started.
+*/
+void vpFlyCaptureGrabber::acquireRaw(vpImage<unsigned char> &I, FlyCapture2::TimeStamp &timestamp)
+{
+  if (m_async != NULL) {
+    throw (vpException(vpException::fatalError,
+                       "Cannot acquire raw images during the asynchronous capture of camera with guid 0x%lx",
+                       m_guid));
+  }
+
+  this->open();
+
+  FlyCapture2::Error error;
+  const double t_start = m_statsEnabled ? vpTime::measureTimeMs() : 0.;
+  // Retrieve an image
+  error = m_camera.RetrieveBuffer( &m_rawImage );
+  if (error != FlyCapture2::PGRERROR_OK) {
+    error.PrintErrorTrace();
+    throw (vpException(vpException::fatalError,
+                       "Cannot retrieve image for camera with guid 0x%lx",
+                       m_guid) );
+  }
+  const double t_retrieved = m_statsEnabled ? vpTime::measureTimeMs() : 0.;
+  if (m_rawImage.GetBitsPerPixel() != 8) {
+    throw (vpException(vpException::badValue,
+                       "Raw images of camera with guid 0x%lx have %d bits per pixel, only 8 bits are supported",
+                       m_guid, m_rawImage.GetBitsPerPixel()) );
+  }
+  timestamp = m_rawImage.GetTimeStamp();
+  m_bayerFormat = m_rawImage.GetBayerTileFormat();
+
+  // The pixel format matches, the rows are copied
+  convertRawImage(m_rawImage, m_rawImage.GetPixelFormat(), DEMOSAIC_SDK, 0, I);
+  if (m_statsEnabled) {
+    this->updateStatistics(m_stats, t_start, t_retrieved, m_rawImage);
+  }
+  height = I.getHeight();
+  width = I.getWidth();
+}
+
+/*!
+  Select how acquire() converts the raw Bayer frames (FlyCapture2::PIXEL_FORMAT_RAW8). The other pixel formats
+  are always converted by the SDK.
+
+  With DEMOSAIC_BILINEAR or DEMOSAIC_HALF_SIZE the conversion is done by ViSP on several threads, and gray level
+  images are computed from the mosaic without the intermediate color image. DEMOSAIC_HALF_SIZE is the cheapest and
+  returns images of half the sensor size.
+
+  The asynchronous capture uses the method set before startAsyncCapture().
+
+  \param method : Conversion method, DEMOSAIC_SDK by default.
+  \param nbThreads : Number of threads of the ViSP conversion, 0 for the number of processors.
+
+  \sa acquireRaw(), demosaic()
+*/
+void vpFlyCaptureGrabber::setDemosaicMethod(vpDemosaicMethod method, unsigned int nbThreads)
+{
+  m_demosaicMethod = method;
+  m_demosaicThreads = nbThreads;
+}
+
+/*!
+  Copy the oldest frame captured by the asynchronous capture thread and not yet read.
+
+  \param I : Gray level image, the capture must have been started with startAsyncCapture(false).
+  \param timestamp : The acquisition timestamp.
+  \param timeout_ms : Maximum waiting time in milliseconds when no frame is ready; 0 returns immediately and a
+  negative value waits until a frame is captured.
+
+  \return true if a frame was copied, false on timeout or if the capture thread stopped.
+
+  \exception vpException::fatalError : The capture thread stopped on a persistent error of the camera, as a
+  disconnection, and all the frames captured before were read.
+
+  \sa acquireLatest(), startAsyncCapture()
+ */
+bool vpFlyCaptureGrabber::acquireNext(vpImage<unsigned char> &I, FlyCapture2::TimeStamp &timestamp, int timeout_ms)
+{
+  return this->acquireAsync(I, timestamp, timeout_ms, false);
+}
+
+/*!
+  Copy the oldest frame captured by the asynchronous capture thread and not yet read.
+
+  \param I : Color image, the capture must have been started with startAsyncCapture(true).
+  \param timestamp : The acquisition timestamp.
+  \param timeout_ms : Maximum waiting time in milliseconds when no frame is ready; 0 returns immediately and a
+  negative value waits until a frame is captured.
+
+  \return true if a frame was copied, false on timeout or if the capture thread stopped.
+
+  \exception vpException::fatalError : The capture thread stopped on a persistent error of the camera, as a
+  disconnection, and all the frames captured before were read.
+
+  \sa acquireLatest(), startAsyncCapture()
+ */
+bool vpFlyCaptureGrabber::acquireNext(vpImage<vpRGBa> &I, FlyCapture2::TimeStamp &timestamp, int timeout_ms)
+{
+  return this->acquireAsync(I, timestamp, timeout_ms, false);
+}
+
+/*!
+  Copy the most recent frame captured by the asynchronous capture thread. The older frames not yet read are
+  released and counted by getAsyncSkippedFrames().
+
+  \param I : Gray level image, the capture must have been started with startAsyncCapture(false).
+  \param timestamp : The acquisition timestamp.
+  \param timeout_ms : Maximum waiting time in milliseconds when no frame is ready; 0 returns immediately and a
+  negative value waits until a frame is captured.
+
+  \return true if a frame was copied, false on timeout or if the capture thread stopped.
+
+  \exception vpException::fatalError : The capture thread stopped on a persistent error of the camera, as a
+  disconnection, and all the frames captured before were read.
+
+  \sa acquireNext(), startAsyncCapture()
+ */
+bool vpFlyCaptureGrabber::acquireLatest(vpImage<unsigned char> &I, FlyCapture2::TimeStamp &timestamp, int timeout_ms)
+{
+  return this->acquireAsync(I, timestamp, timeout_ms, true);
+}
+
+/*!
+  Copy the most recent frame captured by the asynchronous capture thread. The older frames not yet read are
+  released and counted by getAsyncSkippedFrames().
+
+  \param I : Color image, the capture must have been started with startAsyncCapture(true).
+  \param timestamp : The acquisition timestamp.
+  \param timeout_ms : Maximum waiting time in milliseconds when no frame is ready; 0 returns immediately and a
+  negative value waits until a frame is captured.
+
+  \return true if a frame was copied, false on timeout or if the capture thread stopped.
+
+  \exception vpException::fatalError : The capture thread stopped on a persistent error of the camera, as a
+  disconnection, and all the frames captured before were read.
+
+  \sa acquireNext(), startAsyncCapture()
+ */
+bool vpFlyCaptureGrabber::acquireLatest(vpImage<vpRGBa> &I, FlyCapture2::TimeStamp &timestamp, int timeout_ms)
+{
+  return this->acquireAsync(I, timestamp, timeout_ms, true);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template <class Type>
+bool vpFlyCaptureGrabber::acquireAsync(vpImage<Type> &I, FlyCapture2::TimeStamp &timestamp, int timeout_ms,
+                                       bool latest)
+{
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+  if (m_async == NULL) {
+    throw (vpException(vpException::fatalError,
+                       "Asynchronous capture not started for camera with guid 0x%lx", m_guid));
+  }
+  if (m_async->m_color != (sizeof(Type) != 1)) {
+    throw (vpException(vpException::badValue,
+                       "The asynchronous capture of camera with guid 0x%lx captures %s images", m_guid,
+                       m_async->m_color ? "color" : "gray level"));
+  }
+
+  if (! m_async->read(I, timestamp, timeout_ms, latest))
+    return false;
+
+  height = I.getHeight();
+  width = I.getWidth();
+  return true;
+#else
+  (void)I;
+  (void)timestamp;
+  (void)timeout_ms;
+  (void)latest;
+  throw (vpException(vpException::notImplementedError,
+                     "The asynchronous capture needs ViSP to be built with thread support"));
+#endif
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Return the number of frames captured by the asynchronous capture thread since startAsyncCapture(), 0 if the
+  asynchronous capture is not started.
+ */
+unsigned int vpFlyCaptureGrabber::getAsyncCapturedFrames() const
+{
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+  if (m_async != NULL) {
+    vpFlyCaptureLock::vpScopedLock lock(m_async->m_lock);
+    return m_async->m_captured;
+  }
+#endif
+  return 0;
+}
+
+/*!
+  Return the number of frames dropped by the asynchronous capture thread since startAsyncCapture() because all the
+  images of the ring held frames not yet read, 0 if the asynchronous capture is not started.
+
+  \sa vpAsyncDropPolicy
+ */
+unsigned int vpFlyCaptureGrabber::getAsyncDroppedFrames() const
+{
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+  if (m_async != NULL) {
+    vpFlyCaptureLock::vpScopedLock lock(m_async->m_lock);
+    return m_async->m_dropped;
+  }
+#endif
+  return 0;
+}
+
+/*!
+  Return the number of frames skipped by acquireLatest() since startAsyncCapture(), 0 if the asynchronous capture
+  is not started.
+ */
+unsigned int vpFlyCaptureGrabber::getAsyncSkippedFrames() const
+{
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+  if (m_async != NULL) {
+    vpFlyCaptureLock::vpScopedLock lock(m_async->m_lock);
+    return m_async->m_skipped;
+  }
+#endif
+  return 0;
+}
+
+/*!
+  Start a thread that captures the frames of the active camera into a ring of \e nbBuffers preallocated images.
+  The camera is connected and its capture started if needed. The frames are then obtained with acquireNext() or
+  acquireLatest(), acquire() being similar to acquireNext() without timeout.
+
+  The thread goes on capturing after a timeout or a frame with lost packets, waiting longer and longer before
+  retrying when these errors repeat. Any other error of the camera stops the thread and is reported by the next
+  acquisitions once the frames captured before are read.
+
+  \param color : If true the ring holds color images and frames have to be acquired in vpImage<vpRGBa>, otherwise
+  it holds gray level images.
+  \param nbBuffers : Number of images of the ring, at least 2.
+  \param policy : Frame that is dropped when all the images of the ring hold frames not yet read, see
+  getAsyncDroppedFrames().
+
+  \exception vpException::badValue : If \e nbBuffers is lower than 2.
+  \exception vpException::fatalError : If the asynchronous capture is already started.
+  \exception vpException::notImplementedError : If ViSP is built without thread support.
+
+  \sa stopAsyncCapture()
+ */
+void vpFlyCaptureGrabber::startAsyncCapture(bool color, unsigned int nbBuffers, vpAsyncDropPolicy policy)
+{
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+  if (nbBuffers < 2) {
+    throw (vpException(vpException::badValue,
+                       "The asynchronous capture needs at least 2 buffers, not %d", nbBuffers));
+  }
+  if (m_async != NULL) {
+    throw (vpException(vpException::fatalError,
+                       "Asynchronous capture already started for camera with guid 0x%lx", m_guid));
+  }
+
+  this->open();
+
+  m_async = new vpFlyCaptureAsyncCapture(*this, color, nbBuffers, policy);
+  m_async->start();
+#else
+  (void)color;
+  (void)nbBuffers;
+  (void)policy;
+  throw (vpException(vpException::notImplementedError,
+                     "The asynchronous capture needs ViSP to be built with thread support"));
+#endif
+}
+
+/*!
+  Stop the asynchronous capture thread and release the ring of images. Since the thread may be waiting for a frame,
+  the capture of the camera is stopped as well; a next call to acquire() restarts it.
+
+  \sa startAsyncCapture(), stopCapture()
+ */
+void vpFlyCaptureGrabber::stopAsyncCapture()
+{
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+  if (m_async == NULL)
+    return;
+
+  {
+    vpFlyCaptureLock::vpScopedLock lock(m_async->m_lock);
+    m_async->m_stop = true;
+  }
+
+  // Unblock RetrieveBuffer() in the capture thread
+  FlyCapture2::Error error;
+  if (m_capture == true) {
+    error = m_camera.StopCapture();
+    m_capture = false;
+  }
+
+  m_async->m_thread.join();
+  delete m_async;
+  m_async = NULL;
+
+  if (error != FlyCapture2::PGRERROR_OK) {
+    error.PrintErrorTrace();
+    throw (vpException(vpException::fatalError,
+                       "Cannot stop capture for camera with guid 0x%lx", m_guid));
+  }
+#endif
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+/*
+  Body of the asynchronous capture thread.
+ */
+void vpFlyCaptureGrabber::runAsyncCapture()
+{
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+  vpFlyCaptureAsyncCapture &async = *m_async;
+  unsigned int nbErrors = 0;
+  double backoff_ms = asyncMinBackoffMs;
+
+  try {
+    for (;;) {
+      const double t_start = async.m_statistics ? vpTime::measureTimeMs() : 0.;
+      FlyCapture2::Error error = m_camera.RetrieveBuffer( &async.m_rawImage );
+      const double t_retrieved = async.m_statistics ? vpTime::measureTimeMs() : 0.;
+
+      if (isTransientError(error)) {
+        // Keep capturing after a lost packet or a timeout, but do not spin when they repeat
+        if (++nbErrors > asyncMaxErrorsBeforeBackoff) {
+          vpTime::wait(backoff_ms);
+          backoff_ms = std::min(2. * backoff_ms, asyncMaxBackoffMs);
+        }
+        continue;
+      }
+      nbErrors = 0;
+      backoff_ms = asyncMinBackoffMs;
+
+      unsigned int slot = 0;
+      {
+        vpFlyCaptureLock::vpScopedLock lock(async.m_lock);
+        if (async.m_stop || error == FlyCapture2::PGRERROR_ISOCH_NOT_STARTED) {
+          break;
+        }
+        if (error != FlyCapture2::PGRERROR_OK) {
+          // Persistent error, reported by the next reads once the ready frames are consumed
+          async.m_error = error;
+          break;
+        }
+        if (async.m_statistics) {
+          // Also the frames dropped below, so that they are not counted as lost by the camera
+          m_stats.addSample(vpFlyCaptureStatistics::STAGE_RETRIEVE, t_retrieved - t_start);
+          m_stats.addFrame(t_retrieved, getSensorTimeMs(async.m_rawImage, m_stats.m_hasTimeStamp),
+                           async.m_rawImage.GetMetadata().embeddedFrameCounter);
+        }
+
+        if (! async.m_free.empty()) {
+          slot = async.m_free.back();
+          async.m_free.pop_back();
+        }
+        else if (async.m_policy == DROP_OLDEST && ! async.m_ready.empty()) {
+          slot = async.m_ready.front();
+          async.m_ready.pop_front();
+          async.m_dropped++;
+        }
+        else {
+          async.m_dropped++;
+          continue;
+        }
+      }
+
+      // The slot is only accessed by this thread until it is pushed in the ready frames
+      vpFlyCaptureAsyncCapture::vpSlot &s = async.m_slots[slot];
+      s.m_timestamp = async.m_rawImage.GetTimeStamp();
+      if (async.m_color)
+        error = convertRawImage(async.m_rawImage, FlyCapture2::PIXEL_FORMAT_RGBU, async.m_demosaicMethod,
+                                async.m_demosaicThreads, s.m_color);
+      else
+        error = convertRawImage(async.m_rawImage, FlyCapture2::PIXEL_FORMAT_MONO8, async.m_demosaicMethod,
+                                async.m_demosaicThreads, s.m_gray);
+      const double t_converted = async.m_statistics ? vpTime::measureTimeMs() : 0.;
+
+      vpFlyCaptureLock::vpScopedLock lock(async.m_lock);
+      if (error != FlyCapture2::PGRERROR_OK) {
+        async.m_free.push_back(slot);
+        continue;
+      }
+      if (async.m_statistics) {
+        m_stats.addSample(vpFlyCaptureStatistics::STAGE_CONVERT, t_converted - t_retrieved);
+      }
+      async.m_ready.push_back(slot);
+      async.m_captured++;
+      async.m_lock.notifyAll();
+    }
+  }
+  catch(...) {
+    // Do not let an exception escape the thread, the consumers are woken up below
+    vpFlyCaptureLock::vpScopedLock lock(async.m_lock);
+    async.m_error = FlyCapture2::PGRERROR_FAILED;
+  }
+
+  vpFlyCaptureLock::vpScopedLock lock(async.m_lock);
+  async.m_running = false;
+  async.m_lock.notifyAll();
+#endif
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/*!
+  Enable or disable the timing statistics of the acquisition, see getStatistics(). Enabling the statistics resets
+  them. Recording a frame costs a few clock readings and additions, so that the statistics may be left enabled.
+
+  When the camera supports it, its frame counter and timestamp are embedded in the frames to count the frames lost
+  by the camera and to time the transfer. As documented by the SDK, the embedded information replaces the first
+  pixels of the frames. The embedded image info of the camera is saved when the statistics are enabled and restored
+  when they are disabled.
+
+  \param on : true to enable the statistics.
+
+  \exception vpException::fatalError : If the asynchronous capture is started, or if the embedded image info cannot
+  be restored.
+
+  \sa resetStatistics()
+ */
+void vpFlyCaptureGrabber::enableStatistics(bool on)
+{
+  if (m_async != NULL) {
+    throw (vpException(vpException::fatalError,
+                       "Cannot change the statistics during the asynchronous capture of camera with guid 0x%lx",
+                       m_guid));
+  }
+
+  if (on) {
+    this->connect();
+
+    // Already switched on by a previous call, m_embeddedInfo keeps the info of the camera before it
+    if (! m_embeddedInfoChanged) {
+      FlyCapture2::EmbeddedImageInfo info;
+      FlyCapture2::Error error = m_camera.GetEmbeddedImageInfo( &info );
+      if (error == FlyCapture2::PGRERROR_OK) {
+        m_embeddedInfo = info;
+        if (info.frameCounter.available)
+          info.frameCounter.onOff = true;
+        if (info.timestamp.available)
+          info.timestamp.onOff = true;
+        error = m_camera.SetEmbeddedImageInfo( &info );
+        m_embeddedInfoChanged = (error == FlyCapture2::PGRERROR_OK);
+      }
+      m_stats.m_hasFrameCounter = m_embeddedInfoChanged && info.frameCounter.available;
+      m_stats.m_hasTimeStamp = m_embeddedInfoChanged && info.timestamp.available;
+    }
+    m_stats.m_nominalFrameRate = this->getFrameRate();
+  }
+  else if (m_embeddedInfoChanged) {
+    m_embeddedInfoChanged = false;
+    m_stats.m_hasFrameCounter = false;
+    m_stats.m_hasTimeStamp = false;
+    if (m_connected) {
+      FlyCapture2::Error error = m_camera.SetEmbeddedImageInfo( &m_embeddedInfo );
+      if (error != FlyCapture2::PGRERROR_OK) {
+        error.PrintErrorTrace();
+        throw (vpException(vpException::fatalError,
+                           "Cannot restore the embedded image info of camera with guid 0x%lx", m_guid));
+      }
+    }
+  }
+
+  m_stats.reset();
+  m_statsEnabled = on;
+}
+
+/*!
+  Return a copy of the timing statistics of the frames acquired since enableStatistics() or resetStatistics().
+
+  While the statistics are enabled, the first pixels of the acquired frames are overwritten by the frame counter
+  and the timestamp of the camera when it supports them, see enableStatistics().
+ */
+vpFlyCaptureStatistics vpFlyCaptureGrabber::getStatistics() const
+{
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+  if (m_async != NULL) {
+    vpFlyCaptureLock::vpScopedLock lock(m_async->m_lock);
+    return m_stats;
+  }
+#endif
+  return m_stats;
 }
 
+/*!
+  Forget the timing statistics of the frames acquired so far.
+ */
+void vpFlyCaptureGrabber::resetStatistics()
+{
+#if defined(VP_FLYCAPTURE_HAVE_THREADS)
+  if (m_async != NULL) {
+    vpFlyCaptureLock::vpScopedLock lock(m_async->m_lock);
+    m_stats.reset();
+    return;
+  }
+#endif
+  m_stats.reset();
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+/*
+  Record the frame acquired between t_start and t_retrieved, then converted until now.
+ */
+void vpFlyCaptureGrabber::updateStatistics(vpFlyCaptureStatistics &stats, double t_start, double t_retrieved,
+                                           const FlyCapture2::Image &rawImage)
+{
+  stats.addSample(vpFlyCaptureStatistics::STAGE_RETRIEVE, t_retrieved - t_start);
+  stats.addSample(vpFlyCaptureStatistics::STAGE_CONVERT, vpTime::measureTimeMs() - t_retrieved);
+  stats.addFrame(t_retrieved, getSensorTimeMs(rawImage, stats.m_hasTimeStamp),
+                 rawImage.GetMetadata().embeddedFrameCounter);
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 
 /*!
    Connect to the active camera, start capture and retrieve an image.
@@ -0,0 +1,188 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Mutex and condition variable of the capture threads.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpFlyCaptureLock.h
+  \brief Mutex and condition variable with timeout of the capture threads, number of processors (private header).
+*/
+
+#ifndef __vpFlyCaptureLock_h_
+#define __vpFlyCaptureLock_h_
+
+#include <algorithm>
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+
+#if defined(_WIN32)
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <errno.h>
+#  include <pthread.h>
+#  include <sys/time.h>
+#  include <unistd.h>
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/*
+  Mutex and condition variable, vpMutex has no condition variable. The waits are bounded by a timeout so that a
+  consumer is never blocked forever by a camera that stopped sending frames.
+*/
+class vpFlyCaptureLock
+{
+public:
+  vpFlyCaptureLock() {
+#if defined(_WIN32)
+    InitializeCriticalSection(&m_mutex);
+    InitializeConditionVariable(&m_condition);
+#else
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_condition, NULL);
+#endif
+  }
+
+  ~vpFlyCaptureLock() {
+#if defined(_WIN32)
+    DeleteCriticalSection(&m_mutex);
+#else
+    pthread_cond_destroy(&m_condition);
+    pthread_mutex_destroy(&m_mutex);
+#endif
+  }
+
+  void lock() {
+#if defined(_WIN32)
+    EnterCriticalSection(&m_mutex);
+#else
+    pthread_mutex_lock(&m_mutex);
+#endif
+  }
+
+  void unlock() {
+#if defined(_WIN32)
+    LeaveCriticalSection(&m_mutex);
+#else
+    pthread_mutex_unlock(&m_mutex);
+#endif
+  }
+
+  /*
+    Wait for a notification during at most timeout_ms milliseconds (forever if negative), the lock must be held.
+    Return false on timeout. As for any condition variable the wake up may be spurious, the caller checks its
+    condition again.
+  */
+  bool wait(const double timeout_ms) {
+#if defined(_WIN32)
+    return SleepConditionVariableCS(&m_condition, &m_mutex, timeout_ms < 0 ? INFINITE : (DWORD) timeout_ms) != 0;
+#else
+    if (timeout_ms < 0) {
+      pthread_cond_wait(&m_condition, &m_mutex);
+      return true;
+    }
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    long long deadline_us = (long long) now.tv_sec * 1000000LL + now.tv_usec + (long long) (timeout_ms * 1000.0);
+    struct timespec deadline;
+    deadline.tv_sec = (time_t) (deadline_us / 1000000LL);
+    deadline.tv_nsec = (long) (deadline_us % 1000000LL) * 1000L;
+    return pthread_cond_timedwait(&m_condition, &m_mutex, &deadline) != ETIMEDOUT;
+#endif
+  }
+
+  void notifyAll() {
+#if defined(_WIN32)
+    WakeAllConditionVariable(&m_condition);
+#else
+    pthread_cond_broadcast(&m_condition);
+#endif
+  }
+
+  //! Return the number of processors online, at least 1.
+  static unsigned int getNbProcessors() {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return std::max((unsigned int) info.dwNumberOfProcessors, 1u);
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long nbProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+    return nbProcessors > 0 ? (unsigned int) nbProcessors : 1u;
+#else
+    return 1;
+#endif
+  }
+
+  //! Lock held in a scope.
+  class vpScopedLock
+  {
+  public:
+    explicit vpScopedLock(vpFlyCaptureLock &lock) : m_lock(lock) {
+      m_lock.lock();
+    }
+    ~vpScopedLock() {
+      m_lock.unlock();
+    }
+
+  private:
+    vpScopedLock(const vpScopedLock &);
+    vpScopedLock &operator=(const vpScopedLock &);
+
+    vpFlyCaptureLock &m_lock;
+  };
+
+private:
+  vpFlyCaptureLock(const vpFlyCaptureLock &);
+  vpFlyCaptureLock &operator=(const vpFlyCaptureLock &);
+
+#if defined(_WIN32)
+  CRITICAL_SECTION m_mutex;
+  CONDITION_VARIABLE m_condition;
+#else
+  pthread_mutex_t m_mutex;
+  pthread_cond_t m_condition;
+#endif
+};
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif
+#endif
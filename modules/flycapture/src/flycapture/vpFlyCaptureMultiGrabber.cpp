@@ -0,0 +1,327 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Synchronized capture from multiple PointGrey cameras.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpFlyCaptureMultiGrabber.cpp
+  \brief Synchronized capture from multiple PointGrey cameras using FlyCapture SDK.
+*/
+
+#include <visp3/core/vpException.h>
+#include <visp3/flycapture/vpFlyCaptureMultiGrabber.h>
+
+#ifdef VISP_HAVE_FLYCAPTURE
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace {
+//! Return the timestamp in milliseconds.
+double getTimeStampMs(const FlyCapture2::TimeStamp &timestamp)
+{
+  return (double) timestamp.seconds * 1000. + (double) timestamp.microSeconds / 1000.;
+}
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+   Default constructor. If setCameraIndexes() is not called, open() uses all the cameras found on the bus.
+ */
+vpFlyCaptureMultiGrabber::vpFlyCaptureMultiGrabber()
+  : m_grabbers(), m_tolerance(-1.), m_lastSpread(0.), m_maxSpread(0.), m_matchedSets(0), m_discardedFrames(0),
+    m_color(false), m_open(false)
+{
+}
+
+/*!
+   Stop the capture, disconnect the cameras and release the grabbers.
+ */
+vpFlyCaptureMultiGrabber::~vpFlyCaptureMultiGrabber()
+{
+  close();
+  for (size_t i = 0; i < m_grabbers.size(); i++)
+    delete m_grabbers[i];
+}
+
+/*!
+  Select the cameras of the group by their index on the bus.
+
+  \param indexes : Index of each camera, the images returned by acquire() are in the same order.
+
+  \exception vpException::fatalError : If the capture is started.
+  \exception vpException::badValue : If \e indexes is empty or if an index is given twice.
+ */
+void vpFlyCaptureMultiGrabber::setCameraIndexes(const std::vector<unsigned int> &indexes)
+{
+  if (m_open) {
+    throw (vpException(vpException::fatalError,
+                       "Cannot change the cameras while the capture is started"));
+  }
+  if (indexes.empty()) {
+    throw (vpException(vpException::badValue, "No camera selected"));
+  }
+  for (size_t i = 0; i < indexes.size(); i++) {
+    for (size_t j = i+1; j < indexes.size(); j++) {
+      if (indexes[i] == indexes[j]) {
+        throw (vpException(vpException::badValue,
+                           "Camera with index %u selected twice", indexes[i]));
+      }
+    }
+  }
+
+  this->createGrabbers(indexes);
+}
+
+/*!
+  Set the maximum time between the frames of a set returned by acquire(). By default the tolerance is half the frame
+  period of the first camera.
+
+  \param tolerance_ms : Tolerance in milliseconds.
+ */
+void vpFlyCaptureMultiGrabber::setTolerance(double tolerance_ms)
+{
+  if (tolerance_ms < 0) {
+    throw (vpException(vpException::badValue,
+                       "Bad tolerance %f ms, should be positive", tolerance_ms));
+  }
+  m_tolerance = tolerance_ms;
+}
+
+/*!
+  Return the grabber of a camera of the group to modify its settings, before or after open().
+
+  \param cam : Position of the camera in the indexes given to setCameraIndexes().
+
+  \exception vpException::badValue : If \e cam is not lower than getNumCameras().
+ */
+vpFlyCaptureGrabber &vpFlyCaptureMultiGrabber::getGrabber(unsigned int cam)
+{
+  if (m_grabbers.empty()) {
+    this->createGrabbers();
+  }
+  if (cam >= m_grabbers.size()) {
+    throw (vpException(vpException::badValue,
+                       "The group has only %d cameras, cannot get camera %d", (int) m_grabbers.size(), cam));
+  }
+  return *m_grabbers[cam];
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void vpFlyCaptureMultiGrabber::createGrabbers()
+{
+  std::vector<unsigned int> indexes(vpFlyCaptureGrabber::getNumCameras());
+  for (unsigned int i = 0; i < indexes.size(); i++)
+    indexes[i] = i;
+  this->createGrabbers(indexes);
+}
+
+void vpFlyCaptureMultiGrabber::createGrabbers(const std::vector<unsigned int> &indexes)
+{
+  for (size_t i = 0; i < m_grabbers.size(); i++)
+    delete m_grabbers[i];
+  m_grabbers.clear();
+
+  for (size_t i = 0; i < indexes.size(); i++) {
+    m_grabbers.push_back(new vpFlyCaptureGrabber);
+    m_grabbers.back()->setCameraIndex(indexes[i]);
+  }
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Connect the cameras, start their capture at once with FlyCapture2::Camera::StartSyncCapture() and start one
+  capture thread per camera.
+
+  \param color : If true the cameras are acquired in vpImage<vpRGBa>, otherwise in vpImage<unsigned char>.
+  \param nbBuffers : Number of images buffered for each camera, see vpFlyCaptureGrabber::startAsyncCapture().
+
+  \exception vpException::fatalError : If no camera is found or if the capture cannot be started.
+ */
+void vpFlyCaptureMultiGrabber::open(bool color, unsigned int nbBuffers)
+{
+  if (m_open)
+    return;
+
+  if (m_grabbers.empty()) {
+    this->createGrabbers();
+    if (m_grabbers.empty()) {
+      throw (vpException(vpException::fatalError, "No camera found on the bus"));
+    }
+  }
+
+  std::vector<const FlyCapture2::Camera *> cameras(m_grabbers.size());
+  for (size_t i = 0; i < m_grabbers.size(); i++) {
+    // A capture started alone would not be synchronized
+    m_grabbers[i]->stopCapture();
+    m_grabbers[i]->connect();
+    cameras[i] = m_grabbers[i]->getCameraHandler();
+  }
+
+  FlyCapture2::Error error;
+  error = FlyCapture2::Camera::StartSyncCapture((unsigned int) cameras.size(), &cameras[0]);
+  if (error != FlyCapture2::PGRERROR_OK) {
+    error.PrintErrorTrace();
+    throw (vpException(vpException::fatalError,
+                       "Cannot start synchronized capture of %d cameras", (int) cameras.size()));
+  }
+
+  try {
+    for (size_t i = 0; i < m_grabbers.size(); i++) {
+      m_grabbers[i]->m_capture = true;
+      m_grabbers[i]->startAsyncCapture(color, nbBuffers, vpFlyCaptureGrabber::DROP_OLDEST);
+    }
+  }
+  catch(...) {
+    for (size_t i = 0; i < m_grabbers.size(); i++) {
+      m_grabbers[i]->m_capture = true;
+      m_grabbers[i]->stopCapture();
+    }
+    throw;
+  }
+
+  if (m_tolerance < 0) {
+    float framerate = m_grabbers[0]->getFrameRate();
+    m_tolerance = (framerate > 0) ? 500. / framerate : 10.;
+  }
+
+  m_color = color;
+  m_lastSpread = 0.;
+  m_maxSpread = 0.;
+  m_matchedSets = 0;
+  m_discardedFrames = 0;
+  m_open = true;
+}
+
+/*!
+  Stop the capture threads and the capture of the cameras, then disconnect the cameras.
+ */
+void vpFlyCaptureMultiGrabber::close()
+{
+  for (size_t i = 0; i < m_grabbers.size(); i++) {
+    m_grabbers[i]->close();
+  }
+  m_open = false;
+}
+
+/*!
+  Acquire a set of gray level images, one per camera, captured within getTolerance() milliseconds.
+
+  \param I : Images, in the order of the cameras of the group.
+  \param timestamps : Acquisition timestamp of each image.
+  \param timeout_ms : Maximum waiting time in milliseconds for each frame, negative to wait forever.
+
+  \return true if a set was acquired, false on timeout.
+
+  \exception vpException::fatalError : If the capture is not started with open(false).
+ */
+bool vpFlyCaptureMultiGrabber::acquire(std::vector< vpImage<unsigned char> > &I,
+                                       std::vector<FlyCapture2::TimeStamp> &timestamps, int timeout_ms)
+{
+  return this->acquireSet(I, timestamps, timeout_ms);
+}
+
+/*!
+  Acquire a set of color images, one per camera, captured within getTolerance() milliseconds.
+
+  \param I : Images, in the order of the cameras of the group.
+  \param timestamps : Acquisition timestamp of each image.
+  \param timeout_ms : Maximum waiting time in milliseconds for each frame, negative to wait forever.
+
+  \return true if a set was acquired, false on timeout.
+
+  \exception vpException::fatalError : If the capture is not started with open(true).
+ */
+bool vpFlyCaptureMultiGrabber::acquire(std::vector< vpImage<vpRGBa> > &I,
+                                       std::vector<FlyCapture2::TimeStamp> &timestamps, int timeout_ms)
+{
+  return this->acquireSet(I, timestamps, timeout_ms);
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template <class Type>
+bool vpFlyCaptureMultiGrabber::acquireSet(std::vector< vpImage<Type> > &I,
+                                          std::vector<FlyCapture2::TimeStamp> &timestamps, int timeout_ms)
+{
+  if (! m_open) {
+    throw (vpException(vpException::fatalError, "The capture of the cameras is not started"));
+  }
+  if (m_color != (sizeof(Type) != 1)) {
+    throw (vpException(vpException::fatalError, "The capture of the cameras is started in %s",
+                       m_color ? "color" : "gray level"));
+  }
+
+  const size_t nbCameras = m_grabbers.size();
+  I.resize(nbCameras);
+  timestamps.resize(nbCameras);
+  std::vector<double> t(nbCameras);
+  for (size_t i = 0; i < nbCameras; i++) {
+    if (! m_grabbers[i]->acquireNext(I[i], timestamps[i], timeout_ms))
+      return false;
+    t[i] = getTimeStampMs(timestamps[i]);
+  }
+
+  for (;;) {
+    size_t first = 0, last = 0;
+    for (size_t i = 1; i < nbCameras; i++) {
+      if (t[i] < t[first])
+        first = i;
+      if (t[i] > t[last])
+        last = i;
+    }
+
+    if (t[last] - t[first] <= m_tolerance) {
+      m_lastSpread = t[last] - t[first];
+      break;
+    }
+
+    // The oldest frame has no match, replace it by the next frame of its camera
+    if (! m_grabbers[first]->acquireNext(I[first], timestamps[first], timeout_ms))
+      return false;
+    t[first] = getTimeStampMs(timestamps[first]);
+    m_discardedFrames++;
+  }
+
+  if (m_lastSpread > m_maxSpread)
+    m_maxSpread = m_lastSpread;
+  m_matchedSets++;
+
+  return true;
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#elif !defined(VISP_BUILD_SHARED_LIBS)
+// Work arround to avoid warning: libvisp_flycapture.a(vpFlyCaptureMultiGrabber.cpp.o) has no symbols
+void dummy_vpFlyCaptureMultiGrabber() {};
+#endif
@@ -0,0 +1,228 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Capture timing statistics of PointGrey cameras.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpFlyCaptureStatistics.cpp
+  \brief Capture timing statistics of PointGrey cameras.
+*/
+
+#include <iomanip>
+#include <limits>
+
+#include <visp3/core/vpException.h>
+#include <visp3/flycapture/vpFlyCaptureStatistics.h>
+
+#ifdef VISP_HAVE_FLYCAPTURE
+
+const unsigned int vpFlyCaptureStatistics::NB_BINS;
+
+/*!
+   Default constructor, no frame recorded.
+ */
+vpFlyCaptureStatistics::vpFlyCaptureStatistics()
+  : m_frames(0), m_droppedFrames(0), m_lastFrameCounter(0), m_hasFrameCounter(false), m_hasTimeStamp(false),
+    m_nominalFrameRate(0.), m_firstHostTime(0.), m_lastHostTime(0.), m_lastSensorTime(0.), m_sensorTimeWrap(0.),
+    m_minReceiveDelay(0.)
+{
+  reset();
+}
+
+/*!
+  Forget the recorded frames and durations.
+ */
+void vpFlyCaptureStatistics::reset()
+{
+  for (unsigned int s = 0; s < STAGE_COUNT; s++) {
+    for (unsigned int b = 0; b < NB_BINS; b++)
+      m_histogram[s][b] = 0;
+    m_count[s] = 0;
+    m_sum[s] = 0.;
+    m_min[s] = std::numeric_limits<double>::max();
+    m_max[s] = 0.;
+  }
+  m_frames = 0;
+  m_droppedFrames = 0;
+  m_lastFrameCounter = 0;
+  m_firstHostTime = 0.;
+  m_lastHostTime = 0.;
+  m_lastSensorTime = 0.;
+  m_sensorTimeWrap = 0.;
+  m_minReceiveDelay = 0.;
+}
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+void vpFlyCaptureStatistics::addSample(vpStage stage, double duration_ms)
+{
+  if (duration_ms < 0)
+    duration_ms = 0;
+
+  unsigned long long us = (unsigned long long) (duration_ms * 1000.);
+  unsigned int bin = 0;
+  while ((us >>= 1) != 0 && bin + 1 < NB_BINS)
+    bin++;
+
+  m_histogram[stage][bin]++;
+  m_count[stage]++;
+  m_sum[stage] += duration_ms;
+  if (duration_ms < m_min[stage])
+    m_min[stage] = duration_ms;
+  if (duration_ms > m_max[stage])
+    m_max[stage] = duration_ms;
+}
+
+/*
+  Record a frame received by the host at host_ms: count the frames lost since the previous one from the frame
+  counter of the camera, ignored without m_hasFrameCounter, and the receive delay from the sensor time in ms modulo
+  128 s.
+*/
+void vpFlyCaptureStatistics::addFrame(double host_ms, double sensor_ms, unsigned int frameCounter)
+{
+  if (m_hasFrameCounter) {
+    // The difference is computed modulo 2^32, a counter that goes backward is ignored
+    const unsigned int gap = frameCounter - m_lastFrameCounter;
+    if (m_frames > 0 && gap > 1 && gap < 0x80000000u)
+      m_droppedFrames += gap - 1;
+    m_lastFrameCounter = frameCounter;
+  }
+
+  // The cycle time wraps every 128 s
+  if (m_frames > 0 && sensor_ms + 64000. < m_lastSensorTime)
+    m_sensorTimeWrap += 128000.;
+  m_lastSensorTime = sensor_ms;
+
+  const double delay = host_ms - (sensor_ms + m_sensorTimeWrap);
+  if (m_frames == 0 || delay < m_minReceiveDelay)
+    m_minReceiveDelay = delay;
+  addSample(STAGE_RECEIVE_DELAY, delay - m_minReceiveDelay);
+
+  if (m_frames == 0)
+    m_firstHostTime = host_ms;
+  m_lastHostTime = host_ms;
+  m_frames++;
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/*!
+  Return the number of frames per second received by the host, from the first and the last frames recorded.
+  It can be compared to getNominalFrameRate().
+ */
+double vpFlyCaptureStatistics::getEffectiveFrameRate() const
+{
+  if (m_frames < 2 || m_lastHostTime <= m_firstHostTime)
+    return 0.;
+  return (m_frames - 1) * 1000. / (m_lastHostTime - m_firstHostTime);
+}
+
+/*!
+  Return the number of durations of a stage in the bin \e bin of its histogram, that is in [2^bin, 2^(bin+1)[
+  microseconds. The first bin also counts the durations below 1 microsecond, the last one the longer durations.
+
+  \exception vpException::badValue : If \e bin is not lower than NB_BINS.
+ */
+unsigned int vpFlyCaptureStatistics::getHistogram(vpStage stage, unsigned int bin) const
+{
+  if (bin >= NB_BINS) {
+    throw (vpException(vpException::badValue,
+                       "Bad histogram bin %d, should be lower than %d", bin, NB_BINS));
+  }
+  return m_histogram[stage][bin];
+}
+
+/*!
+  Return the mean duration of a stage in milliseconds.
+ */
+double vpFlyCaptureStatistics::getMean(vpStage stage) const
+{
+  return m_count[stage] ? m_sum[stage] / m_count[stage] : 0.;
+}
+
+/*!
+  Return an upper bound in milliseconds of the given percentile of the durations of a stage, from its histogram:
+  the result is within a factor 2 of the exact value.
+
+  \param stage : Stage of the acquisition.
+  \param percent : Percentile in [0, 100], 50 for the median.
+ */
+double vpFlyCaptureStatistics::getPercentile(vpStage stage, double percent) const
+{
+  if (m_count[stage] == 0)
+    return 0.;
+
+  const double target = percent / 100. * m_count[stage];
+  unsigned int cumulated = 0;
+  for (unsigned int b = 0; b < NB_BINS; b++) {
+    cumulated += m_histogram[stage][b];
+    if (cumulated >= target && cumulated > 0) {
+      // The last bin also counts the longer durations
+      const double upper = (double) (1ULL << (b + 1)) / 1000.;
+      return (b + 1 < NB_BINS && upper < m_max[stage]) ? upper : m_max[stage];
+    }
+  }
+  return m_max[stage];
+}
+
+/*!
+  Print the statistics of each stage, the frame rates and the dropped frames.
+ */
+std::ostream &operator<<(std::ostream &os, const vpFlyCaptureStatistics &stats)
+{
+  const char *names[vpFlyCaptureStatistics::STAGE_COUNT] = { "Retrieve", "Convert", "Copy", "Receive delay" };
+
+  os << "Frames: " << stats.getFrames() << ", effective frame rate: " << stats.getEffectiveFrameRate()
+     << " fps (nominal " << stats.getNominalFrameRate() << " fps)";
+  if (stats.hasFrameCounter())
+    os << ", dropped frames: " << stats.getDroppedFrames();
+  os << std::endl;
+
+  os << std::setw(14) << std::left << "Stage (ms)" << std::right << std::setw(10) << "mean" << std::setw(10) << "min"
+     << std::setw(10) << "median" << std::setw(10) << "99%" << std::setw(10) << "max" << std::endl;
+  for (unsigned int s = 0; s < vpFlyCaptureStatistics::STAGE_COUNT; s++) {
+    vpFlyCaptureStatistics::vpStage stage = (vpFlyCaptureStatistics::vpStage) s;
+    os << std::setw(14) << std::left << names[s] << std::right << std::setw(10) << stats.getMean(stage)
+       << std::setw(10) << stats.getMin(stage) << std::setw(10) << stats.getPercentile(stage, 50.)
+       << std::setw(10) << stats.getPercentile(stage, 99.) << std::setw(10) << stats.getMax(stage);
+    if (s + 1 < vpFlyCaptureStatistics::STAGE_COUNT)
+      os << std::endl;
+  }
+  return os;
+}
+
+#elif !defined(VISP_BUILD_SHARED_LIBS)
+// Work arround to avoid warning: libvisp_flycapture.a(vpFlyCaptureStatistics.cpp.o) has no symbols
+void dummy_vpFlyCaptureStatistics() {};
+#endif
@@ -41,6 +41,8 @@
   Test PointGrey FlyCapture SDK wrapper to capture and display images.
 */
 
+#include <cmath>
+#include <cstdlib>
 #include <iomanip>
 
 #include <visp3/core/vpImage.h>
@@ -49,10 +51,153 @@
 #include <visp3/gui/vpDisplayOpenCV.h>
 #include <visp3/flycapture/vpFlyCaptureGrabber.h>
 
+#if defined(VISP_HAVE_FLYCAPTURE)
+// A mosaic of a uniform color has to be converted back to this color by any method
+bool checkDemosaic(FlyCapture2::BayerTileFormat bayerFormat)
+{
+  const unsigned char color[3] = {200, 120, 40};
+  const char *pattern = (bayerFormat == FlyCapture2::RGGB) ? "RGGB" : (bayerFormat == FlyCapture2::GRBG) ? "GRBG"
+                      : (bayerFormat == FlyCapture2::GBRG) ? "GBRG" : "BGGR";
+  vpImage<unsigned char> bayer(61, 83);
+  for (unsigned int i = 0; i < bayer.getHeight(); i++) {
+    for (unsigned int j = 0; j < bayer.getWidth(); j++) {
+      char site = pattern[(i%2)*2 + (j%2)];
+      bayer[i][j] = (site == 'R') ? color[0] : ((site == 'G') ? color[1] : color[2]);
+    }
+  }
+
+  vpFlyCaptureGrabber::vpDemosaicMethod methods[2] = { vpFlyCaptureGrabber::DEMOSAIC_BILINEAR,
+                                                       vpFlyCaptureGrabber::DEMOSAIC_HALF_SIZE };
+  const unsigned char gray = (unsigned char) ((77*color[0] + 150*color[1] + 29*color[2] + 128) >> 8);
+  for (unsigned int m = 0; m < 2; m++) {
+    vpImage<vpRGBa> I;
+    vpImage<unsigned char> G;
+    vpFlyCaptureGrabber::demosaic(bayer, bayerFormat, I, methods[m]);
+    vpFlyCaptureGrabber::demosaic(bayer, bayerFormat, G, methods[m]);
+    for (unsigned int k = 0; k < I.getSize(); k++) {
+      if (I.bitmap[k].R != color[0] || I.bitmap[k].G != color[1] || I.bitmap[k].B != color[2] || G.bitmap[k] != gray) {
+        std::cerr << "Bad demosaic of " << pattern << " pattern with method " << m << std::endl;
+        return false;
+      }
+    }
+  }
+
+  // A non uniform mosaic tall enough to be split over 4 threads by both methods, that have to give the same result
+  // as a single thread, also on the rows next to the split
+  vpImage<unsigned char> mosaic(263, 171);
+  for (unsigned int i = 0; i < mosaic.getHeight(); i++) {
+    for (unsigned int j = 0; j < mosaic.getWidth(); j++) {
+      mosaic[i][j] = (unsigned char) ((i*31 + j*17 + (i*j) % 13 * 19) & 0xFF);
+    }
+  }
+  for (unsigned int m = 0; m < 2; m++) {
+    vpImage<vpRGBa> I1, I4;
+    vpImage<unsigned char> G1, G4;
+    vpFlyCaptureGrabber::demosaic(mosaic, bayerFormat, I1, methods[m], 1);
+    vpFlyCaptureGrabber::demosaic(mosaic, bayerFormat, I4, methods[m], 4);
+    vpFlyCaptureGrabber::demosaic(mosaic, bayerFormat, G1, methods[m], 1);
+    vpFlyCaptureGrabber::demosaic(mosaic, bayerFormat, G4, methods[m], 4);
+    if (I1 != I4 || G1 != G4) {
+      std::cerr << "Different demosaic of " << pattern << " pattern with method " << m << " on 1 and 4 threads"
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Give access to the recording of the durations and frames, normally done by vpFlyCaptureGrabber
+class vpFlyCaptureStatisticsTester : public vpFlyCaptureStatistics
+{
+public:
+  vpFlyCaptureStatisticsTester(bool hasFrameCounter) : vpFlyCaptureStatistics() {
+    m_hasFrameCounter = hasFrameCounter;
+  }
+  using vpFlyCaptureStatistics::addSample;
+  using vpFlyCaptureStatistics::addFrame;
+};
+
+bool checkStatistics()
+{
+  vpFlyCaptureStatisticsTester stats(true);
+
+  // 0.5 us, 3 us, 1 ms and 100 ms fall in the bins 0, 1, 9 and 16, 20 s is above the last bin
+  const double durations[5] = { 0.0005, 0.003, 1., 100., 20000. };
+  const unsigned int bins[5] = { 0, 1, 9, 16, vpFlyCaptureStatistics::NB_BINS - 1 };
+  for (unsigned int k = 0; k < 4; k++)
+    stats.addSample(vpFlyCaptureStatistics::STAGE_CONVERT, durations[k]);
+  for (unsigned int k = 0; k < 4; k++) {
+    if (stats.getHistogram(vpFlyCaptureStatistics::STAGE_CONVERT, bins[k]) != 1) {
+      std::cerr << "Bad histogram bin of the duration " << durations[k] << " ms" << std::endl;
+      return false;
+    }
+  }
+  if (stats.getCount(vpFlyCaptureStatistics::STAGE_CONVERT) != 4
+      || stats.getCount(vpFlyCaptureStatistics::STAGE_COPY) != 0
+      || stats.getMin(vpFlyCaptureStatistics::STAGE_CONVERT) != durations[0]
+      || stats.getMax(vpFlyCaptureStatistics::STAGE_CONVERT) != durations[3]) {
+    std::cerr << "Bad count, min or max of the durations" << std::endl;
+    return false;
+  }
+
+  // The percentiles are the upper bounds of the bins, bounded by the longest duration
+  const double percents[5] = { 0., 25., 50., 75., 100. };
+  const double percentiles[5] = { 0.002, 0.002, 0.004, 1.024, 100. };
+  for (unsigned int k = 0; k < 5; k++) {
+    if (std::fabs(stats.getPercentile(vpFlyCaptureStatistics::STAGE_CONVERT, percents[k]) - percentiles[k]) > 1e-9) {
+      std::cerr << "Bad " << percents[k] << "% percentile: "
+                << stats.getPercentile(vpFlyCaptureStatistics::STAGE_CONVERT, percents[k]) << " ms" << std::endl;
+      return false;
+    }
+  }
+
+  stats.addSample(vpFlyCaptureStatistics::STAGE_CONVERT, durations[4]);
+  if (stats.getHistogram(vpFlyCaptureStatistics::STAGE_CONVERT, bins[4]) != 1
+      || stats.getPercentile(vpFlyCaptureStatistics::STAGE_CONVERT, 100.) != durations[4]) {
+    std::cerr << "Bad last histogram bin" << std::endl;
+    return false;
+  }
+
+  // Frames every 20 ms with a constant receive delay, while the frame counter wraps around 2^32 and the sensor time
+  // around 128 s. The frames 0 and 1 are lost, then the counter going backward is ignored.
+  const unsigned int counters[5] = { 0xFFFFFFFEu, 0xFFFFFFFFu, 2, 3, 1 };
+  for (unsigned int k = 0; k < 5; k++)
+    stats.addFrame(1000. + 20. * k, std::fmod(127950. + 20. * k, 128000.), counters[k]);
+
+  if (stats.getFrames() != 5 || stats.getDroppedFrames() != 2) {
+    std::cerr << "Bad number of dropped frames: " << stats.getDroppedFrames() << std::endl;
+    return false;
+  }
+  if (stats.getCount(vpFlyCaptureStatistics::STAGE_RECEIVE_DELAY) != 5
+      || stats.getMax(vpFlyCaptureStatistics::STAGE_RECEIVE_DELAY) > 1e-9) {
+    std::cerr << "Bad receive delay after the wrap of the sensor time: "
+              << stats.getMax(vpFlyCaptureStatistics::STAGE_RECEIVE_DELAY) << " ms" << std::endl;
+    return false;
+  }
+  if (std::fabs(stats.getEffectiveFrameRate() - 50.) > 1e-9) {
+    std::cerr << "Bad effective frame rate: " << stats.getEffectiveFrameRate() << " fps" << std::endl;
+    return false;
+  }
+
+  stats.reset();
+  if (stats.getFrames() != 0 || stats.getCount(vpFlyCaptureStatistics::STAGE_CONVERT) != 0
+      || ! stats.hasFrameCounter()) {
+    std::cerr << "Bad statistics reset" << std::endl;
+    return false;
+  }
+  return true;
+}
+#endif
+
 int main(int argc, const char ** argv)
 {
 #if defined(VISP_HAVE_FLYCAPTURE)
   try {
+    if (! checkDemosaic(FlyCapture2::RGGB) || ! checkDemosaic(FlyCapture2::GRBG)
+        || ! checkDemosaic(FlyCapture2::GBRG) || ! checkDemosaic(FlyCapture2::BGGR) || ! checkStatistics()) {
+      return EXIT_FAILURE;
+    }
+
     bool opt_display_on = true;
     bool opt_click_on = true;
     for (int i=0; i<argc; i++) {
@@ -89,6 +234,7 @@ int main(int argc, const char ** argv)
     std::cout << " Exposure  : " << g.getExposure() << std::endl;
     std::cout << " Sharpness : " << g.getSharpness() << std::endl;
 
+    g.enableStatistics();
     g.open(I);
 
     vpDisplay *display = NULL;
@@ -119,6 +265,29 @@ int main(int argc, const char ** argv)
       }
 
     }
+    std::cout << g.getStatistics() << std::endl;
+    // Restore the embedded image info of the camera
+    g.enableStatistics(false);
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+    // Same acquisition with the asynchronous capture thread
+    FlyCapture2::TimeStamp timestamp;
+    g.startAsyncCapture(false, 4, vpFlyCaptureGrabber::DROP_OLDEST);
+    for (unsigned int i = 0; i < 20; i++) {
+      bool valid = (i % 2) ? g.acquireLatest(I, timestamp, 2000) : g.acquireNext(I, timestamp, 2000);
+      if (! valid) {
+        std::cout << "Asynchronous capture timeout" << std::endl;
+        break;
+      }
+      vpDisplay::display(I);
+      vpDisplay::displayText(I, 10, 10, "Asynchronous capture", vpColor::red);
+      vpDisplay::flush(I);
+    }
+    std::cout << "Asynchronous capture: " << g.getAsyncCapturedFrames() << " frames captured, "
+              << g.getAsyncDroppedFrames() << " dropped, " << g.getAsyncSkippedFrames() << " skipped" << std::endl;
+    g.stopAsyncCapture();
+#endif
+
     if (display != NULL)
       delete display;
   }
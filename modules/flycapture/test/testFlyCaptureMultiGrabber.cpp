@@ -0,0 +1,100 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ *
+ * Description:
+ * Test synchronized capture from multiple PointGrey cameras.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \example testFlyCaptureMultiGrabber.cpp
+
+  Test synchronized capture of sets of images from all the PointGrey cameras found on the bus.
+*/
+
+#include <cstdlib>
+#include <iostream>
+
+#include <visp3/core/vpImage.h>
+#include <visp3/flycapture/vpFlyCaptureMultiGrabber.h>
+
+int main(int argc, const char ** argv)
+{
+#if defined(VISP_HAVE_FLYCAPTURE) && (defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0)))
+  try {
+    unsigned int nframes = 20;
+    for (int i=0; i<argc; i++) {
+      if (std::string(argv[i]) == "-n" && i+1 < argc)
+        nframes = (unsigned int) atoi(argv[i+1]);
+      else if (std::string(argv[i]) == "-h") {
+        std::cout << "\nUsage: " << argv[0] << " [-n <number of sets>] [-h]\n" << std::endl;
+        std::cout << "Options: " << std::endl;
+        std::cout << " -n : Number of sets of images to acquire" << std::endl;
+        std::cout << " -h : Print help message\n" << std::endl;
+        return 0;
+      }
+    }
+
+    unsigned int numCameras = vpFlyCaptureGrabber::getNumCameras();
+    std::cout << "Number of cameras detected: " << numCameras << std::endl;
+    if (numCameras == 0)
+      return 0;
+
+    vpFlyCaptureMultiGrabber g;
+    std::vector< vpImage<unsigned char> > I;
+    std::vector<FlyCapture2::TimeStamp> timestamps;
+
+    g.open();
+    std::cout << "Tolerance between the frames of a set: " << g.getTolerance() << " ms" << std::endl;
+
+    for (unsigned int i = 0; i < nframes; i++) {
+      if (! g.acquire(I, timestamps, 2000)) {
+        std::cout << "Synchronized capture timeout" << std::endl;
+        break;
+      }
+      std::cout << "Set " << i << ": frames captured within " << g.getLastSpread() << " ms" << std::endl;
+    }
+
+    std::cout << g.getMatchedSets() << " sets acquired, " << g.getDiscardedFrames() << " frames discarded, "
+              << "largest spread " << g.getMaxSpread() << " ms" << std::endl;
+    g.close();
+  }
+  catch(vpException &e) {
+    std::cout << "Catch an exception: " << e.getStringMessage() << std::endl;
+  }
+#else
+  (void)argc;
+  (void)argv;
+  std::cout << "You should install PointGrey FlyCapture SDK and build ViSP with thread support to use this binary..." << std::endl;
+#endif
+}
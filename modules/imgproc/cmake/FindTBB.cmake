@@ -0,0 +1,80 @@
+#############################################################################
+#
+# This file is part of the ViSP software.
+# Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+#
+# This software is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# ("GPL") version 2 as published by the Free Software Foundation.
+# See the file LICENSE.txt at the root directory of this source
+# distribution for additional information about the GNU GPL.
+#
+# For using ViSP with software that can not be combined with the GNU
+# GPL, please contact Inria about acquiring a ViSP Professional
+# Edition License.
+#
+# See http://visp.inria.fr for more information.
+#
+# This software was developed at:
+# Inria Rennes - Bretagne Atlantique
+# Campus Universitaire de Beaulieu
+# 35042 Rennes Cedex
+# France
+#
+# If you have questions regarding the use of this file, please contact
+# Inria at visp@inria.fr
+#
+# This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+# WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+#
+# Description:
+# Try to find Intel Threading Building Blocks library
+#
+# TBB_FOUND
+# TBB_INCLUDE_DIRS
+# TBB_LIBRARIES
+#
+# Authors:
+# ViSP contributors
+#
+#############################################################################
+
+set(TBB_INC_SEARCH_PATH /usr/include /usr/local/include)
+set(TBB_LIB_SEARCH_PATH /usr/lib /usr/local/lib)
+
+if(MSVC)
+  list(APPEND TBB_INC_SEARCH_PATH "C:/Program Files (x86)/IntelSWTools/compilers_and_libraries/windows/tbb/include")
+  if(CMAKE_CL_64)
+    list(APPEND TBB_LIB_SEARCH_PATH "C:/Program Files (x86)/IntelSWTools/compilers_and_libraries/windows/tbb/lib/intel64/vc14")
+  else()
+    list(APPEND TBB_LIB_SEARCH_PATH "C:/Program Files (x86)/IntelSWTools/compilers_and_libraries/windows/tbb/lib/ia32/vc14")
+  endif()
+endif()
+
+find_path(TBB_INCLUDE_DIRS tbb/task_arena.h
+  PATHS
+    $ENV{TBB_ROOT}/include
+    $ENV{TBBROOT}/include
+    ${TBB_INC_SEARCH_PATH}
+)
+
+find_library(TBB_LIBRARIES
+  NAMES tbb
+  PATHS
+    $ENV{TBB_ROOT}/lib
+    $ENV{TBBROOT}/lib
+    ${TBB_LIB_SEARCH_PATH}
+)
+
+if(TBB_LIBRARIES AND TBB_INCLUDE_DIRS)
+  set(TBB_FOUND TRUE)
+else()
+  set(TBB_FOUND FALSE)
+endif()
+
+mark_as_advanced(
+  TBB_INCLUDE_DIRS
+  TBB_LIBRARIES
+  TBB_INC_SEARCH_PATH
+  TBB_LIB_SEARCH_PATH
+)
@@ -0,0 +1,210 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Block access to images larger than the memory.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpBlockIo.h
+  \brief Readers and writers of rectangular blocks of images, used by the tiled image processing functions.
+*/
+
+#ifndef __vpBlockIo_h__
+#define __vpBlockIo_h__
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <visp3/core/vpImage.h>
+#include <visp3/core/vpException.h>
+
+namespace vp
+{
+  /*!
+    Source of rectangular blocks of an image that does not need to fit in memory. The tiled image processing
+    functions read the blocks in raster order of the tiles, the blocks of neighbor tiles overlap by their halo.
+  */
+  template <class Type>
+  class vpBlockReader {
+  public:
+    virtual ~vpBlockReader() {
+    }
+
+    //! Return the image height.
+    virtual unsigned int getHeight() const = 0;
+    //! Return the image width.
+    virtual unsigned int getWidth() const = 0;
+
+    /*!
+      Read the block of the size of \e block whose top left corner is at row \e top and column \e left.
+    */
+    virtual void read(const unsigned int top, const unsigned int left, vpImage<Type> &block) = 0;
+  };
+
+  /*!
+    Destination of rectangular blocks of an image that does not need to fit in memory. The tiled image processing
+    functions write each pixel once, the blocks do not overlap and come in raster order of the tiles.
+  */
+  template <class Type>
+  class vpBlockWriter {
+  public:
+    virtual ~vpBlockWriter() {
+    }
+
+    /*!
+      Write the block whose top left corner is at row \e top and column \e left.
+    */
+    virtual void write(const unsigned int top, const unsigned int left, const vpImage<Type> &block) = 0;
+  };
+
+  /*!
+    Blocks read from an image in memory.
+  */
+  template <class Type>
+  class vpImageBlockReader : public vpBlockReader<Type> {
+  public:
+    explicit vpImageBlockReader(const vpImage<Type> &I) : m_I(I) {
+    }
+
+    virtual unsigned int getHeight() const {
+      return m_I.getHeight();
+    }
+
+    virtual unsigned int getWidth() const {
+      return m_I.getWidth();
+    }
+
+    virtual void read(const unsigned int top, const unsigned int left, vpImage<Type> &block) {
+      if (top + block.getHeight() > m_I.getHeight() || left + block.getWidth() > m_I.getWidth()) {
+        throw vpException(vpException::dimensionError, "The block is outside the image");
+      }
+
+      for (unsigned int i = 0; i < block.getHeight(); i++) {
+        std::copy(m_I[top + i] + left, m_I[top + i] + left + block.getWidth(), block[i]);
+      }
+    }
+
+  private:
+    const vpImage<Type> &m_I;
+  };
+
+  /*!
+    Blocks written to an image in memory, resized to the image size at the construction.
+  */
+  template <class Type>
+  class vpImageBlockWriter : public vpBlockWriter<Type> {
+  public:
+    vpImageBlockWriter(vpImage<Type> &I, const unsigned int height, const unsigned int width) : m_I(I) {
+      m_I.resize(height, width);
+    }
+
+    virtual void write(const unsigned int top, const unsigned int left, const vpImage<Type> &block) {
+      if (top + block.getHeight() > m_I.getHeight() || left + block.getWidth() > m_I.getWidth()) {
+        throw vpException(vpException::dimensionError, "The block is outside the image");
+      }
+
+      for (unsigned int i = 0; i < block.getHeight(); i++) {
+        std::copy(block[i], block[i] + block.getWidth(), m_I[top + i] + left);
+      }
+    }
+
+  private:
+    vpImage<Type> &m_I;
+  };
+
+  /*!
+    Blocks read from a binary PGM (P5) or PPM (P6) file with 8-bit samples, without loading the image: each row
+    of a block is read at its offset in the file. The type of the blocks can differ from the type of the file,
+    a PPM file is then converted to grayscale and a PGM file to RGBa.
+
+    Available for unsigned char and vpRGBa.
+  */
+  template <class Type>
+  class VISP_EXPORT vpPnmBlockReader : public vpBlockReader<Type> {
+  public:
+    explicit vpPnmBlockReader(const std::string &filename);
+    virtual ~vpPnmBlockReader();
+
+    virtual unsigned int getHeight() const {
+      return m_height;
+    }
+
+    virtual unsigned int getWidth() const {
+      return m_width;
+    }
+
+    virtual void read(const unsigned int top, const unsigned int left, vpImage<Type> &block);
+
+  private:
+    vpPnmBlockReader(const vpPnmBlockReader &);
+    vpPnmBlockReader &operator=(const vpPnmBlockReader &);
+
+    FILE *m_file;
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_nbChannels;      //1 for PGM, 3 for PPM
+    long long m_dataOffset;         //offset of the first pixel in the file
+    std::vector<unsigned char> m_row;
+  };
+
+  /*!
+    Blocks written to a binary PGM (P5) file for unsigned char, or PPM (P6) file for vpRGBa (the alpha channel is
+    dropped). The header is written at the construction and each row of a block is written at its offset in the
+    file, the blocks can come in any order.
+
+    Available for unsigned char and vpRGBa.
+  */
+  template <class Type>
+  class VISP_EXPORT vpPnmBlockWriter : public vpBlockWriter<Type> {
+  public:
+    vpPnmBlockWriter(const std::string &filename, const unsigned int height, const unsigned int width);
+    virtual ~vpPnmBlockWriter();
+
+    virtual void write(const unsigned int top, const unsigned int left, const vpImage<Type> &block);
+
+  private:
+    vpPnmBlockWriter(const vpPnmBlockWriter &);
+    vpPnmBlockWriter &operator=(const vpPnmBlockWriter &);
+
+    FILE *m_file;
+    unsigned int m_width;
+    unsigned int m_height;
+    long long m_dataOffset;
+    std::vector<unsigned char> m_row;
+  };
+}
+
+#endif
@@ -142,6 +142,39 @@ namespace vp
     CONTOUR_RETR_EXTERNAL /*!< Retrieve only external contours. */
   } vpContourRetrievalType;
 
+  typedef enum {
+    CONTOUR_APPROX_NONE,  /*!< Keep all the contour points. */
+    CONTOUR_APPROX_SIMPLE /*!< Keep only the end points of the horizontal, vertical and diagonal segments. */
+  } vpContourApproximationType;
+
+  typedef enum {
+    CONTOUR_STORE_IMAGE_POINTS,   /*!< Contour points stored as vpImagePoint. */
+    CONTOUR_STORE_INTEGER_POINTS, /*!< Contour points stored as vpContourPoint. */
+    CONTOUR_STORE_CHAIN_CODES     /*!< Start point and chain codes (vpDirectionType values) stored for each contour. */
+  } vpContourStorageType;
+
+
+  struct vpContourPoint {
+    int m_i;
+    int m_j;
+
+    vpContourPoint() :
+      m_i(0), m_j(0) {
+    }
+
+    vpContourPoint(const int i, const int j) :
+      m_i(i), m_j(j) {
+    }
+
+    bool operator==(const vpContourPoint &other) const {
+      return m_i == other.m_i && m_j == other.m_j;
+    }
+
+    bool operator!=(const vpContourPoint &other) const {
+      return !(*this == other);
+    }
+  };
+
 
   struct vpContour {
     std::vector<vpContour *> m_children;
@@ -216,11 +249,60 @@ namespace vp
   };
 
 
+  /*!
+    Contours stored in flat arrays: the points of all the contours are stored in one contiguous buffer and the
+    hierarchy is stored in parallel arrays indexed by the contour index, in the style of OpenCV hierarchy.
+    A parent, child or sibling index equal to -1 means none (a contour with a -1 parent is in the image frame).
+
+    Only the buffer corresponding to \e m_storage is filled and \e m_offsets indexes this buffer. With
+    vp::CONTOUR_STORE_CHAIN_CODES, a contour of n > 1 points has n chain codes, the last one going back to
+    the start point, and a single pixel contour has no chain code.
+  */
+  struct VISP_EXPORT vpContourSet {
+    vpContourStorageType m_storage;             /*!< Type of storage of the contour points. */
+    std::vector<vpImagePoint> m_points;         /*!< Points of all the contours (vp::CONTOUR_STORE_IMAGE_POINTS). */
+    std::vector<vpContourPoint> m_intPoints;    /*!< Points of all the contours (vp::CONTOUR_STORE_INTEGER_POINTS). */
+    std::vector<unsigned char> m_chainCodes;    /*!< Chain codes of all the contours (vp::CONTOUR_STORE_CHAIN_CODES). */
+    std::vector<vpContourPoint> m_chainStarts;  /*!< Start point of each contour (vp::CONTOUR_STORE_CHAIN_CODES). */
+    std::vector<unsigned int> m_offsets;        /*!< The points (or chain codes) of contour k are in [m_offsets[k], m_offsets[k+1][. */
+    std::vector<vpContourType> m_types;         /*!< Contour types. */
+    std::vector<int> m_parent;                  /*!< Parent contour. */
+    std::vector<int> m_firstChild;              /*!< First child contour. */
+    std::vector<int> m_nextSibling;             /*!< Next contour with the same parent. */
+
+    vpContourSet();
+
+    void clear();
+
+    void getContour(const unsigned int index, std::vector<vpImagePoint> &points) const;
+    void getContour(const unsigned int index, std::vector<vpContourPoint> &points) const;
+
+    unsigned int getNbPoints(const unsigned int index) const;
+
+    /*!
+      Return a pointer to the first point of the contour \e index in \e m_points, NULL unless the points are stored
+      with vp::CONTOUR_STORE_IMAGE_POINTS. Otherwise, see getContour().
+    */
+    const vpImagePoint *getPoints(const unsigned int index) const {
+      return (m_storage != CONTOUR_STORE_IMAGE_POINTS || m_points.empty()) ? NULL : &m_points[m_offsets[index]];
+    }
+
+    //! Return the number of contours.
+    unsigned int size() const {
+      return (unsigned int) m_types.size();
+    }
+  };
+
+
   VISP_EXPORT void drawContours(vpImage<unsigned char> &I, const std::vector<std::vector<vpImagePoint> > &contours, unsigned char grayValue=255);
   VISP_EXPORT void drawContours(vpImage<vpRGBa> &I, const std::vector<std::vector<vpImagePoint> > &contours, const vpColor &color);
 
   VISP_EXPORT void findContours(const vpImage<unsigned char> &I_original, vpContour &contours, std::vector<std::vector<vpImagePoint> > &contourPts,
                                 const vpContourRetrievalType& retrievalMode=vp::CONTOUR_RETR_TREE);
+  VISP_EXPORT void findContours(const vpImage<unsigned char> &I_original, vpContourSet &contours,
+                                const vpContourRetrievalType& retrievalMode=vp::CONTOUR_RETR_TREE,
+                                const vpContourApproximationType& approximationMode=vp::CONTOUR_APPROX_NONE,
+                                const vpContourStorageType& storage=vp::CONTOUR_STORE_IMAGE_POINTS);
 }
 
 #endif
@@ -44,9 +44,13 @@
 #ifndef __vpImgproc_h__
 #define __vpImgproc_h__
 
+#include <visp3/core/vpHistogram.h>
 #include <visp3/core/vpImage.h>
 #include <visp3/core/vpImageMorphology.h>
+#include <visp3/core/vpRect.h>
+#include <visp3/imgproc/vpBlockIo.h>
 #include <visp3/imgproc/vpContours.h>
+#include <visp3/imgproc/vpParallel.h>
 
 #define USE_OLD_FILL_HOLE 0
 
@@ -57,6 +61,12 @@ namespace vp
       RETINEX_UNIFORM = 0, RETINEX_LOW = 1, RETINEX_HIGH = 2
   };
 
+  typedef enum {
+    RETINEX_BLUR_KERNEL,              /*!< Gaussian blur with a truncated kernel of size kernelSize, the cost grows with the kernel size. */
+    RETINEX_BLUR_RECURSIVE,           /*!< Third order recursive Gaussian filter (van Vliet, Young and Verbeek), constant cost per pixel whatever the scale \cite vanVliet:1998:RGD */
+    RETINEX_BLUR_RECURSIVE_PYRAMID    /*!< Recursive Gaussian filter, the large scales are computed on a downsampled image and upsampled. */
+  } vpRetinexBlurMethod;
+
   typedef enum {
     AUTO_THRESHOLD_HUANG,       /*!< Huang L.-K. and Wang M.-J.J. (1995) "Image Thresholding by Minimizing the Measures of Fuzziness" Pattern Recognition, 28(1): 41-51 \cite Huang_imagethresholding */
     AUTO_THRESHOLD_INTERMODES,  /*!< Prewitt, JMS & Mendelsohn, ML (1966), "The analysis of cell images", Annals of the New York Academy of Sciences 128: 1035-1053 \cite NYAS:NYAS1035 */
@@ -66,6 +76,271 @@ namespace vp
     AUTO_THRESHOLD_TRIANGLE     /*!< Zack GW, Rogers WE, Latt SA (1977), "Automatic measurement of sister chromatid exchange frequency", J. Histochem. Cytochem. 25 (7): 741–53, PMID 70454 \cite doi:10.1177/25.7.70454 */
   } vpAutoThresholdMethod;
 
+  typedef enum {
+    LOCAL_THRESHOLD_NIBLACK,    /*!< Niblack W. (1986), "An Introduction to Digital Image Processing", Prentice-Hall: threshold m + k s with the local mean m and standard deviation s, k is typically -0.2. */
+    LOCAL_THRESHOLD_SAUVOLA,    /*!< Sauvola J. and Pietikainen M. (2000), "Adaptive document image binarization", Pattern Recognition 33(2): 225-236: threshold m (1 + k (s / 128 - 1)), k is typically 0.34. */
+    LOCAL_THRESHOLD_BRADLEY     /*!< Bradley D. and Roth G. (2007), "Adaptive Thresholding using the Integral Image", Journal of Graphics Tools 12(2): 13-21: threshold m (1 - k), k is typically 0.15. */
+  } vpLocalThresholdMethod;
+
+  /*!
+    Statistics of a connected component computed during the labeling.
+  */
+  struct vpConnectedComponent {
+    unsigned int m_area;  /*!< Number of pixels. */
+    unsigned int m_minRow; /*!< Top most row. */
+    unsigned int m_maxRow; /*!< Bottom most row. */
+    unsigned int m_minCol; /*!< Left most column. */
+    unsigned int m_maxCol; /*!< Right most column. */
+    double m_sumRow; /*!< Sum of the row coordinates. */
+    double m_sumCol; /*!< Sum of the column coordinates. */
+
+    vpConnectedComponent() :
+      m_area(0), m_minRow(UINT_MAX), m_maxRow(0), m_minCol(UINT_MAX), m_maxCol(0), m_sumRow(0.0), m_sumCol(0.0) {
+    }
+
+    //! Add the pixel at position (i, j).
+    void add(const unsigned int i, const unsigned int j) {
+      m_area++;
+      m_minRow = std::min(m_minRow, i);
+      m_maxRow = std::max(m_maxRow, i);
+      m_minCol = std::min(m_minCol, j);
+      m_maxCol = std::max(m_maxCol, j);
+      m_sumRow += i;
+      m_sumCol += j;
+    }
+
+    //! Merge the statistics of another part of the same component.
+    void merge(const vpConnectedComponent &other) {
+      m_area += other.m_area;
+      m_minRow = std::min(m_minRow, other.m_minRow);
+      m_maxRow = std::max(m_maxRow, other.m_maxRow);
+      m_minCol = std::min(m_minCol, other.m_minCol);
+      m_maxCol = std::max(m_maxCol, other.m_maxCol);
+      m_sumRow += other.m_sumRow;
+      m_sumCol += other.m_sumCol;
+    }
+
+    //! Return the bounding box of the component.
+    vpRect getBoundingBox() const {
+      return vpRect(m_minCol, m_minRow, m_maxCol - m_minCol + 1, m_maxRow - m_minRow + 1);
+    }
+
+    //! Return the center of gravity of the component.
+    vpImagePoint getCentroid() const {
+      return m_area > 0 ? vpImagePoint(m_sumRow / m_area, m_sumCol / m_area) : vpImagePoint(-1, -1);
+    }
+  };
+
+  /*!
+    Statistics of a grayscale image computed in a single pass: histogram, min / max intensities and sum of the
+    intensities. Computing them once per frame avoids scanning the image again in each histogram-based function:
+    equalizeHistogram(), stretchContrast() and autoThreshold() accept them.
+  */
+  struct VISP_EXPORT vpImageStatistics {
+    unsigned int m_histogram[256]; /*!< Histogram of the intensities. */
+    unsigned int m_nbPixels;       /*!< Number of pixels. */
+    unsigned char m_min;           /*!< Minimum intensity. */
+    unsigned char m_max;           /*!< Maximum intensity. */
+    double m_sum;                  /*!< Sum of the intensities. */
+
+    vpImageStatistics();
+    explicit vpImageStatistics(const vpImage<unsigned char> &I);
+
+    void compute(const vpImage<unsigned char> &I);
+
+    //! Return the mean intensity.
+    double getMean() const {
+      return m_nbPixels > 0 ? m_sum / m_nbPixels : 0.0;
+    }
+  };
+
+  /*!
+    Caller owned buffers for fillHoles(vpImage<unsigned char> &, vpFillHolesWorkspace &), reusing the same workspace
+    over successive frames avoids any memory allocation once the buffers have grown.
+  */
+  struct vpFillHolesWorkspace {
+    std::vector<int> m_stack;       /*!< Flood fill segment stack. */
+    vpImage<unsigned char> m_mask;  /*!< Binary copy of the image padded with a 1-pixel border. */
+
+    vpFillHolesWorkspace() : m_stack(), m_mask() {
+    }
+  };
+
+  /*!
+    Integral image of a grayscale image and, optionally, integral image of the squared intensities. The sum of the
+    intensities (of their squares) over any rectangle is obtained with four look-ups, whatever its size. The
+    integral images have one more row and one more column than the image: m_sum[i][j] is the sum of the intensities
+    of the rows < i and of the columns < j. The sums of 8-bit intensities are exact in double precision.
+
+    Reusing the same object over successive frames of the same size avoids any memory allocation.
+  */
+  struct VISP_EXPORT vpIntegralImage {
+    vpImage<double> m_sum;       /*!< Integral image of the intensities. */
+    vpImage<double> m_squareSum; /*!< Integral image of the squared intensities, only up to date if computed. */
+
+    vpIntegralImage();
+    explicit vpIntegralImage(const vpImage<unsigned char> &I, const bool squares=true);
+
+    void compute(const vpImage<unsigned char> &I, const bool squares=true);
+
+    //! Return the sum of the intensities of the rows [top, bottom[ and of the columns [left, right[.
+    double getSum(const unsigned int top, const unsigned int left, const unsigned int bottom,
+                  const unsigned int right) const {
+      return m_sum[bottom][right] - m_sum[top][right] - m_sum[bottom][left] + m_sum[top][left];
+    }
+
+    //! Return the sum of the squared intensities of the rows [top, bottom[ and of the columns [left, right[.
+    double getSquareSum(const unsigned int top, const unsigned int left, const unsigned int bottom,
+                        const unsigned int right) const {
+      return m_squareSum[bottom][right] - m_squareSum[top][right] - m_squareSum[bottom][left] + m_squareSum[top][left];
+    }
+  };
+
+  typedef enum {
+    STREAMING_EQUALIZE_HISTOGRAM,  /*!< Histogram equalization, see equalizeHistogram(). */
+    STREAMING_STRETCH_CONTRAST     /*!< Contrast stretching, see stretchContrast(). */
+  } vpStreamingContrastMethod;
+
+  /*!
+    Contrast enhancement of a video stream: the look-up table is kept from one frame to the next and only rebuilt
+    every \e refreshPeriod frames, from the statistics of a pixel grid subsampled by \e subsampling in both
+    directions. The histogram (the min / max intensities for the contrast stretching) is exponentially smoothed
+    with the \e smoothing factor, which avoids the flickering of a per-frame equalization. Between two refreshes
+    the cost per frame is the one of the look-up table.
+
+    With the default parameters (refresh at each frame, no subsampling, no smoothing), the result is the one of
+    equalizeHistogram() or stretchContrast() on each frame.
+
+    \code
+    vp::vpStreamingContrast equalizer(vp::STREAMING_EQUALIZE_HISTOGRAM, 5, 4, 0.2);
+    while (acquire(I)) {
+      equalizer.apply(I);
+    }
+    \endcode
+  */
+  class VISP_EXPORT vpStreamingContrast {
+  public:
+    explicit vpStreamingContrast(const vpStreamingContrastMethod &method=STREAMING_EQUALIZE_HISTOGRAM,
+                                 const unsigned int refreshPeriod=1, const unsigned int subsampling=1,
+                                 const double smoothing=1.0);
+
+    void apply(vpImage<unsigned char> &I);
+    void apply(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2);
+
+    //! Return the look-up table applied to the last frame.
+    const unsigned char *getLut() const {
+      return m_lut;
+    }
+    //! Return the method.
+    vpStreamingContrastMethod getMethod() const {
+      return m_method;
+    }
+    //! Return the number of frames between two refreshes of the statistics.
+    unsigned int getRefreshPeriod() const {
+      return m_refreshPeriod;
+    }
+    //! Return the smoothing factor of the statistics.
+    double getSmoothing() const {
+      return m_smoothing;
+    }
+    //! Return the subsampling step of the statistics pixel grid.
+    unsigned int getSubsampling() const {
+      return m_subsampling;
+    }
+
+    void reset();
+
+    void setMethod(const vpStreamingContrastMethod &method);
+    void setRefreshPeriod(const unsigned int refreshPeriod);
+    void setSmoothing(const double smoothing);
+    void setSubsampling(const unsigned int subsampling);
+
+  private:
+    void updateLut(const vpImage<unsigned char> &I);
+
+    vpStreamingContrastMethod m_method;
+    unsigned int m_refreshPeriod;
+    unsigned int m_subsampling;
+    double m_smoothing;
+    unsigned int m_nbFrames;    //frames since the last refresh of the statistics
+    bool m_initialized;         //false until the first statistics
+    double m_histogram[256];    //smoothed histogram
+    double m_nbSamples;         //sum of the smoothed histogram
+    double m_min, m_max;        //smoothed min / max intensities
+    unsigned char m_lut[256];
+  };
+
+  /*!
+    Chain of point operations on a grayscale image fused into a single look-up table. Each stage has the result
+    of the function of the same name, but the chain costs at most two passes over the image whatever its length:
+    - the statistics of the source image are computed once, the histogram seen by each histogram-based stage
+    (equalizeHistogram(), stretchContrast(), autoThreshold()) is the source histogram transformed by the look-up
+    table of the previous stages, no pass is needed when there is no histogram-based stage;
+    - the look-up table of all the stages is applied once, directly from the source to the destination image.
+
+    \code
+    vp::vpLutPipeline pipeline;
+    pipeline.adjust(1.2, -10.0).gammaCorrection(1.5).stretchContrast().autoThreshold(vp::AUTO_THRESHOLD_OTSU);
+    while (acquire(I)) {
+      pipeline.apply(I, I_binarised);
+    }
+    \endcode
+  */
+  class VISP_EXPORT vpLutPipeline {
+  public:
+    vpLutPipeline();
+
+    vpLutPipeline &adjust(const double alpha, const double beta);
+    vpLutPipeline &autoThreshold(const vpAutoThresholdMethod &method, const unsigned char backgroundValue=0,
+                                 const unsigned char foregroundValue=255);
+    vpLutPipeline &binarise(const unsigned char threshold, const unsigned char backgroundValue=0,
+                            const unsigned char foregroundValue=255);
+    vpLutPipeline &equalizeHistogram();
+    vpLutPipeline &gammaCorrection(const double gamma);
+    vpLutPipeline &performLut(const unsigned char (&lut)[256]);
+    vpLutPipeline &stretchContrast();
+
+    void apply(vpImage<unsigned char> &I);
+    void apply(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2);
+
+    void clear();
+
+    //! Return the look-up table of the whole chain applied to the last image.
+    const unsigned char *getLut() const {
+      return m_lut;
+    }
+    //! Return the threshold of each autoThreshold() stage on the last image, -1 if the method failed.
+    const std::vector<int> &getThresholds() const {
+      return m_thresholds;
+    }
+    //! Return the number of stages.
+    unsigned int size() const {
+      return (unsigned int) m_stages.size();
+    }
+
+  private:
+    typedef enum {
+      STAGE_LUT,
+      STAGE_AUTO_THRESHOLD,
+      STAGE_EQUALIZE_HISTOGRAM,
+      STAGE_STRETCH_CONTRAST
+    } vpStageType;
+
+    struct vpStage {
+      vpStageType m_type;
+      vpAutoThresholdMethod m_method;
+      unsigned char m_backgroundValue;
+      unsigned char m_foregroundValue;
+      unsigned char m_lut[256];   //look-up table of a STAGE_LUT stage
+    };
+
+    vpLutPipeline &addStage(const vpStageType &type);
+
+    std::vector<vpStage> m_stages;
+    std::vector<int> m_thresholds;
+    unsigned char m_lut[256];
+  };
+
   VISP_EXPORT void adjust(vpImage<unsigned char> &I, const double alpha, const double beta);
   VISP_EXPORT void adjust(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const double alpha, const double beta);
   VISP_EXPORT void adjust(vpImage<vpRGBa> &I, const double alpha, const double beta);
@@ -73,23 +348,51 @@ namespace vp
 
   VISP_EXPORT void equalizeHistogram(vpImage<unsigned char> &I);
   VISP_EXPORT void equalizeHistogram(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2);
+  VISP_EXPORT void equalizeHistogram(vpImage<unsigned char> &I, const vpImageStatistics &statistics);
+  VISP_EXPORT void equalizeHistogram(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const vpImageStatistics &statistics);
   VISP_EXPORT void equalizeHistogram(vpImage<vpRGBa> &I, const bool useHSV=false);
   VISP_EXPORT void equalizeHistogram(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const bool useHSV=false);
+  VISP_EXPORT void equalizeHistogram(vpImage<unsigned short> &I, const unsigned int nbBins=65536);
+  VISP_EXPORT void equalizeHistogram(const vpImage<unsigned short> &I1, vpImage<unsigned short> &I2,
+                                     const unsigned int nbBins=65536);
+  VISP_EXPORT void equalizeHistogram(vpBlockReader<unsigned char> &reader, vpBlockWriter<unsigned char> &writer,
+                                     const unsigned int tileSize=1024);
+
+  VISP_EXPORT void clahe(vpImage<unsigned char> &I, const unsigned int nbTilesX=8, const unsigned int nbTilesY=8,
+                         const double clipLimit=2.0);
+  VISP_EXPORT void clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const unsigned int nbTilesX=8,
+                         const unsigned int nbTilesY=8, const double clipLimit=2.0);
+  VISP_EXPORT void clahe(vpImage<vpRGBa> &I, const unsigned int nbTilesX=8, const unsigned int nbTilesY=8,
+                         const double clipLimit=2.0, const bool useHSV=false);
+  VISP_EXPORT void clahe(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const unsigned int nbTilesX=8,
+                         const unsigned int nbTilesY=8, const double clipLimit=2.0, const bool useHSV=false);
 
   VISP_EXPORT void gammaCorrection(vpImage<unsigned char> &I, const double gamma);
   VISP_EXPORT void gammaCorrection(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const double gamma);
   VISP_EXPORT void gammaCorrection(vpImage<vpRGBa> &I, const double gamma);
   VISP_EXPORT void gammaCorrection(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const double gamma);
+  VISP_EXPORT void gammaCorrection(vpImage<unsigned short> &I, const double gamma);
+  VISP_EXPORT void gammaCorrection(const vpImage<unsigned short> &I1, vpImage<unsigned short> &I2, const double gamma);
 
   VISP_EXPORT void retinex(vpImage<vpRGBa> &I, const int scale=240, const int scaleDiv=3,
-                           const int level=RETINEX_UNIFORM, const double dynamic=1.2, const int kernelSize=-1);
+                           const int level=RETINEX_UNIFORM, const double dynamic=1.2, const int kernelSize=-1,
+                           const vpRetinexBlurMethod &blurMethod=RETINEX_BLUR_KERNEL);
   VISP_EXPORT void retinex(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const int scale=240, const int scaleDiv=3,
-                           const int level=RETINEX_UNIFORM, const double dynamic=1.2, const int kernelSize=-1);
+                           const int level=RETINEX_UNIFORM, const double dynamic=1.2, const int kernelSize=-1,
+                           const vpRetinexBlurMethod &blurMethod=RETINEX_BLUR_KERNEL);
+  VISP_EXPORT void retinex(vpBlockReader<vpRGBa> &reader, vpBlockWriter<vpRGBa> &writer, const int scale=240,
+                           const int scaleDiv=3, const int level=RETINEX_UNIFORM, const double dynamic=1.2,
+                           const int kernelSize=-1, const vpRetinexBlurMethod &blurMethod=RETINEX_BLUR_KERNEL,
+                           const unsigned int tileSize=1024);
 
   VISP_EXPORT void stretchContrast(vpImage<unsigned char> &I);
   VISP_EXPORT void stretchContrast(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2);
+  VISP_EXPORT void stretchContrast(vpImage<unsigned char> &I, const vpImageStatistics &statistics);
+  VISP_EXPORT void stretchContrast(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const vpImageStatistics &statistics);
   VISP_EXPORT void stretchContrast(vpImage<vpRGBa> &I);
   VISP_EXPORT void stretchContrast(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2);
+  VISP_EXPORT void stretchContrast(vpImage<unsigned short> &I);
+  VISP_EXPORT void stretchContrast(const vpImage<unsigned short> &I1, vpImage<unsigned short> &I2);
 
   VISP_EXPORT void stretchContrastHSV(vpImage<vpRGBa> &I);
   VISP_EXPORT void stretchContrastHSV(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2);
@@ -100,24 +403,80 @@ namespace vp
   VISP_EXPORT void unsharpMask(vpImage<vpRGBa> &I, const unsigned int size=7, const double weight=0.6);
   VISP_EXPORT void unsharpMask(const vpImage<vpRGBa> &I, vpImage<vpRGBa> &Ires,
                                const unsigned int size=7, const double weight=0.6);
+  VISP_EXPORT void unsharpMask(vpBlockReader<unsigned char> &reader, vpBlockWriter<unsigned char> &writer,
+                               const unsigned int size=7, const double weight=0.6, const unsigned int tileSize=1024);
+  VISP_EXPORT void unsharpMask(vpBlockReader<vpRGBa> &reader, vpBlockWriter<vpRGBa> &writer,
+                               const unsigned int size=7, const double weight=0.6, const unsigned int tileSize=1024);
 
   VISP_EXPORT void connectedComponents(const vpImage<unsigned char> &I, vpImage<int> &labels, int &nbComponents,
-                                       const vpImageMorphology::vpConnexityType &connexity=vpImageMorphology::CONNEXITY_4);
+                                       const vpImageMorphology::vpConnexityType &connexity=vpImageMorphology::CONNEXITY_4,
+                                       const unsigned int nbThreads=1);
+  VISP_EXPORT void connectedComponents(const vpImage<unsigned char> &I, vpImage<int> &labels, int &nbComponents,
+                                       std::vector<vpConnectedComponent> &components,
+                                       const vpImageMorphology::vpConnexityType &connexity=vpImageMorphology::CONNEXITY_4,
+                                       const unsigned int minArea=0, const unsigned int nbThreads=1);
 
   VISP_EXPORT void fillHoles(vpImage<unsigned char> &I
 #if USE_OLD_FILL_HOLE
                              , const vpImageMorphology::vpConnexityType &connexity=vpImageMorphology::CONNEXITY_4
 #endif
       );
+  VISP_EXPORT void fillHoles(vpImage<unsigned char> &I, vpFillHolesWorkspace &workspace);
 
   VISP_EXPORT void floodFill(vpImage<unsigned char> &I, const vpImagePoint &seedPoint, const unsigned char oldValue, const unsigned char newValue,
                              const vpImageMorphology::vpConnexityType &connexity=vpImageMorphology::CONNEXITY_4);
+  VISP_EXPORT void floodFill(vpImage<unsigned char> &I, const vpImagePoint &seedPoint, const unsigned char oldValue, const unsigned char newValue,
+                             const vpImageMorphology::vpConnexityType &connexity, std::vector<int> &stack);
 
   VISP_EXPORT void reconstruct(const vpImage<unsigned char> &marker, const vpImage<unsigned char> &mask, vpImage<unsigned char> &I,
                                const vpImageMorphology::vpConnexityType &connexity=vpImageMorphology::CONNEXITY_4);
 
   VISP_EXPORT unsigned char autoThreshold(vpImage<unsigned char> &I, const vp::vpAutoThresholdMethod &method, const unsigned char backgroundValue=0,
                                           const unsigned char foregroundValue=255);
+  VISP_EXPORT unsigned char autoThreshold(vpImage<unsigned char> &I, const vpImageStatistics &statistics,
+                                          const vp::vpAutoThresholdMethod &method, const unsigned char backgroundValue=0,
+                                          const unsigned char foregroundValue=255);
+  VISP_EXPORT int computeAutoThreshold(const vpHistogram &hist, const vpAutoThresholdMethod &method);
+  VISP_EXPORT int computeAutoThreshold(const vpImageStatistics &statistics, const vpAutoThresholdMethod &method);
+  VISP_EXPORT void computeAutoThresholds(const vpHistogram &hist, const std::vector<vpAutoThresholdMethod> &methods,
+                                         std::vector<int> &thresholds);
+  VISP_EXPORT void computeAutoThresholds(const vpImage<unsigned char> &I, const std::vector<vpAutoThresholdMethod> &methods,
+                                         std::vector<int> &thresholds, const unsigned int subsampling=1);
+  VISP_EXPORT void binarise(vpImage<unsigned char> &I, const unsigned char threshold, const unsigned char backgroundValue=0,
+                            const unsigned char foregroundValue=255);
+  VISP_EXPORT void localThreshold(vpImage<unsigned char> &I, const vpLocalThresholdMethod &method,
+                                  const unsigned int windowSize, const double k, const unsigned char backgroundValue=0,
+                                  const unsigned char foregroundValue=255);
+  VISP_EXPORT void localThreshold(vpImage<unsigned char> &I, vpIntegralImage &integral, const vpLocalThresholdMethod &method,
+                                  const unsigned int windowSize, const double k, const unsigned char backgroundValue=0,
+                                  const unsigned char foregroundValue=255);
+
+  VISP_EXPORT int autoThreshold(vpImage<unsigned short> &I, const vp::vpAutoThresholdMethod &method,
+                                const unsigned short backgroundValue=0, const unsigned short foregroundValue=65535,
+                                const unsigned int nbBins=65536);
+  VISP_EXPORT void computeAutoThresholds(const vpImage<unsigned short> &I, const std::vector<vpAutoThresholdMethod> &methods,
+                                         std::vector<int> &thresholds, const unsigned int subsampling=1,
+                                         const unsigned int nbBins=65536);
+  VISP_EXPORT void binarise(vpImage<unsigned short> &I, const unsigned short threshold, const unsigned short backgroundValue=0,
+                            const unsigned short foregroundValue=65535);
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+  /*
+    Kernels of the look-up tables. The fastest one supported by the CPU is used, the tests force each of them with
+    setSimdKernel() to compare them with the scalar kernel. The kernel must not be changed while images are processed.
+  */
+  typedef enum {
+    SIMD_KERNEL_AUTO,         // Fastest kernel supported by the CPU
+    SIMD_KERNEL_SCALAR,
+    SIMD_KERNEL_AVX2,
+    SIMD_KERNEL_AVX512VBMI,
+    SIMD_KERNEL_NEON
+  } vpSimdKernel;
+
+  // Return false and keep the current kernel if the kernel is not built or not supported by the CPU
+  VISP_EXPORT bool setSimdKernel(const vpSimdKernel &kernel);
+  VISP_EXPORT vpSimdKernel getSimdKernel();
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 }
 
 #endif
@@ -0,0 +1,69 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Parallel execution layer of the image processing module.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpParallel.h
+  \brief Parallel execution of independent jobs on a pool of threads shared by the module.
+*/
+
+#ifndef __vpParallel_h__
+#define __vpParallel_h__
+
+#include <visp3/core/vpConfig.h>
+
+namespace vp
+{
+  /*!
+    Job function of parallelRun(): process the job number \e job of the task described by \e data.
+  */
+  typedef void (*vpParallelJobFn)(void *data, const unsigned int job);
+
+  /*!
+    Range function of parallelFor(): process the indexes [\e begin, \e end[ of the task described by \e data.
+  */
+  typedef void (*vpParallelRangeFn)(void *data, const unsigned int begin, const unsigned int end);
+
+  VISP_EXPORT void setNbThreads(const unsigned int nbThreads);
+  VISP_EXPORT unsigned int getNbThreads();
+  VISP_EXPORT unsigned int getNbWorkers(const unsigned int nbJobs, const unsigned int nbThreads=0);
+
+  VISP_EXPORT void parallelRun(const unsigned int nbJobs, vpParallelJobFn fn, void *data, const unsigned int nbThreads=0);
+  VISP_EXPORT void parallelFor(const unsigned int begin, const unsigned int end, const unsigned int grainSize,
+                               vpParallelRangeFn fn, void *data, const unsigned int nbThreads=0);
+}
+
+#endif
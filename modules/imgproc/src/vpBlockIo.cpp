@@ -0,0 +1,237 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Block access to images larger than the memory.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpBlockIo.cpp
+  \brief Readers and writers of rectangular blocks of PGM / PPM files.
+*/
+
+#include <cctype>
+
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/imgproc/vpBlockIo.h>
+
+
+namespace {
+//Offsets beyond 2 GB for the gigapixel images
+int seekFile(FILE *file, const long long offset) {
+#if defined(_WIN32)
+  return _fseeki64(file, offset, SEEK_SET);
+#else
+  return fseeko(file, (off_t) offset, SEEK_SET);
+#endif
+}
+
+//Next integer of a PNM header, the comments start with '#' and end at the end of the line
+bool readHeaderValue(FILE *file, unsigned int &value) {
+  int c = fgetc(file);
+  while (c != EOF && (isspace(c) || c == '#')) {
+    if (c == '#') {
+      while (c != EOF && c != '\n') {
+        c = fgetc(file);
+      }
+    }
+    c = fgetc(file);
+  }
+
+  if (c == EOF || !isdigit(c)) {
+    return false;
+  }
+
+  value = 0;
+  while (c != EOF && isdigit(c)) {
+    value = 10 * value + (unsigned int) (c - '0');
+    c = fgetc(file);
+  }
+
+  //A single whitespace character separates the header from the data
+  return c != EOF && isspace(c);
+}
+
+void convertRow(const unsigned char *src, const unsigned int nbChannels, const unsigned int size, unsigned char *dst) {
+  if (nbChannels == 1) {
+    std::copy(src, src + size, dst);
+  } else {
+    vpImageConvert::RGBToGrey(const_cast<unsigned char *>(src), dst, size);
+  }
+}
+
+void convertRow(const unsigned char *src, const unsigned int nbChannels, const unsigned int size, vpRGBa *dst) {
+  if (nbChannels == 1) {
+    vpImageConvert::GreyToRGBa(const_cast<unsigned char *>(src), reinterpret_cast<unsigned char *>(dst), size);
+  } else {
+    vpImageConvert::RGBToRGBa(const_cast<unsigned char *>(src), reinterpret_cast<unsigned char *>(dst), size);
+  }
+}
+
+void convertRow(const unsigned char *src, const unsigned int size, unsigned char *dst) {
+  std::copy(src, src + size, dst);
+}
+
+void convertRow(const vpRGBa *src, const unsigned int size, unsigned char *dst) {
+  vpImageConvert::RGBaToRGB(reinterpret_cast<unsigned char *>(const_cast<vpRGBa *>(src)), dst, size);
+}
+
+template <class Type>
+unsigned int getNbChannels();
+
+template <>
+unsigned int getNbChannels<unsigned char>() {
+  return 1;
+}
+
+template <>
+unsigned int getNbChannels<vpRGBa>() {
+  return 3;
+}
+} //namespace
+
+/*!
+  Open a PGM or PPM file and read its header.
+
+  \param filename : Binary PGM (P5) or PPM (P6) file with samples of 8 bits.
+*/
+template <class Type>
+vp::vpPnmBlockReader<Type>::vpPnmBlockReader(const std::string &filename) :
+  m_file(NULL), m_width(0), m_height(0), m_nbChannels(0), m_dataOffset(0), m_row() {
+  m_file = fopen(filename.c_str(), "rb");
+  if (m_file == NULL) {
+    throw vpException(vpException::ioError, "Cannot open the file %s", filename.c_str());
+  }
+
+  char magic[2] = { 0, 0 };
+  unsigned int maxValue = 0;
+  if (fread(magic, 1, 2, m_file) != 2 || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6')) {
+    fclose(m_file);
+    throw vpException(vpException::ioError, "The file %s is not a binary PGM or PPM file", filename.c_str());
+  }
+  if (!readHeaderValue(m_file, m_width) || !readHeaderValue(m_file, m_height) || !readHeaderValue(m_file, maxValue)
+      || maxValue == 0 || maxValue > 255) {
+    fclose(m_file);
+    throw vpException(vpException::ioError, "Bad header of the file %s, only 8-bit samples are supported",
+                      filename.c_str());
+  }
+
+  m_nbChannels = magic[1] == '5' ? 1 : 3;
+  m_dataOffset = (long long) ftell(m_file);
+}
+
+template <class Type>
+vp::vpPnmBlockReader<Type>::~vpPnmBlockReader() {
+  fclose(m_file);
+}
+
+/*!
+  Read a block of the file.
+
+  \param top : Row of the top left corner of the block.
+  \param left : Column of the top left corner of the block.
+  \param block : Block, its size is the size of the block to read.
+*/
+template <class Type>
+void vp::vpPnmBlockReader<Type>::read(const unsigned int top, const unsigned int left, vpImage<Type> &block) {
+  if (top + block.getHeight() > m_height || left + block.getWidth() > m_width) {
+    throw vpException(vpException::dimensionError, "The block is outside the image");
+  }
+
+  const unsigned int rowSize = block.getWidth() * m_nbChannels;
+  m_row.resize(rowSize);
+  for (unsigned int i = 0; i < block.getHeight(); i++) {
+    const long long offset = m_dataOffset + ((long long) (top + i) * m_width + left) * m_nbChannels;
+    if (rowSize > 0 && (seekFile(m_file, offset) != 0 || fread(&m_row[0], 1, rowSize, m_file) != rowSize)) {
+      throw vpException(vpException::ioError, "Cannot read the row %d of the file", top + i);
+    }
+    convertRow(m_row.empty() ? NULL : &m_row[0], m_nbChannels, block.getWidth(), block[i]);
+  }
+}
+
+/*!
+  Create a PGM file (unsigned char blocks) or a PPM file (vpRGBa blocks) and write its header.
+
+  \param filename : Name of the file.
+  \param height : Image height.
+  \param width : Image width.
+*/
+template <class Type>
+vp::vpPnmBlockWriter<Type>::vpPnmBlockWriter(const std::string &filename, const unsigned int height,
+                                             const unsigned int width) :
+  m_file(NULL), m_width(width), m_height(height), m_dataOffset(0), m_row() {
+  m_file = fopen(filename.c_str(), "wb");
+  if (m_file == NULL) {
+    throw vpException(vpException::ioError, "Cannot create the file %s", filename.c_str());
+  }
+
+  fprintf(m_file, "P%c\n%u %u\n255\n", getNbChannels<Type>() == 1 ? '5' : '6', width, height);
+  m_dataOffset = (long long) ftell(m_file);
+}
+
+template <class Type>
+vp::vpPnmBlockWriter<Type>::~vpPnmBlockWriter() {
+  fclose(m_file);
+}
+
+/*!
+  Write a block to the file.
+
+  \param top : Row of the top left corner of the block.
+  \param left : Column of the top left corner of the block.
+  \param block : Block to write.
+*/
+template <class Type>
+void vp::vpPnmBlockWriter<Type>::write(const unsigned int top, const unsigned int left, const vpImage<Type> &block) {
+  if (top + block.getHeight() > m_height || left + block.getWidth() > m_width) {
+    throw vpException(vpException::dimensionError, "The block is outside the image");
+  }
+
+  const unsigned int nbChannels = getNbChannels<Type>();
+  const unsigned int rowSize = block.getWidth() * nbChannels;
+  m_row.resize(rowSize);
+  for (unsigned int i = 0; i < block.getHeight() && rowSize > 0; i++) {
+    convertRow(block[i], block.getWidth(), &m_row[0]);
+    const long long offset = m_dataOffset + ((long long) (top + i) * m_width + left) * nbChannels;
+    if (seekFile(m_file, offset) != 0 || fwrite(&m_row[0], 1, rowSize, m_file) != rowSize) {
+      throw vpException(vpException::ioError, "Cannot write the row %d of the file", top + i);
+    }
+  }
+}
+
+namespace vp {
+  template class vpPnmBlockReader<unsigned char>;
+  template class vpPnmBlockReader<vpRGBa>;
+  template class vpPnmBlockWriter<unsigned char>;
+  template class vpPnmBlockWriter<vpRGBa>;
+}
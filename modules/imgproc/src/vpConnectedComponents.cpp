@@ -40,129 +40,462 @@
   \brief Basic connected components.
 */
 
-#include <queue>
 #include <visp3/imgproc/vpImgproc.h>
 
 namespace {
-void getNeighbors(const vpImage<unsigned char> &I, std::queue<vpImagePoint> &listOfNeighbors,
-                  const unsigned int i, const unsigned int j,
-                  const vpImageMorphology::vpConnexityType &connexity) {
-  unsigned char currValue = I[i][j];
-
-  if (connexity == vpImageMorphology::CONNEXITY_4) {
-    //Top
-    if (I[i-1][j] == currValue) {
-      listOfNeighbors.push(vpImagePoint(i-1, j));
-    }
+//Minimum number of pixels per strip to label the strips concurrently
+const unsigned int MIN_PIXELS_PER_STRIP = 256*256;
+
+//Union-find equivalence table where each root is the smallest label of its set,
+//so parents always point to a lower (earlier) provisional label.
+int findRoot(const std::vector<int> &parent, int label) {
+  while (parent[(size_t) label] < label) {
+    label = parent[(size_t) label];
+  }
+
+  return label;
+}
+
+//Make all the labels on the path from label to its root point to root
+void setRoot(std::vector<int> &parent, int label, const int root) {
+  while (parent[(size_t) label] < label) {
+    int next = parent[(size_t) label];
+    parent[(size_t) label] = root;
+    label = next;
+  }
+
+  parent[(size_t) label] = root;
+}
 
-    //Left
-    if (I[i][j-1] == currValue) {
-      listOfNeighbors.push(vpImagePoint(i, j-1));
+//Merge the sets of labels a and b and return the new root
+int mergeLabels(std::vector<int> &parent, const int a, const int b) {
+  int root = findRoot(parent, a);
+
+  if (a != b) {
+    int root_b = findRoot(parent, b);
+    if (root > root_b) {
+      root = root_b;
     }
 
-    //Right
-    if (I[i][j+1] == currValue) {
-      listOfNeighbors.push(vpImagePoint(i, j+1));
+    setRoot(parent, b, root);
+  }
+
+  setRoot(parent, a, root);
+
+  return root;
+}
+
+//Accumulator used when no statistics are requested
+class vpNoStatistics {
+public:
+  void addLabel() {
+  }
+
+  void addPixel(const int, const unsigned int, const unsigned int) {
+  }
+
+  void append(const vpNoStatistics &) {
+  }
+};
+
+//Accumulate the statistics of each provisional label
+class vpLabelStatistics {
+public:
+  std::vector<vp::vpConnectedComponent> m_components;
+
+  vpLabelStatistics() : m_components(1) {
+  }
+
+  void addLabel() {
+    m_components.push_back(vp::vpConnectedComponent());
+  }
+
+  void addPixel(const int label, const unsigned int i, const unsigned int j) {
+    m_components[(size_t) label].add(i, j);
+  }
+
+  //Append the provisional labels of another table (the background entry is skipped)
+  void append(const vpLabelStatistics &other) {
+    m_components.insert(m_components.end(), other.m_components.begin() + 1, other.m_components.end());
+  }
+};
+
+template <class Accumulator>
+int newLabel(std::vector<int> &parent, Accumulator &accumulator) {
+  int label = (int) parent.size();
+  parent.push_back(label);
+  accumulator.addLabel();
+
+  return label;
+}
+
+//First pass: assign provisional labels in raster order to the rows [startRow, endRow[ and record the equivalences.
+//Two pixels are connected if they share the same non zero value.
+template <class Accumulator>
+void firstPass4(const vpImage<unsigned char> &I, vpImage<int> &labels, const unsigned int startRow, const unsigned int endRow,
+                std::vector<int> &parent, Accumulator &accumulator) {
+  const unsigned int width = I.getWidth();
+
+  for (unsigned int i = startRow; i < endRow; i++) {
+    const unsigned char *ptr_cur = I[i];
+    const unsigned char *ptr_prev = i > startRow ? I[i-1] : NULL;
+    int *ptr_label_cur = labels[i];
+    const int *ptr_label_prev = i > startRow ? labels[i-1] : NULL;
+
+    for (unsigned int j = 0; j < width; j++) {
+      const unsigned char value = ptr_cur[j];
+
+      if (value == 0) {
+        ptr_label_cur[j] = 0;
+        continue;
+      }
+
+      const bool left = j > 0 && ptr_cur[j-1] == value;
+      const bool top = ptr_prev != NULL && ptr_prev[j] == value;
+
+      if (top) {
+        ptr_label_cur[j] = left ? mergeLabels(parent, ptr_label_prev[j], ptr_label_cur[j-1]) : ptr_label_prev[j];
+      } else if (left) {
+        ptr_label_cur[j] = ptr_label_cur[j-1];
+      } else {
+        ptr_label_cur[j] = newLabel(parent, accumulator);
+      }
+
+      accumulator.addPixel(ptr_label_cur[j], i, j);
     }
+  }
+}
+
+template <class Accumulator>
+void firstPass8(const vpImage<unsigned char> &I, vpImage<int> &labels, const unsigned int startRow, const unsigned int endRow,
+                std::vector<int> &parent, Accumulator &accumulator) {
+  const unsigned int width = I.getWidth();
+
+  for (unsigned int i = startRow; i < endRow; i++) {
+    const unsigned char *ptr_cur = I[i];
+    const unsigned char *ptr_prev = i > startRow ? I[i-1] : NULL;
+    int *ptr_label_cur = labels[i];
+    const int *ptr_label_prev = i > startRow ? labels[i-1] : NULL;
+
+    for (unsigned int j = 0; j < width; j++) {
+      const unsigned char value = ptr_cur[j];
+
+      if (value == 0) {
+        ptr_label_cur[j] = 0;
+        continue;
+      }
+
+      //Decision tree from Wu et al., "Optimizing two-pass connected-component labeling algorithms":
+      //when the top neighbor belongs to the component, the other neighbors are already merged with it.
+      if (ptr_prev != NULL && ptr_prev[j] == value) {
+        ptr_label_cur[j] = ptr_label_prev[j];
+      } else if (ptr_prev != NULL && j+1 < width && ptr_prev[j+1] == value) {
+        if (j > 0 && ptr_prev[j-1] == value) {
+          ptr_label_cur[j] = mergeLabels(parent, ptr_label_prev[j+1], ptr_label_prev[j-1]);
+        } else if (j > 0 && ptr_cur[j-1] == value) {
+          ptr_label_cur[j] = mergeLabels(parent, ptr_label_prev[j+1], ptr_label_cur[j-1]);
+        } else {
+          ptr_label_cur[j] = ptr_label_prev[j+1];
+        }
+      } else if (ptr_prev != NULL && j > 0 && ptr_prev[j-1] == value) {
+        ptr_label_cur[j] = ptr_label_prev[j-1];
+      } else if (j > 0 && ptr_cur[j-1] == value) {
+        ptr_label_cur[j] = ptr_label_cur[j-1];
+      } else {
+        ptr_label_cur[j] = newLabel(parent, accumulator);
+      }
 
-    //Bottom
-    if (I[i+1][j] == currValue) {
-      listOfNeighbors.push(vpImagePoint(i+1, j));
+      accumulator.addPixel(ptr_label_cur[j], i, j);
     }
+  }
+}
+
+//Horizontal strip of the image labeled independently. Provisional labels are local to the strip,
+//m_offset converts them to the labels of the global equivalence table.
+template <class Accumulator>
+struct vpLabelingStrip {
+  const vpImage<unsigned char> *m_I;
+  vpImage<int> *m_labels;
+  vpImageMorphology::vpConnexityType m_connexity;
+  unsigned int m_startRow;
+  unsigned int m_endRow;
+  std::vector<int> *m_parent;
+  Accumulator *m_accumulator;
+  const std::vector<int> *m_lut;
+  int m_offset;
+
+  vpLabelingStrip() :
+    m_I(NULL), m_labels(NULL), m_connexity(vpImageMorphology::CONNEXITY_4), m_startRow(0), m_endRow(0),
+    m_parent(NULL), m_accumulator(NULL), m_lut(NULL), m_offset(0) {
+  }
+};
+
+template <class Accumulator>
+void labelStrip(vpLabelingStrip<Accumulator> &strip) {
+  if (strip.m_connexity == vpImageMorphology::CONNEXITY_4) {
+    firstPass4(*strip.m_I, *strip.m_labels, strip.m_startRow, strip.m_endRow, *strip.m_parent, *strip.m_accumulator);
   } else {
-    for (int cpt1 = -1; cpt1 <= 1; cpt1++) {
-      for (int cpt2 = -1; cpt2 <= 1; cpt2++) {
-        //Everything except the current position
-        if (cpt1 != 0 || cpt2 != 0) {
-          if ( I[(int) i + cpt1][(int) j + cpt2] == currValue ) {
-            listOfNeighbors.push(vpImagePoint( (int) i + cpt1, (int) j + cpt2));
-          }
+    firstPass8(*strip.m_I, *strip.m_labels, strip.m_startRow, strip.m_endRow, *strip.m_parent, *strip.m_accumulator);
+  }
+}
+
+//Second pass: replace provisional labels by the final labels
+template <class Accumulator>
+void relabelStrip(vpLabelingStrip<Accumulator> &strip) {
+  const std::vector<int> &lut = *strip.m_lut;
+  int *ptr_start = (*strip.m_labels)[strip.m_startRow];
+  int *ptr_end = ptr_start + (strip.m_endRow - strip.m_startRow) * strip.m_labels->getWidth();
+
+  for (int *ptr = ptr_start; ptr != ptr_end; ++ptr) {
+    if (*ptr != 0) {
+      *ptr = lut[(size_t) (*ptr + strip.m_offset)];
+    }
+  }
+}
+
+template <class Accumulator>
+struct vpStripJobs {
+  std::vector<vpLabelingStrip<Accumulator> > *m_strips;
+  void (*m_fn)(vpLabelingStrip<Accumulator> &);
+};
+
+template <class Accumulator>
+void stripJob(void *data, const unsigned int job) {
+  vpStripJobs<Accumulator> &jobs = *((vpStripJobs<Accumulator> *) data);
+  jobs.m_fn((*jobs.m_strips)[job]);
+}
+
+//Run fn on each strip with the thread pool of the module
+template <class Accumulator>
+void processStrips(std::vector<vpLabelingStrip<Accumulator> > &strips, void (*fn)(vpLabelingStrip<Accumulator> &)) {
+  vpStripJobs<Accumulator> jobs;
+  jobs.m_strips = &strips;
+  jobs.m_fn = fn;
+  vp::parallelRun((unsigned int) strips.size(), stripJob<Accumulator>, &jobs, (unsigned int) strips.size());
+}
+
+//One strip per worker, small images are labeled sequentially, threading would cost more than it saves
+unsigned int getNbStrips(const vpImage<unsigned char> &I, const unsigned int nbThreads) {
+  unsigned int nbStrips = std::min(I.getSize() / MIN_PIXELS_PER_STRIP, I.getHeight());
+  return vp::getNbWorkers(std::max(nbStrips, 1u), nbThreads);
+}
+
+//Merge the equivalences of the labels on each side of the strip borders
+template <class Accumulator>
+void mergeStripBorders(const vpImage<unsigned char> &I, const vpImage<int> &labels,
+                       const std::vector<vpLabelingStrip<Accumulator> > &strips, std::vector<int> &parent,
+                       const vpImageMorphology::vpConnexityType &connexity) {
+  const int width = (int) I.getWidth();
+
+  for (size_t cpt = 1; cpt < strips.size(); cpt++) {
+    const unsigned int i = strips[cpt].m_startRow;
+    const unsigned char *ptr_cur = I[i];
+    const unsigned char *ptr_prev = I[i-1];
+    const int *ptr_label_cur = labels[i];
+    const int *ptr_label_prev = labels[i-1];
+    const int offset_cur = strips[cpt].m_offset;
+    const int offset_prev = strips[cpt-1].m_offset;
+
+    for (int j = 0; j < width; j++) {
+      const unsigned char value = ptr_cur[j];
+      if (value == 0) {
+        continue;
+      }
+
+      const int label = ptr_label_cur[j] + offset_cur;
+      const int start = connexity == vpImageMorphology::CONNEXITY_4 ? j : std::max(j-1, 0);
+      const int end = connexity == vpImageMorphology::CONNEXITY_4 ? j : std::min(j+1, width-1);
+
+      for (int k = start; k <= end; k++) {
+        if (ptr_prev[k] == value) {
+          mergeLabels(parent, label, ptr_label_prev[k] + offset_prev);
         }
       }
     }
   }
 }
 
-void visitNeighbors(vpImage<unsigned char> &I_copy, std::queue<vpImagePoint> &listOfNeighbors, vpImage<int> &labels,
-                    const int current_label, const vpImageMorphology::vpConnexityType &connexity) {
-  //Visit the neighbors
-  while (!listOfNeighbors.empty()) {
-    vpImagePoint imPt = listOfNeighbors.front();
-    unsigned int i = (unsigned int) imPt.get_i();
-    unsigned int j = (unsigned int) imPt.get_j();
-    listOfNeighbors.pop();
+//Label the image by horizontal strips and build the global equivalence table and provisional statistics
+template <class Accumulator>
+void firstPass(const vpImage<unsigned char> &I, vpImage<int> &labels, const vpImageMorphology::vpConnexityType &connexity,
+               const unsigned int nbThreads, std::vector<vpLabelingStrip<Accumulator> > &strips,
+               std::vector<int> &parent, Accumulator &accumulator) {
+  const unsigned int nbStrips = getNbStrips(I, nbThreads);
+  strips.resize(nbStrips);
+
+  //Equivalence table, label 0 is reserved for the background
+  parent.clear();
+  parent.reserve(1024);
+  parent.push_back(0);
+
+  std::vector<std::vector<int> > strip_parents(nbStrips > 1 ? nbStrips : 0, parent);
+  std::vector<Accumulator> strip_accumulators(nbStrips > 1 ? nbStrips : 0);
+
+  for (unsigned int cpt = 0; cpt < nbStrips; cpt++) {
+    strips[cpt].m_I = &I;
+    strips[cpt].m_labels = &labels;
+    strips[cpt].m_connexity = connexity;
+    strips[cpt].m_startRow = (unsigned int) ((cpt * (size_t) I.getHeight()) / nbStrips);
+    strips[cpt].m_endRow = (unsigned int) (((cpt+1) * (size_t) I.getHeight()) / nbStrips);
+    strips[cpt].m_parent = nbStrips > 1 ? &strip_parents[cpt] : &parent;
+    strips[cpt].m_accumulator = nbStrips > 1 ? &strip_accumulators[cpt] : &accumulator;
+  }
+
+  if (nbStrips == 1) {
+    labelStrip(strips[0]);
+    return;
+  }
+
+  processStrips(strips, &labelStrip<Accumulator>);
+
+  //Concatenate the equivalence tables in the strip order, which preserves the raster order of the labels
+  for (unsigned int cpt = 0; cpt < nbStrips; cpt++) {
+    const int offset = (int) parent.size() - 1;
+    const std::vector<int> &strip_parent = strip_parents[cpt];
+
+    for (size_t label = 1; label < strip_parent.size(); label++) {
+      parent.push_back(strip_parent[label] + offset);
+    }
+
+    accumulator.append(strip_accumulators[cpt]);
+    strips[cpt].m_offset = offset;
+    strips[cpt].m_parent = &parent;
+    strips[cpt].m_accumulator = &accumulator;
+  }
+
+  mergeStripBorders(I, labels, strips, parent, connexity);
+}
+
+template <class Accumulator>
+void secondPass(std::vector<vpLabelingStrip<Accumulator> > &strips, const std::vector<int> &lut) {
+  for (size_t cpt = 0; cpt < strips.size(); cpt++) {
+    strips[cpt].m_lut = &lut;
+  }
+
+  if (strips.size() == 1) {
+    relabelStrip(strips[0]);
+    return;
+  }
 
-    if (I_copy[i][j]) {
-      getNeighbors(I_copy, listOfNeighbors, i, j, connexity);
+  processStrips(strips, &relabelStrip<Accumulator>);
+}
+
+//Transform the equivalence table into a look-up table of consecutive final labels.
+//Since a root is the first provisional label met in raster order, the final labels are ordered by the
+//first pixel of each component, as with a flood fill based labeling.
+int flattenLabels(std::vector<int> &parent) {
+  int nbLabels = 0;
 
-      //Reset current position and set label
-      I_copy[i][j] = 0;
-      labels[i][j] = current_label;
+  for (size_t label = 1; label < parent.size(); label++) {
+    if (parent[label] < (int) label) {
+      parent[label] = parent[(size_t) parent[label]];
+    } else {
+      parent[label] = ++nbLabels;
     }
   }
+
+  return nbLabels;
+}
+
+//Gather the statistics of the provisional labels into the final labels and remove the components
+//smaller than minArea. The look-up table is updated accordingly.
+int flattenStatistics(std::vector<int> &parent, const int nbLabels, const std::vector<vp::vpConnectedComponent> &provisional,
+                      std::vector<vp::vpConnectedComponent> &components, const unsigned int minArea) {
+  components.assign((size_t) nbLabels, vp::vpConnectedComponent());
+  for (size_t label = 1; label < parent.size(); label++) {
+    components[(size_t) parent[label] - 1].merge(provisional[label]);
+  }
+
+  if (minArea <= 1) {
+    return nbLabels;
+  }
+
+  //Keep the large enough components and relabel them consecutively, preserving the order
+  std::vector<int> relabel((size_t) nbLabels + 1, 0);
+  int nbKept = 0;
+  for (size_t cpt = 0; cpt < components.size(); cpt++) {
+    if (components[cpt].m_area >= minArea) {
+      components[(size_t) nbKept] = components[cpt];
+      relabel[cpt + 1] = ++nbKept;
+    }
+  }
+  components.resize((size_t) nbKept);
+
+  for (size_t label = 1; label < parent.size(); label++) {
+    parent[label] = relabel[(size_t) parent[label]];
+  }
+
+  return nbKept;
 }
 } //namespace
 
 /*!
   \ingroup group_imgproc_connected_components
 
-  Perform connected components detection.
+  Perform connected components detection. The labeling is done with a two-pass scan and a union-find
+  equivalence table, labels are numbered from 1 following the raster order of the first pixel of each component.
+
+  With \e nbThreads > 1, the image is split into horizontal strips labeled concurrently by the thread pool of the
+  module and the label equivalences are merged along the strip borders. The result is identical to the sequential
+  labeling. Images too small to benefit from threading are labeled sequentially.
 
   \param I : Input image (0 means background).
   \param labels : Label image that contain for each position the component label.
   \param nbComponents : Number of connected components.
   \param connexity : Type of connexity.
+  \param nbThreads : Maximum number of threads, 0 to use getNbThreads(). It is bounded by getNbThreads().
 */
 void vp::connectedComponents(const vpImage<unsigned char> &I, vpImage<int> &labels, int &nbComponents,
-                             const vpImageMorphology::vpConnexityType &connexity) {
+                             const vpImageMorphology::vpConnexityType &connexity, const unsigned int nbThreads) {
   if (I.getSize() == 0) {
     return;
   }
 
   labels.resize(I.getHeight(), I.getWidth());
 
-  vpImage<unsigned char> I_copy(I.getHeight()+2, I.getWidth()+2);
-  // Copy and add border
-  for (unsigned int i = 0; i < I_copy.getHeight(); i++) {
-    if (i == 0 || i == I_copy.getHeight() - 1) {
-      memset(I_copy[i], 0, sizeof(unsigned char)*I_copy.getWidth());
-    } else {
-      I_copy[i][0] = 0;
-      memcpy(I_copy[i]+1, I[i-1], sizeof(unsigned char)*I.getWidth());
-      I_copy[i][I_copy.getWidth() - 1] = 0;
-    }
-  }
-
-  vpImage<int> labels_copy(I.getHeight()+2, I.getWidth()+2, 0);
+  std::vector<vpLabelingStrip<vpNoStatistics> > strips;
+  std::vector<int> parent;
+  vpNoStatistics accumulator;
+  firstPass(I, labels, connexity, nbThreads, strips, parent, accumulator);
 
-  int current_label = 1;
-  std::queue<vpImagePoint> listOfNeighbors;
+  nbComponents = flattenLabels(parent);
 
-  for (unsigned int cpt1 = 0; cpt1 < I.getHeight(); cpt1++) {
-    unsigned int i = cpt1+1;
+  secondPass(strips, parent);
+}
 
-    for (unsigned int cpt2 = 0; cpt2 < I.getWidth(); cpt2++) {
-      unsigned int j = cpt2+1;
+/*!
+  \ingroup group_imgproc_connected_components
 
-      if (I_copy[i][j] && labels_copy[i][j] == 0) {
-        //Get all the neighbors relative to the current position
-        getNeighbors(I_copy, listOfNeighbors, i, j, connexity);
+  Perform connected components detection and compute the statistics (area, bounding box, centroid) of each component
+  during the labeling pass.
 
-        //Reset current position and set label
-        I_copy[i][j] = 0;
-        labels_copy[i][j] = current_label;
+  \param I : Input image (0 means background).
+  \param labels : Label image that contain for each position the component label.
+  \param nbComponents : Number of connected components.
+  \param components : Statistics of each connected component, \e components[k] corresponds to the label \e k+1.
+  \param connexity : Type of connexity.
+  \param minArea : Components with less than \e minArea pixels are removed (set to 0 in \e labels) before the final
+  relabeling, the remaining components are numbered consecutively.
+  \param nbThreads : Maximum number of threads, see connectedComponents(const vpImage<unsigned char> &, vpImage<int> &, int &, const vpImageMorphology::vpConnexityType &, const unsigned int).
+*/
+void vp::connectedComponents(const vpImage<unsigned char> &I, vpImage<int> &labels, int &nbComponents,
+                             std::vector<vpConnectedComponent> &components,
+                             const vpImageMorphology::vpConnexityType &connexity, const unsigned int minArea,
+                             const unsigned int nbThreads) {
+  components.clear();
+  if (I.getSize() == 0) {
+    return;
+  }
 
-        visitNeighbors(I_copy, listOfNeighbors, labels_copy, current_label, connexity);
+  labels.resize(I.getHeight(), I.getWidth());
 
-        //Increment label
-        current_label++;
-      }
-    }
-  }
+  std::vector<vpLabelingStrip<vpLabelStatistics> > strips;
+  std::vector<int> parent;
+  vpLabelStatistics accumulator;
+  firstPass(I, labels, connexity, nbThreads, strips, parent, accumulator);
 
-  for (unsigned int i = 0; i < labels.getHeight(); i++) {
-    memcpy(labels[i], labels_copy[i+1]+1, sizeof(int)*labels.getWidth());
-  }
+  nbComponents = flattenLabels(parent);
+  nbComponents = flattenStatistics(parent, nbComponents, accumulator.m_components, components, minArea);
 
-  nbComponents = current_label - 1;
+  secondPass(strips, parent);
 }
@@ -69,165 +69,244 @@
   \brief Basic contours extraction.
 */
 
-#include <map>
 #include <visp3/imgproc/vpImgproc.h>
 
 namespace {
-bool fromTo(const vpImagePoint &from, const vpImagePoint &to, vpDirection &direction) {
-  if (from == to) {
-    return false;
+//Displacement for each vpDirectionType
+const int g_dirx[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+const int g_diry[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+/*
+  Border following (3) on the padded image: directions are integer indexes (vpDirectionType values) and
+  the neighbors are accessed with precomputed offsets in the bitmap, the padding avoids any bounds check.
+  Points are added without the 1-pixel padding.
+*/
+void followBorder(vpImage<int> &I, const unsigned int i, const unsigned int j, const int startDirection,
+                  std::vector<vp::vpContourPoint> &points, const int nbd) {
+  const int width = (int) I.getWidth();
+  const int offsets[8] = { -width, -width + 1, 1, width + 1, width, width - 1, -1, -width - 1 };
+  int * const bitmap = I.bitmap;
+  const int ij = (int) (i * I.getWidth() + j);
+
+  //Find i1j1 (3.1), clockwise from (i2, j2)
+  int direction = (startDirection + 1) & 7;
+  while (direction != startDirection && bitmap[ij + offsets[direction]] == 0) {
+    direction = (direction + 1) & 7;
   }
 
-  if ( std::fabs(from.get_i() - to.get_i()) < std::numeric_limits<double>::epsilon() ) {
-    if (from.get_j() < to.get_j()) {
-      direction.m_direction = EAST;
-    } else {
-      direction.m_direction = WEST;
-    }
-  } else if (from.get_i() < to.get_i()) {
-    if ( std::fabs(from.get_j() - to.get_j()) < std::numeric_limits<double>::epsilon() ) {
-      direction.m_direction = SOUTH;
-    } else if (from.get_j() < to.get_j()) {
-      direction.m_direction = SOUTH_EAST;
-    } else {
-      direction.m_direction = SOUTH_WEST;
-    }
-  } else {
-    if ( std::fabs(from.get_j() - to.get_j()) < std::numeric_limits<double>::epsilon() ) {
-      direction.m_direction = NORTH;
-    } else if (from.get_j() < to.get_j()) {
-      direction.m_direction = NORTH_EAST;
-    } else {
-      direction.m_direction = NORTH_WEST;
-    }
+  if (direction == startDirection) {
+    //(3.1) ; single pixel contour
+    return;
   }
 
-  return true;
-}
+  const int i1j1 = ij + offsets[direction];
+  int i3j3 = ij; //(3.2)
+  int i3 = (int) i - 1, j3 = (int) j - 1;
+  int toI2j2 = direction; //direction from (i3, j3) to (i2, j2)
 
-bool crossesEastBorder(const vpImage<int> &I, bool checked[8], const vpImagePoint &point) {
-  vpDirection direction;
-  if ( !fromTo(point, vpImagePoint(point.get_i(), point.get_j() + 1), direction) ) {
-    return false;
-  }
-
-  bool b = checked[(int) direction.m_direction];
+  while (true) {
+    //(3.3), counterclockwise from (i2, j2)
+    bool eastChecked = false;
+    int trace = (toI2j2 + 7) & 7;
+    while (bitmap[i3j3 + offsets[trace]] == 0) {
+      eastChecked = eastChecked || trace == EAST;
+      trace = (trace + 7) & 7;
+    }
 
-  if (point.get_i() < 0 || point.get_j() < 0) {
-    return false;
-  }
+    //(3.4)
+    points.push_back(vp::vpContourPoint(i3, j3));
+    if (eastChecked) {
+      bitmap[i3j3] = -nbd;
+    } else if (bitmap[i3j3] == 1) {
+      //Only set if the pixel has not been visited before (3.4) (b)
+      bitmap[i3j3] = nbd;
+    } //Otherwise leave it alone
 
-  unsigned int i = (unsigned int) point.get_i();
-  unsigned int j = (unsigned int) point.get_j();
+    const int i4j4 = i3j3 + offsets[trace];
+    if (i4j4 == ij && i3j3 == i1j1) {
+      //(3.5)
+      break;
+    }
 
-  return I[i][j] != 0 && ( (unsigned int) point.get_j() == I.getWidth()-1 || b);
+    //(3.5)
+    i3j3 = i4j4;
+    i3 += g_diry[trace];
+    j3 += g_dirx[trace];
+    toI2j2 = (trace + 4) & 7;
+  }
 }
 
-void addContourPoint(vpImage<int> &I, vp::vpContour *border, const vpImagePoint &point, bool checked[8], const int nbd) {
-  border->m_points.push_back(vpImagePoint(point.get_i()-1, point.get_j()-1)); //remove 1-pixel padding
+//Chain code between two neighbor points, indexed by (di+1)*3 + (dj+1)
+const unsigned char g_chainCodes[9] = {
+  NORTH_WEST, NORTH, NORTH_EAST, WEST, LAST_DIRECTION, EAST, SOUTH_WEST, SOUTH, SOUTH_EAST
+};
 
-  unsigned int i = (unsigned int) point.get_i();
-  unsigned int j = (unsigned int) point.get_j();
-
-  if (crossesEastBorder(I, checked, point)) {
-    I[i][j] = -nbd;
-  } else if (I[i][j] == 1) {
-    //Only set if the pixel has not been visited before (3.4) (b)
-    I[i][j] = nbd;
-  } //Otherwise leave it alone
+unsigned char getChainCode(const vp::vpContourPoint &from, const vp::vpContourPoint &to) {
+  return g_chainCodes[(to.m_i - from.m_i + 1)*3 + (to.m_j - from.m_j + 1)];
 }
 
-void followBorder(vpImage<int> &I, const vpImagePoint &ij, vpImagePoint &i2j2, vp::vpContour *border, const int nbd) {
-  vpDirection dir;
-  if (!fromTo(ij, i2j2, dir)) {
-    throw vpException(vpException::fatalError, "ij == i2j2");
+void appendPoint(vp::vpContourSet &contours, const vp::vpContourPoint &point) {
+  if (contours.m_storage == vp::CONTOUR_STORE_INTEGER_POINTS) {
+    contours.m_intPoints.push_back(point);
+  } else {
+    contours.m_points.push_back(vpImagePoint(point.m_i, point.m_j));
   }
+}
 
-  vpDirection trace = dir.clockwise();
-  vpImagePoint i1j1(-1, -1);
+void appendContour(vp::vpContourSet &contours, const std::vector<vp::vpContourPoint> &points,
+                   const vp::vpContourApproximationType &approximationMode) {
+  //Successive points are 8-connected, including the last and the first points of a contour of more than one point
+  const size_t nbPoints = points.size();
 
-  //Find i1j1 (3.1)
-  while (trace.m_direction != dir.m_direction) {
-    vpImagePoint activePixel = trace.active(I, ij);
+  if (contours.m_storage == vp::CONTOUR_STORE_CHAIN_CODES) {
+    contours.m_chainStarts.push_back(points.front());
 
-    if (activePixel.get_i() >= 0 && activePixel.get_j() >= 0) {
-      i1j1 = activePixel;
-      break;
+    if (nbPoints > 1) {
+      for (size_t k = 0; k < nbPoints; k++) {
+        contours.m_chainCodes.push_back(getChainCode(points[k], points[(k+1) % nbPoints]));
+      }
     }
 
-    trace = trace.clockwise();
-  }
-
-  if (i1j1.get_i() < 0 || i1j1.get_j() < 0) {
-    //(3.1) ; single pixel contour
+    contours.m_offsets.push_back((unsigned int) contours.m_chainCodes.size());
     return;
   }
 
-  i2j2 = i1j1;
-  vpImagePoint i3j3 = ij; //(3.2)
+  if (approximationMode == vp::CONTOUR_APPROX_SIMPLE && nbPoints > 2) {
+    //Keep the start point and the points where the direction changes
+    unsigned char previousCode = getChainCode(points.front(), points[1]);
+    appendPoint(contours, points.front());
 
-  bool checked[8] = {
-    false, false, false, false, false, false, false, false
-  };
-
-  while (true) {
-    if (!fromTo(i3j3, i2j2, dir)) {
-      throw vpException(vpException::fatalError, "i3j3 == i2j2");
+    for (size_t k = 1; k < nbPoints; k++) {
+      unsigned char code = getChainCode(points[k], points[(k+1) % nbPoints]);
+      if (code != previousCode) {
+        appendPoint(contours, points[k]);
+        previousCode = code;
+      }
     }
+  } else {
+    for (std::vector<vp::vpContourPoint>::const_iterator it = points.begin(); it != points.end(); ++it) {
+      appendPoint(contours, *it);
+    }
+  }
 
-    trace = dir.counterClockwise();
-    vpImagePoint i4j4(-1, -1);
+  contours.m_offsets.push_back((unsigned int) (contours.m_storage == vp::CONTOUR_STORE_INTEGER_POINTS ?
+                                               contours.m_intPoints.size() : contours.m_points.size()));
+}
 
-    //Reset checked
-    for (int cpt = 0; cpt < 8; cpt++) {
-      checked[cpt] = false;
+void clearContour(vp::vpContour &contour, const bool deleteChildren) {
+  if (deleteChildren) {
+    for (std::vector<vp::vpContour *>::iterator it = contour.m_children.begin(); it != contour.m_children.end(); ++it) {
+      (*it)->m_parent = NULL;
+      if (*it != NULL) {
+        delete *it;
+        *it = NULL;
+      }
     }
+  }
 
-    while (true) {
-      i4j4 = trace.active(I, i3j3); //(3.3)
-      if (i4j4.get_i() >= 0 && i4j4.get_j() >= 0) {
-        break;
-      }
+  contour.m_parent = NULL;
+  contour.m_children.clear();
+}
 
-      checked[(int) trace.m_direction] = true;
-      trace = trace.counterClockwise();
-    }
+vp::vpContour *newContourNode(const vp::vpContourSet &contourSet, const unsigned int index, vp::vpContour *parent) {
+  vp::vpContour *contour_node = new vp::vpContour(contourSet.m_types[index]);
+  contourSet.getContour(index, contour_node->m_points);
+  contour_node->setParent(parent);
 
-    addContourPoint(I, border, i3j3, checked, nbd);
+  return contour_node;
+}
+} //namespace
 
-    if (i4j4 == ij && i3j3 == i1j1) {
-      //(3.5)
+vp::vpContourSet::vpContourSet() :
+  m_storage(vp::CONTOUR_STORE_IMAGE_POINTS), m_points(), m_intPoints(), m_chainCodes(), m_chainStarts(),
+  m_offsets(1, 0), m_types(), m_parent(), m_firstChild(), m_nextSibling() {
+}
+
+/*!
+  Remove all the contours, the allocated memory is kept.
+*/
+void vp::vpContourSet::clear() {
+  m_points.clear();
+  m_intPoints.clear();
+  m_chainCodes.clear();
+  m_chainStarts.clear();
+  m_offsets.assign(1, 0);
+  m_types.clear();
+  m_parent.clear();
+  m_firstChild.clear();
+  m_nextSibling.clear();
+}
+
+/*!
+  Get the points of a contour, whatever the storage type.
+
+  \param index : Contour index.
+  \param points : Contour points.
+*/
+void vp::vpContourSet::getContour(const unsigned int index, std::vector<vpContourPoint> &points) const {
+  const unsigned int begin = m_offsets[index], end = m_offsets[index+1];
+
+  switch (m_storage) {
+    case vp::CONTOUR_STORE_INTEGER_POINTS:
+      points.assign(m_intPoints.begin() + begin, m_intPoints.begin() + end);
+      break;
+
+    case vp::CONTOUR_STORE_CHAIN_CODES: {
+      vpContourPoint point = m_chainStarts[index];
+      points.assign(1, point);
+
+      //The last chain code goes back to the start point
+      for (unsigned int k = begin; k + 1 < end; k++) {
+        point.m_i += g_diry[m_chainCodes[k]];
+        point.m_j += g_dirx[m_chainCodes[k]];
+        points.push_back(point);
+      }
       break;
     }
 
-    //(3.5)
-    i2j2 = i3j3;
-    i3j3 = i4j4;
+    default:
+      points.resize(end - begin);
+      for (unsigned int k = begin; k < end; k++) {
+        points[k - begin] = vpContourPoint((int) m_points[k].get_i(), (int) m_points[k].get_j());
+      }
+      break;
   }
 }
 
-bool isOuterBorderStart(const vpImage<int> &I, unsigned int i, unsigned int j) {
-  return (I[i][j] == 1 && (j == 0 || I[i][j - 1] == 0));
-}
+/*!
+  Get the points of a contour, whatever the storage type.
+
+  \param index : Contour index.
+  \param points : Contour points.
+*/
+void vp::vpContourSet::getContour(const unsigned int index, std::vector<vpImagePoint> &points) const {
+  if (m_storage == vp::CONTOUR_STORE_IMAGE_POINTS) {
+    points.assign(m_points.begin() + m_offsets[index], m_points.begin() + m_offsets[index+1]);
+  } else {
+    std::vector<vpContourPoint> intPoints;
+    getContour(index, intPoints);
 
-bool isHoleBorderStart(const vpImage<int> &I, unsigned int i, unsigned int j) {
-  return (I[i][j] >= 1 && (j == I.getWidth()-1 || I[i][j + 1] == 0));
+    points.resize(intPoints.size());
+    for (size_t k = 0; k < intPoints.size(); k++) {
+      points[k].set_ij(intPoints[k].m_i, intPoints[k].m_j);
+    }
+  }
 }
 
-void getContoursList(const vp::vpContour &root, const int level, vp::vpContour &contour_list) {
-  if (level > 0) {
-    vp::vpContour *contour_node = new vp::vpContour;
-    contour_node->m_contourType = root.m_contourType;
-    contour_node->m_points = root.m_points;
+/*!
+  Return the number of points of a contour.
 
-    contour_list.m_children.push_back(contour_node);
+  \param index : Contour index.
+*/
+unsigned int vp::vpContourSet::getNbPoints(const unsigned int index) const {
+  unsigned int size = m_offsets[index+1] - m_offsets[index];
+  if (m_storage == vp::CONTOUR_STORE_CHAIN_CODES && size == 0) {
+    //Single pixel contour
+    return 1;
   }
 
-  for (std::vector<vp::vpContour *>::const_iterator it = root.m_children.begin(); it != root.m_children.end(); ++it) {
-    getContoursList(**it, level+1, contour_list);
-  }
+  return size;
 }
-} //namespace
 
 /*!
   \ingroup group_imgproc_contours
@@ -284,6 +363,9 @@ void vp::drawContours(vpImage<vpRGBa> &I, const std::vector<std::vector<vpImageP
   \param contours : Detected contours.
   \param contourPts : List of contours, each contour contains a list of contour points.
   \param retrievalMode : Contour retrieval mode.
+
+  \note The contours are extracted with findContours(const vpImage<unsigned char> &, vpContourSet &, const vpContourRetrievalType &)
+  and converted afterwards to a vpContour tree.
 */
 void vp::findContours(const vpImage<unsigned char> &I_original, vpContour &contours, std::vector<std::vector<vpImagePoint> > &contourPts,
                       const vpContourRetrievalType& retrievalMode) {
@@ -291,14 +373,93 @@ void vp::findContours(const vpImage<unsigned char> &I_original, vpContour &conto
     return;
   }
 
+  //The hierarchy is needed to get the contours list in depth-first order
+  vpContourSet contourSet;
+  findContours(I_original, contourSet, retrievalMode == CONTOUR_RETR_EXTERNAL ? CONTOUR_RETR_EXTERNAL : CONTOUR_RETR_TREE);
+
+  //Copy contours points
+  contourPts.resize(contourSet.size());
+  for (unsigned int index = 0; index < contourSet.size(); index++) {
+    contourSet.getContour(index, contourPts[index]);
+  }
+
+  if (retrievalMode == CONTOUR_RETR_TREE) {
+    //Same behavior than assigning a root contour
+    clearContour(contours, contours.m_parent == NULL);
+    contours.m_contourType = vp::CONTOUR_HOLE;
+
+    //A parent contour is always found before its children
+    std::vector<vpContour *> nodes(contourSet.size());
+    for (unsigned int index = 0; index < contourSet.size(); index++) {
+      int parent = contourSet.m_parent[index];
+      nodes[index] = newContourNode(contourSet, index, parent < 0 ? &contours : nodes[(size_t) parent]);
+    }
+  } else {
+    //Delete contours content
+    clearContour(contours, true);
+
+    if (retrievalMode == CONTOUR_RETR_EXTERNAL) {
+      //Add only external contours
+      for (unsigned int index = 0; index < contourSet.size(); index++) {
+        newContourNode(contourSet, index, &contours);
+      }
+    } else if (contourSet.size() > 0) {
+      //CONTOUR_RETR_LIST: depth-first traversal of the hierarchy, the first contour is always an external contour
+      int index = 0;
+      while (index >= 0) {
+        newContourNode(contourSet, (unsigned int) index, &contours);
+
+        if (contourSet.m_firstChild[(size_t) index] >= 0) {
+          index = contourSet.m_firstChild[(size_t) index];
+        } else {
+          while (index >= 0 && contourSet.m_nextSibling[(size_t) index] < 0) {
+            index = contourSet.m_parent[(size_t) index];
+          }
+
+          if (index >= 0) {
+            index = contourSet.m_nextSibling[(size_t) index];
+          }
+        }
+      }
+    }
+  }
+}
+
+/*!
+  \ingroup group_imgproc_contours
+
+  Extract contours from a binary image without allocating a contour tree.
+  The points of all the contours are stored in a single buffer and the hierarchy in flat arrays, see vpContourSet.
+
+  With CONTOUR_RETR_TREE, the contour index k corresponds to the border number k+2 in the original paper and the
+  siblings are linked in the order the contours are found (top-level contours start at index 0).
+  With CONTOUR_RETR_LIST, all the contours are retrieved without any parent or child.
+  With CONTOUR_RETR_EXTERNAL, only the external contours are retrieved.
+
+  With CONTOUR_APPROX_SIMPLE, only the start point and the points where the direction of the contour changes are kept.
+  The approximation mode is ignored when chain codes are stored.
+
+  \param I_original : Input binary image (0 means background, 1 means foreground, other values are not allowed).
+  \param contours : Detected contours, the memory already allocated is reused.
+  \param retrievalMode : Contour retrieval mode.
+  \param approximationMode : Contour approximation mode.
+  \param storage : Type of storage of the contour points.
+*/
+void vp::findContours(const vpImage<unsigned char> &I_original, vpContourSet &contours, const vpContourRetrievalType& retrievalMode,
+                      const vpContourApproximationType& approximationMode, const vpContourStorageType& storage) {
   //Clear output results
-  contourPts.clear();
+  contours.clear();
+  contours.m_storage = storage;
+
+  if (I_original.getSize() == 0) {
+    return;
+  }
 
   //Copy uchar I_original into int I + padding
   vpImage<int> I(I_original.getHeight() + 2, I_original.getWidth() + 2);
   for (unsigned int i = 0; i < I.getHeight(); i++) {
     if (i == 0 || i == I.getHeight()-1) {
-      memset(I.bitmap, 0, sizeof(int)*I.getWidth());
+      memset(I[i], 0, sizeof(int)*I.getWidth());
     } else {
       I[i][0] = 0;
       for (unsigned int j = 0; j < I_original.getWidth(); j++) {
@@ -313,47 +474,42 @@ void vp::findContours(const vpImage<unsigned char> &I_original, vpContour &conto
   int nbd = 1; //Newest border
   int lnbd = 1; //Last newest border
 
-  //Background contour
-  //By default the root contour is a hole contour
-  vpContour *root = new vpContour(vp::CONTOUR_HOLE);
+  //Type, parent border and output index of each border, indexed by border number
+  //Border 1 is the background contour, by default a hole contour without parent
+  std::vector<vpContourType> borderTypes(2, vp::CONTOUR_HOLE);
+  std::vector<int> borderParents(2, 0);
+  std::vector<int> borderIndexes(2, -1);
 
-  std::map<int, vpContour*> borderMap;
-  borderMap[lnbd] = root;
+  //Points of the current border
+  std::vector<vpContourPoint> points;
 
-  for (unsigned int i = 0; i < I.getHeight(); i++) {
+  //The first and last rows and columns of the padded image are background pixels
+  for (unsigned int i = 1; i < I.getHeight()-1; i++) {
     lnbd = 1; //Reset LNBD at the beginning of each scan row
+    const int *row = I[i];
 
-    for (unsigned int j = 0; j < I.getWidth(); j++) {
-      int fji = I[i][j];
+    for (unsigned int j = 1; j < I.getWidth()-1; j++) {
+      int fji = row[j];
+      if (fji == 0) {
+        continue;
+      }
 
-      bool isOuter = isOuterBorderStart(I, i, j);
-      bool isHole = isHoleBorderStart(I, i, j);
+      bool isOuter = (fji == 1 && row[j - 1] == 0);
+      bool isHole = (fji >= 1 && row[j + 1] == 0);
 
       if (isOuter || isHole) { //else (1) (c)
-        vpContour *border = new vpContour;
-        vpContour *borderPrime = NULL;
-        vpImagePoint from(i, j);
+        vpContourType borderType;
+        int borderParent;
+        int startDirection;
 
         if (isOuter) {
           //(1) (a)
           nbd++;
-          from.set_j(from.get_j() - 1);
-          border->m_contourType = vp::CONTOUR_OUTER;
-          borderPrime = borderMap[lnbd];
+          startDirection = WEST;
+          borderType = vp::CONTOUR_OUTER;
 
           //Table 1
-          switch (borderPrime->m_contourType) {
-            case vp::CONTOUR_OUTER:
-              border->setParent(borderPrime->m_parent);
-              break;
-
-            case vp::CONTOUR_HOLE:
-              border->setParent(borderPrime);
-              break;
-
-            default:
-              break;
-          }
+          borderParent = borderTypes[(size_t) lnbd] == vp::CONTOUR_OUTER ? borderParents[(size_t) lnbd] : lnbd;
         } else {
           //(1) (b)
           nbd++;
@@ -362,40 +518,34 @@ void vp::findContours(const vpImage<unsigned char> &I_original, vpContour &conto
             lnbd = fji;
           }
 
-          borderPrime = borderMap[lnbd];
-          from.set_j(from.get_j() + 1);
-          border->m_contourType = vp::CONTOUR_HOLE;
+          startDirection = EAST;
+          borderType = vp::CONTOUR_HOLE;
 
           //Table 1
-          switch (borderPrime->m_contourType) {
-            case vp::CONTOUR_OUTER:
-              border->setParent(borderPrime);
-              break;
-
-            case vp::CONTOUR_HOLE:
-              border->setParent(borderPrime->m_parent);
-              break;
-
-            default:
-              break;
-          }
+          borderParent = borderTypes[(size_t) lnbd] == vp::CONTOUR_OUTER ? lnbd : borderParents[(size_t) lnbd];
         }
 
-        vpImagePoint ij(i, j);
-        followBorder(I, ij, from, border, nbd);
+        points.clear();
+        followBorder(I, i, j, startDirection, points, nbd);
 
         //(3) (1) ; single pixel contour
-        if (border->m_points.empty()) {
-          border->m_points.push_back(vpImagePoint(ij.get_i()-1, ij.get_j()-1)); //remove 1-pixel padding
+        if (points.empty()) {
+          points.push_back(vpContourPoint((int) i-1, (int) j-1)); //remove 1-pixel padding
           I[i][j] = -nbd;
         }
 
-        if (retrievalMode == CONTOUR_RETR_LIST || retrievalMode == CONTOUR_RETR_TREE) {
-          //Add contour points
-          contourPts.push_back(border->m_points);
-        }
+        borderTypes.push_back(borderType);
+        borderParents.push_back(borderParent);
 
-        borderMap[nbd] = border;
+        if (retrievalMode != CONTOUR_RETR_EXTERNAL || borderParent == 1) {
+          borderIndexes.push_back((int) contours.m_types.size());
+          contours.m_types.push_back(borderType);
+          contours.m_parent.push_back(retrievalMode == CONTOUR_RETR_TREE ? borderIndexes[(size_t) borderParent] : -1);
+          appendContour(contours, points, approximationMode);
+        } else {
+          //Border following is still needed to label the image
+          borderIndexes.push_back(-1);
+        }
       }
 
       //(4)
@@ -405,50 +555,21 @@ void vp::findContours(const vpImage<unsigned char> &I_original, vpContour &conto
     }
   }
 
-  if (retrievalMode == CONTOUR_RETR_EXTERNAL || retrievalMode == CONTOUR_RETR_LIST) {
-    //Delete contours content
-    contours.m_parent = NULL;
+  //Link the children of each contour in the order they have been found
+  contours.m_firstChild.assign(contours.m_parent.size(), -1);
+  contours.m_nextSibling.assign(contours.m_parent.size(), -1);
+  std::vector<int> lastChild(contours.m_parent.size() + 1, -1); //shifted by one for top-level contours
 
-    for (std::vector<vpContour *>::iterator it = contours.m_children.begin(); it != contours.m_children.end(); ++it) {
-      (*it)->m_parent = NULL;
-      if (*it != NULL) {
-        delete *it;
-        *it = NULL;
-      }
-    }
-
-    contours.m_children.clear();
-  }
+  for (size_t index = 0; index < contours.m_parent.size(); index++) {
+    int parent = contours.m_parent[index];
+    int &last = lastChild[(size_t) (parent + 1)];
 
-  if (retrievalMode == CONTOUR_RETR_EXTERNAL) {
-    //Add only external contours
-    for (std::vector<vpContour*>::const_iterator it = root->m_children.begin(); it != root->m_children.end(); ++it) {
-      //Save children
-      std::vector<vpContour *> children_copy = (*it)->m_children;
-      //Erase children
-      (*it)->m_children.clear();
-      //Copy contour
-      contours.m_children.push_back(new vpContour(**it));
-      //Restore children
-      (*it)->m_children = children_copy;
-      //Set parent to children
-      for (size_t i = 0; i < contours.m_children.size(); i++) {
-        contours.m_children[i]->m_parent = &contours;
-      }
-      contourPts.push_back((*it)->m_points);
+    if (last >= 0) {
+      contours.m_nextSibling[(size_t) last] = (int) index;
+    } else if (parent >= 0) {
+      contours.m_firstChild[(size_t) parent] = (int) index;
     }
-  } else if (retrievalMode == CONTOUR_RETR_LIST) {
-    getContoursList(*root, 0, contours);
 
-    //Set parent to root
-    for (std::vector<vpContour*>::iterator it = contours.m_children.begin(); it != contours.m_children.end(); ++it) {
-      (*it)->m_parent = &contours;
-    }
-  } else {
-    //CONTOUR_RETR_TREE
-    contours = *root;
+    last = (int) index;
   }
-
-  delete root;
-  root = NULL;
 }
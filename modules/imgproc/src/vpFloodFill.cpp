@@ -40,9 +40,19 @@
   \brief Flood fill algorithm.
 */
 
-#include <queue>
 #include <visp3/imgproc/vpImgproc.h>
 
+namespace {
+//Push the segment [xl, xr] of the filled line y, line y+dy has to be scanned
+void pushSegment(std::vector<int> &stack, const int y, const int xl, const int xr, const int dy, const int height) {
+  if (y + dy >= 0 && y + dy < height) {
+    stack.push_back(y);
+    stack.push_back(xl);
+    stack.push_back(xr);
+    stack.push_back(dy);
+  }
+}
+} //namespace
 
 /*!
   \ingroup group_imgproc_connected_components
@@ -57,89 +67,91 @@
 */
 void vp::floodFill(vpImage<unsigned char> &I, const vpImagePoint &seedPoint, const unsigned char oldValue, const unsigned char newValue,
                    const vpImageMorphology::vpConnexityType &connexity) {
-  //Code from Lode Vandevenne tutorial.
-  //Naive modification for 8-connexity implementation
-  if (oldValue == newValue || I.getSize() == 0) {
+  std::vector<int> stack;
+  floodFill(I, seedPoint, oldValue, newValue, connexity, stack);
+}
+
+/*!
+  \ingroup group_imgproc_connected_components
+
+  Perform the flood fill algorithm using the scanline seed fill of Heckbert (Graphics Gems, 1990):
+  filled horizontal segments (y, xLeft, xRight, direction) are pushed on a stack and the adjacent lines are
+  scanned for new segments.
+
+  \param I : Input image to flood fill.
+  \param seedPoint : Seed position in the image.
+  \param oldValue : Old value to replace.
+  \param newValue : New value to flood fill.
+  \param connexity : Type of connexity.
+  \param stack : Segment stack, can be reused over successive calls to avoid memory allocations.
+*/
+void vp::floodFill(vpImage<unsigned char> &I, const vpImagePoint &seedPoint, const unsigned char oldValue, const unsigned char newValue,
+                   const vpImageMorphology::vpConnexityType &connexity, std::vector<int> &stack) {
+  const int width = (int) I.getWidth(), height = (int) I.getHeight();
+  const int seed_x = (int) seedPoint.get_j(), seed_y = (int) seedPoint.get_i();
+
+  if (oldValue == newValue || I.getSize() == 0 || seed_x < 0 || seed_x >= width || seed_y < 0 || seed_y >= height ||
+      I[seed_y][seed_x] != oldValue) {
     return;
   }
 
-  std::queue<vpImagePoint> seed_queue;
+  //With 8-connexity, the pixels diagonally adjacent to the parent segment must be scanned too
+  const int extend = connexity == vpImageMorphology::CONNEXITY_4 ? 0 : 1;
 
-  //Add initial seed point
-  seed_queue.push(seedPoint);
+  stack.clear();
+  pushSegment(stack, seed_y, seed_x, seed_x, 1, height);
+  pushSegment(stack, seed_y + 1, seed_x, seed_x, -1, height);
 
-  while ( !seed_queue.empty() ) {
-    vpImagePoint current_seed = seed_queue.front();
-    seed_queue.pop();
+  while (!stack.empty()) {
+    //Pop the segment [x1, x2] of line y-dy and scan line y
+    const int dy = stack.back(); stack.pop_back();
+    const int x2 = stack.back(); stack.pop_back();
+    const int x1 = stack.back(); stack.pop_back();
+    const int y = stack.back() + dy; stack.pop_back();
 
-    unsigned int x = current_seed.get_j();
-    unsigned int y = current_seed.get_i();
-    int x1 = (int) x;
+    const int scan_x1 = std::max(x1 - extend, 0);
+    const int scan_x2 = std::min(x2 + extend, width - 1);
+    unsigned char *ptr_row = I[y];
 
-    //Find most left pixel
-    while (x1 >= 0 && I[y][x1] == oldValue) {
-      x1--;
+    //Fill to the left of scan_x1
+    int x = scan_x1;
+    for (; x >= 0 && ptr_row[x] == oldValue; x--) {
+      ptr_row[x] = newValue;
     }
-    x1++;
-
-    bool spanAbove = false, spanBelow = false;
-
-    while (x1 < (int) I.getWidth() && I[y][x1] == oldValue) {
-      I[y][x1] = newValue;
-
-      if (!spanAbove && y > 0) {
-        if (I[y-1][x1] == oldValue) {
-          //North
-          spanAbove = true;
-          seed_queue.push( vpImagePoint(y-1, x1) );
-        }
-
-        if (connexity != vpImageMorphology::CONNEXITY_4) {
-          if (x1 > 0 && I[y-1][x1-1] == oldValue) {
-            //North west
-            spanAbove = true;
-            seed_queue.push( vpImagePoint(y-1, x1-1) );
-          }
-          if (x1 < (int) I.getWidth()-1 && I[y-1][x1+1] == oldValue) {
-            //North east
-            spanAbove = true;
-            seed_queue.push( vpImagePoint(y-1, x1+1) );
-          }
-        }
-      } else if (spanAbove && y > 0 && I[y-1][x1] != oldValue) {
-        spanAbove = false;
+
+    int left = x + 1;
+    if (x < scan_x1) {
+      if (left < x1) {
+        //Leak on the left
+        pushSegment(stack, y, left, x1 - 1, -dy, height);
+      }
+      x = scan_x1 + 1;
+    } else {
+      //Skip the pixels that cannot be filled
+      for (x++; x <= scan_x2 && ptr_row[x] != oldValue; x++) {
       }
+      left = x;
 
-      if (!spanBelow && y < I.getHeight()-1) {
-        if (I[y+1][x1] == oldValue) {
-          //South
-          seed_queue.push( vpImagePoint(y+1, x1) );
-          spanBelow = true;
-        }
-
-        if (connexity != vpImageMorphology::CONNEXITY_4) {
-          if (x1 > 0 && I[y+1][x1-1] == oldValue) {
-            //South west
-            seed_queue.push( vpImagePoint(y+1, x1-1) );
-            spanBelow = true;
-          }
-          if (x1 < (int) I.getWidth()-1 && I[y+1][x1+1] == oldValue) {
-            //South east
-            seed_queue.push( vpImagePoint(y+1, x1+1) );
-            spanBelow = true;
-          }
-        }
-      } else if (spanBelow && y < I.getHeight()-1 && I[y+1][x1] != oldValue) {
-        spanBelow = false;
+      if (x > scan_x2) {
+        continue;
       }
+    }
 
-      //TODO: improve 8-connexity
-      if (connexity != vpImageMorphology::CONNEXITY_4) {
-        spanBelow = false;
-        spanAbove = false;
+    do {
+      for (; x < width && ptr_row[x] == oldValue; x++) {
+        ptr_row[x] = newValue;
       }
 
-      x1++;
-    }
+      pushSegment(stack, y, left, x - 1, dy, height);
+      if (x > x2 + 1) {
+        //Leak on the right
+        pushSegment(stack, y, x2 + 1, x - 1, -dy, height);
+      }
+
+      //Skip the pixels that cannot be filled
+      for (x++; x <= scan_x2 && ptr_row[x] != oldValue; x++) {
+      }
+      left = x;
+    } while (x <= scan_x2);
   }
 }
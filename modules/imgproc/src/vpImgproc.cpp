@@ -40,12 +40,716 @@
   \brief Basic image processing functions.
 */
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include <visp3/imgproc/vpImgproc.h>
 #include <visp3/core/vpMath.h>
-#include <visp3/core/vpHistogram.h>
 #include <visp3/core/vpImageConvert.h>
 #include <visp3/core/vpImageFilter.h>
 
+#include "vpImgprocBorder.h"
+#include "vpImgprocSimd.h"
+#include "vpTiles.h"
+
+
+namespace {
+/*
+  Compute the look-up table of the histogram equalization, only the entries of the intensities present in the
+  histogram are set. Return false if there is only one brightness value.
+*/
+bool computeEqualizationLut(const unsigned int *hist, const unsigned int nbPixels, unsigned char *lut) {
+  //Calculate the cumulative distribution function
+  unsigned int cdf[256];
+  unsigned int cdfMin = /*std::numeric_limits<unsigned int>::max()*/ UINT_MAX, cdfMax = 0;
+  unsigned int minValue = /*std::numeric_limits<unsigned int>::max()*/ UINT_MAX, maxValue = 0;
+  cdf[0] = hist[0];
+  
+  if(cdf[0] < cdfMin && cdf[0] > 0) {
+    cdfMin = cdf[0];
+    minValue = 0;
+  }
+  
+  for(unsigned int i = 1; i < 256; i++) {
+    cdf[i] = cdf[i-1] + hist[i];
+
+    if(cdf[i] < cdfMin && cdf[i] > 0) {
+      cdfMin = cdf[i];
+      minValue = i;
+    }
+
+    if(cdf[i] > cdfMax) {
+      cdfMax = cdf[i];
+      maxValue = i;
+    }
+  }
+  
+  if(nbPixels == cdfMin) {
+    //Only one brightness value in the image
+    return false;
+  }
+
+  //Construct the look-up table
+  for(unsigned int x = minValue; x <= maxValue; x++) {
+    lut[x] = vpMath::round( (cdf[x]-cdfMin) / (double) (nbPixels-cdfMin) * 255.0 );
+  }
+
+  return true;
+}
+
+//Look-up table of vp::adjust()
+void computeAdjustLut(const double alpha, const double beta, unsigned char *lut) {
+  for(unsigned int i = 0; i < 256; i++) {
+    lut[i] = vpMath::saturate<unsigned char>(alpha * i + beta);
+  }
+}
+
+//Look-up table of vp::gammaCorrection()
+void computeGammaLut(const double gamma, unsigned char *lut) {
+  double inverse_gamma = 1.0;
+  if(gamma > 0) {
+    inverse_gamma = 1.0 / gamma;
+  } else {
+    throw vpException(vpException::badValue, "The gamma value must be positive !");
+  }
+
+  for(unsigned int i = 0; i < 256; i++) {
+    lut[i] = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, inverse_gamma ) * 255.0 );
+  }
+}
+
+//Look-up table of vp::stretchContrast(), only the entries in [min, max] are set
+void computeStretchLut(const unsigned char min, const unsigned char max, unsigned char *lut) {
+  unsigned char range = max - min;
+  if(range > 0) {
+    for(unsigned int x = min; x <= max; x++) {
+      lut[x] = 255 * (x - min) / range;
+    }
+  } else {
+    lut[min] = min;
+  }
+}
+
+/*
+  Statistics of the image transformed by a look-up table, deduced from the statistics of the image: the pixels of
+  intensity x fall into the bin lut[x].
+*/
+void transformStatistics(const vp::vpImageStatistics &statistics, const unsigned char *lut, vp::vpImageStatistics &result) {
+  memset(result.m_histogram, 0, sizeof(result.m_histogram));
+  for (unsigned int x = 0; x < 256; x++) {
+    result.m_histogram[lut[x]] += statistics.m_histogram[x];
+  }
+
+  result.m_nbPixels = statistics.m_nbPixels;
+  result.m_min = 0;
+  result.m_max = 0;
+  result.m_sum = 0.0;
+  bool first = true;
+  for (unsigned int x = 0; x < 256; x++) {
+    if (result.m_histogram[x] > 0) {
+      result.m_min = first ? (unsigned char) x : result.m_min;
+      result.m_max = (unsigned char) x;
+      result.m_sum += x * (double) result.m_histogram[x];
+      first = false;
+    }
+  }
+}
+
+void checkStatistics(const vp::vpImageStatistics &statistics, const vpImage<unsigned char> &I) {
+  if (statistics.m_nbPixels != I.getSize()) {
+    throw vpException(vpException::dimensionError, "The image statistics (%d pixels) do not correspond to the image (%d pixels)",
+                      statistics.m_nbPixels, I.getSize());
+  }
+}
+
+inline unsigned char saturateFloat(const float value) {
+  //Same rounding and saturation as vpMath::saturate<unsigned char>(double), with a clamp on integers so that the
+  //sharpening loop is vectorized
+  int iv = (int) (value + 0.5f);
+  iv = iv < 0 ? 0 : iv;
+  return (unsigned char) (iv > 255 ? 255 : iv);
+}
+
+//Number of pixels per job of the parallel pixel-wise computations
+const unsigned int STATISTICS_GRAIN_SIZE = 1 << 16;
+
+/*
+  Add the histogram of the pixels to histogram, accumulated in four sub-histograms to avoid the dependency between
+  successive increments of the same bin.
+*/
+void computeHistogram(const unsigned char *ptr, const unsigned int size, unsigned int *histogram) {
+  unsigned int histograms[4][256];
+  memset(histograms, 0, sizeof(histograms));
+
+  unsigned int cpt = 0;
+  for (; cpt + 4 <= size; cpt += 4) {
+    histograms[0][ptr[cpt]]++;
+    histograms[1][ptr[cpt+1]]++;
+    histograms[2][ptr[cpt+2]]++;
+    histograms[3][ptr[cpt+3]]++;
+  }
+  for (; cpt < size; cpt++) {
+    histograms[0][ptr[cpt]]++;
+  }
+
+  for (unsigned int i = 0; i < 256; i++) {
+    histogram[i] += histograms[0][i] + histograms[1][i] + histograms[2][i] + histograms[3][i];
+  }
+}
+
+//One histogram per chunk of STATISTICS_GRAIN_SIZE pixels, summed in the chunk order
+struct vpHistogramJobs {
+  const unsigned char *m_bitmap;
+  std::vector<unsigned int> m_histograms;
+
+  vpHistogramJobs(const unsigned char *bitmap, const unsigned int size) :
+    m_bitmap(bitmap), m_histograms(256 * (size_t) ((size + STATISTICS_GRAIN_SIZE - 1) / STATISTICS_GRAIN_SIZE), 0) {
+  }
+};
+
+void computeHistogramRange(void *data, const unsigned int begin, const unsigned int end) {
+  vpHistogramJobs &jobs = *((vpHistogramJobs *) data);
+  computeHistogram(jobs.m_bitmap + begin, end - begin, &jobs.m_histograms[256 * (size_t) (begin / STATISTICS_GRAIN_SIZE)]);
+}
+
+//Min and max of each channel of interleaved RGBa pixels, one result per chunk of STATISTICS_GRAIN_SIZE pixels
+struct vpMinMaxJobs {
+  const unsigned char *m_bitmap;
+  std::vector<unsigned char> m_min;
+  std::vector<unsigned char> m_max;
+
+  vpMinMaxJobs(const unsigned char *bitmap, const unsigned int size) :
+    m_bitmap(bitmap), m_min(4 * (size_t) ((size + STATISTICS_GRAIN_SIZE - 1) / STATISTICS_GRAIN_SIZE), 255),
+    m_max(m_min.size(), 0) {
+  }
+};
+
+void computeMinMaxRange(void *data, const unsigned int begin, const unsigned int end) {
+  vpMinMaxJobs &jobs = *((vpMinMaxJobs *) data);
+  unsigned char minChannels[4] = { 255, 255, 255, 255 }, maxChannels[4] = { 0, 0, 0, 0 };
+  const unsigned char *ptr = jobs.m_bitmap + 4 * (size_t) begin;
+  for (unsigned int cpt = begin; cpt < end; cpt++, ptr += 4) {
+    for (unsigned int channel = 0; channel < 4; channel++) {
+      minChannels[channel] = std::min(minChannels[channel], ptr[channel]);
+      maxChannels[channel] = std::max(maxChannels[channel], ptr[channel]);
+    }
+  }
+
+  const size_t chunk = 4 * (size_t) (begin / STATISTICS_GRAIN_SIZE);
+  for (unsigned int channel = 0; channel < 4; channel++) {
+    jobs.m_min[chunk + channel] = minChannels[channel];
+    jobs.m_max[chunk + channel] = maxChannels[channel];
+  }
+}
+
+//Min and max of 16-bit intensities, one result per chunk of STATISTICS_GRAIN_SIZE pixels
+struct vpMinMax16Jobs {
+  const unsigned short *m_bitmap;
+  std::vector<unsigned short> m_min;
+  std::vector<unsigned short> m_max;
+
+  vpMinMax16Jobs(const unsigned short *bitmap, const unsigned int size) :
+    m_bitmap(bitmap), m_min((size + STATISTICS_GRAIN_SIZE - 1) / STATISTICS_GRAIN_SIZE, 65535), m_max(m_min.size(), 0) {
+  }
+};
+
+void computeMinMax16Range(void *data, const unsigned int begin, const unsigned int end) {
+  vpMinMax16Jobs &jobs = *((vpMinMax16Jobs *) data);
+  unsigned short minValue = 65535, maxValue = 0;
+  for (unsigned int cpt = begin; cpt < end; cpt++) {
+    minValue = std::min(minValue, jobs.m_bitmap[cpt]);
+    maxValue = std::max(maxValue, jobs.m_bitmap[cpt]);
+  }
+
+  jobs.m_min[begin / STATISTICS_GRAIN_SIZE] = minValue;
+  jobs.m_max[begin / STATISTICS_GRAIN_SIZE] = maxValue;
+}
+
+//Minimum number of pixels per strip to sharpen a strip in a dedicated job
+const unsigned int MIN_PIXELS_PER_UNSHARP_STRIP = 128*128;
+
+/*
+  Horizontal strip of rows sharpened by one job. The rows above and below the strip read by the Gaussian blur are
+  copied before the jobs start, the neighbor strips overwrite them concurrently.
+*/
+struct vpUnsharpStrip {
+  unsigned int m_rowBegin;
+  unsigned int m_rowEnd;
+  std::vector<unsigned char> m_halo;
+
+  vpUnsharpStrip() : m_rowBegin(0), m_rowEnd(0), m_halo() {
+  }
+};
+
+struct vpUnsharpJobs {
+  unsigned char *m_bitmap;
+  unsigned int m_width;
+  unsigned int m_height;
+  unsigned int m_nbChannels;
+  std::vector<float> m_filter;
+  double m_weight;
+  std::vector<vpUnsharpStrip> m_strips;
+
+  vpUnsharpJobs() : m_bitmap(NULL), m_width(0), m_height(0), m_nbChannels(0), m_filter(), m_weight(0.0), m_strips() {
+  }
+
+  //Input row i, the rows outside the strip are read in its halo
+  const unsigned char *getRow(const vpUnsharpStrip &strip, const unsigned int i) const {
+    const unsigned int rowSize = m_width * m_nbChannels;
+    const unsigned int radius = (unsigned int) m_filter.size() - 1;
+    if (i < strip.m_rowBegin) {
+      return &strip.m_halo[(i + radius - strip.m_rowBegin) * rowSize];
+    }
+    if (i >= strip.m_rowEnd) {
+      return &strip.m_halo[(radius + i - strip.m_rowEnd) * rowSize];
+    }
+
+    return m_bitmap + i*rowSize;
+  }
+};
+
+/*
+  Unsharp mask engine on interleaved channels, the alpha channel (if any) is kept.
+  The strip is processed row by row with a sliding window: the vertical Gaussian, the horizontal Gaussian and the
+  sharpening are fused and computed in float on buffers of one row. A sharpened row is written back in the
+  image only once no further row needs it as an input, so that the working set stays in cache.
+*/
+template <unsigned int nbChannels>
+void unsharpMaskStrip(const vpUnsharpJobs &jobs, const vpUnsharpStrip &strip) {
+  unsigned char *bitmap = jobs.m_bitmap;
+  const unsigned int width = jobs.m_width, height = jobs.m_height;
+  const std::vector<float> &filter = jobs.m_filter;
+  const unsigned int radius = (unsigned int) filter.size() - 1;
+
+  const unsigned int rowSize = width * nbChannels;
+  std::vector<float> vertical((width + 2*radius) * nbChannels);
+  std::vector<float> blurred(rowSize);
+  std::vector<unsigned char> pending((radius + 1) * rowSize);
+
+  const float alpha = (float) (1.0 / (1.0 - jobs.m_weight));
+  const float beta = (float) (jobs.m_weight / (1.0 - jobs.m_weight));
+
+  for (unsigned int i = strip.m_rowBegin; i < strip.m_rowEnd; i++) {
+    const unsigned char *src = bitmap + i*rowSize;
+    float *v = &vertical[radius * nbChannels];
+
+    //Vertical pass
+    for (unsigned int j = 0; j < rowSize; j++) {
+      v[j] = filter[0] * src[j];
+    }
+    for (unsigned int k = 1; k <= radius; k++) {
+      const unsigned char *top = jobs.getRow(strip, (unsigned int) vp::border::mirrorIndex((int) i - (int) k, (int) height));
+      const unsigned char *bottom = jobs.getRow(strip, (unsigned int) vp::border::mirrorIndex((int) (i + k), (int) height));
+      const float coeff = filter[k];
+      for (unsigned int j = 0; j < rowSize; j++) {
+        v[j] += coeff * (float) (top[j] + bottom[j]);
+      }
+    }
+
+    //Mirrored borders for the horizontal pass
+    for (unsigned int k = 1; k <= radius; k++) {
+      const int left = vp::border::mirrorIndex(-(int) k, (int) width);
+      const int right = vp::border::mirrorIndex((int) (width - 1 + k), (int) width);
+      for (unsigned int c = 0; c < nbChannels; c++) {
+        v[-(int) (k*nbChannels) + (int) c] = v[left*(int) nbChannels + (int) c];
+        v[(width - 1 + k)*nbChannels + c] = v[right*(int) nbChannels + (int) c];
+      }
+    }
+
+    //Horizontal pass
+    for (unsigned int j = 0; j < rowSize; j++) {
+      blurred[j] = filter[0] * v[j];
+    }
+    for (unsigned int k = 1; k <= radius; k++) {
+      const float coeff = filter[k];
+      const float *left = v - k*nbChannels;
+      const float *right = v + k*nbChannels;
+      for (unsigned int j = 0; j < rowSize; j++) {
+        blurred[j] += coeff * (left[j] + right[j]);
+      }
+    }
+
+    //Sharpening
+    unsigned char *dst = &pending[(i % (radius + 1)) * rowSize];
+    for (unsigned int j = 0; j < rowSize; j++) {
+      dst[j] = saturateFloat(alpha * src[j] - beta * blurred[j]);
+    }
+    if (nbChannels == 4) {
+      for (unsigned int j = 3; j < rowSize; j += 4) {
+        dst[j] = src[j];
+      }
+    }
+
+    //The row i - radius is no longer read by the next rows
+    if (i >= strip.m_rowBegin + radius) {
+      memcpy(bitmap + (i - radius)*rowSize, &pending[((i - radius) % (radius + 1)) * rowSize], rowSize);
+    }
+  }
+
+  const unsigned int rowFlush = std::max(strip.m_rowBegin, strip.m_rowEnd > radius ? strip.m_rowEnd - radius : 0);
+  for (unsigned int i = rowFlush; i < strip.m_rowEnd; i++) {
+    memcpy(bitmap + i*rowSize, &pending[(i % (radius + 1)) * rowSize], rowSize);
+  }
+}
+
+template <unsigned int nbChannels>
+void unsharpMaskJob(void *data, const unsigned int job) {
+  const vpUnsharpJobs &jobs = *((const vpUnsharpJobs *) data);
+  unsharpMaskStrip<nbChannels>(jobs, jobs.m_strips[job]);
+}
+
+/*
+  Sharpen interleaved channels in place. The image is split into horizontal strips sharpened concurrently, each
+  output row only depends on the input image so the result does not depend on the number of strips.
+*/
+template <unsigned int nbChannels>
+void unsharpMaskInterleaved(unsigned char *bitmap, const unsigned int width, const unsigned int height,
+                            const unsigned int size, const double weight) {
+  if (width == 0 || height == 0) {
+    return;
+  }
+
+  vpUnsharpJobs jobs;
+  jobs.m_bitmap = bitmap;
+  jobs.m_width = width;
+  jobs.m_height = height;
+  jobs.m_nbChannels = nbChannels;
+  jobs.m_weight = weight;
+
+  std::vector<double> fg((size+1)/2);
+  vpImageFilter::getGaussianKernel(&fg[0], size);
+  jobs.m_filter.assign(fg.begin(), fg.end());
+  const unsigned int radius = (unsigned int) jobs.m_filter.size() - 1;
+  const unsigned int rowSize = width * nbChannels;
+
+  //A strip has at least 2*radius+1 rows so that the mirrored rows stay in the strip or in its halo
+  unsigned int nbStrips = std::min(vp::getNbWorkers(height), (width * height) / MIN_PIXELS_PER_UNSHARP_STRIP);
+  nbStrips = std::max(std::min(nbStrips, height / (2*radius + 1)), 1u);
+
+  jobs.m_strips.resize(nbStrips);
+  for (unsigned int cpt = 0; cpt < nbStrips; cpt++) {
+    vpUnsharpStrip &strip = jobs.m_strips[cpt];
+    strip.m_rowBegin = (unsigned int) (((unsigned long long) height * cpt) / nbStrips);
+    strip.m_rowEnd = (unsigned int) (((unsigned long long) height * (cpt + 1)) / nbStrips);
+
+    if (nbStrips > 1) {
+      strip.m_halo.resize(2 * radius * rowSize);
+      for (unsigned int k = 0; k < radius; k++) {
+        if (strip.m_rowBegin >= radius - k) {
+          memcpy(&strip.m_halo[k * rowSize], bitmap + (strip.m_rowBegin - radius + k) * rowSize, rowSize);
+        }
+        if (strip.m_rowEnd + k < height) {
+          memcpy(&strip.m_halo[(radius + k) * rowSize], bitmap + (strip.m_rowEnd + k) * rowSize, rowSize);
+        }
+      }
+    }
+  }
+
+  vp::parallelRun(nbStrips, unsharpMaskJob<nbChannels>, &jobs);
+}
+
+//Fractional bits of the bilinear interpolation weights of the CLAHE
+const unsigned int CLAHE_WEIGHT_BITS = 10;
+const unsigned int CLAHE_WEIGHT_ONE = 1u << CLAHE_WEIGHT_BITS;
+//Number of rows per job of the CLAHE interpolation
+const unsigned int CLAHE_ROWS_GRAIN_SIZE = 16;
+
+/*
+  One channel of an interleaved image processed by the CLAHE: the pixel (i, j) is at m_src[(i*m_width + j)*m_step].
+  The tile t covers the rows [m_tileRows[t], m_tileRows[t+1][ (columns [m_tileCols[t], m_tileCols[t+1][).
+*/
+struct vpClaheJobs {
+  const unsigned char *m_src;
+  unsigned char *m_dst;
+  unsigned int m_height;
+  unsigned int m_width;
+  unsigned int m_step;
+  unsigned int m_nbTilesX;
+  unsigned int m_nbTilesY;
+  double m_clipLimit;
+  std::vector<unsigned int> m_tileRows;
+  std::vector<unsigned int> m_tileCols;
+  std::vector<unsigned char> m_luts;
+  //For each row (column), offsets of the look-up tables of the top / bottom tiles (left / right) and weight of
+  //the second one
+  std::vector<unsigned int> m_rowLut0;
+  std::vector<unsigned int> m_rowLut1;
+  std::vector<unsigned int> m_rowWeight;
+  std::vector<unsigned int> m_colLut0;
+  std::vector<unsigned int> m_colLut1;
+  std::vector<unsigned int> m_colWeight;
+};
+
+/*
+  Neighbouring tiles and fixed point weight of the second one for each coordinate: the look-up tables are
+  interpolated between the centers of the tiles and extended as is beyond the first and last centers.
+*/
+void getClaheWeights(const std::vector<unsigned int> &bounds, const unsigned int size, std::vector<unsigned int> &tile0,
+                     std::vector<unsigned int> &tile1, std::vector<unsigned int> &weight) {
+  const unsigned int nbTiles = (unsigned int) bounds.size() - 1;
+  tile0.resize(size);
+  tile1.resize(size);
+  weight.resize(size);
+
+  unsigned int t = 0;
+  for (unsigned int x = 0; x < size; x++) {
+    //Last tile whose center is not after x
+    while (t + 1 < nbTiles && 2*x + 1 >= bounds[t+1] + bounds[t+2]) {
+      t++;
+    }
+
+    const double center0 = (bounds[t] + bounds[t+1] - 1) / 2.0;
+    tile0[x] = t;
+    if (t + 1 == nbTiles || x <= center0) {
+      tile1[x] = t;
+      weight[x] = 0;
+    } else {
+      const double center1 = (bounds[t+1] + bounds[t+2] - 1) / 2.0;
+      tile1[x] = t + 1;
+      weight[x] = (unsigned int) vpMath::round((x - center0) / (center1 - center0) * CLAHE_WEIGHT_ONE);
+    }
+  }
+}
+
+//Clipped histogram and look-up table of the tiles [begin, end[
+void claheTilesRange(void *data, const unsigned int begin, const unsigned int end) {
+  vpClaheJobs &jobs = *((vpClaheJobs *) data);
+  const unsigned int step = jobs.m_step;
+
+  for (unsigned int t = begin; t < end; t++) {
+    const unsigned int tx = t % jobs.m_nbTilesX, ty = t / jobs.m_nbTilesX;
+    const unsigned int left = jobs.m_tileCols[tx], right = jobs.m_tileCols[tx+1];
+    const unsigned int top = jobs.m_tileRows[ty], bottom = jobs.m_tileRows[ty+1];
+
+    unsigned int hist[256];
+    memset(hist, 0, sizeof(hist));
+    for (unsigned int i = top; i < bottom; i++) {
+      const unsigned char *src = jobs.m_src + ((size_t) i * jobs.m_width + left) * step;
+      for (unsigned int j = left; j < right; j++, src += step) {
+        hist[*src]++;
+      }
+    }
+
+    //Clip the histogram and redistribute the excess uniformly over the bins
+    const unsigned int area = (bottom - top) * (right - left);
+    if (jobs.m_clipLimit > 0.0) {
+      const unsigned int limit = std::max(1u, (unsigned int) (jobs.m_clipLimit * area / 256.0));
+      unsigned int excess = 0;
+      for (unsigned int x = 0; x < 256; x++) {
+        if (hist[x] > limit) {
+          excess += hist[x] - limit;
+          hist[x] = limit;
+        }
+      }
+
+      const unsigned int batch = excess / 256;
+      unsigned int residual = excess - batch * 256;
+      for (unsigned int x = 0; x < 256; x++) {
+        hist[x] += batch;
+      }
+      if (residual > 0) {
+        const unsigned int residualStep = std::max(256u / residual, 1u);
+        for (unsigned int x = 0; x < 256 && residual > 0; x += residualStep, residual--) {
+          hist[x]++;
+        }
+      }
+    }
+
+    unsigned char *lut = &jobs.m_luts[(size_t) t * 256];
+    const double scale = 255.0 / area;
+    unsigned int cdf = 0;
+    for (unsigned int x = 0; x < 256; x++) {
+      cdf += hist[x];
+      lut[x] = (unsigned char) vpMath::round(cdf * scale);
+    }
+  }
+}
+
+//Bilinear interpolation of the look-up tables of the four neighbouring tiles for the rows [begin, end[
+void claheInterpolationRange(void *data, const unsigned int begin, const unsigned int end) {
+  vpClaheJobs &jobs = *((vpClaheJobs *) data);
+  const unsigned int step = jobs.m_step, width = jobs.m_width;
+  const unsigned int *colLut0 = &jobs.m_colLut0[0], *colLut1 = &jobs.m_colLut1[0], *colWeight = &jobs.m_colWeight[0];
+  for (unsigned int i = begin; i < end; i++) {
+    const unsigned char *lutTop = &jobs.m_luts[jobs.m_rowLut0[i]];
+    const unsigned char *lutBottom = &jobs.m_luts[jobs.m_rowLut1[i]];
+    const unsigned int wy = jobs.m_rowWeight[i], wy0 = CLAHE_WEIGHT_ONE - wy;
+    const unsigned char *src = jobs.m_src + (size_t) i * width * step;
+    unsigned char *dst = jobs.m_dst + (size_t) i * width * step;
+
+    for (unsigned int j = 0; j < width; j++, src += step, dst += step) {
+      const unsigned int v = *src, wx = colWeight[j], wx0 = CLAHE_WEIGHT_ONE - wx;
+      const unsigned int top = wx0 * lutTop[colLut0[j] + v] + wx * lutTop[colLut1[j] + v];
+      const unsigned int bottom = wx0 * lutBottom[colLut0[j] + v] + wx * lutBottom[colLut1[j] + v];
+      *dst = (unsigned char) ((wy0 * top + wy * bottom + (1u << (2*CLAHE_WEIGHT_BITS - 1))) >> (2*CLAHE_WEIGHT_BITS));
+    }
+  }
+}
+
+/*
+  CLAHE of one channel of an interleaved image of height x width pixels of step bytes, src may be equal to dst.
+*/
+void claheChannel(const unsigned char *src, unsigned char *dst, const unsigned int height, const unsigned int width,
+                  const unsigned int step, const unsigned int nbTilesX, const unsigned int nbTilesY,
+                  const double clipLimit) {
+  if (nbTilesX == 0 || nbTilesY == 0) {
+    throw vpException(vpException::badValue, "The number of tiles of the CLAHE must be at least 1");
+  }
+
+  if (height == 0 || width == 0) {
+    return;
+  }
+
+  vpClaheJobs jobs;
+  jobs.m_src = src;
+  jobs.m_dst = dst;
+  jobs.m_height = height;
+  jobs.m_width = width;
+  jobs.m_step = step;
+  //At least one pixel per tile
+  jobs.m_nbTilesX = std::min(nbTilesX, width);
+  jobs.m_nbTilesY = std::min(nbTilesY, height);
+  jobs.m_clipLimit = clipLimit;
+
+  jobs.m_tileCols.resize(jobs.m_nbTilesX + 1);
+  for (unsigned int t = 0; t <= jobs.m_nbTilesX; t++) {
+    jobs.m_tileCols[t] = (unsigned int) (((unsigned long) t * width) / jobs.m_nbTilesX);
+  }
+  jobs.m_tileRows.resize(jobs.m_nbTilesY + 1);
+  for (unsigned int t = 0; t <= jobs.m_nbTilesY; t++) {
+    jobs.m_tileRows[t] = (unsigned int) (((unsigned long) t * height) / jobs.m_nbTilesY);
+  }
+
+  const unsigned int nbTiles = jobs.m_nbTilesX * jobs.m_nbTilesY;
+  jobs.m_luts.resize((size_t) nbTiles * 256);
+  vp::parallelFor(0, nbTiles, 1, claheTilesRange, &jobs);
+
+  getClaheWeights(jobs.m_tileRows, height, jobs.m_rowLut0, jobs.m_rowLut1, jobs.m_rowWeight);
+  for (unsigned int i = 0; i < height; i++) {
+    jobs.m_rowLut0[i] *= jobs.m_nbTilesX * 256;
+    jobs.m_rowLut1[i] *= jobs.m_nbTilesX * 256;
+  }
+  getClaheWeights(jobs.m_tileCols, width, jobs.m_colLut0, jobs.m_colLut1, jobs.m_colWeight);
+  for (unsigned int j = 0; j < width; j++) {
+    jobs.m_colLut0[j] *= 256;
+    jobs.m_colLut1[j] *= 256;
+  }
+  vp::parallelFor(0, height, CLAHE_ROWS_GRAIN_SIZE, claheInterpolationRange, &jobs);
+}
+
+//First pass of the tiled histogram equalization, the tiles have no halo
+class vpHistogramTileOperation : public vp::tiles::vpTileOperation<unsigned char> {
+public:
+  vpHistogramTileOperation() : m_statistics() {
+  }
+
+  virtual void process(vpImage<unsigned char> &block, const unsigned int, const unsigned int, const unsigned int,
+                       const unsigned int) {
+    vp::vpImageStatistics statistics(block);
+    for (unsigned int i = 0; i < 256; i++) {
+      m_statistics.m_histogram[i] += statistics.m_histogram[i];
+    }
+    m_statistics.m_nbPixels += statistics.m_nbPixels;
+  }
+
+  vp::vpImageStatistics m_statistics;
+};
+
+class vpLutTileOperation : public vp::tiles::vpTileOperation<unsigned char> {
+public:
+  vpLutTileOperation() {
+    for (unsigned int x = 0; x < 256; x++) {
+      m_lut[x] = (unsigned char) x;
+    }
+  }
+
+  virtual void process(vpImage<unsigned char> &block, const unsigned int, const unsigned int, const unsigned int,
+                       const unsigned int) {
+    vp::simd::performLut(block, m_lut);
+  }
+
+  unsigned char m_lut[256];
+};
+
+//The whole block is sharpened, the halo provides the rows and columns read by the blur of the tile
+template <class Type, unsigned int nbChannels>
+class vpUnsharpTileOperation : public vp::tiles::vpTileOperation<Type> {
+public:
+  vpUnsharpTileOperation(const unsigned int size, const double weight) : m_size(size), m_weight(weight) {
+  }
+
+  virtual void process(vpImage<Type> &block, const unsigned int, const unsigned int, const unsigned int,
+                       const unsigned int) {
+    if (m_weight < 1.0 && m_weight >= 0.0) {
+      unsharpMaskInterleaved<nbChannels>(reinterpret_cast<unsigned char *>(block.bitmap), block.getWidth(),
+                                         block.getHeight(), m_size, m_weight);
+    }
+  }
+
+private:
+  unsigned int m_size;
+  double m_weight;
+};
+} //namespace
+
+/*!
+  Default constructor, statistics of an empty image.
+*/
+vp::vpImageStatistics::vpImageStatistics() :
+  m_nbPixels(0), m_min(0), m_max(0), m_sum(0.0) {
+  memset(m_histogram, 0, sizeof(m_histogram));
+}
+
+/*!
+  Compute the statistics of an image.
+
+  \param I : Input grayscale image.
+*/
+vp::vpImageStatistics::vpImageStatistics(const vpImage<unsigned char> &I) :
+  m_nbPixels(0), m_min(0), m_max(0), m_sum(0.0) {
+  compute(I);
+}
+
+/*!
+  Compute the statistics of an image in one pass. The histogram is accumulated in four sub-histograms to avoid
+  the dependency between successive increments of the same bin, the other statistics are deduced from it.
+  Large images are split into chunks whose histograms are computed with vp::parallelFor() and summed.
+
+  \param I : Input grayscale image.
+*/
+void vp::vpImageStatistics::compute(const vpImage<unsigned char> &I) {
+  const unsigned int size = I.getSize();
+  memset(m_histogram, 0, sizeof(m_histogram));
+  if (size <= STATISTICS_GRAIN_SIZE) {
+    computeHistogram(I.bitmap, size, m_histogram);
+  } else {
+    vpHistogramJobs jobs(I.bitmap, size);
+    vp::parallelFor(0, size, STATISTICS_GRAIN_SIZE, computeHistogramRange, &jobs);
+    for (size_t chunk = 0; chunk < jobs.m_histograms.size(); chunk += 256) {
+      for (unsigned int i = 0; i < 256; i++) {
+        m_histogram[i] += jobs.m_histograms[chunk + i];
+      }
+    }
+  }
+
+  m_nbPixels = size;
+  m_min = 255;
+  m_max = 0;
+  m_sum = 0.0;
+  for (unsigned int i = 0; i < 256; i++) {
+    if (m_histogram[i] > 0) {
+      m_min = std::min(m_min, (unsigned char) i);
+      m_max = (unsigned char) i;
+      m_sum += i * (double) m_histogram[i];
+    }
+  }
+
+  if (size == 0) {
+    m_min = 0;
+  }
+}
+
 
 /*!
   \ingroup group_imgproc_brightness
@@ -57,14 +761,7 @@
   \param beta : Constant value added to the old intensity.
 */
 void vp::adjust(vpImage<unsigned char> &I, const double alpha, const double beta) {
-  //Construct the look-up table
-  unsigned char lut[256];
-  for(unsigned int i = 0; i < 256; i++) {
-    lut[i] = vpMath::saturate<unsigned char>(alpha * i + beta);
-  }
-
-  //Apply the transformation using a LUT
-  I.performLut(lut);
+  vp::adjust(I, I, alpha, beta);
 }
 
 /*!
@@ -78,10 +775,12 @@ void vp::adjust(vpImage<unsigned char> &I, const double alpha, const double beta
   \param beta : Constant value added to the old intensity.
 */
 void vp::adjust(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const double alpha, const double beta) {
-  //Copy I1 to I2
-  I2 = I1;
+  //Construct the look-up table
+  unsigned char lut[256];
+  computeAdjustLut(alpha, beta, lut);
 
-  vp::adjust(I2, alpha, beta);
+  //Apply the transformation using a LUT, directly from I1 to I2
+  vp::simd::performLut(I1, I2, lut);
 }
 
 /*!
@@ -104,7 +803,7 @@ void vp::adjust(vpImage<vpRGBa> &I, const double alpha, const double beta) {
   }
 
   //Apply the transformation using a LUT
-  I.performLut(lut);
+  vp::simd::performLut(I, lut);
 }
 
 /*!
@@ -139,62 +838,99 @@ void vp::equalizeHistogram(vpImage<unsigned char> &I) {
   }
 
   //Calculate the histogram
-  vpHistogram hist;
-  hist.calculate(I);
+  vpImageStatistics statistics(I);
+  vp::equalizeHistogram(I, statistics);
+}
 
-  //Calculate the cumulative distribution function
-  unsigned int cdf[256];
-  unsigned int cdfMin = /*std::numeric_limits<unsigned int>::max()*/ UINT_MAX, cdfMax = 0;
-  unsigned int minValue = /*std::numeric_limits<unsigned int>::max()*/ UINT_MAX, maxValue = 0;
-  cdf[0] = hist[0];
-  
-  if(cdf[0] < cdfMin && cdf[0] > 0) {
-    cdfMin = cdf[0];
-    minValue = 0;
+/*!
+  \ingroup group_imgproc_histogram
+
+  Adjust the contrast of a grayscale image by performing an histogram equalization, using the already computed
+  histogram of the image.
+
+  \param I : The grayscale image to apply histogram equalization.
+  \param statistics : Statistics of the input image.
+*/
+void vp::equalizeHistogram(vpImage<unsigned char> &I, const vpImageStatistics &statistics) {
+  vp::equalizeHistogram(I, I, statistics);
+}
+
+/*!
+  \ingroup group_imgproc_histogram
+
+  Adjust the contrast of a grayscale image by performing an histogram equalization.
+  The intensity distribution is redistributed over the full [0 - 255] range such as the cumulative histogram
+  distribution becomes linear.
+
+  \param I1 : The first grayscale image.
+  \param I2 : The second grayscale image after histogram equalization.
+*/
+void vp::equalizeHistogram(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2) {
+  if(I1.getSize() == 0) {
+    I2 = I1;
+    return;
   }
-  
-  for(unsigned int i = 1; i < 256; i++) {
-    cdf[i] = cdf[i-1] + hist[i];
 
-    if(cdf[i] < cdfMin && cdf[i] > 0) {
-      cdfMin = cdf[i];
-      minValue = i;
-    }
+  vpImageStatistics statistics(I1);
+  vp::equalizeHistogram(I1, I2, statistics);
+}
 
-    if(cdf[i] > cdfMax) {
-      cdfMax = cdf[i];
-      maxValue = i;
+/*!
+  \ingroup group_imgproc_histogram
+
+  Adjust the contrast of a grayscale image by performing an histogram equalization, using the already computed
+  histogram of the image.
+
+  \param I1 : The first grayscale image.
+  \param I2 : The second grayscale image after histogram equalization.
+  \param statistics : Statistics of the first image.
+*/
+void vp::equalizeHistogram(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const vpImageStatistics &statistics) {
+  if(I1.getSize() == 0) {
+    if (&I1 != &I2) {
+      I2 = I1;
     }
-  }
-  
-  unsigned int nbPixels = I.getWidth()*I.getHeight();
-  if(nbPixels == cdfMin) {
-    //Only one brightness value in the image
     return;
   }
 
+  checkStatistics(statistics, I1);
+
   //Construct the look-up table
   unsigned char lut[256];
-  for(unsigned int x = minValue; x <= maxValue; x++) {
-    lut[x] = vpMath::round( (cdf[x]-cdfMin) / (double) (nbPixels-cdfMin) * 255.0 );
+  if (!computeEqualizationLut(statistics.m_histogram, I1.getSize(), lut)) {
+    //Only one brightness value in the image
+    if (&I1 != &I2) {
+      I2 = I1;
+    }
+    return;
   }
 
-  I.performLut(lut);
+  vp::simd::performLut(I1, I2, lut);
 }
 
 /*!
   \ingroup group_imgproc_histogram
 
-  Adjust the contrast of a grayscale image by performing an histogram equalization.
-  The intensity distribution is redistributed over the full [0 - 255] range such as the cumulative histogram
-  distribution becomes linear.
+  Histogram equalization of a grayscale image larger than the memory, in two passes over the tiles of the image:
+  the histogram of the whole image is accumulated in the first pass and the look-up table is applied in the
+  second one. The result is the one of equalizeHistogram(vpImage<unsigned char> &) and the memory is bounded by
+  the size of a tile.
 
-  \param I1 : The first grayscale image.
-  \param I2 : The second grayscale image after histogram equalization.
+  \param reader : Blocks of the input grayscale image.
+  \param writer : Blocks of the equalized grayscale image.
+  \param tileSize : Size in pixels of the square tiles.
 */
-void vp::equalizeHistogram(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2) {
-  I2 = I1;
-  vp::equalizeHistogram(I2);
+void vp::equalizeHistogram(vpBlockReader<unsigned char> &reader, vpBlockWriter<unsigned char> &writer,
+                           const unsigned int tileSize) {
+  vpHistogramTileOperation histogram;
+  vp::tiles::processTiles(reader, (vpBlockWriter<unsigned char> *) NULL, tileSize, 0, histogram);
+
+  //Identity when there is only one brightness value
+  vpLutTileOperation lut;
+  if (histogram.m_statistics.m_nbPixels > 0) {
+    computeEqualizationLut(histogram.m_statistics.m_histogram, histogram.m_statistics.m_nbPixels, lut.m_lut);
+  }
+  vp::tiles::processTiles(reader, &writer, tileSize, 0, lut);
 }
 
 /*!
@@ -214,41 +950,41 @@ void vp::equalizeHistogram(vpImage<vpRGBa> &I, const bool useHSV) {
   }
 
   if(!useHSV) {
-    //Split the RGBa image into 4 images
-    vpImage<unsigned char> pR(I.getHeight(), I.getWidth());
-    vpImage<unsigned char> pG(I.getHeight(), I.getWidth());
-    vpImage<unsigned char> pB(I.getHeight(), I.getWidth());
-    vpImage<unsigned char> pa(I.getHeight(), I.getWidth());
-
-    vpImageConvert::split(I, &pR, &pG, &pB, &pa);
-
-    //Apply histogram equalization for each channel
-    vp::equalizeHistogram(pR);
-    vp::equalizeHistogram(pG);
-    vp::equalizeHistogram(pB);
-
-    //Merge the result in I
-    unsigned int size = I.getWidth()*I.getHeight();
-    unsigned char *ptrStart = (unsigned char*) I.bitmap;
-    unsigned char *ptrEnd = ptrStart + size*4;
-    unsigned char *ptrCurrent = ptrStart;
-
-    unsigned int cpt = 0;
-    while(ptrCurrent != ptrEnd) {
-      *ptrCurrent = pR.bitmap[cpt];
-      ++ptrCurrent;
-
-      *ptrCurrent = pG.bitmap[cpt];
-      ++ptrCurrent;
+    //Histograms of the R, G, B channels in one interleaved pass
+    unsigned int histograms[3][256];
+    memset(histograms, 0, sizeof(histograms));
+
+    const unsigned int size = I.getSize();
+    const unsigned char *ptr = (const unsigned char *) I.bitmap;
+    for (unsigned int cpt = 0; cpt < size; cpt++, ptr += 4) {
+      histograms[0][ptr[0]]++;
+      histograms[1][ptr[1]]++;
+      histograms[2][ptr[2]]++;
+    }
 
-      *ptrCurrent = pB.bitmap[cpt];
-      ++ptrCurrent;
+    //Apply histogram equalization for each channel with a single look-up table, alpha channel is kept
+    unsigned char lut[4][256];
+    for (unsigned int x = 0; x < 256; x++) {
+      lut[0][x] = lut[1][x] = lut[2][x] = lut[3][x] = (unsigned char) x;
+    }
 
-      *ptrCurrent = pa.bitmap[cpt];
-      ++ptrCurrent;
+    for (unsigned int channel = 0; channel < 3; channel++) {
+      unsigned char lutChannel[256];
+      if (computeEqualizationLut(histograms[channel], size, lutChannel)) {
+        for (unsigned int x = 0; x < 256; x++) {
+          if (histograms[channel][x] > 0) {
+            lut[channel][x] = lutChannel[x];
+          }
+        }
+      }
+    }
 
-      cpt++;
+    vpRGBa lutRGBa[256];
+    for (unsigned int x = 0; x < 256; x++) {
+      lutRGBa[x] = vpRGBa(lut[0][x], lut[1][x], lut[2][x], lut[3][x]);
     }
+
+    vp::simd::performLut(I, lutRGBa);
   } else {
     vpImage<unsigned char> hue(I.getHeight(), I.getWidth());
     vpImage<unsigned char> saturation(I.getHeight(), I.getWidth());
@@ -285,6 +1021,180 @@ void vp::equalizeHistogram(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const
   vp::equalizeHistogram(I2, useHSV);
 }
 
+/*!
+  \ingroup group_imgproc_histogram
+
+  Contrast-limited adaptive histogram equalization (CLAHE) of a grayscale image \cite Zuiderveld:1994:CLA. The
+  image is split into a grid of nbTilesX x nbTilesY tiles, the histogram of each tile is clipped at clipLimit
+  times its mean bin count, the clipped counts being redistributed over all the bins, and gives the equalization
+  look-up table of the tile. Each pixel is mapped with the bilinear interpolation of the look-up tables of the
+  four tiles whose centers surround it, which avoids the block artifacts.
+
+  The look-up tables of the tiles are computed in parallel, then the rows are interpolated in parallel, with the
+  number of threads set with setNbThreads().
+
+  \param I : The grayscale image to apply the CLAHE.
+  \param nbTilesX : Number of tiles along the columns.
+  \param nbTilesY : Number of tiles along the rows.
+  \param clipLimit : Contrast limit, the maximum bin count of a tile histogram relative to a uniform histogram.
+  Higher values give more contrast, 1 gives almost no change, a value lower than or equal to 0 disables the
+  clipping (adaptive histogram equalization).
+*/
+void vp::clahe(vpImage<unsigned char> &I, const unsigned int nbTilesX, const unsigned int nbTilesY,
+               const double clipLimit) {
+  vp::clahe(I, I, nbTilesX, nbTilesY, clipLimit);
+}
+
+/*!
+  \ingroup group_imgproc_histogram
+
+  Contrast-limited adaptive histogram equalization (CLAHE) of a grayscale image, see
+  clahe(vpImage<unsigned char> &, const unsigned int, const unsigned int, const double).
+
+  \param I1 : The first grayscale image.
+  \param I2 : The second grayscale image after the CLAHE.
+  \param nbTilesX : Number of tiles along the columns.
+  \param nbTilesY : Number of tiles along the rows.
+  \param clipLimit : Contrast limit, the maximum bin count of a tile histogram relative to a uniform histogram, a
+  value lower than or equal to 0 disables the clipping.
+*/
+void vp::clahe(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const unsigned int nbTilesX,
+               const unsigned int nbTilesY, const double clipLimit) {
+  if (&I1 != &I2) {
+    I2.resize(I1.getHeight(), I1.getWidth());
+  }
+
+  claheChannel(I1.bitmap, I2.bitmap, I1.getHeight(), I1.getWidth(), 1, nbTilesX, nbTilesY, clipLimit);
+}
+
+/*!
+  \ingroup group_imgproc_histogram
+
+  Contrast-limited adaptive histogram equalization (CLAHE) of a color image, see
+  clahe(vpImage<unsigned char> &, const unsigned int, const unsigned int, const double). The alpha channel is
+  kept.
+
+  \param I : The color image to apply the CLAHE.
+  \param nbTilesX : Number of tiles along the columns.
+  \param nbTilesY : Number of tiles along the rows.
+  \param clipLimit : Contrast limit, the maximum bin count of a tile histogram relative to a uniform histogram, a
+  value lower than or equal to 0 disables the clipping.
+  \param useHSV : If true, the CLAHE is performed on the value channel (in HSV space), otherwise it is performed
+  independently on the RGB channels.
+*/
+void vp::clahe(vpImage<vpRGBa> &I, const unsigned int nbTilesX, const unsigned int nbTilesY, const double clipLimit,
+               const bool useHSV) {
+  if (!useHSV) {
+    //The channels are processed in place in the interleaved image
+    unsigned char *bitmap = (unsigned char *) I.bitmap;
+    for (unsigned int channel = 0; channel < 3; channel++) {
+      claheChannel(bitmap + channel, bitmap + channel, I.getHeight(), I.getWidth(), 4, nbTilesX, nbTilesY, clipLimit);
+    }
+  } else {
+    vpImage<unsigned char> hue(I.getHeight(), I.getWidth());
+    vpImage<unsigned char> saturation(I.getHeight(), I.getWidth());
+    vpImage<unsigned char> value(I.getHeight(), I.getWidth());
+
+    unsigned int size = I.getWidth()*I.getHeight();
+    //Convert from RGBa to HSV
+    vpImageConvert::RGBaToHSV((unsigned char *) I.bitmap, (unsigned char *) hue.bitmap,
+        (unsigned char *) saturation.bitmap, (unsigned char *) value.bitmap, size);
+
+    //CLAHE on the value plane
+    vp::clahe(value, nbTilesX, nbTilesY, clipLimit);
+
+    //Convert from HSV to RGBa
+    vpImageConvert::HSVToRGBa((unsigned char*) hue.bitmap, (unsigned char*) saturation.bitmap,
+        (unsigned char*) value.bitmap, (unsigned char*) I.bitmap, size);
+  }
+}
+
+/*!
+  \ingroup group_imgproc_histogram
+
+  Contrast-limited adaptive histogram equalization (CLAHE) of a color image, see
+  clahe(vpImage<vpRGBa> &, const unsigned int, const unsigned int, const double, const bool).
+
+  \param I1 : The first color image.
+  \param I2 : The second color image after the CLAHE.
+  \param nbTilesX : Number of tiles along the columns.
+  \param nbTilesY : Number of tiles along the rows.
+  \param clipLimit : Contrast limit, the maximum bin count of a tile histogram relative to a uniform histogram, a
+  value lower than or equal to 0 disables the clipping.
+  \param useHSV : If true, the CLAHE is performed on the value channel (in HSV space), otherwise it is performed
+  independently on the RGB channels.
+*/
+void vp::clahe(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const unsigned int nbTilesX,
+               const unsigned int nbTilesY, const double clipLimit, const bool useHSV) {
+  I2 = I1;
+  vp::clahe(I2, nbTilesX, nbTilesY, clipLimit, useHSV);
+}
+
+/*!
+  \ingroup group_imgproc_histogram
+
+  Adjust the contrast of a 16-bit grayscale image by performing an histogram equalization.
+  The intensity distribution is redistributed over the full [0 - 65535] range such as the cumulative histogram
+  distribution becomes linear. With less than 65536 bins, the histogram stays in cache but the intensities of a
+  same bin get the same equalized intensity.
+
+  \param I : The 16-bit grayscale image to apply histogram equalization.
+  \param nbBins : Number of bins of the histogram, in [2, 65536], the intensity v falls into the bin
+  (v * nbBins) / 65536.
+*/
+void vp::equalizeHistogram(vpImage<unsigned short> &I, const unsigned int nbBins) {
+  if (nbBins < 2 || nbBins > 65536) {
+    throw vpException(vpException::badValue, "The number of bins (%d) must be in [2, 65536]", nbBins);
+  }
+
+  if(I.getWidth()*I.getHeight() == 0) {
+    return;
+  }
+
+  //Calculate the histogram and the cumulative distribution function
+  std::vector<unsigned int> cdf(nbBins);
+  vp::simd::computeHistogram(I.bitmap, I.getSize(), nbBins, &cdf[0]);
+  for (unsigned int i = 1; i < nbBins; i++) {
+    cdf[i] += cdf[i-1];
+  }
+
+  unsigned int minBin = 0;
+  while (cdf[minBin] == 0) {
+    minBin++;
+  }
+
+  const unsigned int nbPixels = I.getSize(), cdfMin = cdf[minBin];
+  if(nbPixels == cdfMin) {
+    //Only one brightness value in the image
+    return;
+  }
+
+  //Construct the look-up table, the bins below the first non-empty bin are empty
+  std::vector<unsigned short> lut(65536, 0);
+  for (unsigned int v = 0; v < 65536; v++) {
+    const unsigned int bin = (v * nbBins) >> 16;
+    if (bin >= minBin) {
+      lut[v] = (unsigned short) vpMath::round( (cdf[bin]-cdfMin) / (double) (nbPixels-cdfMin) * 65535.0 );
+    }
+  }
+
+  vp::simd::performLut(I, &lut[0]);
+}
+
+/*!
+  \ingroup group_imgproc_histogram
+
+  Adjust the contrast of a 16-bit grayscale image by performing an histogram equalization.
+
+  \param I1 : The first 16-bit grayscale image.
+  \param I2 : The second 16-bit grayscale image after histogram equalization.
+  \param nbBins : Number of bins of the histogram, in [2, 65536].
+*/
+void vp::equalizeHistogram(const vpImage<unsigned short> &I1, vpImage<unsigned short> &I2, const unsigned int nbBins) {
+  I2 = I1;
+  vp::equalizeHistogram(I2, nbBins);
+}
+
 /*!
   \ingroup group_imgproc_gamma
 
@@ -294,6 +1204,35 @@ void vp::equalizeHistogram(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const
   \param gamma : Gamma value.
 */
 void vp::gammaCorrection(vpImage<unsigned char> &I, const double gamma) {
+  vp::gammaCorrection(I, I, gamma);
+}
+
+/*!
+  \ingroup group_imgproc_gamma
+
+  Perform a gamma correction on a grayscale image.
+
+  \param I1 : The first grayscale image.
+  \param I2 : The second grayscale image after gamma correction.
+  \param gamma : Gamma value.
+*/
+void vp::gammaCorrection(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const double gamma) {
+  //Construct the look-up table
+  unsigned char lut[256];
+  computeGammaLut(gamma, lut);
+
+  vp::simd::performLut(I1, I2, lut);
+}
+
+/*!
+  \ingroup group_imgproc_gamma
+
+  Perform a gamma correction on a color image.
+
+  \param I : The color image to apply gamma correction.
+  \param gamma : Gamma value.
+*/
+void vp::gammaCorrection(vpImage<vpRGBa> &I, const double gamma) {
   double inverse_gamma = 1.0;
   if(gamma > 0) {
     inverse_gamma = 1.0 / gamma;
@@ -302,24 +1241,27 @@ void vp::gammaCorrection(vpImage<unsigned char> &I, const double gamma) {
   }
 
   //Construct the look-up table
-  unsigned char lut[256];
+  vpRGBa lut[256];
   for(unsigned int i = 0; i < 256; i++) {
-    lut[i] = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, inverse_gamma ) * 255.0 );
+    lut[i].R = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, inverse_gamma ) * 255.0 );
+    lut[i].G = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, inverse_gamma ) * 255.0 );
+    lut[i].B = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, inverse_gamma ) * 255.0 );
+    lut[i].A = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, inverse_gamma ) * 255.0 );
   }
 
-  I.performLut(lut);
+  vp::simd::performLut(I, lut);
 }
 
 /*!
   \ingroup group_imgproc_gamma
 
-  Perform a gamma correction on a grayscale image.
+  Perform a gamma correction on a color image.
 
-  \param I1 : The first grayscale image.
-  \param I2 : The second grayscale image after gamma correction.
+  \param I1 : The first color image.
+  \param I2 : The second color image after gamma correction.
   \param gamma : Gamma value.
 */
-void vp::gammaCorrection(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const double gamma) {
+void vp::gammaCorrection(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const double gamma) {
   I2 = I1;
   vp::gammaCorrection(I2, gamma);
 }
@@ -327,12 +1269,12 @@ void vp::gammaCorrection(const vpImage<unsigned char> &I1, vpImage<unsigned char
 /*!
   \ingroup group_imgproc_gamma
 
-  Perform a gamma correction on a color image.
+  Perform a gamma correction on a 16-bit grayscale image, using a 65536-entry look-up table.
 
-  \param I : The color image to apply gamma correction.
+  \param I : The 16-bit grayscale image to apply gamma correction.
   \param gamma : Gamma value.
 */
-void vp::gammaCorrection(vpImage<vpRGBa> &I, const double gamma) {
+void vp::gammaCorrection(vpImage<unsigned short> &I, const double gamma) {
   double inverse_gamma = 1.0;
   if(gamma > 0) {
     inverse_gamma = 1.0 / gamma;
@@ -341,27 +1283,24 @@ void vp::gammaCorrection(vpImage<vpRGBa> &I, const double gamma) {
   }
 
   //Construct the look-up table
-  vpRGBa lut[256];
-  for(unsigned int i = 0; i < 256; i++) {
-    lut[i].R = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, inverse_gamma ) * 255.0 );
-    lut[i].G = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, inverse_gamma ) * 255.0 );
-    lut[i].B = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, inverse_gamma ) * 255.0 );
-    lut[i].A = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, inverse_gamma ) * 255.0 );
+  std::vector<unsigned short> lut(65536);
+  for(unsigned int i = 0; i < 65536; i++) {
+    lut[i] = vpMath::saturate<unsigned short>( pow( (double) i / 65535.0, inverse_gamma ) * 65535.0 );
   }
 
-  I.performLut(lut);
+  vp::simd::performLut(I, &lut[0]);
 }
 
 /*!
   \ingroup group_imgproc_gamma
 
-  Perform a gamma correction on a color image.
+  Perform a gamma correction on a 16-bit grayscale image.
 
-  \param I1 : The first color image.
-  \param I2 : The second color image after gamma correction.
+  \param I1 : The first 16-bit grayscale image.
+  \param I2 : The second 16-bit grayscale image after gamma correction.
   \param gamma : Gamma value.
 */
-void vp::gammaCorrection(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const double gamma) {
+void vp::gammaCorrection(const vpImage<unsigned short> &I1, vpImage<unsigned short> &I2, const double gamma) {
   I2 = I1;
   vp::gammaCorrection(I2, gamma);
 }
@@ -375,22 +1314,20 @@ void vp::gammaCorrection(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const d
 */
 void vp::stretchContrast(vpImage<unsigned char> &I) {
   //Find min and max intensity values
-  unsigned char min = 255, max = 0;
-  I.getMinMaxValue(min, max);
+  vpImageStatistics statistics(I);
+  vp::stretchContrast(I, statistics);
+}
 
-  unsigned char range = max - min;
+/*!
+  \ingroup group_imgproc_contrast
 
-  //Construct the look-up table
-  unsigned char lut[256];
-  if(range > 0) {
-    for(unsigned int x = min; x <= max; x++) {
-      lut[x] = 255 * (x - min) / range;
-    }
-  } else {
-    lut[min] = min;
-  }
+  Stretch the contrast of a grayscale image, using the already computed min and max intensities of the image.
 
-  I.performLut(lut);
+  \param I : The grayscale image to stretch the contrast.
+  \param statistics : Statistics of the input image.
+*/
+void vp::stretchContrast(vpImage<unsigned char> &I, const vpImageStatistics &statistics) {
+  vp::stretchContrast(I, I, statistics);
 }
 
 /*!
@@ -402,9 +1339,36 @@ void vp::stretchContrast(vpImage<unsigned char> &I) {
   \param I2 : The second output grayscale image.
 */
 void vp::stretchContrast(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2) {
-  //Copy I1 to I2
-  I2 = I1;
-  vp::stretchContrast(I2);
+  //Find min and max intensity values
+  vpImageStatistics statistics(I1);
+  vp::stretchContrast(I1, I2, statistics);
+}
+
+/*!
+  \ingroup group_imgproc_contrast
+
+  Stretch the contrast of a grayscale image, using the already computed min and max intensities of the image.
+
+  \param I1 : The first input grayscale image.
+  \param I2 : The second output grayscale image.
+  \param statistics : Statistics of the first image.
+*/
+void vp::stretchContrast(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const vpImageStatistics &statistics) {
+  if (I1.getSize() == 0) {
+    if (&I1 != &I2) {
+      I2 = I1;
+    }
+    return;
+  }
+
+  checkStatistics(statistics, I1);
+
+  //Construct the look-up table
+  unsigned char lut[256];
+  computeStretchLut(statistics.m_min, statistics.m_max, lut);
+
+  //Write directly I2 from I1
+  vp::simd::performLut(I1, I2, lut);
 }
 
 /*!
@@ -415,33 +1379,24 @@ void vp::stretchContrast(const vpImage<unsigned char> &I1, vpImage<unsigned char
   \param I : The color image to stretch the contrast.
 */
 void vp::stretchContrast(vpImage<vpRGBa> &I) {
-  //Find min and max intensity values
-  vpRGBa min = 255, max = 0;
-
-  //Split the RGBa image into 4 images
-  vpImage<unsigned char> pR(I.getHeight(), I.getWidth());
-  vpImage<unsigned char> pG(I.getHeight(), I.getWidth());
-  vpImage<unsigned char> pB(I.getHeight(), I.getWidth());
-  vpImage<unsigned char> pa(I.getHeight(), I.getWidth());
-
-  vpImageConvert::split(I, &pR, &pG, &pB, &pa);
-  //Min max values calculated for each channel
-  unsigned char minChannel, maxChannel;
-  pR.getMinMaxValue(minChannel, maxChannel);
-  min.R = minChannel;
-  max.R = maxChannel;
+  if (I.getSize() == 0) {
+    return;
+  }
 
-  pG.getMinMaxValue(minChannel, maxChannel);
-  min.G = minChannel;
-  max.G = maxChannel;
+  //Find min and max intensity values for each channel in one interleaved pass, split into chunks
+  vpMinMaxJobs jobs((const unsigned char *) I.bitmap, I.getSize());
+  vp::parallelFor(0, I.getSize(), STATISTICS_GRAIN_SIZE, computeMinMaxRange, &jobs);
 
-  pB.getMinMaxValue(minChannel, maxChannel);
-  min.B = minChannel;
-  max.B = maxChannel;
+  unsigned char minChannels[4] = { 255, 255, 255, 255 }, maxChannels[4] = { 0, 0, 0, 0 };
+  for (size_t chunk = 0; chunk < jobs.m_min.size(); chunk += 4) {
+    for (unsigned int channel = 0; channel < 4; channel++) {
+      minChannels[channel] = std::min(minChannels[channel], jobs.m_min[chunk + channel]);
+      maxChannels[channel] = std::max(maxChannels[channel], jobs.m_max[chunk + channel]);
+    }
+  }
 
-  pa.getMinMaxValue(minChannel, maxChannel);
-  min.A = minChannel;
-  max.A = maxChannel;
+  vpRGBa min(minChannels[0], minChannels[1], minChannels[2], minChannels[3]);
+  vpRGBa max(maxChannels[0], maxChannels[1], maxChannels[2], maxChannels[3]);
 
 
   //Construct the look-up table
@@ -482,7 +1437,7 @@ void vp::stretchContrast(vpImage<vpRGBa> &I) {
     lut[min.A].A = min.A;
   }
 
-  I.performLut(lut);
+  vp::simd::performLut(I, lut);
 }
 
 /*!
@@ -499,6 +1454,53 @@ void vp::stretchContrast(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2) {
   vp::stretchContrast(I2);
 }
 
+/*!
+  \ingroup group_imgproc_contrast
+
+  Stretch the contrast of a 16-bit grayscale image over the full [0 - 65535] range, using a 65536-entry look-up
+  table.
+
+  \param I : The 16-bit grayscale image to stretch the contrast.
+*/
+void vp::stretchContrast(vpImage<unsigned short> &I) {
+  if (I.getSize() == 0) {
+    return;
+  }
+
+  //Find min and max intensity values, split into chunks
+  vpMinMax16Jobs jobs(I.bitmap, I.getSize());
+  vp::parallelFor(0, I.getSize(), STATISTICS_GRAIN_SIZE, computeMinMax16Range, &jobs);
+  unsigned short min = *std::min_element(jobs.m_min.begin(), jobs.m_min.end());
+  unsigned short max = *std::max_element(jobs.m_max.begin(), jobs.m_max.end());
+  unsigned int range = (unsigned int) (max - min);
+
+  //Construct the look-up table
+  std::vector<unsigned short> lut(65536, 0);
+  if(range > 0) {
+    for(unsigned int x = min; x <= max; x++) {
+      lut[x] = (unsigned short) (65535 * (x - min) / range);
+    }
+  } else {
+    lut[min] = min;
+  }
+
+  vp::simd::performLut(I, &lut[0]);
+}
+
+/*!
+  \ingroup group_imgproc_contrast
+
+  Stretch the contrast of a 16-bit grayscale image.
+
+  \param I1 : The first input 16-bit grayscale image.
+  \param I2 : The second output 16-bit grayscale image.
+*/
+void vp::stretchContrast(const vpImage<unsigned short> &I1, vpImage<unsigned short> &I2) {
+  //Copy I1 to I2
+  I2 = I1;
+  vp::stretchContrast(I2);
+}
+
 /*!
   \ingroup group_imgproc_contrast
 
@@ -564,10 +1566,404 @@ void vp::stretchContrastHSV(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2) {
   vp::stretchContrastHSV(I2);
 }
 
+/*!
+  Construct the contrast enhancement of a video stream.
+
+  \param method : Histogram equalization or contrast stretching.
+  \param refreshPeriod : Number of frames between two refreshes of the statistics and of the look-up table,
+  must be at least 1.
+  \param subsampling : Step in pixels, in both directions, of the grid of pixels whose statistics are computed,
+  must be at least 1.
+  \param smoothing : Weight in ]0, 1] of the new statistics in the exponential smoothing, 1 means that only the
+  statistics of the last refreshed frame are used.
+*/
+vp::vpStreamingContrast::vpStreamingContrast(const vpStreamingContrastMethod &method, const unsigned int refreshPeriod,
+                                             const unsigned int subsampling, const double smoothing) :
+  m_method(method), m_refreshPeriod(1), m_subsampling(1), m_smoothing(1.0), m_nbFrames(0), m_initialized(false),
+  m_nbSamples(0.0), m_min(0.0), m_max(0.0) {
+  setRefreshPeriod(refreshPeriod);
+  setSubsampling(subsampling);
+  setSmoothing(smoothing);
+  reset();
+}
+
+/*!
+  Enhance the contrast of a frame of the stream. The statistics and the look-up table are refreshed at the first
+  frame and then every \e refreshPeriod frames, otherwise only the look-up table of the previous frame is applied.
+
+  \param I : The grayscale frame to enhance.
+*/
+void vp::vpStreamingContrast::apply(vpImage<unsigned char> &I) {
+  apply(I, I);
+}
+
+/*!
+  Enhance the contrast of a frame of the stream.
+
+  \param I1 : The grayscale frame.
+  \param I2 : The enhanced grayscale frame.
+*/
+void vp::vpStreamingContrast::apply(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2) {
+  if (I1.getSize() == 0) {
+    if (&I1 != &I2) {
+      I2 = I1;
+    }
+    return;
+  }
+
+  if (!m_initialized || m_nbFrames >= m_refreshPeriod) {
+    updateLut(I1);
+    m_nbFrames = 0;
+  }
+  m_nbFrames++;
+
+  vp::simd::performLut(I1, I2, m_lut);
+}
+
+/*!
+  Forget the statistics of the previous frames, the next frame refreshes the look-up table from its own
+  statistics only.
+*/
+void vp::vpStreamingContrast::reset() {
+  m_nbFrames = 0;
+  m_initialized = false;
+  memset(m_histogram, 0, sizeof(m_histogram));
+  m_nbSamples = 0.0;
+  m_min = m_max = 0.0;
+  for (unsigned int x = 0; x < 256; x++) {
+    m_lut[x] = (unsigned char) x;
+  }
+}
+
+/*!
+  Set the method, the statistics of the previous frames are forgotten.
+
+  \param method : Histogram equalization or contrast stretching.
+*/
+void vp::vpStreamingContrast::setMethod(const vpStreamingContrastMethod &method) {
+  m_method = method;
+  reset();
+}
+
+/*!
+  Set the number of frames between two refreshes of the statistics and of the look-up table.
+
+  \param refreshPeriod : Number of frames, must be at least 1.
+*/
+void vp::vpStreamingContrast::setRefreshPeriod(const unsigned int refreshPeriod) {
+  if (refreshPeriod == 0) {
+    throw vpException(vpException::badValue, "The refresh period must be at least 1 frame");
+  }
+  m_refreshPeriod = refreshPeriod;
+}
+
+/*!
+  Set the weight of the statistics of a refreshed frame in the exponential smoothing.
+
+  \param smoothing : Weight in ]0, 1], 1 means no smoothing.
+*/
+void vp::vpStreamingContrast::setSmoothing(const double smoothing) {
+  if (smoothing <= 0.0 || smoothing > 1.0) {
+    throw vpException(vpException::badValue, "The smoothing factor (%f) must be in ]0, 1]", smoothing);
+  }
+  m_smoothing = smoothing;
+}
+
+/*!
+  Set the step of the grid of pixels whose statistics are computed.
+
+  \param subsampling : Step in pixels in both directions, must be at least 1.
+*/
+void vp::vpStreamingContrast::setSubsampling(const unsigned int subsampling) {
+  if (subsampling == 0) {
+    throw vpException(vpException::badValue, "The subsampling step must be at least 1 pixel");
+  }
+  m_subsampling = subsampling;
+}
+
+/*!
+  Compute the statistics of the subsampled pixel grid, smooth them with the statistics of the previous refreshes
+  and rebuild the look-up table. With a smoothing factor of 1 the look-up table is the one of equalizeHistogram()
+  or stretchContrast() on the pixel grid, also defined for the intensities absent from the grid.
+*/
+void vp::vpStreamingContrast::updateLut(const vpImage<unsigned char> &I) {
+  //Histogram of the pixel grid, centered in the image
+  vpImageStatistics statistics;
+  if (m_subsampling == 1) {
+    statistics.compute(I);
+  } else {
+    const unsigned int step = m_subsampling, offset = m_subsampling / 2;
+    for (unsigned int i = std::min(offset, I.getHeight() - 1); i < I.getHeight(); i += step) {
+      const unsigned char *row = I[i];
+      for (unsigned int j = std::min(offset, I.getWidth() - 1); j < I.getWidth(); j += step) {
+        statistics.m_histogram[row[j]]++;
+        statistics.m_nbPixels++;
+      }
+    }
+
+    statistics.m_min = 255;
+    for (unsigned int x = 0; x < 256; x++) {
+      if (statistics.m_histogram[x] > 0) {
+        statistics.m_min = std::min(statistics.m_min, (unsigned char) x);
+        statistics.m_max = (unsigned char) x;
+      }
+    }
+  }
+
+  //Exponential smoothing, the previous histogram is first scaled to the number of samples of the new one
+  const double nbSamples = statistics.m_nbPixels;
+  if (!m_initialized || m_smoothing == 1.0) {
+    for (unsigned int x = 0; x < 256; x++) {
+      m_histogram[x] = statistics.m_histogram[x];
+    }
+    m_min = statistics.m_min;
+    m_max = statistics.m_max;
+    m_initialized = true;
+  } else {
+    const double scale = (1.0 - m_smoothing) * nbSamples / m_nbSamples;
+    for (unsigned int x = 0; x < 256; x++) {
+      m_histogram[x] = scale * m_histogram[x] + m_smoothing * statistics.m_histogram[x];
+    }
+    m_min = (1.0 - m_smoothing) * m_min + m_smoothing * statistics.m_min;
+    m_max = (1.0 - m_smoothing) * m_max + m_smoothing * statistics.m_max;
+  }
+  m_nbSamples = nbSamples;
+
+  //Construct the look-up table, identity when there is only one brightness value
+  for (unsigned int x = 0; x < 256; x++) {
+    m_lut[x] = (unsigned char) x;
+  }
+
+  if (m_method == STREAMING_EQUALIZE_HISTOGRAM) {
+    double cdf[256];
+    cdf[0] = m_histogram[0];
+    for (unsigned int x = 1; x < 256; x++) {
+      cdf[x] = cdf[x-1] + m_histogram[x];
+    }
+
+    unsigned int minValue = 0;
+    while (minValue < 255 && cdf[minValue] <= 0.0) {
+      minValue++;
+    }
+
+    const double cdfMin = cdf[minValue], cdfMax = cdf[255];
+    if (cdfMax > cdfMin) {
+      for (unsigned int x = 0; x < 256; x++) {
+        m_lut[x] = x < minValue ? 0 : (unsigned char) vpMath::round( (cdf[x]-cdfMin) / (cdfMax-cdfMin) * 255.0 );
+      }
+    }
+  } else {
+    const int min = vpMath::round(m_min), max = vpMath::round(m_max);
+    if (max > min) {
+      for (int x = 0; x < 256; x++) {
+        m_lut[x] = x <= min ? 0 : (x >= max ? 255 : (unsigned char) (255 * (x - min) / (max - min)));
+      }
+    }
+  }
+}
+
+/*!
+  Construct an empty chain, whose look-up table is the identity.
+*/
+vp::vpLutPipeline::vpLutPipeline() : m_stages(), m_thresholds() {
+  clear();
+}
+
+/*!
+  Append a vp::adjust() stage.
+
+  \param alpha : Multiplication coefficient.
+  \param beta : Constant value added to the old intensity.
+  \return The chain, to append the next stage.
+*/
+vp::vpLutPipeline &vp::vpLutPipeline::adjust(const double alpha, const double beta) {
+  computeAdjustLut(alpha, beta, addStage(STAGE_LUT).m_stages.back().m_lut);
+  return *this;
+}
+
+/*!
+  Append a vp::autoThreshold() stage, the threshold is computed from the histogram of the output of the previous
+  stages.
+
+  \param method : Automatic thresholding method.
+  \param backgroundValue : Value to set to the background.
+  \param foregroundValue : Value to set to the foreground.
+  \return The chain, to append the next stage.
+*/
+vp::vpLutPipeline &vp::vpLutPipeline::autoThreshold(const vpAutoThresholdMethod &method, const unsigned char backgroundValue,
+                                                    const unsigned char foregroundValue) {
+  vpStage &stage = addStage(STAGE_AUTO_THRESHOLD).m_stages.back();
+  stage.m_method = method;
+  stage.m_backgroundValue = backgroundValue;
+  stage.m_foregroundValue = foregroundValue;
+  return *this;
+}
+
+/*!
+  Append a vp::binarise() stage with a fixed threshold.
+
+  \param threshold : The intensities below the threshold are set to the background value, the other intensities
+  to the foreground value.
+  \param backgroundValue : Value to set to the background.
+  \param foregroundValue : Value to set to the foreground.
+  \return The chain, to append the next stage.
+*/
+vp::vpLutPipeline &vp::vpLutPipeline::binarise(const unsigned char threshold, const unsigned char backgroundValue,
+                                               const unsigned char foregroundValue) {
+  unsigned char *lut = addStage(STAGE_LUT).m_stages.back().m_lut;
+  for (unsigned int x = 0; x < 256; x++) {
+    lut[x] = x < threshold ? backgroundValue : foregroundValue;
+  }
+  return *this;
+}
+
+/*!
+  Append a vp::equalizeHistogram() stage, the equalization is computed from the histogram of the output of the
+  previous stages.
+
+  \return The chain, to append the next stage.
+*/
+vp::vpLutPipeline &vp::vpLutPipeline::equalizeHistogram() {
+  return addStage(STAGE_EQUALIZE_HISTOGRAM);
+}
+
+/*!
+  Append a vp::gammaCorrection() stage.
+
+  \param gamma : Gamma value, must be positive.
+  \return The chain, to append the next stage.
+*/
+vp::vpLutPipeline &vp::vpLutPipeline::gammaCorrection(const double gamma) {
+  unsigned char lut[256];
+  computeGammaLut(gamma, lut);
+  return performLut(lut);
+}
+
+/*!
+  Append a stage applying a user defined look-up table.
+
+  \param lut : Look-up table mapping for each intensity the new corresponding value.
+  \return The chain, to append the next stage.
+*/
+vp::vpLutPipeline &vp::vpLutPipeline::performLut(const unsigned char (&lut)[256]) {
+  memcpy(addStage(STAGE_LUT).m_stages.back().m_lut, lut, sizeof(lut));
+  return *this;
+}
+
+/*!
+  Append a vp::stretchContrast() stage, the min and max intensities are the ones of the output of the previous
+  stages.
+
+  \return The chain, to append the next stage.
+*/
+vp::vpLutPipeline &vp::vpLutPipeline::stretchContrast() {
+  return addStage(STAGE_STRETCH_CONTRAST);
+}
+
+/*!
+  Apply the chain in place.
+
+  \param I : The grayscale image to process.
+*/
+void vp::vpLutPipeline::apply(vpImage<unsigned char> &I) {
+  apply(I, I);
+}
+
+/*!
+  Apply the chain, the result gets the value of the successive functions applied to I1 but the image is read
+  at most twice: once for the statistics when there is a histogram-based stage, once for the look-up table that
+  writes directly I2.
+
+  \param I1 : The grayscale image to process.
+  \param I2 : The processed grayscale image, can be I1.
+*/
+void vp::vpLutPipeline::apply(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2) {
+  for (unsigned int x = 0; x < 256; x++) {
+    m_lut[x] = (unsigned char) x;
+  }
+  m_thresholds.clear();
+
+  bool histogramBased = false;
+  for (size_t i = 0; i < m_stages.size(); i++) {
+    histogramBased = histogramBased || m_stages[i].m_type != STAGE_LUT;
+  }
+
+  vpImageStatistics source, statistics;
+  if (histogramBased) {
+    source.compute(I1);
+  }
+
+  for (size_t i = 0; i < m_stages.size(); i++) {
+    const vpStage &stage = m_stages[i];
+    unsigned char lut[256];
+    if (stage.m_type == STAGE_LUT) {
+      memcpy(lut, stage.m_lut, sizeof(lut));
+    } else {
+      //Statistics of the output of the previous stages, identity look-up table when the stage is a no-op
+      transformStatistics(source, m_lut, statistics);
+      for (unsigned int x = 0; x < 256; x++) {
+        lut[x] = (unsigned char) x;
+      }
+
+      if (statistics.m_nbPixels > 0) {
+        if (stage.m_type == STAGE_EQUALIZE_HISTOGRAM) {
+          computeEqualizationLut(statistics.m_histogram, statistics.m_nbPixels, lut);
+        } else if (stage.m_type == STAGE_STRETCH_CONTRAST) {
+          computeStretchLut(statistics.m_min, statistics.m_max, lut);
+        }
+      }
+
+      if (stage.m_type == STAGE_AUTO_THRESHOLD) {
+        int threshold = vp::computeAutoThreshold(statistics, stage.m_method);
+        m_thresholds.push_back(threshold);
+        if (threshold != -1) {
+          for (int x = 0; x < 256; x++) {
+            lut[x] = x < threshold ? stage.m_backgroundValue : stage.m_foregroundValue;
+          }
+        }
+      }
+    }
+
+    //Compose with the previous stages
+    for (unsigned int x = 0; x < 256; x++) {
+      m_lut[x] = lut[m_lut[x]];
+    }
+  }
+
+  vp::simd::performLut(I1, I2, m_lut);
+}
+
+/*!
+  Remove all the stages.
+*/
+void vp::vpLutPipeline::clear() {
+  m_stages.clear();
+  m_thresholds.clear();
+  for (unsigned int x = 0; x < 256; x++) {
+    m_lut[x] = (unsigned char) x;
+  }
+}
+
+vp::vpLutPipeline &vp::vpLutPipeline::addStage(const vpStageType &type) {
+  vpStage stage;
+  stage.m_type = type;
+  stage.m_method = AUTO_THRESHOLD_OTSU;
+  stage.m_backgroundValue = 0;
+  stage.m_foregroundValue = 255;
+  for (unsigned int x = 0; x < 256; x++) {
+    stage.m_lut[x] = (unsigned char) x;
+  }
+  m_stages.push_back(stage);
+
+  return *this;
+}
+
 /*!
   \ingroup group_imgproc_sharpening
 
   Sharpen a grayscale image using the unsharp mask technique.
+  Large images are split into horizontal strips sharpened concurrently with the number of threads set with
+  setNbThreads().
 
   \param I : The grayscale image to sharpen.
   \param size : Size (must be odd) of the Gaussian blur kernel.
@@ -575,15 +1971,7 @@ void vp::stretchContrastHSV(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2) {
  */
 void vp::unsharpMask(vpImage<unsigned char> &I, const unsigned int size, const double weight) {
   if(weight < 1.0 && weight >= 0.0) {
-    //Gaussian blurred image
-    vpImage<double> I_blurred;
-    vpImageFilter::gaussianBlur(I, I_blurred, size);
-
-    //Unsharp mask
-    for(unsigned int cpt = 0; cpt < I.getSize(); cpt++) {
-      double val = (I.bitmap[cpt] - weight*I_blurred.bitmap[cpt]) / (1 - weight);
-      I.bitmap[cpt] = vpMath::saturate<unsigned char>(val); //val > 255 ? 255 : (val < 0 ? 0 : val);
-    }
+    unsharpMaskInterleaved<1>(I.bitmap, I.getWidth(), I.getHeight(), size, weight);
   }
 }
 
@@ -607,6 +1995,8 @@ void vp::unsharpMask(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I
   \ingroup group_imgproc_sharpening
 
   Sharpen a color image using the unsharp mask technique.
+  Large images are split into horizontal strips sharpened concurrently with the number of threads set with
+  setNbThreads().
 
   \param I : The color image to sharpen.
   \param size : Size (must be odd) of the Gaussian blur kernel.
@@ -614,25 +2004,8 @@ void vp::unsharpMask(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I
  */
 void vp::unsharpMask(vpImage<vpRGBa> &I, const unsigned int size, const double weight) {
   if(weight < 1.0 && weight >= 0.0) {
-    //Gaussian blurred image
-    vpImage<double> I_blurred_R,  I_blurred_G,  I_blurred_B;
-    vpImage<unsigned char> I_R, I_G, I_B;
-
-    vpImageConvert::split(I, &I_R, &I_G, &I_B);
-    vpImageFilter::gaussianBlur(I_R, I_blurred_R, size);
-    vpImageFilter::gaussianBlur(I_G, I_blurred_G, size);
-    vpImageFilter::gaussianBlur(I_B, I_blurred_B, size);
-
-    //Unsharp mask
-    for(unsigned int cpt = 0; cpt < I.getSize(); cpt++) {
-      double val_R = (I.bitmap[cpt].R - weight*I_blurred_R.bitmap[cpt]) / (1 - weight);
-      double val_G = (I.bitmap[cpt].G - weight*I_blurred_G.bitmap[cpt]) / (1 - weight);
-      double val_B = (I.bitmap[cpt].B - weight*I_blurred_B.bitmap[cpt]) / (1 - weight);
-
-      I.bitmap[cpt].R = vpMath::saturate<unsigned char>(val_R);
-      I.bitmap[cpt].G = vpMath::saturate<unsigned char>(val_G);
-      I.bitmap[cpt].B = vpMath::saturate<unsigned char>(val_B);
-    }
+    //The R, G, B channels are blurred in the same sweep over the interleaved data
+    unsharpMaskInterleaved<4>(reinterpret_cast<unsigned char *>(I.bitmap), I.getWidth(), I.getHeight(), size, weight);
   }
 }
 
@@ -651,3 +2024,42 @@ void vp::unsharpMask(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const unsig
   I2 = I1;
   vp::unsharpMask(I2, size, weight);
 }
+
+/*!
+  \ingroup group_imgproc_sharpening
+
+  Sharpen a grayscale image larger than the memory using the unsharp mask technique. The image is processed by
+  tiles read with a halo of the radius of the Gaussian blur, the result is the one of
+  unsharpMask(vpImage<unsigned char> &, const unsigned int, const double) and the memory is bounded by the size
+  of a tile.
+
+  \param reader : Blocks of the input grayscale image.
+  \param writer : Blocks of the sharpened grayscale image.
+  \param size : Size (must be odd) of the Gaussian blur kernel.
+  \param weight : Weight (between [0 - 1[) for the sharpening process.
+  \param tileSize : Size in pixels of the square tiles.
+*/
+void vp::unsharpMask(vpBlockReader<unsigned char> &reader, vpBlockWriter<unsigned char> &writer, const unsigned int size,
+                     const double weight, const unsigned int tileSize) {
+  //The halo is the radius of the Gaussian kernel
+  vpUnsharpTileOperation<unsigned char, 1> operation(size, weight);
+  vp::tiles::processTiles(reader, &writer, tileSize, size / 2, operation);
+}
+
+/*!
+  \ingroup group_imgproc_sharpening
+
+  Sharpen a color image larger than the memory using the unsharp mask technique, see
+  unsharpMask(vpBlockReader<unsigned char> &, vpBlockWriter<unsigned char> &, const unsigned int, const double, const unsigned int).
+
+  \param reader : Blocks of the input color image.
+  \param writer : Blocks of the sharpened color image.
+  \param size : Size (must be odd) of the Gaussian blur kernel.
+  \param weight : Weight (between [0 - 1[) for the sharpening process.
+  \param tileSize : Size in pixels of the square tiles.
+*/
+void vp::unsharpMask(vpBlockReader<vpRGBa> &reader, vpBlockWriter<vpRGBa> &writer, const unsigned int size,
+                     const double weight, const unsigned int tileSize) {
+  vpUnsharpTileOperation<vpRGBa, 4> operation(size, weight);
+  vp::tiles::processTiles(reader, &writer, tileSize, size / 2, operation);
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Border handling of the image filters.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImgprocBorder.h
+  \brief Border handling shared by the image filters of the module (private header).
+*/
+
+#ifndef __vpImgprocBorder_h__
+#define __vpImgprocBorder_h__
+
+#include <algorithm>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+namespace vp {
+  namespace border {
+    /*!
+      Mirror an index the same way as the border functions of vpImageFilter (filterX(), filterY()): no repetition
+      of the first element on the left / top border, repetition of the last element on the right / bottom border.
+    */
+    inline int mirrorIndex(int index, const int size) {
+      if (index < 0) {
+        index = -index;
+      }
+      if (index >= size) {
+        index = 2*size - index - 1;
+      }
+
+      return std::max(0, std::min(index, size - 1));
+    }
+  }
+}
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif
@@ -0,0 +1,530 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * SIMD kernels for the image processing module.
+ *
+ * The kernels are selected once at runtime from the instruction sets
+ * supported by the CPU (AVX-512 VBMI, AVX2 on x86, NEON on AArch64) and
+ * always fall back to a scalar implementation.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImgprocSimd.cpp
+  \brief Vectorized kernels with runtime CPU dispatch.
+*/
+
+#include <cstring>
+#include <vector>
+
+#include <visp3/imgproc/vpImgproc.h>
+#include <visp3/imgproc/vpParallel.h>
+
+#include "vpImgprocSimd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+  ( (defined(__clang__) && (__clang_major__ >= 5)) || (!defined(__clang__) && defined(__GNUC__) && (__GNUC__ >= 6)) )
+#  define VP_IMGPROC_HAVE_X86_DISPATCH
+#  include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  define VP_IMGPROC_HAVE_NEON
+#  include <arm_neon.h>
+#endif
+
+
+namespace {
+  bool isSimdKernelSupported(const vp::vpSimdKernel &kernel) {
+    switch (kernel) {
+    case vp::SIMD_KERNEL_SCALAR:
+      return true;
+
+#if defined(VP_IMGPROC_HAVE_X86_DISPATCH)
+    case vp::SIMD_KERNEL_AVX2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") != 0;
+
+    case vp::SIMD_KERNEL_AVX512VBMI:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vbmi");
+#endif
+
+#if defined(VP_IMGPROC_HAVE_NEON)
+    case vp::SIMD_KERNEL_NEON:
+      return true;
+#endif
+
+    default:
+      return false;
+    }
+  }
+
+  vp::vpSimdKernel detectSimdLevel() {
+    const vp::vpSimdKernel kernels[3] = { vp::SIMD_KERNEL_AVX512VBMI, vp::SIMD_KERNEL_AVX2, vp::SIMD_KERNEL_NEON };
+    for (unsigned int k = 0; k < 3; k++) {
+      if (isSimdKernelSupported(kernels[k])) {
+        return kernels[k];
+      }
+    }
+    return vp::SIMD_KERNEL_SCALAR;
+  }
+
+  //Kernel forced by vp::setSimdKernel(), SIMD_KERNEL_AUTO for the detected one
+  vp::vpSimdKernel g_simdKernel = vp::SIMD_KERNEL_AUTO;
+
+  vp::vpSimdKernel getSimdLevel() {
+    static const vp::vpSimdKernel level = detectSimdLevel();
+    return g_simdKernel == vp::SIMD_KERNEL_AUTO ? level : g_simdKernel;
+  }
+
+  /*
+    The kernels read the pixels from src and write them to dst, src and dst are either the same buffer (in place
+    look-up) or two buffers that do not overlap.
+  */
+  void performLutScalar(const unsigned char *src, unsigned char *dst, const unsigned int size, const unsigned char *lut) {
+    unsigned int i = 0;
+    //Unrolled to break the load / store dependency between consecutive pixels
+    for (; i + 4 <= size; i += 4) {
+      unsigned char v0 = lut[src[i]];
+      unsigned char v1 = lut[src[i+1]];
+      unsigned char v2 = lut[src[i+2]];
+      unsigned char v3 = lut[src[i+3]];
+      dst[i] = v0;
+      dst[i+1] = v1;
+      dst[i+2] = v2;
+      dst[i+3] = v3;
+    }
+
+    for (; i < size; i++) {
+      dst[i] = lut[src[i]];
+    }
+  }
+
+  void performLutScalar(const vpRGBa *src, vpRGBa *dst, const unsigned int size, const vpRGBa *lut) {
+    for (unsigned int i = 0; i < size; i++) {
+      const vpRGBa p = src[i];
+      dst[i].R = lut[p.R].R;
+      dst[i].G = lut[p.G].G;
+      dst[i].B = lut[p.B].B;
+      dst[i].A = lut[p.A].A;
+    }
+  }
+
+  void performLutScalar(const unsigned short *src, unsigned short *dst, const unsigned int size, const unsigned short *lut) {
+    unsigned int i = 0;
+    for (; i + 4 <= size; i += 4) {
+      unsigned short v0 = lut[src[i]];
+      unsigned short v1 = lut[src[i+1]];
+      unsigned short v2 = lut[src[i+2]];
+      unsigned short v3 = lut[src[i+3]];
+      dst[i] = v0;
+      dst[i+1] = v1;
+      dst[i+2] = v2;
+      dst[i+3] = v3;
+    }
+
+    for (; i < size; i++) {
+      dst[i] = lut[src[i]];
+    }
+  }
+
+#if defined(VP_IMGPROC_HAVE_X86_DISPATCH)
+  /*
+    AVX2 has no 256-entry byte shuffle: the table is split in 16 sub-tables of
+    16 entries and each one is looked up with vpshufb. Biasing the index by
+    0x70 with unsigned saturation sets the most significant bit (output 0)
+    for every lane that does not belong to the current sub-table.
+  */
+  __attribute__((target("avx2")))
+  void performLutAvx2(const unsigned char *src, unsigned char *dst, const unsigned int size, const unsigned char *lut) {
+    __m256i tables[16];
+    for (int t = 0; t < 16; t++) {
+      tables[t] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lut + 16*t)));
+    }
+    const __m256i step = _mm256_set1_epi8(16);
+    const __m256i bias = _mm256_set1_epi8(0x70);
+
+    unsigned int i = 0;
+    for (; i + 64 <= size; i += 64) {
+      __m256i idx0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+      __m256i idx1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 32));
+      __m256i res0 = _mm256_setzero_si256();
+      __m256i res1 = _mm256_setzero_si256();
+
+      for (int t = 0; t < 16; t++) {
+        res0 = _mm256_or_si256(res0, _mm256_shuffle_epi8(tables[t], _mm256_adds_epu8(idx0, bias)));
+        res1 = _mm256_or_si256(res1, _mm256_shuffle_epi8(tables[t], _mm256_adds_epu8(idx1, bias)));
+        idx0 = _mm256_sub_epi8(idx0, step);
+        idx1 = _mm256_sub_epi8(idx1, step);
+      }
+
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), res0);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 32), res1);
+    }
+
+    //Clear the upper part of the vector registers, otherwise the SSE code running after these kernels is slowed down
+    _mm256_zeroupper();
+    performLutScalar(src + i, dst + i, size - i, lut);
+  }
+
+  /*
+    Interleaved RGBa: one 32-bit gather per channel from a table holding the
+    channel value already shifted at its position in the pixel.
+  */
+  __attribute__((target("avx2")))
+  void performLutAvx2(const vpRGBa *src, vpRGBa *dst, const unsigned int size, const vpRGBa *lut) {
+    int tables[4][256];
+    for (unsigned int k = 0; k < 256; k++) {
+      tables[0][k] = (int) lut[k].R;
+      tables[1][k] = (int) ((unsigned int) lut[k].G << 8);
+      tables[2][k] = (int) ((unsigned int) lut[k].B << 16);
+      tables[3][k] = (int) ((unsigned int) lut[k].A << 24);
+    }
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+
+    unsigned int i = 0;
+    for (; i + 8 <= size; i += 8) {
+      __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+      __m256i res = _mm256_i32gather_epi32(tables[0], _mm256_and_si256(p, mask), 4);
+      res = _mm256_or_si256(res, _mm256_i32gather_epi32(tables[1], _mm256_and_si256(_mm256_srli_epi32(p, 8), mask), 4));
+      res = _mm256_or_si256(res, _mm256_i32gather_epi32(tables[2], _mm256_and_si256(_mm256_srli_epi32(p, 16), mask), 4));
+      res = _mm256_or_si256(res, _mm256_i32gather_epi32(tables[3], _mm256_srli_epi32(p, 24), 4));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), res);
+    }
+
+    _mm256_zeroupper();
+    performLutScalar(src + i, dst + i, size - i, lut);
+  }
+
+  /*
+    AVX-512 VBMI: vpermi2b looks up 128 entries at once, the most significant
+    bit of the index selects between the two halves of the table.
+  */
+  __attribute__((target("avx512f,avx512bw,avx512vbmi")))
+  void performLutAvx512(const unsigned char *src, unsigned char *dst, const unsigned int size, const unsigned char *lut) {
+    const __m512i t0 = _mm512_loadu_si512(lut);
+    const __m512i t1 = _mm512_loadu_si512(lut + 64);
+    const __m512i t2 = _mm512_loadu_si512(lut + 128);
+    const __m512i t3 = _mm512_loadu_si512(lut + 192);
+
+    unsigned int i = 0;
+    for (; i + 64 <= size; i += 64) {
+      __m512i idx = _mm512_loadu_si512(src + i);
+      __m512i low = _mm512_permutex2var_epi8(t0, idx, t1);
+      __m512i high = _mm512_permutex2var_epi8(t2, idx, t3);
+      _mm512_storeu_si512(dst + i, _mm512_mask_blend_epi8(_mm512_movepi8_mask(idx), low, high));
+    }
+
+    _mm256_zeroupper();
+    performLutScalar(src + i, dst + i, size - i, lut);
+  }
+
+  __attribute__((target("avx512f,avx512bw,avx512vbmi")))
+  void performLutAvx512(const vpRGBa *src, vpRGBa *dst, const unsigned int size, const vpRGBa *lut) {
+    unsigned char planes[4][256];
+    for (unsigned int k = 0; k < 256; k++) {
+      planes[0][k] = lut[k].R;
+      planes[1][k] = lut[k].G;
+      planes[2][k] = lut[k].B;
+      planes[3][k] = lut[k].A;
+    }
+
+    __m512i tables[4][4];
+    for (int c = 0; c < 4; c++) {
+      for (int t = 0; t < 4; t++) {
+        tables[c][t] = _mm512_loadu_si512(planes[c] + 64*t);
+      }
+    }
+    //Byte lanes of each channel in the interleaved RGBa layout
+    const __mmask64 channels[4] = { 0x1111111111111111ULL, 0x2222222222222222ULL,
+                                    0x4444444444444444ULL, 0x8888888888888888ULL };
+
+    const unsigned char *srcData = reinterpret_cast<const unsigned char *>(src);
+    unsigned char *dstData = reinterpret_cast<unsigned char *>(dst);
+    unsigned int i = 0;
+    for (; i + 16 <= size; i += 16) {
+      __m512i idx = _mm512_loadu_si512(srcData + 4*i);
+      __mmask64 high = _mm512_movepi8_mask(idx);
+      __m512i res = idx;
+
+      for (int c = 0; c < 4; c++) {
+        res = _mm512_mask_blend_epi8(channels[c] & ~high, res, _mm512_permutex2var_epi8(tables[c][0], idx, tables[c][1]));
+        res = _mm512_mask_blend_epi8(channels[c] & high, res, _mm512_permutex2var_epi8(tables[c][2], idx, tables[c][3]));
+      }
+
+      _mm512_storeu_si512(dstData + 4*i, res);
+    }
+
+    _mm256_zeroupper();
+    performLutScalar(src + i, dst + i, size - i, lut);
+  }
+#endif
+
+#if defined(VP_IMGPROC_HAVE_NEON)
+  inline uint8x16_t lookupNeon(const uint8x16x4_t (&tables)[4], uint8x16_t idx) {
+    //Out of range indexes leave the lane untouched with vqtbx
+    const uint8x16_t step = vdupq_n_u8(64);
+    uint8x16_t res = vqtbl4q_u8(tables[0], idx);
+    idx = vsubq_u8(idx, step);
+    res = vqtbx4q_u8(res, tables[1], idx);
+    idx = vsubq_u8(idx, step);
+    res = vqtbx4q_u8(res, tables[2], idx);
+    idx = vsubq_u8(idx, step);
+    return vqtbx4q_u8(res, tables[3], idx);
+  }
+
+  void loadTablesNeon(const unsigned char *lut, uint8x16x4_t (&tables)[4]) {
+    for (int t = 0; t < 4; t++) {
+      for (int k = 0; k < 4; k++) {
+        tables[t].val[k] = vld1q_u8(lut + 64*t + 16*k);
+      }
+    }
+  }
+
+  void performLutNeon(const unsigned char *src, unsigned char *dst, const unsigned int size, const unsigned char *lut) {
+    uint8x16x4_t tables[4];
+    loadTablesNeon(lut, tables);
+
+    unsigned int i = 0;
+    for (; i + 16 <= size; i += 16) {
+      vst1q_u8(dst + i, lookupNeon(tables, vld1q_u8(src + i)));
+    }
+
+    performLutScalar(src + i, dst + i, size - i, lut);
+  }
+
+  void performLutNeon(const vpRGBa *src, vpRGBa *dst, const unsigned int size, const vpRGBa *lut) {
+    unsigned char planes[4][256];
+    for (unsigned int k = 0; k < 256; k++) {
+      planes[0][k] = lut[k].R;
+      planes[1][k] = lut[k].G;
+      planes[2][k] = lut[k].B;
+      planes[3][k] = lut[k].A;
+    }
+
+    uint8x16x4_t tables[4][4];
+    for (int c = 0; c < 4; c++) {
+      loadTablesNeon(planes[c], tables[c]);
+    }
+
+    const unsigned char *srcData = reinterpret_cast<const unsigned char *>(src);
+    unsigned char *dstData = reinterpret_cast<unsigned char *>(dst);
+    unsigned int i = 0;
+    for (; i + 16 <= size; i += 16) {
+      //vld4 de-interleaves the R, G, B and A planes
+      uint8x16x4_t p = vld4q_u8(srcData + 4*i);
+      for (int c = 0; c < 4; c++) {
+        p.val[c] = lookupNeon(tables[c], p.val[c]);
+      }
+      vst4q_u8(dstData + 4*i, p);
+    }
+
+    performLutScalar(src + i, dst + i, size - i, lut);
+  }
+#endif
+
+  //Number of bytes per job of the parallel look-up, large enough to amortize the scheduling of a job
+  const unsigned int LUT_GRAIN_SIZE = 1 << 16;
+
+  void performLutKernel(const unsigned char *src, unsigned char *dst, const unsigned int size, const unsigned char *lut) {
+    switch (getSimdLevel()) {
+#if defined(VP_IMGPROC_HAVE_X86_DISPATCH)
+    case vp::SIMD_KERNEL_AVX512VBMI:
+      performLutAvx512(src, dst, size, lut);
+      break;
+
+    case vp::SIMD_KERNEL_AVX2:
+      performLutAvx2(src, dst, size, lut);
+      break;
+#endif
+
+#if defined(VP_IMGPROC_HAVE_NEON)
+    case vp::SIMD_KERNEL_NEON:
+      performLutNeon(src, dst, size, lut);
+      break;
+#endif
+
+    default:
+      performLutScalar(src, dst, size, lut);
+      break;
+    }
+  }
+
+  void performLutKernel(const vpRGBa *src, vpRGBa *dst, const unsigned int size, const vpRGBa *lut) {
+    switch (getSimdLevel()) {
+#if defined(VP_IMGPROC_HAVE_X86_DISPATCH)
+    case vp::SIMD_KERNEL_AVX512VBMI:
+      performLutAvx512(src, dst, size, lut);
+      break;
+
+    case vp::SIMD_KERNEL_AVX2:
+      performLutAvx2(src, dst, size, lut);
+      break;
+#endif
+
+#if defined(VP_IMGPROC_HAVE_NEON)
+    case vp::SIMD_KERNEL_NEON:
+      performLutNeon(src, dst, size, lut);
+      break;
+#endif
+
+    default:
+      performLutScalar(src, dst, size, lut);
+      break;
+    }
+  }
+
+  void performLutKernel(const unsigned short *src, unsigned short *dst, const unsigned int size, const unsigned short *lut) {
+    performLutScalar(src, dst, size, lut);
+  }
+
+  template <class Type>
+  struct vpLutJobs {
+    const Type *m_src;
+    Type *m_dst;
+    const Type *m_lut;
+
+    vpLutJobs(const Type *src, Type *dst, const Type *lut) : m_src(src), m_dst(dst), m_lut(lut) {
+    }
+  };
+
+  template <class Type>
+  void performLutRange(void *data, const unsigned int begin, const unsigned int end) {
+    const vpLutJobs<Type> &jobs = *((const vpLutJobs<Type> *) data);
+    performLutKernel(jobs.m_src + begin, jobs.m_dst + begin, end - begin, jobs.m_lut);
+  }
+
+  //Number of pixels per job of the 16-bit histogram, each job fills its own histogram
+  const unsigned int HISTOGRAM_GRAIN_SIZE = 1 << 18;
+
+  struct vpHistogramJobs {
+    const unsigned short *m_bitmap;
+    unsigned int m_size;
+    unsigned int m_nbBins;
+    unsigned int m_nbJobs;
+    std::vector<unsigned int> m_histograms;
+
+    vpHistogramJobs(const unsigned short *bitmap, const unsigned int size, const unsigned int nbBins,
+                    const unsigned int nbJobs) :
+      m_bitmap(bitmap), m_size(size), m_nbBins(nbBins), m_nbJobs(nbJobs), m_histograms((size_t) nbBins * nbJobs, 0) {
+    }
+  };
+
+  void computeHistogramKernel(const unsigned short *bitmap, const unsigned int size, const unsigned int nbBins,
+                              unsigned int *histogram) {
+    if (nbBins == 65536) {
+      for (unsigned int i = 0; i < size; i++) {
+        histogram[bitmap[i]]++;
+      }
+    } else {
+      for (unsigned int i = 0; i < size; i++) {
+        histogram[(bitmap[i] * nbBins) >> 16]++;
+      }
+    }
+  }
+
+  void computeHistogramJob(void *data, const unsigned int job) {
+    vpHistogramJobs &jobs = *((vpHistogramJobs *) data);
+    const unsigned int begin = (unsigned int) ((unsigned long long) jobs.m_size * job / jobs.m_nbJobs);
+    const unsigned int end = (unsigned int) ((unsigned long long) jobs.m_size * (job + 1) / jobs.m_nbJobs);
+    computeHistogramKernel(jobs.m_bitmap + begin, end - begin, jobs.m_nbBins,
+                           &jobs.m_histograms[(size_t) jobs.m_nbBins * job]);
+  }
+}
+
+bool vp::setSimdKernel(const vpSimdKernel &kernel) {
+  if (kernel != SIMD_KERNEL_AUTO && !isSimdKernelSupported(kernel)) {
+    return false;
+  }
+  g_simdKernel = kernel;
+  return true;
+}
+
+vp::vpSimdKernel vp::getSimdKernel() {
+  return getSimdLevel();
+}
+
+void vp::simd::performLut(unsigned char *bitmap, const unsigned int size, const unsigned char (&lut)[256]) {
+  vp::simd::performLut(bitmap, bitmap, size, lut);
+}
+
+void vp::simd::performLut(const unsigned char *src, unsigned char *dst, const unsigned int size,
+                          const unsigned char (&lut)[256]) {
+  //The chunks are multiples of 64 bytes, the vector kernels keep the alignment of the image
+  vpLutJobs<unsigned char> jobs(src, dst, lut);
+  vp::parallelFor(0, size, LUT_GRAIN_SIZE, performLutRange<unsigned char>, &jobs);
+}
+
+void vp::simd::performLut(vpRGBa *bitmap, const unsigned int size, const vpRGBa (&lut)[256]) {
+  //When the four channels share the same table (adjust, gammaCorrection, ...)
+  //the image is processed as a plain array of bytes
+  bool sameTable = true;
+  unsigned char lutGray[256];
+  for (unsigned int k = 0; k < 256 && sameTable; k++) {
+    lutGray[k] = lut[k].R;
+    sameTable = lut[k].G == lut[k].R && lut[k].B == lut[k].R && lut[k].A == lut[k].R;
+  }
+
+  if (sameTable) {
+    vp::simd::performLut(reinterpret_cast<unsigned char *>(bitmap), 4*size, lutGray);
+    return;
+  }
+
+  vpLutJobs<vpRGBa> jobs(bitmap, bitmap, lut);
+  vp::parallelFor(0, size, LUT_GRAIN_SIZE / 4, performLutRange<vpRGBa>, &jobs);
+}
+
+void vp::simd::performLut(unsigned short *bitmap, const unsigned int size, const unsigned short *lut) {
+  vpLutJobs<unsigned short> jobs(bitmap, bitmap, lut);
+  vp::parallelFor(0, size, LUT_GRAIN_SIZE / 2, performLutRange<unsigned short>, &jobs);
+}
+
+void vp::simd::computeHistogram(const unsigned short *bitmap, const unsigned int size, const unsigned int nbBins,
+                                unsigned int *histogram) {
+  memset(histogram, 0, nbBins * sizeof(unsigned int));
+
+  //The counts are exact whatever the split, one job per worker bounds the memory of the partial histograms
+  const unsigned int nbJobs = vp::getNbWorkers((size + HISTOGRAM_GRAIN_SIZE - 1) / HISTOGRAM_GRAIN_SIZE);
+  if (nbJobs <= 1) {
+    computeHistogramKernel(bitmap, size, nbBins, histogram);
+    return;
+  }
+
+  vpHistogramJobs jobs(bitmap, size, nbBins, nbJobs);
+  vp::parallelRun(nbJobs, computeHistogramJob, &jobs);
+  for (unsigned int job = 0; job < nbJobs; job++) {
+    const unsigned int *ptr = &jobs.m_histograms[(size_t) nbBins * job];
+    for (unsigned int i = 0; i < nbBins; i++) {
+      histogram[i] += ptr[i];
+    }
+  }
+}
@@ -0,0 +1,115 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * SIMD kernels for the image processing module.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImgprocSimd.h
+  \brief Vectorized kernels with runtime CPU dispatch (private header).
+*/
+
+#ifndef __vpImgprocSimd_h__
+#define __vpImgprocSimd_h__
+
+#include <visp3/core/vpImage.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+namespace vp {
+  namespace simd {
+    /*!
+      Apply a 256-entry look-up table in place using the fastest kernel
+      available on the running CPU. The result is bit-exact with
+      vpImage<unsigned char>::performLut(), large images are split into chunks
+      processed with vp::parallelFor().
+    */
+    void performLut(unsigned char *bitmap, const unsigned int size, const unsigned char (&lut)[256]);
+
+    /*!
+      Apply a 256-entry look-up table from src to dst, which either do not
+      overlap or are the same buffer. Writing directly the destination avoids
+      the copy of the source image before an in place look-up.
+    */
+    void performLut(const unsigned char *src, unsigned char *dst, const unsigned int size,
+                    const unsigned char (&lut)[256]);
+
+    /*!
+      Apply a per-channel 256-entry look-up table in place using the fastest
+      kernel available on the running CPU. The result is bit-exact with
+      vpImage<vpRGBa>::performLut(), large images are split into chunks
+      processed with vp::parallelFor().
+    */
+    void performLut(vpRGBa *bitmap, const unsigned int size, const vpRGBa (&lut)[256]);
+
+    /*!
+      Apply a 65536-entry look-up table in place, large images are split into
+      chunks processed with vp::parallelFor(). No vector gather is used: on
+      16-bit indices it is not faster than the scalar loads.
+    */
+    void performLut(unsigned short *bitmap, const unsigned int size, const unsigned short *lut);
+
+    /*!
+      Compute the histogram of 16-bit intensities with nbBins bins, the
+      intensity v falls into the bin (v * nbBins) >> 16. The histogram is
+      overwritten, the image is split between the threads of the module with
+      one histogram per thread.
+    */
+    void computeHistogram(const unsigned short *bitmap, const unsigned int size, const unsigned int nbBins,
+                          unsigned int *histogram);
+
+    inline void performLut(vpImage<unsigned char> &I, const unsigned char (&lut)[256]) {
+      performLut(I.bitmap, I.getSize(), lut);
+    }
+
+    inline void performLut(const vpImage<unsigned char> &I1, vpImage<unsigned char> &I2, const unsigned char (&lut)[256]) {
+      if (&I1 != &I2) {
+        I2.resize(I1.getHeight(), I1.getWidth());
+      }
+      performLut(I1.bitmap, I2.bitmap, I1.getSize(), lut);
+    }
+
+    inline void performLut(vpImage<vpRGBa> &I, const vpRGBa (&lut)[256]) {
+      performLut(I.bitmap, I.getSize(), lut);
+    }
+
+    inline void performLut(vpImage<unsigned short> &I, const unsigned short *lut) {
+      performLut(I.bitmap, I.getSize(), lut);
+    }
+  }
+}
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif
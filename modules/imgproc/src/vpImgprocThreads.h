@@ -0,0 +1,158 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Thread helpers of the image processing module.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpImgprocThreads.h
+  \brief Number of processors and lock with a condition variable (private header).
+*/
+
+#ifndef __vpImgprocThreads_h__
+#define __vpImgprocThreads_h__
+
+#include <algorithm>
+
+#include <visp3/core/vpConfig.h>
+
+#if defined(_WIN32)
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <unistd.h>
+#  if defined(VISP_HAVE_PTHREAD)
+#    include <pthread.h>
+#  endif
+#endif
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+namespace vp {
+  namespace threads {
+    /*!
+      Return the number of processors online, at least 1.
+    */
+    inline unsigned int getNbProcessors() {
+#if defined(_WIN32)
+      SYSTEM_INFO info;
+      GetSystemInfo(&info);
+      return std::max((unsigned int) info.dwNumberOfProcessors, 1u);
+#elif defined(_SC_NPROCESSORS_ONLN)
+      long nbProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+      return nbProcessors > 0 ? (unsigned int) nbProcessors : 1u;
+#else
+      return 1;
+#endif
+    }
+
+#if defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+    /*!
+      Mutex and condition variable, vpMutex has no condition variable.
+    */
+    class vpLock {
+    public:
+      vpLock() {
+#if defined(_WIN32)
+        InitializeCriticalSection(&m_mutex);
+        InitializeConditionVariable(&m_condition);
+#else
+        pthread_mutex_init(&m_mutex, NULL);
+        pthread_cond_init(&m_condition, NULL);
+#endif
+      }
+
+      ~vpLock() {
+#if defined(_WIN32)
+        DeleteCriticalSection(&m_mutex);
+#else
+        pthread_cond_destroy(&m_condition);
+        pthread_mutex_destroy(&m_mutex);
+#endif
+      }
+
+      void lock() {
+#if defined(_WIN32)
+        EnterCriticalSection(&m_mutex);
+#else
+        pthread_mutex_lock(&m_mutex);
+#endif
+      }
+
+      void unlock() {
+#if defined(_WIN32)
+        LeaveCriticalSection(&m_mutex);
+#else
+        pthread_mutex_unlock(&m_mutex);
+#endif
+      }
+
+      //! Wait for a notification, the lock must be held.
+      void wait() {
+#if defined(_WIN32)
+        SleepConditionVariableCS(&m_condition, &m_mutex, INFINITE);
+#else
+        pthread_cond_wait(&m_condition, &m_mutex);
+#endif
+      }
+
+      void notifyAll() {
+#if defined(_WIN32)
+        WakeAllConditionVariable(&m_condition);
+#else
+        pthread_cond_broadcast(&m_condition);
+#endif
+      }
+
+    private:
+      vpLock(const vpLock &);
+      vpLock &operator=(const vpLock &);
+
+#if defined(_WIN32)
+      CRITICAL_SECTION m_mutex;
+      CONDITION_VARIABLE m_condition;
+#else
+      pthread_mutex_t m_mutex;
+      pthread_cond_t m_condition;
+#endif
+    };
+#endif
+  }
+}
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif
@@ -40,8 +40,9 @@
   \brief Additional image morphology functions.
 */
 
+#include <cstring>
+#include <queue>
 #include <visp3/imgproc/vpImgproc.h>
-#include <visp3/core/vpImageTools.h>
 
 /*!
   \ingroup group_imgproc_morph
@@ -62,7 +63,7 @@ void vp::fillHoles(vpImage<unsigned char> &I
 #if USE_OLD_FILL_HOLE
   //Code similar to Matlab imfill(BW,'holes')
   //Replaced by flood fill as imfill use imreconstruct
-  //and our reconstruct implementation is naive and inefficient
+  //and a border seeded flood fill is still cheaper than the reconstruction
   //Difference between new and old implementation:
   //  - new implementation allows to set the fill value
   //  - only background==0 is required, before it was 0 (background) / 1 (foreground)
@@ -97,27 +98,52 @@ void vp::fillHoles(vpImage<unsigned char> &I
     }
   }
 #else
-  //Create flood fill mask
-  vpImage<unsigned char> flood_fill_mask(I.getHeight() + 2, I.getWidth() + 2, 0);
-  //Copy I to mask + add border padding
-  for (unsigned int i = 0; i < I.getHeight(); i++) {
-    memcpy(flood_fill_mask[i+1]+1, I[i], sizeof(unsigned char)*I.getWidth());
-  }
+  vpFillHolesWorkspace workspace;
+  vp::fillHoles(I, workspace);
+#endif
+}
+
+/*!
+  \ingroup group_imgproc_morph
 
-  //Perform flood fill
-  vp::floodFill(flood_fill_mask, vpImagePoint(0,0), 0, 255);
+  Fill the holes in a binary image, in place. The image is copied in a mask padded with a 1-pixel border of
+  background, so that a single flood fill from the border marks all the background connected to the image border,
+  then a single pass sets this background to 0 and all the other pixels (foreground and holes) to 255.
+  The buffers are taken from \e workspace, no memory is allocated when the same workspace is reused.
 
-  //Get current mask
-  vpImage<unsigned char> mask(I.getHeight(), I.getWidth());
-  for (unsigned int i = 0; i < mask.getHeight(); i++) {
-    memcpy(mask[i], flood_fill_mask[i+1]+1, sizeof(unsigned char)*mask.getWidth());
+  \param I : Input binary image (0 means background, any other value means foreground, for instance 1 or 255).
+  \param workspace : Caller owned buffers.
+*/
+void vp::fillHoles(vpImage<unsigned char> &I, vpFillHolesWorkspace &workspace) {
+  if (I.getSize() == 0) {
+    return;
   }
 
-  //Get image with holes filled
-  vpImage<unsigned char> I_white(I.getHeight(), I.getWidth(), 255), I_holes;
-  vpImageTools::imageSubtract(I_white, mask, I_holes);
-  vpImageTools::imageAdd(I, I_holes, I, true);
-#endif
+  //The mask only holds 0 and 255, the border marker cannot be confused with a foreground value
+  const unsigned char border_value = 1;
+  const unsigned int width = I.getWidth(), height = I.getHeight();
+  vpImage<unsigned char> &mask = workspace.m_mask;
+  mask.resize(height + 2, width + 2);
+  memset(mask[0], 0, mask.getWidth());
+  memset(mask[height + 1], 0, mask.getWidth());
+  for (unsigned int i = 0; i < height; i++) {
+    const unsigned char *src = I[i];
+    unsigned char *dst = mask[i + 1];
+    dst[0] = dst[width + 1] = 0;
+    for (unsigned int j = 0; j < width; j++) {
+      dst[j + 1] = src[j] != 0 ? 255 : 0;
+    }
+  }
+
+  vp::floodFill(mask, vpImagePoint(0, 0), 0, border_value, vpImageMorphology::CONNEXITY_4, workspace.m_stack);
+
+  for (unsigned int i = 0; i < height; i++) {
+    const unsigned char *src = mask[i + 1] + 1;
+    unsigned char *dst = I[i];
+    for (unsigned int j = 0; j < width; j++) {
+      dst[j] = src[j] == border_value ? 0 : 255;
+    }
+  }
 }
 
 /*!
@@ -132,6 +158,10 @@ void vp::fillHoles(vpImage<unsigned char> &I
   \f]
   with \f$ k \f$ such that: \f$ D_{g}^{\left ( k \right )} \left ( f \right ) = D_{g}^{\left ( k+1 \right )} \left ( f \right ) \f$
 
+  The stability is reached with the hybrid algorithm of L. Vincent, "Morphological grayscale reconstruction in
+  image analysis: applications and efficient algorithms" (IEEE Transactions on Image Processing, 1993): a raster and
+  an anti-raster scan propagate the values, then the remaining pixels are processed with a FIFO queue.
+
   \param marker : Grayscale image marker.
   \param mask : Grayscale image mask.
   \param h_kp1 : Image morphologically reconstructed.
@@ -149,24 +179,90 @@ void vp::reconstruct(const vpImage<unsigned char> &marker, const vpImage<unsigne
     return;
   }
 
-  vpImage<unsigned char> h_k = marker;
-  h_kp1 = h_k;
+  const unsigned int height = mask.getHeight(), width = mask.getWidth();
 
-  do {
-    //Dilatation
-    vpImageMorphology::dilatation(h_kp1, connexity);
+  //First geodesic dilation, the marker does not have to be below the mask
+  vpImage<unsigned char> mask_copy;
+  const vpImage<unsigned char> *ptr_mask = &mask;
+  if (&mask == &h_kp1) {
+    mask_copy = mask;
+    ptr_mask = &mask_copy;
+  }
 
-    //Keep min
-    for (unsigned int i = 0; i < h_kp1.getHeight(); i++) {
-      for (unsigned int j = 0; j < h_kp1.getWidth(); j++) {
-        h_kp1[i][j] = std::min(h_kp1[i][j], mask[i][j]);
+  if (&marker != &h_kp1) {
+    h_kp1 = marker;
+  }
+  vpImageMorphology::dilatation(h_kp1, connexity);
+
+  //Copy to images with a 1-pixel border of 0, the border pixels are never modified
+  vpImage<unsigned char> J(height + 2, width + 2, 0), M(height + 2, width + 2, 0);
+  for (unsigned int i = 0; i < height; i++) {
+    const unsigned char *ptr_mask_row = (*ptr_mask)[i];
+    const unsigned char *ptr_dilated_row = h_kp1[i];
+    unsigned char *ptr_J = J[i+1] + 1;
+    unsigned char *ptr_M = M[i+1] + 1;
+
+    for (unsigned int j = 0; j < width; j++) {
+      ptr_M[j] = ptr_mask_row[j];
+      ptr_J[j] = std::min(ptr_dilated_row[j], ptr_mask_row[j]);
+    }
+  }
+
+  //Offsets of the neighbors already visited in raster order, the anti-raster neighbors are the opposite offsets
+  const int stride = (int) width + 2;
+  const int nb_neighbors = connexity == vpImageMorphology::CONNEXITY_4 ? 2 : 4;
+  const int offsets[4] = { -1, -stride, -stride - 1, -stride + 1 };
+  unsigned char *ptr_J = J.bitmap;
+  const unsigned char *ptr_M = M.bitmap;
+
+  //Raster scan
+  for (unsigned int i = 1; i <= height; i++) {
+    for (int p = (int) i * stride + 1; p <= (int) i * stride + (int) width; p++) {
+      unsigned char value = ptr_J[p];
+      for (int cpt = 0; cpt < nb_neighbors; cpt++) {
+        value = std::max(value, ptr_J[p + offsets[cpt]]);
+      }
+      ptr_J[p] = std::min(value, ptr_M[p]);
+    }
+  }
+
+  //Anti-raster scan, initialize the queue with the pixels that can still propagate their value
+  std::queue<int> fifo;
+  for (unsigned int i = height; i >= 1; i--) {
+    for (int p = (int) i * stride + (int) width; p >= (int) i * stride + 1; p--) {
+      unsigned char value = ptr_J[p];
+      for (int cpt = 0; cpt < nb_neighbors; cpt++) {
+        value = std::max(value, ptr_J[p - offsets[cpt]]);
+      }
+      value = std::min(value, ptr_M[p]);
+      ptr_J[p] = value;
+
+      for (int cpt = 0; cpt < nb_neighbors; cpt++) {
+        const int q = p - offsets[cpt];
+        if (ptr_J[q] < value && ptr_J[q] < ptr_M[q]) {
+          fifo.push(p);
+          break;
+        }
       }
     }
+  }
 
-    if (h_kp1 == h_k) {
-      break;
+  //Propagation
+  while (!fifo.empty()) {
+    const int p = fifo.front();
+    fifo.pop();
+    const unsigned char value = ptr_J[p];
+
+    for (int cpt = 0; cpt < 2*nb_neighbors; cpt++) {
+      const int q = cpt < nb_neighbors ? p + offsets[cpt] : p - offsets[cpt - nb_neighbors];
+      if (ptr_J[q] < value && ptr_M[q] != ptr_J[q]) {
+        ptr_J[q] = std::min(value, ptr_M[q]);
+        fifo.push(q);
+      }
     }
+  }
 
-    h_k = h_kp1;
-  } while (true);
+  for (unsigned int i = 0; i < height; i++) {
+    memcpy(h_kp1[i], J[i+1] + 1, sizeof(unsigned char)*width);
+  }
 }
@@ -0,0 +1,406 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Parallel execution layer of the image processing module.
+ *
+ * The jobs are run by one of the backends selected with the CMake variable
+ * VISP_IMGPROC_PARALLEL_BACKEND: a persistent pool of ViSP threads (the
+ * default), OpenMP or Intel TBB.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpParallel.cpp
+  \brief Parallel execution of independent jobs on a pool of threads shared by the module.
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include <visp3/core/vpThread.h>
+#include <visp3/imgproc/vpConfigImgproc.h>
+#include <visp3/imgproc/vpParallel.h>
+
+#include "vpImgprocThreads.h"
+
+#if defined(VISP_IMGPROC_HAVE_TBB)
+#  include <tbb/blocked_range.h>
+#  include <tbb/parallel_for.h>
+#  include <tbb/task_arena.h>
+#elif defined(VISP_IMGPROC_HAVE_OPENMP)
+#  include <omp.h>
+#elif defined(VISP_HAVE_PTHREAD) || (defined(_WIN32) && !defined(WINRT_8_0))
+#  define VP_IMGPROC_USE_THREAD_POOL 1
+#endif
+
+
+namespace {
+unsigned int getDefaultNbThreads() {
+#if defined(VP_IMGPROC_USE_THREAD_POOL) || defined(VISP_IMGPROC_HAVE_OPENMP) || defined(VISP_IMGPROC_HAVE_TBB)
+  return VISP_IMGPROC_NB_THREADS == 0 ? vp::threads::getNbProcessors() : VISP_IMGPROC_NB_THREADS;
+#else
+  return 1;
+#endif
+}
+
+unsigned int g_nbThreads = getDefaultNbThreads();
+
+#if defined(VP_IMGPROC_USE_THREAD_POOL)
+//Jobs submitted by one call of parallelRun()
+struct vpPoolTask {
+  vp::vpParallelJobFn m_fn;
+  void *m_data;
+  unsigned int m_nbJobs;
+  unsigned int m_nextJob;
+  unsigned int m_nbDone;
+  unsigned int m_nbHelpers;    //Jobs of the task being run by the pool threads
+  unsigned int m_maxHelpers;
+
+  vpPoolTask(vp::vpParallelJobFn fn, void *data, const unsigned int nbJobs, const unsigned int maxHelpers) :
+    m_fn(fn), m_data(data), m_nbJobs(nbJobs), m_nextJob(0), m_nbDone(0), m_nbHelpers(0), m_maxHelpers(maxHelpers) {
+  }
+};
+
+/*
+  Pool of getNbThreads()-1 threads shared by all the calls, the calling thread runs the jobs of its own task with
+  the pool threads so that the number of threads working on a task never exceeds getNbThreads(). Several threads
+  (one per camera stream for instance) can submit tasks concurrently, the pool threads take the jobs of the oldest
+  tasks first.
+*/
+class vpThreadPool {
+public:
+  vpThreadPool() : m_lock(), m_threads(), m_tasks(), m_stop(false) {
+  }
+
+  ~vpThreadPool() {
+    stop();
+  }
+
+  void run(vpPoolTask &task) {
+    m_lock.lock();
+    if (m_threads.size() + 1 < g_nbThreads) {
+      start();
+    }
+
+    m_tasks.push_back(&task);
+    m_lock.notifyAll();
+
+    unsigned int job;
+    while (takeJob(task, job)) {
+      m_lock.unlock();
+      task.m_fn(task.m_data, job);
+      m_lock.lock();
+      task.m_nbDone++;
+    }
+
+    while (task.m_nbDone < task.m_nbJobs) {
+      m_lock.wait();
+    }
+    m_lock.unlock();
+  }
+
+  //Stop the pool threads, the new number of threads is created at the next task
+  void restart() {
+    stop();
+  }
+
+private:
+  vpThreadPool(const vpThreadPool &);
+  vpThreadPool &operator=(const vpThreadPool &);
+
+  static vpThread::Return workerThread(vpThread::Args args) {
+    ((vpThreadPool *) args)->work();
+    return 0;
+  }
+
+  //Take the next job of the task, the lock must be held
+  bool takeJob(vpPoolTask &task, unsigned int &job) {
+    if (task.m_nextJob >= task.m_nbJobs) {
+      return false;
+    }
+
+    job = task.m_nextJob++;
+    if (task.m_nextJob == task.m_nbJobs) {
+      m_tasks.erase(std::find(m_tasks.begin(), m_tasks.end(), &task));
+    }
+
+    return true;
+  }
+
+  //Take the next job of the oldest task accepting one more pool thread, the lock must be held
+  vpPoolTask *takeHelperJob(unsigned int &job) {
+    for (size_t cpt = 0; cpt < m_tasks.size(); cpt++) {
+      vpPoolTask *task = m_tasks[cpt];
+      if (task->m_nbHelpers < task->m_maxHelpers && takeJob(*task, job)) {
+        task->m_nbHelpers++;
+        return task;
+      }
+    }
+
+    return NULL;
+  }
+
+  void work() {
+    m_lock.lock();
+    while (!m_stop) {
+      unsigned int job;
+      vpPoolTask *task = takeHelperJob(job);
+      if (task == NULL) {
+        m_lock.wait();
+        continue;
+      }
+
+      m_lock.unlock();
+      task->m_fn(task->m_data, job);
+      m_lock.lock();
+
+      task->m_nbDone++;
+      task->m_nbHelpers--;
+      //Wake the submitting thread if the task is done, another pool thread if a helper slot is free
+      m_lock.notifyAll();
+    }
+    m_lock.unlock();
+  }
+
+  //Create the pool threads, the lock must be held
+  void start() {
+    while (m_threads.size() + 1 < g_nbThreads) {
+      m_threads.push_back(new vpThread(workerThread, (vpThread::Args) this));
+    }
+  }
+
+  //Stop the pool threads once they have finished their current job
+  void stop() {
+    m_lock.lock();
+    m_stop = true;
+    m_lock.notifyAll();
+    std::vector<vpThread *> threads;
+    threads.swap(m_threads);
+    m_lock.unlock();
+
+    for (size_t cpt = 0; cpt < threads.size(); cpt++) {
+      threads[cpt]->join();
+      delete threads[cpt];
+    }
+
+    m_lock.lock();
+    m_stop = false;
+    m_lock.unlock();
+  }
+
+  vp::threads::vpLock m_lock;
+  std::vector<vpThread *> m_threads;
+  std::vector<vpPoolTask *> m_tasks;
+  bool m_stop;
+};
+
+vpThreadPool &getThreadPool() {
+  static vpThreadPool pool;
+  return pool;
+}
+#endif
+
+#if defined(VISP_IMGPROC_HAVE_TBB)
+struct vpTbbBody {
+  vp::vpParallelJobFn m_fn;
+  void *m_data;
+
+  vpTbbBody(vp::vpParallelJobFn fn, void *data) : m_fn(fn), m_data(data) {
+  }
+
+  void operator()(const tbb::blocked_range<unsigned int> &range) const {
+    for (unsigned int job = range.begin(); job != range.end(); job++) {
+      m_fn(m_data, job);
+    }
+  }
+};
+
+struct vpTbbTask {
+  const vpTbbBody &m_body;
+  unsigned int m_nbJobs;
+
+  vpTbbTask(const vpTbbBody &body, const unsigned int nbJobs) : m_body(body), m_nbJobs(nbJobs) {
+  }
+
+  void operator()() const {
+    tbb::parallel_for(tbb::blocked_range<unsigned int>(0, m_nbJobs, 1), m_body);
+  }
+};
+#endif
+
+struct vpParallelForJobs {
+  vp::vpParallelRangeFn m_fn;
+  void *m_data;
+  unsigned int m_begin;
+  unsigned int m_end;
+  unsigned int m_grainSize;
+
+  vpParallelForJobs(vp::vpParallelRangeFn fn, void *data, const unsigned int begin, const unsigned int end,
+                    const unsigned int grainSize) :
+    m_fn(fn), m_data(data), m_begin(begin), m_end(end), m_grainSize(grainSize) {
+  }
+};
+
+void parallelForJob(void *data, const unsigned int job) {
+  const vpParallelForJobs &jobs = *((const vpParallelForJobs *) data);
+  const unsigned int begin = jobs.m_begin + job * jobs.m_grainSize;
+  jobs.m_fn(jobs.m_data, begin, begin + std::min(jobs.m_grainSize, jobs.m_end - begin));
+}
+} //namespace
+
+/*!
+  \ingroup group_imgproc_parallel
+
+  Set the maximum number of threads used by the functions of the module: the pixel-wise functions (adjust(),
+  gammaCorrection(), equalizeHistogram(), stretchContrast(), the binarisation of autoThreshold()), retinex() and
+  unsharpMask(). The results do not depend on the number of threads.
+
+  The threads form a single pool shared by all the calls, the calling thread being one of them: several threads
+  processing different camera streams share the same pool instead of each call creating its own threads.
+  The default value is set with the CMake variable VISP_IMGPROC_NB_THREADS. The setting is global and should not
+  be changed while another thread is running one of the functions of the module.
+
+  \param nbThreads : Maximum number of threads, 0 to use one thread per processor, 1 to run in the calling thread only.
+*/
+void vp::setNbThreads(const unsigned int nbThreads) {
+#if defined(VP_IMGPROC_USE_THREAD_POOL) || defined(VISP_IMGPROC_HAVE_OPENMP) || defined(VISP_IMGPROC_HAVE_TBB)
+  g_nbThreads = nbThreads == 0 ? vp::threads::getNbProcessors() : nbThreads;
+#else
+  (void) nbThreads;
+  g_nbThreads = 1;
+#endif
+
+#if defined(VP_IMGPROC_USE_THREAD_POOL)
+  getThreadPool().restart();
+#endif
+}
+
+/*!
+  \ingroup group_imgproc_parallel
+
+  Get the maximum number of threads used by the functions of the module, see setNbThreads().
+
+  \return The maximum number of threads, 1 when ViSP is built without thread support.
+*/
+unsigned int vp::getNbThreads() {
+  return g_nbThreads;
+}
+
+/*!
+  \ingroup group_imgproc_parallel
+
+  Get the number of threads which would run \e nbJobs jobs with parallelRun().
+
+  \param nbJobs : Number of jobs.
+  \param nbThreads : Maximum number of threads for this call, 0 to use getNbThreads(). It is bounded by
+  getNbThreads().
+  \return The number of threads, between 1 and \e nbJobs.
+*/
+unsigned int vp::getNbWorkers(const unsigned int nbJobs, const unsigned int nbThreads) {
+  const unsigned int maxThreads = nbThreads == 0 ? g_nbThreads : std::min(nbThreads, g_nbThreads);
+  return std::max(std::min(maxThreads, nbJobs), 1u);
+}
+
+/*!
+  \ingroup group_imgproc_parallel
+
+  Run the jobs [0, \e nbJobs[ with at most getNbWorkers(nbJobs, nbThreads) threads, the calling thread being one of
+  them, and return once all the jobs are done. The jobs are started in increasing order but may complete in any
+  order: to get a deterministic result, each job must write its own output and the outputs must be reduced by the
+  caller. The jobs must not throw.
+
+  \param nbJobs : Number of jobs.
+  \param fn : Job function, called once per job.
+  \param data : Data passed to the job function.
+  \param nbThreads : Maximum number of threads for this call, 0 to use getNbThreads(). It is bounded by
+  getNbThreads().
+*/
+void vp::parallelRun(const unsigned int nbJobs, vpParallelJobFn fn, void *data, const unsigned int nbThreads) {
+  const unsigned int nbWorkers = getNbWorkers(nbJobs, nbThreads);
+
+  if (nbWorkers > 1) {
+#if defined(VISP_IMGPROC_HAVE_TBB)
+    vpTbbBody body(fn, data);
+    vpTbbTask tbbTask(body, nbJobs);
+    tbb::task_arena arena((int) nbWorkers);
+    arena.execute(tbbTask);
+    return;
+#elif defined(VISP_IMGPROC_HAVE_OPENMP)
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(nbWorkers)
+    for (int job = 0; job < (int) nbJobs; job++) {
+      fn(data, (unsigned int) job);
+    }
+    return;
+#elif defined(VP_IMGPROC_USE_THREAD_POOL)
+    vpPoolTask task(fn, data, nbJobs, nbWorkers - 1);
+    getThreadPool().run(task);
+    return;
+#endif
+  }
+
+  for (unsigned int job = 0; job < nbJobs; job++) {
+    fn(data, job);
+  }
+}
+
+/*!
+  \ingroup group_imgproc_parallel
+
+  Parallel loop over the indexes [\e begin, \e end[, typically image rows, split into ranges of \e grainSize
+  indexes run with parallelRun().
+
+  \param begin : First index.
+  \param end : Index after the last index.
+  \param grainSize : Number of indexes per range, the range function should have enough work to amortize the
+  scheduling of a job (tens of microseconds). If 0, the indexes are split into four ranges per thread.
+  \param fn : Range function, called once per range.
+  \param data : Data passed to the range function.
+  \param nbThreads : Maximum number of threads for this call, 0 to use getNbThreads(). It is bounded by
+  getNbThreads().
+*/
+void vp::parallelFor(const unsigned int begin, const unsigned int end, const unsigned int grainSize,
+                     vpParallelRangeFn fn, void *data, const unsigned int nbThreads) {
+  if (begin >= end) {
+    return;
+  }
+
+  const unsigned int count = end - begin;
+  unsigned int grain = grainSize;
+  if (grain == 0) {
+    const unsigned int nbRanges = 4 * getNbWorkers(count, nbThreads);
+    grain = (count + nbRanges - 1) / nbRanges;
+  }
+
+  vpParallelForJobs jobs(fn, data, begin, end, grain);
+  parallelRun((count - 1) / grain + 1, parallelForJob, &jobs, nbThreads);
+}
@@ -40,14 +40,333 @@
   \brief Retinex algorithm
 */
 
-#include <numeric>
-#include <functional>
+#include <algorithm>
+#include <complex>
+#include <vector>
 
 #include <visp3/imgproc/vpImgproc.h>
 #include <visp3/core/vpMath.h>
 #include <visp3/core/vpImageFilter.h>
 
+#include "vpImgprocBorder.h"
+#include "vpTiles.h"
+
 #define MAX_RETINEX_SCALES 8
+#define RETINEX_PYRAMID_MIN_SIGMA 4.0
+#define RETINEX_KERNEL_STRIP_WIDTH 16
+
+
+namespace {
+/*
+  Separable Gaussian blur with a truncated kernel, in place and in float, equivalent to vpImageFilter::gaussianBlur().
+  The vertical pass works on strips of columns copied in a contiguous buffer.
+*/
+void kernelGaussianBlur(vpImage<float> &I, const unsigned int kernelSize, const double sigma) {
+  std::vector<double> fg((kernelSize + 1) / 2);
+  vpImageFilter::getGaussianKernel(&fg[0], kernelSize, sigma, true);
+  const std::vector<float> filter(fg.begin(), fg.end());
+  const int radius = (int) filter.size() - 1;
+  const int width = (int) I.getWidth(), height = (int) I.getHeight();
+
+  //Horizontal pass
+  std::vector<float> row(width + 2*radius);
+  for (int i = 0; i < height; i++) {
+    float *data = I[i];
+    for (int j = -radius; j < width + radius; j++) {
+      row[j + radius] = data[vp::border::mirrorIndex(j, width)];
+    }
+
+    const float *center = &row[radius];
+    for (int j = 0; j < width; j++) {
+      float value = filter[0] * center[j];
+      for (int k = 1; k <= radius; k++) {
+        value += filter[k] * (center[j - k] + center[j + k]);
+      }
+      data[j] = value;
+    }
+  }
+
+  //Vertical pass
+  std::vector<int> rowIndexes(height + 2*radius);
+  for (int i = -radius; i < height + radius; i++) {
+    rowIndexes[i + radius] = vp::border::mirrorIndex(i, height);
+  }
+
+  std::vector<float> strip(height * RETINEX_KERNEL_STRIP_WIDTH);
+  float value[RETINEX_KERNEL_STRIP_WIDTH];
+  for (int j0 = 0; j0 < width; j0 += RETINEX_KERNEL_STRIP_WIDTH) {
+    const int stripWidth = std::min(RETINEX_KERNEL_STRIP_WIDTH, width - j0);
+    for (int i = 0; i < height; i++) {
+      std::copy(I[i] + j0, I[i] + j0 + stripWidth, &strip[i * RETINEX_KERNEL_STRIP_WIDTH]);
+    }
+
+    for (int i = 0; i < height; i++) {
+      const float *center = &strip[i * RETINEX_KERNEL_STRIP_WIDTH];
+      for (int c = 0; c < RETINEX_KERNEL_STRIP_WIDTH; c++) {
+        value[c] = filter[0] * center[c];
+      }
+
+      for (int k = 1; k <= radius; k++) {
+        const float *top = &strip[rowIndexes[i + radius - k] * RETINEX_KERNEL_STRIP_WIDTH];
+        const float *bottom = &strip[rowIndexes[i + radius + k] * RETINEX_KERNEL_STRIP_WIDTH];
+        for (int c = 0; c < RETINEX_KERNEL_STRIP_WIDTH; c++) {
+          value[c] += filter[k] * (top[c] + bottom[c]);
+        }
+      }
+
+      std::copy(value, value + stripWidth, I[i] + j0);
+    }
+  }
+}
+
+double recursiveGaussianVariance(const double q, std::complex<double> &p1, double &p3) {
+  p1 = std::pow(std::complex<double>(1.41650, 1.00829), -1.0 / q);
+  p3 = std::pow(1.86543, -1.0 / q);
+
+  std::complex<double> v1 = p1 / ((1.0 - p1) * (1.0 - p1));
+  return 2.0 * (2.0 * v1.real() + p3 / vpMath::sqr(1.0 - p3));
+}
+
+/*
+  Coefficients of the recursive Gaussian filter, normalized by b0:
+  w[n] = B x[n] + b1 w[n-1] + b2 w[n-2] + b3 w[n-3].
+  The poles scaling is solved so that the variance of the filter is exactly sigma^2, which keeps the accuracy
+  (about 1% of the peak value) constant from small to very large scales.
+*/
+struct vpRecursiveGaussianCoefficients {
+  double m_B;
+  double m_b1;
+  double m_b2;
+  double m_b3;
+
+  explicit vpRecursiveGaussianCoefficients(const double sigma) : m_B(0.0), m_b1(0.0), m_b2(0.0), m_b3(0.0) {
+    const double variance = vpMath::sqr(std::max(sigma, 0.5));
+    std::complex<double> p1;
+    double p3;
+
+    //Newton iterations on q, q = 1 for sigma = 2
+    double q = std::sqrt(variance) / 2.0;
+    for (int iter = 0; iter < 20; iter++) {
+      double h = 1e-6 * q;
+      double f = recursiveGaussianVariance(q, p1, p3) - variance;
+      double df = (recursiveGaussianVariance(q + h, p1, p3) - recursiveGaussianVariance(q - h, p1, p3)) / (2.0 * h);
+      double step = f / df;
+      q -= step;
+      if (std::fabs(step) < 1e-9 * q) {
+        break;
+      }
+    }
+    recursiveGaussianVariance(q, p1, p3);
+
+    //Expansion of (1 - p1 z^-1) (1 - conj(p1) z^-1) (1 - p3 z^-1)
+    double sumP1 = 2.0 * p1.real(), prodP1 = std::norm(p1);
+    m_b1 = sumP1 + p3;
+    m_b2 = -(prodP1 + sumP1 * p3);
+    m_b3 = prodP1 * p3;
+    m_B = 1.0 - (m_b1 + m_b2 + m_b3);
+  }
+};
+
+
+/*
+  Forward and backward recursive filtering along the rows, the borders are extended with the first / last value.
+  The recursion is computed in double, small feedback errors would be amplified for the large scales.
+*/
+void recursiveGaussianX(vpImage<float> &I, const vpRecursiveGaussianCoefficients &c) {
+  const unsigned int width = I.getWidth();
+
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    float *row = I[i];
+
+    double w1 = row[0], w2 = row[0], w3 = row[0];
+    for (unsigned int j = 0; j < width; j++) {
+      double w = c.m_B*row[j] + c.m_b1*w1 + c.m_b2*w2 + c.m_b3*w3;
+      w3 = w2;
+      w2 = w1;
+      w1 = w;
+      row[j] = (float) w;
+    }
+
+    w2 = w3 = w1;
+    for (unsigned int j = width; j-- > 0;) {
+      double w = c.m_B*row[j] + c.m_b1*w1 + c.m_b2*w2 + c.m_b3*w3;
+      w3 = w2;
+      w2 = w1;
+      w1 = w;
+      row[j] = (float) w;
+    }
+  }
+}
+
+/*
+  Forward and backward recursive filtering along the columns, all the columns of a row are processed at once to
+  keep a row-major memory access. The three previous outputs are kept in double precision row buffers.
+*/
+void recursiveGaussianY(vpImage<float> &I, const vpRecursiveGaussianCoefficients &c) {
+  const unsigned int width = I.getWidth(), height = I.getHeight();
+  std::vector<double> history(3 * width);
+  double *w1 = &history[0], *w2 = &history[width], *w3 = &history[2*width];
+
+  for (int pass = 0; pass < 2; pass++) {
+    //Forward pass from the top row, backward pass from the bottom row
+    const unsigned int first = pass == 0 ? 0 : height - 1;
+    for (unsigned int j = 0; j < width; j++) {
+      w1[j] = w2[j] = w3[j] = I[first][j];
+    }
+
+    for (unsigned int n = 0; n < height; n++) {
+      float *row = pass == 0 ? I[n] : I[height - 1 - n];
+      for (unsigned int j = 0; j < width; j++) {
+        double w = c.m_B*row[j] + c.m_b1*w1[j] + c.m_b2*w2[j] + c.m_b3*w3[j];
+        w3[j] = w;
+        row[j] = (float) w;
+      }
+
+      //The newest output becomes w1
+      double *tmp = w3;
+      w3 = w2;
+      w2 = w1;
+      w1 = tmp;
+    }
+  }
+}
+
+void recursiveGaussianBlur(vpImage<float> &I, const double sigma) {
+  vpRecursiveGaussianCoefficients coefficients(sigma);
+  recursiveGaussianX(I, coefficients);
+  recursiveGaussianY(I, coefficients);
+}
+
+/*
+  In place Gaussian blur of standard deviation sigma computed on an image downsampled by a power of two factor such
+  that the standard deviation at the reduced resolution stays above RETINEX_PYRAMID_MIN_SIGMA, then bilinearly
+  upsampled.
+*/
+void recursiveGaussianBlurPyramid(vpImage<float> &I, const double sigma) {
+  unsigned int factor = 1;
+  while (sigma / (2*factor) >= RETINEX_PYRAMID_MIN_SIGMA && 2*factor <= std::min(I.getWidth(), I.getHeight())) {
+    factor *= 2;
+  }
+
+  if (factor == 1) {
+    recursiveGaussianBlur(I, sigma);
+    return;
+  }
+
+  //Box downsampling, the last blocks may be partial
+  const unsigned int height = I.getHeight(), width = I.getWidth();
+  const unsigned int reducedHeight = (height + factor - 1) / factor, reducedWidth = (width + factor - 1) / factor;
+  vpImage<float> I_reduced(reducedHeight, reducedWidth, 0.0f);
+  for (unsigned int i = 0; i < height; i++) {
+    float *reducedRow = I_reduced[i / factor];
+    for (unsigned int j = 0; j < width; j++) {
+      reducedRow[j / factor] += I[i][j];
+    }
+  }
+  for (unsigned int i = 0; i < reducedHeight; i++) {
+    unsigned int blockHeight = std::min(factor, height - i*factor);
+    for (unsigned int j = 0; j < reducedWidth; j++) {
+      I_reduced[i][j] /= (float) (blockHeight * std::min(factor, width - j*factor));
+    }
+  }
+
+  //The box filter has already blurred by a variance of (factor^2 - 1) / 12 pixels^2 per axis
+  double reducedSigma = std::sqrt(std::max(vpMath::sqr(sigma / factor) - (1.0 - 1.0 / (factor*factor)) / 12.0, 0.25));
+  recursiveGaussianBlur(I_reduced, reducedSigma);
+
+  //Bilinear upsampling, pixel centers are aligned
+  std::vector<unsigned int> j0(width), j1(width);
+  std::vector<float> dj(width);
+  for (unsigned int j = 0; j < width; j++) {
+    double v = std::min(std::max((j + 0.5) / factor - 0.5, 0.0), (double) (reducedWidth - 1));
+    j0[j] = (unsigned int) v;
+    j1[j] = std::min(j0[j] + 1, reducedWidth - 1);
+    dj[j] = (float) (v - j0[j]);
+  }
+  for (unsigned int i = 0; i < height; i++) {
+    double u = std::min(std::max((i + 0.5) / factor - 0.5, 0.0), (double) (reducedHeight - 1));
+    unsigned int i0 = (unsigned int) u, i1 = std::min(i0 + 1, reducedHeight - 1);
+    float di = (float) (u - i0);
+    const float *top = I_reduced[i0], *bottom = I_reduced[i1];
+    float *row = I[i];
+    for (unsigned int j = 0; j < width; j++) {
+      float t = top[j0[j]] + dj[j] * (top[j1[j]] - top[j0[j]]);
+      float b = bottom[j0[j]] + dj[j] * (bottom[j1[j]] - bottom[j0[j]]);
+      row[j] = t + di * (b - t);
+    }
+  }
+}
+
+unsigned char getChannel(const vpRGBa &rgba, const int channel) {
+  return channel == 0 ? rgba.R : (channel == 1 ? rgba.G : rgba.B);
+}
+
+/*
+  Dest value of MSRCR for one channel, restoration of the colors from the multi-scale retinex.
+*/
+inline double getDestValue(const double *logTable, const double *logSumTable, const double logAlpha,
+                           const vpRGBa &rgba, const int channel, const float retinex) {
+  const double gain = 1.0, offset = 0.0;
+  unsigned int sum = (unsigned int) rgba.R + rgba.G + rgba.B;
+  return gain * (logAlpha + logTable[getChannel(rgba, channel)] - logSumTable[sum]) * retinex + offset;
+}
+
+/*
+  Blur jobs of MSRCR, the job number k of a batch computes log(blur + 1) of one channel at one scale in the buffer k.
+*/
+struct vpRetinexBlurJobs {
+  const vpImage<vpRGBa> &m_I;
+  const std::vector<double> &m_scales;
+  const unsigned int m_nbScales;
+  const unsigned int m_kernelSize;
+  const vp::vpRetinexBlurMethod m_blurMethod;
+  std::vector<vpImage<float> > &m_blurImages;
+  unsigned int m_firstJob;
+
+  vpRetinexBlurJobs(const vpImage<vpRGBa> &I, const std::vector<double> &scales, const unsigned int nbScales,
+                    const unsigned int kernelSize, const vp::vpRetinexBlurMethod &blurMethod,
+                    std::vector<vpImage<float> > &blurImages) :
+    m_I(I), m_scales(scales), m_nbScales(nbScales), m_kernelSize(kernelSize), m_blurMethod(blurMethod), m_blurImages(blurImages),
+    m_firstJob(0) {
+  }
+};
+
+void retinexBlurJob(void *data, const unsigned int job) {
+  vpRetinexBlurJobs &jobs = *((vpRetinexBlurJobs *) data);
+  const unsigned int index = jobs.m_firstJob + job;
+  const int channel = (int) (index / jobs.m_nbScales);
+  const double sigma = jobs.m_scales[index % jobs.m_nbScales];
+
+  const vpImage<vpRGBa> &I = jobs.m_I;
+  const unsigned int size = I.getSize();
+  vpImage<float> &blurImage = jobs.m_blurImages[job];
+  blurImage.resize(I.getHeight(), I.getWidth());
+
+  //Blurring the channel shifted by 1 is the blurred channel shifted by 1, the filters have a unit gain
+  for(unsigned int cpt = 0; cpt < size; cpt++) {
+    blurImage.bitmap[cpt] = getChannel(I.bitmap[cpt], channel);
+  }
+
+  switch (jobs.m_blurMethod) {
+  case vp::RETINEX_BLUR_RECURSIVE:
+    recursiveGaussianBlur(blurImage, sigma);
+    break;
+
+  case vp::RETINEX_BLUR_RECURSIVE_PYRAMID:
+    recursiveGaussianBlurPyramid(blurImage, sigma);
+    break;
+
+  case vp::RETINEX_BLUR_KERNEL:
+  default:
+    kernelGaussianBlur(blurImage, jobs.m_kernelSize, sigma);
+    break;
+  }
+
+  for(unsigned int cpt = 0; cpt < size; cpt++) {
+    blurImage.bitmap[cpt] = std::log(blurImage.bitmap[cpt] + 1.0f);
+  }
+}
+} //namespace
 
 
 std::vector<double> retinexScalesDistribution(const int scaleDiv, const int level, const int scale) {
@@ -91,97 +410,209 @@ std::vector<double> retinexScalesDistribution(const int scaleDiv, const int leve
   return scales;
 }
 
-//See: http://imagej.net/Retinex and https://docs.gimp.org/en/plug-in-retinex.html
-void MSRCR(vpImage<vpRGBa> &I, const int _scale, const int scaleDiv,
-    const int level, const double dynamic, const int _kernelSize) {
-  //Calculate the scales of filtering according to the number of filter and their distribution.
-  std::vector<double> retinexScales = retinexScalesDistribution(scaleDiv, level, _scale);
 
+namespace {
+//The pixel values are shifted by 1 to avoid problem with log(0), log(I+1) and log(R+G+B+3) are tabulated
+struct vpRetinexTables {
+  double m_log[256];
+  double m_logSum[3*255 + 1];
+  double m_logAlpha;
+
+  vpRetinexTables() : m_logAlpha(std::log(128.0)) {
+    for (unsigned int i = 0; i < 256; i++) {
+      m_log[i] = std::log(i + 1.0);
+    }
+    for (unsigned int i = 0; i <= 3*255; i++) {
+      m_logSum[i] = std::log(i + 3.0);
+    }
+  }
+
+  double getDestValue(const vpRGBa &rgba, const int channel, const float retinex) const {
+    return ::getDestValue(m_log, m_logSum, m_logAlpha, rgba, channel, retinex);
+  }
+};
+
+/*
+  Multi-scale retinex of the three channels, before the color restoration.
+*/
+void multiScaleRetinex(const vpImage<vpRGBa> &I, const std::vector<double> &retinexScales, const int scaleDiv,
+                       const unsigned int kernelSize, const vp::vpRetinexBlurMethod &blurMethod,
+                       const vpRetinexTables &tables, std::vector<vpImage<float> > &retinexRGB) {
   //Filtering according to the various scales.
   //Summarize the results of the various filters according to a specific weight(here equivalent for all).
-  double weight = 1.0 / (double) scaleDiv;
+  float weight = 1.0f / (float) scaleDiv;
 
-  std::vector<vpImage<double> > doubleRGB(3);
-  std::vector<vpImage<double> > doubleResRGB(3);
   unsigned int size = I.getSize();
 
-  int kernelSize = _kernelSize;
-  if(kernelSize == -1) {
-    //Compute the kernel size from the input image size
-    kernelSize = (int) (std::min(I.getWidth(), I.getHeight()) / 2.0);
-    kernelSize = (kernelSize - kernelSize%2) + 1;
-  }
-
+  retinexRGB.resize(3);
   for(int channel = 0; channel < 3; channel++) {
-    doubleRGB[(size_t) channel] = vpImage<double>(I.getHeight(), I.getWidth());
-    doubleResRGB[(size_t) channel] = vpImage<double>(I.getHeight(), I.getWidth());
-
+    vpImage<float> &retinex = retinexRGB[(size_t) channel];
+    retinex.resize(I.getHeight(), I.getWidth());
     for(unsigned int cpt = 0; cpt < size; cpt++) {
-      //Shift the pixel values by 1 to avoid problem with log(0)
-      switch(channel) {
-      case 0:
-        doubleRGB[(size_t) channel].bitmap[cpt] = I.bitmap[cpt].R + 1.0;
-        break;
-
-      case 1:
-        doubleRGB[(size_t) channel].bitmap[cpt] = I.bitmap[cpt].G + 1.0;
-        break;
-
-      case 2:
-        doubleRGB[(size_t) channel].bitmap[cpt] = I.bitmap[cpt].B + 1.0;
-        break;
-
-      default:
-        break;
-      }
+      retinex.bitmap[cpt] = (float) tables.m_log[getChannel(I.bitmap[cpt], channel)];
     }
+  }
 
-    for (int sc = 0; sc < scaleDiv; sc++) {
-      vpImage<double> blurImage;
-      double sigma = retinexScales[(size_t) sc];
-      vpImageFilter::gaussianBlur(doubleRGB[(size_t) channel], blurImage, (unsigned int) kernelSize, sigma);
-
+  //The channel x scale blurs are independent, they are run by batches of one job per thread with one blur buffer
+  //per job. Each batch is reduced in the job order so that the result does not depend on the number of threads.
+  const unsigned int nbJobs = 3 * (unsigned int) scaleDiv;
+  const unsigned int nbWorkers = vp::getNbWorkers(nbJobs);
+  std::vector<vpImage<float> > blurImages(nbWorkers);
+  vpRetinexBlurJobs jobs(I, retinexScales, (unsigned int) scaleDiv, kernelSize, blurMethod, blurImages);
+
+  for (unsigned int firstJob = 0; firstJob < nbJobs; firstJob += nbWorkers) {
+    const unsigned int nbBatchJobs = std::min(nbWorkers, nbJobs - firstJob);
+    jobs.m_firstJob = firstJob;
+    vp::parallelRun(nbBatchJobs, retinexBlurJob, &jobs);
+
+    for (unsigned int job = 0; job < nbBatchJobs; job++) {
+      //Summarize the filtered values.
+      //In fact one calculates a ratio between the original values and the filtered values.
+      vpImage<float> &retinex = retinexRGB[(firstJob + job) / (unsigned int) scaleDiv];
+      const float *logBlur = blurImages[job].bitmap;
       for(unsigned int cpt = 0; cpt < size; cpt++) {
-        //Summarize the filtered values.
-        //In fact one calculates a ratio between the original values and the filtered values.
-        doubleResRGB[(size_t) channel].bitmap[cpt] += weight * (std::log(doubleRGB[(size_t) channel].bitmap[cpt])
-          - std::log(blurImage.bitmap[cpt]));
+        retinex.bitmap[cpt] -= weight * logBlur[cpt];
       }
     }
   }
+}
 
-  std::vector<double> dest(size*3);
-  const double gain = 1.0, alpha = 128.0, offset = 0.0;
+/*
+  Mean and standard deviation of the dest values of the rectangle (top, left, height, width) in one streaming pass:
+  the statistics of each row are merged in (mean, m2, count) with Chan et al. update of Welford's algorithm.
+*/
+void accumulateRetinexStatistics(const vpImage<vpRGBa> &I, const std::vector<vpImage<float> > &retinexRGB,
+                                 const vpRetinexTables &tables, const unsigned int top, const unsigned int left,
+                                 const unsigned int height, const unsigned int width,
+                                 double &mean, double &m2, double &count) {
+  for (unsigned int i = top; i < top + height; i++) {
+    double rowSum = 0.0;
+    for (unsigned int j = left; j < left + width; j++) {
+      unsigned int cpt = i * I.getWidth() + j;
+      for (int channel = 0; channel < 3; channel++) {
+        rowSum += tables.getDestValue(I.bitmap[cpt], channel, retinexRGB[(size_t) channel].bitmap[cpt]);
+      }
+    }
 
-  for(unsigned int cpt = 0; cpt < size; cpt++) {
-    double logl = std::log( (double) (I.bitmap[cpt].R + I.bitmap[cpt].G + I.bitmap[cpt].B + 3.0) );
+    double rowCount = 3.0 * width, rowMean = rowSum / rowCount, rowM2 = 0.0;
+    for (unsigned int j = left; j < left + width; j++) {
+      unsigned int cpt = i * I.getWidth() + j;
+      for (int channel = 0; channel < 3; channel++) {
+        double d = tables.getDestValue(I.bitmap[cpt], channel, retinexRGB[(size_t) channel].bitmap[cpt]) - rowMean;
+        rowM2 += d*d;
+      }
+    }
 
-    dest[cpt*3] = gain * (std::log(alpha * doubleRGB[0].bitmap[cpt]) - logl) * doubleResRGB[0].bitmap[cpt] + offset;
-    dest[cpt*3 + 1] = gain * (std::log(alpha * doubleRGB[1].bitmap[cpt]) - logl) * doubleResRGB[1].bitmap[cpt] + offset;
-    dest[cpt*3 + 2] = gain * (std::log(alpha * doubleRGB[2].bitmap[cpt]) - logl) * doubleResRGB[2].bitmap[cpt] + offset;
+    double delta = rowMean - mean, total = count + rowCount;
+    mean += delta * rowCount / total;
+    m2 += rowM2 + delta*delta * count * rowCount / total;
+    count = total;
   }
+}
 
-  double sum = std::accumulate(dest.begin(), dest.end(), 0.0);
-  double mean = sum / dest.size();
+/*
+  Color restoration of the rectangle (top, left, height, width), the dest values in [mini, mini + range] are
+  mapped to [0, 255].
+*/
+void restoreRetinexColors(vpImage<vpRGBa> &I, const std::vector<vpImage<float> > &retinexRGB,
+                          const vpRetinexTables &tables, const unsigned int top, const unsigned int left,
+                          const unsigned int height, const unsigned int width, const double mini, const double range) {
+  for (unsigned int i = top; i < top + height; i++) {
+    for (unsigned int j = left; j < left + width; j++) {
+      unsigned int cpt = i * I.getWidth() + j;
+      vpRGBa rgba = I.bitmap[cpt];
+      I.bitmap[cpt].R = vpMath::saturate<unsigned char>(255.0 * (tables.getDestValue(rgba, 0, retinexRGB[0].bitmap[cpt]) - mini) / range);
+      I.bitmap[cpt].G = vpMath::saturate<unsigned char>(255.0 * (tables.getDestValue(rgba, 1, retinexRGB[1].bitmap[cpt]) - mini) / range);
+      I.bitmap[cpt].B = vpMath::saturate<unsigned char>(255.0 * (tables.getDestValue(rgba, 2, retinexRGB[2].bitmap[cpt]) - mini) / range);
+    }
+  }
+}
 
-  std::vector<double> diff(dest.size());
-  std::transform(dest.begin(), dest.end(), diff.begin(), std::bind2nd(std::minus<double>(), mean));
-  double sq_sum = std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
-  double stdev = std::sqrt(sq_sum / dest.size());
+//Range of the dest values mapped to [0, 255]
+void getRetinexRange(const double mean, const double m2, const double count, const double dynamic,
+                     double &mini, double &range) {
+  double stdev = std::sqrt(m2 / count);
 
-  double mini = mean - dynamic*stdev;
+  mini = mean - dynamic*stdev;
   double maxi = mean + dynamic*stdev;
-  double range = maxi - mini;
+  range = maxi - mini;
 
   if(vpMath::nul(range)) {
     range = 1.0;
   }
+}
 
-  for(unsigned int cpt = 0; cpt < size; cpt++) {
-    I.bitmap[cpt].R = vpMath::saturate<unsigned char>((255.0 * (dest[cpt*3 + 0] - mini) / range));
-    I.bitmap[cpt].G = vpMath::saturate<unsigned char>((255.0 * (dest[cpt*3 + 1] - mini) / range));
-    I.bitmap[cpt].B = vpMath::saturate<unsigned char>((255.0 * (dest[cpt*3 + 2] - mini) / range));
+/*
+  Tiled MSRCR: the retinex of each tile is computed on the tile and its halo, the first pass accumulates the
+  statistics of the dest values of the tiles and the second one computes the retinex again to restore the colors.
+*/
+class vpRetinexTileOperation : public vp::tiles::vpTileOperation<vpRGBa> {
+public:
+  vpRetinexTileOperation(const std::vector<double> &retinexScales, const int scaleDiv, const unsigned int kernelSize,
+                         const vp::vpRetinexBlurMethod &blurMethod) :
+    m_retinexScales(retinexScales), m_scaleDiv(scaleDiv), m_kernelSize(kernelSize), m_blurMethod(blurMethod),
+    m_tables(), m_retinexRGB(), m_restore(false), m_mean(0.0), m_m2(0.0), m_count(0.0), m_mini(0.0), m_range(1.0) {
+  }
+
+  virtual void process(vpImage<vpRGBa> &block, const unsigned int top, const unsigned int left,
+                       const unsigned int height, const unsigned int width) {
+    multiScaleRetinex(block, m_retinexScales, m_scaleDiv, m_kernelSize, m_blurMethod, m_tables, m_retinexRGB);
+    if (m_restore) {
+      restoreRetinexColors(block, m_retinexRGB, m_tables, top, left, height, width, m_mini, m_range);
+    } else {
+      accumulateRetinexStatistics(block, m_retinexRGB, m_tables, top, left, height, width, m_mean, m_m2, m_count);
+    }
+  }
+
+  //Switch to the second pass
+  void setRestore(const double dynamic) {
+    getRetinexRange(m_mean, m_m2, m_count, dynamic, m_mini, m_range);
+    m_restore = true;
+  }
+
+private:
+  std::vector<double> m_retinexScales;
+  int m_scaleDiv;
+  unsigned int m_kernelSize;
+  vp::vpRetinexBlurMethod m_blurMethod;
+  vpRetinexTables m_tables;
+  std::vector<vpImage<float> > m_retinexRGB;
+  bool m_restore;
+  double m_mean, m_m2, m_count;
+  double m_mini, m_range;
+};
+
+//Tiles copied unchanged
+class vpCopyTileOperation : public vp::tiles::vpTileOperation<vpRGBa> {
+public:
+  virtual void process(vpImage<vpRGBa> &, const unsigned int, const unsigned int, const unsigned int,
+                       const unsigned int) {
   }
+};
+} //namespace
+
+//See: http://imagej.net/Retinex and https://docs.gimp.org/en/plug-in-retinex.html
+void MSRCR(vpImage<vpRGBa> &I, const int _scale, const int scaleDiv,
+    const int level, const double dynamic, const int _kernelSize, const vp::vpRetinexBlurMethod &blurMethod) {
+  //Calculate the scales of filtering according to the number of filter and their distribution.
+  std::vector<double> retinexScales = retinexScalesDistribution(scaleDiv, level, _scale);
+
+  int kernelSize = _kernelSize;
+  if(kernelSize == -1) {
+    //Compute the kernel size from the input image size
+    kernelSize = (int) (std::min(I.getWidth(), I.getHeight()) / 2.0);
+    kernelSize = (kernelSize - kernelSize%2) + 1;
+  }
+
+  vpRetinexTables tables;
+  std::vector<vpImage<float> > retinexRGB;
+  multiScaleRetinex(I, retinexScales, scaleDiv, (unsigned int) kernelSize, blurMethod, tables, retinexRGB);
+
+  double mean = 0.0, m2 = 0.0, count = 0.0, mini = 0.0, range = 1.0;
+  accumulateRetinexStatistics(I, retinexRGB, tables, 0, 0, I.getHeight(), I.getWidth(), mean, m2, count);
+  getRetinexRange(mean, m2, count, dynamic, mini, range);
+
+  restoreRetinexColors(I, retinexRGB, tables, 0, 0, I.getHeight(), I.getWidth(), mini, range);
 }
 
 /*!
@@ -199,9 +630,15 @@ void MSRCR(vpImage<vpRGBa> &I, const int _scale, const int scaleDiv,
     - 2, enhances the bright regions of the image.
   \param dynamic : Adjusts the color of the result. Large values produce less saturated images.
   \param kernelSize : Kernel size for the gaussian blur operation. If -1, the kernel size is calculated from the image size.
+  Not used with the recursive blur methods.
+  \param blurMethod : Gaussian blur implementation. The recursive methods have a cost independent of the scale and
+  are suited to video processing.
+
+  The blurs of the channels at the different scales are computed concurrently with the number of threads set with
+  setNbThreads(), one blur buffer of the image size is allocated per thread.
 */
 void vp::retinex(vpImage<vpRGBa> &I, const int scale, const int scaleDiv,
-    const int level, const double dynamic, const int kernelSize) {
+    const int level, const double dynamic, const int kernelSize, const vpRetinexBlurMethod &blurMethod) {
   //Assert scale
   if(scale < 16 || scale > 250) {
     std::cerr << "Scale must be between the interval [16 - 250]" << std::endl;
@@ -218,7 +655,7 @@ void vp::retinex(vpImage<vpRGBa> &I, const int scale, const int scaleDiv,
     return;
   }
 
-  MSRCR(I, scale, scaleDiv, level, dynamic, kernelSize);
+  MSRCR(I, scale, scaleDiv, level, dynamic, kernelSize, blurMethod);
 }
 
 /*!
@@ -237,9 +674,85 @@ void vp::retinex(vpImage<vpRGBa> &I, const int scale, const int scaleDiv,
     - 2, enhances the bright regions of the image.
   \param dynamic : Adjusts the color of the result. Large values produce less saturated images.
   \param kernelSize : Kernel size for the gaussian blur operation. If -1, the kernel size is calculated from the image size.
+  Not used with the recursive blur methods.
+  \param blurMethod : Gaussian blur implementation. The recursive methods have a cost independent of the scale and
+  are suited to video processing.
 */
 void vp::retinex(const vpImage<vpRGBa> &I1, vpImage<vpRGBa> &I2, const int scale, const int scaleDiv,
-    const int level, const double dynamic, const int kernelSize) {
+    const int level, const double dynamic, const int kernelSize, const vpRetinexBlurMethod &blurMethod) {
   I2 = I1;
-  vp::retinex(I2, scale, scaleDiv, level, dynamic, kernelSize);
+  vp::retinex(I2, scale, scaleDiv, level, dynamic, kernelSize, blurMethod);
+}
+
+/*!
+  \ingroup group_imgproc_retinex
+
+  Apply the Retinex algorithm tile by tile to a color image larger than the memory. Unlike the full image version,
+  with kernelSize=-1 the kernel size computed from the image size is capped at 6 standard deviations of the largest
+  Gaussian.
+
+  The image is processed in two passes over the tiles. Each tile is read with a halo of the radius of the largest
+  Gaussian blur: the statistics of the dest values of the whole image are accumulated in the first pass and the
+  colors are restored in the second one, the retinex of the tiles is computed in both passes. The memory is bounded
+  by the size of a tile and its halo.
+
+  With the RETINEX_BLUR_KERNEL method and an explicit kernelSize, the result is the one of
+  retinex(vpImage<vpRGBa> &, const int, const int, const int, const double, const int, const vpRetinexBlurMethod &)
+  up to the rounding of the statistics. The recursive blur methods have an infinite support and are approximated
+  within the halo of 3 standard deviations, which changes the result by about one intensity level.
+
+  \param reader : Blocks of the input color image.
+  \param writer : Blocks of the color image after application of the Retinex technique.
+  \param scale : Specifies the depth of the retinex effect. Minimum value is 16, a value providing gross, unrefined filtering.
+  Maximum value is 250. Optimal and default value is 240.
+  \param scaleDiv : Specifies the number of iterations of the multiscale filter.
+  Values larger than 2 exploit the "multiscale" nature of the algorithm.
+  \param level : Specifies distribution of the Gaussian blurring kernel sizes for Scale division values > 2:
+    - 0, tends to treat all image intensities similarly,
+    - 1, enhances dark regions of the image,
+    - 2, enhances the bright regions of the image.
+  \param dynamic : Adjusts the color of the result. Large values produce less saturated images.
+  \param kernelSize : Kernel size for the gaussian blur operation. If -1, the kernel size is calculated from the image size
+  and capped at 6 standard deviations of the largest Gaussian. Not used with the recursive blur methods.
+  \param blurMethod : Gaussian blur implementation.
+  \param tileSize : Size in pixels of the square tiles.
+*/
+void vp::retinex(vpBlockReader<vpRGBa> &reader, vpBlockWriter<vpRGBa> &writer, const int scale, const int scaleDiv,
+    const int level, const double dynamic, const int kernelSize, const vpRetinexBlurMethod &blurMethod,
+    const unsigned int tileSize) {
+  //Assert scale and scaleDiv, the image is copied unchanged as with retinex(const vpImage<vpRGBa> &, vpImage<vpRGBa> &)
+  bool valid = true;
+  if(scale < 16 || scale > 250) {
+    std::cerr << "Scale must be between the interval [16 - 250]" << std::endl;
+    valid = false;
+  } else if(scaleDiv < 1 || scaleDiv > 8) {
+    std::cerr << "Scale division must be between the interval [1 - 8]" << std::endl;
+    valid = false;
+  }
+
+  if(!valid || reader.getWidth()*reader.getHeight() == 0) {
+    vpCopyTileOperation copy;
+    vp::tiles::processTiles(reader, &writer, tileSize, 0, copy);
+    return;
+  }
+
+  std::vector<double> retinexScales = retinexScalesDistribution(scaleDiv, level, scale);
+  const double maxScale = *std::max_element(retinexScales.begin(), retinexScales.begin() + scaleDiv);
+  const int gaussianRadius = (int) std::ceil(3.0 * maxScale);
+
+  int blurKernelSize = kernelSize;
+  if(blurKernelSize == -1) {
+    //Compute the kernel size from the image size
+    blurKernelSize = (int) (std::min(reader.getWidth(), reader.getHeight()) / 2.0);
+    blurKernelSize = std::min((blurKernelSize - blurKernelSize%2) + 1, 2*gaussianRadius + 1);
+  }
+
+  //The halo is the radius of the blur kernel
+  const unsigned int halo = (unsigned int) (blurMethod == RETINEX_BLUR_KERNEL ? blurKernelSize / 2 : gaussianRadius);
+
+  vpRetinexTileOperation operation(retinexScales, scaleDiv, (unsigned int) blurKernelSize, blurMethod);
+  vp::tiles::processTiles(reader, (vpBlockWriter<vpRGBa> *) NULL, tileSize, halo, operation);
+
+  operation.setRestore(dynamic);
+  vp::tiles::processTiles(reader, &writer, tileSize, halo, operation);
 }
@@ -40,9 +40,14 @@
   \brief Automatic thresholding functions.
 */
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include <visp3/imgproc/vpImgproc.h>
 #include <visp3/core/vpHistogram.h>
-#include <visp3/core/vpImageTools.h>
+
+#include "vpImgprocSimd.h"
 
 namespace {
 bool isBimodal(const std::vector<float> &hist_float) {
@@ -61,21 +66,255 @@ bool isBimodal(const std::vector<float> &hist_float) {
   return (modes == 2);
 }
 
-int computeThresholdHuang(const vpHistogram &hist) {
+//Number of thresholds per job of the Huang method when bounding their entropies with the coarse chords
+const unsigned int HUANG_GRAIN_SIZE = 1024;
+//Number of thresholds per job of the Huang method when bounding their entropies with the fine chords, or when
+//accumulating them over all the bins
+const unsigned int HUANG_CANDIDATE_GRAIN_SIZE = 16;
+//Number of thresholds whose entropies are accumulated together over all the bins
+const unsigned int HUANG_LANES = 4;
+
+/*
+  Segments [m_knots[j], m_knots[j + 1][ of the distances |i - mu|, one per distance below the growth then
+  growing by 1 / growth, with the chords of Smu on each segment.
+*/
+struct vpHuangChords {
+  std::vector<size_t> m_knots;
+  std::vector<double> m_a, m_b;         //Chord m_a[j] + m_b[j] * d of Smu on the segment j
+  std::vector<double> m_below, m_above; //Largest deviations of Smu below and above the chord j
+  double m_slack;                       //Largest deviations relatively to Smu
+
+  vpHuangChords(const std::vector<float> &Smu, const size_t growth)
+    : m_knots(), m_a(), m_b(), m_below(), m_above(), m_slack(0.0) {
+    for (size_t d = 0; d < Smu.size(); d = d < growth ? d + 1 : d + d / growth) {
+      m_knots.push_back(d);
+    }
+    m_knots.push_back(Smu.size());
+
+    for (size_t j = 0; j + 1 < m_knots.size(); j++) {
+      const size_t d0 = m_knots[j], d1 = m_knots[j + 1] - 1;
+      const double b = d1 > d0 ? (Smu[d1] - (double) Smu[d0]) / (d1 - d0) : 0.0;
+      const double a = Smu[d0] - b * d0;
+      double below = 0.0, above = 0.0;
+      for (size_t d = d0; d <= d1; d++) {
+        const double deviation = Smu[d] - (a + b * d);
+        below = std::max(below, -deviation);
+        above = std::max(above, deviation);
+      }
+      m_a.push_back(a);
+      m_b.push_back(b);
+      m_below.push_back(below);
+      m_above.push_back(above);
+      if (Smu[d0] > 0) {
+        m_slack = std::max(m_slack, (below + above) / Smu[d0]);
+      }
+    }
+  }
+};
+
+struct vpHuangJobs {
+  size_t m_first;
+  size_t m_last;
+  const std::vector<unsigned int> *m_hist;
+  std::vector<float> m_S;               //Cumulative density, in single precision as in the former implementation
+  std::vector<float> m_W;               //Weighted cumulative density
+  std::vector<float> m_Smu;             //Summands of the entropy given |i - mu|
+  std::vector<double> m_H;              //m_H[i]: sum of hist[k] for k < i, exact in double precision
+  std::vector<double> m_I;              //m_I[i]: sum of k * hist[k] for k < i, exact in double precision
+  std::vector<size_t> m_bins;           //Non-empty bins
+  const vpHuangChords *m_chords;        //Chords of the current bounds
+  std::vector<size_t> m_candidates;     //Thresholds whose entropy may be the smallest one
+  std::vector<double> m_lower, m_upper; //Bounds of the entropy of each candidate
+  std::vector<float> m_bestEntropies;   //Best entropy of each chunk of HUANG_CANDIDATE_GRAIN_SIZE candidates
+  std::vector<size_t> m_bestThresholds;
+};
+
+/*
+  Rounded mean of a class in single precision as in the former implementation, clamped to [first, last] since the
+  sums exceeding 2^24 pixels are rounded, up to an empty class.
+*/
+int huangMean(const float weightedSum, const float sum, const size_t first, const size_t last) {
+  const float mean = weightedSum / sum;
+  if (!(mean >= (float) first)) {
+    return (int) first;
+  }
+  return mean > (float) last ? (int) last : vpMath::round(mean);
+}
+
+/*
+  Rounded means of the background [first, threshold] and of the foreground ]threshold, last].
+*/
+void huangMeans(const vpHuangJobs &jobs, const size_t threshold, int &muBackground, int &muForeground) {
+  const std::vector<float> &S = jobs.m_S, &W = jobs.m_W;
+  const size_t first = jobs.m_first, last = jobs.m_last;
+  muBackground = huangMean(W[threshold], S[threshold], first, last);
+  muForeground = threshold < last ? huangMean(W[last] - W[threshold], S[last] - S[threshold], first, last) : 0;
+}
+
+/*
+  Add to lower and upper the bounds of the sum of Smu[|i - mu|] * hist[i] for i in [begin, end]. On a segment of
+  distances the sum of the chord of Smu only needs the mass and the first moment of the bins, which are given by the
+  prefix sums of hist[i] and i * hist[i], so that no bin is scanned.
+*/
+void huangClassBounds(const vpHuangJobs &jobs, const long mu, const long begin, const long end, double &lower,
+                      double &upper) {
+  const std::vector<double> &H = jobs.m_H, &I = jobs.m_I;
+  const vpHuangChords &chords = *jobs.m_chords;
+
+  for (size_t j = 0; j + 1 < chords.m_knots.size(); j++) {
+    const long d0 = (long) chords.m_knots[j], d1 = (long) chords.m_knots[j + 1] - 1;
+    if (mu + d0 > end && mu - d0 < begin) {
+      break;
+    }
+
+    //Bins on the right of mu, at the distance i - mu
+    long p = std::max(begin, mu + d0), q = std::min(end, mu + d1);
+    if (p <= q) {
+      const double mass = H[q + 1] - H[p], distance = (I[q + 1] - I[p]) - mu * mass;
+      const double chord = chords.m_a[j] * mass + chords.m_b[j] * distance;
+      lower += chord - chords.m_below[j] * mass;
+      upper += chord + chords.m_above[j] * mass;
+    }
+
+    //Bins on the left of mu, at the distance mu - i, the bin mu being counted on the right
+    p = std::max(begin, mu - d1);
+    q = std::min(end, mu - std::max(d0, 1L));
+    if (p <= q) {
+      const double mass = H[q + 1] - H[p], distance = mu * mass - (I[q + 1] - I[p]);
+      const double chord = chords.m_a[j] * mass + chords.m_b[j] * distance;
+      lower += chord - chords.m_below[j] * mass;
+      upper += chord + chords.m_above[j] * mass;
+    }
+  }
+}
+
+/*
+  Bounds of the entropies of the candidates [begin, end[.
+*/
+void huangBoundsRange(void *data, const unsigned int begin, const unsigned int end) {
+  vpHuangJobs &jobs = *((vpHuangJobs *) data);
+  const size_t first = jobs.m_first, last = jobs.m_last;
+
+  for (unsigned int cpt = begin; cpt < end; cpt++) {
+    const size_t threshold = jobs.m_candidates[cpt];
+    int muBackground, muForeground;
+    huangMeans(jobs, threshold, muBackground, muForeground);
+
+    double lower = 0.0, upper = 0.0;
+    huangClassBounds(jobs, muBackground, (long) first, (long) threshold, lower, upper);
+    if (threshold < last) {
+      huangClassBounds(jobs, muForeground, (long) threshold + 1, (long) last, lower, upper);
+    }
+    jobs.m_lower[cpt] = lower;
+    jobs.m_upper[cpt] = upper;
+  }
+}
+
+/*
+  Entropies of HUANG_LANES thresholds accumulated over all the bins in single precision and in the order of the
+  former implementation, so that they are the same values. The empty bins add zeros, which are exact, and the sums
+  of the thresholds are interleaved so that their additions do not wait for each other.
+*/
+void huangEntropies(const vpHuangJobs &jobs, const size_t *thresholds, float *entropies) {
+  const std::vector<unsigned int> &hist = *jobs.m_hist;
+  const std::vector<float> &Smu = jobs.m_Smu;
+  int muBackground[HUANG_LANES], muForeground[HUANG_LANES];
+  for (unsigned int lane = 0; lane < HUANG_LANES; lane++) {
+    huangMeans(jobs, thresholds[lane], muBackground[lane], muForeground[lane]);
+  }
+
+  float sum[HUANG_LANES] = {0};
+  for (size_t k = 0; k < jobs.m_bins.size(); k++) {
+    const int i = (int) jobs.m_bins[k];
+    const unsigned int count = hist[(size_t) i];
+    for (unsigned int lane = 0; lane < HUANG_LANES; lane++) {
+      const int mu = i <= (int) thresholds[lane] ? muBackground[lane] : muForeground[lane];
+      sum[lane] += Smu[(size_t) std::abs(i - mu)] * count;
+    }
+  }
+
+  for (unsigned int lane = 0; lane < HUANG_LANES; lane++) {
+    entropies[lane] = sum[lane];
+  }
+}
+
+/*
+  Keep the candidates whose entropy may be the smallest one, given the bounds of their exact entropies computed with
+  the chords, the relative error gamma of the single precision entropies and the absolute error tolerance of the
+  bounds. The smallest entropy does not exceed the one of the candidate of smallest upper bound.
+*/
+void huangSelectCandidates(vpHuangJobs &jobs, const vpHuangChords &chords, const unsigned int grainSize,
+                           const double gamma, const double tolerance) {
+  const unsigned int nbCandidates = (unsigned int) jobs.m_candidates.size();
+  jobs.m_chords = &chords;
+  jobs.m_lower.resize(nbCandidates);
+  jobs.m_upper.resize(nbCandidates);
+  vp::parallelFor(0, nbCandidates, grainSize, huangBoundsRange, &jobs);
+
+  const size_t best = (size_t) (std::min_element(jobs.m_upper.begin(), jobs.m_upper.end()) - jobs.m_upper.begin());
+  size_t thresholds[HUANG_LANES];
+  std::fill(thresholds, thresholds + HUANG_LANES, jobs.m_candidates[best]);
+  float entropies[HUANG_LANES];
+  huangEntropies(jobs, thresholds, entropies);
+
+  size_t nbSelected = 0;
+  for (unsigned int cpt = 0; cpt < nbCandidates; cpt++) {
+    if (jobs.m_lower[cpt] * (1 - gamma) - tolerance <= entropies[0]) {
+      jobs.m_candidates[nbSelected++] = jobs.m_candidates[cpt];
+    }
+  }
+  jobs.m_candidates.resize(nbSelected);
+}
+
+/*
+  Smallest entropy of the candidates [begin, end[, the first one on ties.
+*/
+void huangEntropyRange(void *data, const unsigned int begin, const unsigned int end) {
+  vpHuangJobs &jobs = *((vpHuangJobs *) data);
+
+  float bestEntropy = std::numeric_limits<float>::max();
+  size_t bestThreshold = jobs.m_candidates[begin];
+  for (unsigned int cpt = begin; cpt < end; cpt += HUANG_LANES) {
+    //The last lanes repeat the last candidate
+    size_t thresholds[HUANG_LANES];
+    for (unsigned int lane = 0; lane < HUANG_LANES; lane++) {
+      thresholds[lane] = jobs.m_candidates[std::min(cpt + lane, end - 1)];
+    }
+    float entropies[HUANG_LANES];
+    huangEntropies(jobs, thresholds, entropies);
+
+    for (unsigned int lane = 0; lane < HUANG_LANES; lane++) {
+      if (bestEntropy > entropies[lane]) {
+        bestEntropy = entropies[lane];
+        bestThreshold = thresholds[lane];
+      }
+    }
+  }
+
+  jobs.m_bestEntropies[begin / HUANG_CANDIDATE_GRAIN_SIZE] = bestEntropy;
+  jobs.m_bestThresholds[begin / HUANG_CANDIDATE_GRAIN_SIZE] = bestThreshold;
+}
+
+int computeThresholdHuang(const std::vector<unsigned int> &hist) {
   //Code ported from the AutoThreshold ImageJ plugin:
   // Implements Huang's fuzzy thresholding method
   // Uses Shannon's entropy function (one can also use Yager's entropy function)
   // Huang L.-K. and Wang M.-J.J. (1995) "Image Thresholding by Minimizing
   // the Measures of Fuzziness" Pattern Recognition, 28(1): 41-51
   // Reimplemented (to handle 16-bit efficiently) by Johannes Schindelin Jan 31, 2011
+  //Smu is bounded by its chords on segments of distances, so that the entropy of a threshold is bounded from the
+  //prefix sums of hist[i] and i * hist[i] without scanning the bins. The thresholds whose lower bound exceeds the
+  //smallest upper bound are discarded, first with coarse chords then with fine ones, and only the remaining ones
+  //are accumulated over all the bins, in single precision as in the former implementation, which gives its
+  //threshold.
 
   //Find first and last non-empty bin
   size_t first, last;
-  for (first = 0; first < (size_t) hist.getSize() && hist[first] == 0; first++) {
+  for (first = 0; first < (size_t) hist.size() && hist[first] == 0; first++) {
     // do nothing
   }
 
-  for (last = (size_t) hist.getSize()-1; last > first && hist[last] == 0; last--) {
+  for (last = (size_t) hist.size()-1; last > first && hist[last] == 0; last--) {
     // do nothing
   }
 
@@ -83,9 +322,16 @@ int computeThresholdHuang(const vpHistogram &hist) {
     return 0;
   }
 
+  vpHuangJobs jobs;
+  jobs.m_first = first;
+  jobs.m_last = last;
+  jobs.m_hist = &hist;
+
   //Calculate the cumulative density and the weighted cumulative density
-  std::vector<float> S(last + 1);
-  std::vector<float> W(last + 1);
+  std::vector<float> &S = jobs.m_S;
+  std::vector<float> &W = jobs.m_W;
+  S.resize(last + 1);
+  W.resize(last + 1);
 
   S[0] = hist[0];
   W[0] = 0.0f;
@@ -96,40 +342,67 @@ int computeThresholdHuang(const vpHistogram &hist) {
 
   //Precalculate the summands of the entropy given the absolute difference x - mu (integral)
   float C = last - first;
-  std::vector<float> Smu(last + 1 - first);
+  std::vector<float> &Smu = jobs.m_Smu;
+  Smu.resize(last + 1 - first);
 
   for (size_t i = 1; i < Smu.size(); i++) {
     float mu = 1 / (1 + i / C);
     Smu[i] = -mu * std::log(mu) - (1 - mu) * std::log(1 - mu);
   }
 
-  //Calculate the threshold
-  int bestThreshold = 0;
-  float bestEntropy = std::numeric_limits<float>::max();
-
-  for (size_t threshold = first; threshold <= last; threshold++) {
-    float entropy = 0;
-    int mu = vpMath::round(W[threshold] / S[threshold]);
-    for (size_t i = first; i <= threshold; i++) {
-      entropy += Smu[(size_t) std::abs((int) i - mu)] * hist[i];
-    }
+  //Prefix sums of the mass and of the first moment, integers exactly represented in double precision
+  jobs.m_H.assign(last + 2, 0.0);
+  jobs.m_I.assign(last + 2, 0.0);
+  for (size_t i = first; i <= last; i++) {
+    jobs.m_H[i + 1] = jobs.m_H[i] + hist[i];
+    jobs.m_I[i + 1] = jobs.m_I[i] + (double) i * hist[i];
+  }
 
-    mu = vpMath::round((W[last] - W[threshold]) / (S[last] - S[threshold]));
-    for (size_t i = threshold + 1; i <= last; i++) {
-      entropy += Smu[(size_t) std::abs((int) i - mu)] * hist[i];
+  //The single precision entropy of n non-zero summands is within a relative error gamma_n of the exact sum, the
+  //summands and the additions being rounded, and the bins exceeding 2^24 too; the bounds themselves are within an
+  //absolute error tolerance
+  unsigned int nbRoundings = 1;
+  for (size_t i = first; i <= last; i++) {
+    if (hist[i] != 0) {
+      jobs.m_bins.push_back(i);
+      nbRoundings += hist[i] > (1U << std::numeric_limits<float>::digits) ? 2 : 1;
     }
+  }
+  const double ku = nbRoundings * (double) std::numeric_limits<float>::epsilon() / 2;
+  const double gamma = ku / (1 - ku);
+  const double tolerance = 1e-9 * (*std::max_element(Smu.begin(), Smu.end())) * jobs.m_H[last + 1];
+
+  //Discard the thresholds that cannot have the smallest entropy. The thresholds between two non-empty bins give the
+  //entropy of the first bin, which is kept on ties
+  jobs.m_candidates = jobs.m_bins;
+  const vpHuangChords coarseChords(Smu, 8);
+  huangSelectCandidates(jobs, coarseChords, HUANG_GRAIN_SIZE, gamma, tolerance);
+  if (jobs.m_candidates.size() > 1 && coarseChords.m_slack > gamma) {
+    const vpHuangChords fineChords(Smu, 128);
+    huangSelectCandidates(jobs, fineChords, HUANG_CANDIDATE_GRAIN_SIZE, gamma, tolerance);
+  }
 
-    if (bestEntropy > entropy) {
-      bestEntropy = entropy;
-      bestThreshold = threshold;
+  //Calculate the threshold among the candidates
+  const unsigned int nbCandidates = (unsigned int) jobs.m_candidates.size();
+  const unsigned int nbChunks = (nbCandidates + HUANG_CANDIDATE_GRAIN_SIZE - 1) / HUANG_CANDIDATE_GRAIN_SIZE;
+  jobs.m_bestEntropies.resize(nbChunks);
+  jobs.m_bestThresholds.resize(nbChunks);
+  vp::parallelFor(0, nbCandidates, HUANG_CANDIDATE_GRAIN_SIZE, huangEntropyRange, &jobs);
+
+  size_t bestThreshold = jobs.m_bestThresholds[0];
+  float bestEntropy = jobs.m_bestEntropies[0];
+  for (unsigned int chunk = 1; chunk < nbChunks; chunk++) {
+    if (bestEntropy > jobs.m_bestEntropies[chunk]) {
+      bestEntropy = jobs.m_bestEntropies[chunk];
+      bestThreshold = jobs.m_bestThresholds[chunk];
     }
   }
 
-  return bestThreshold;
+  return (int) bestThreshold;
 }
 
-int computeThresholdIntermodes(const vpHistogram &hist) {
-  if (hist.getSize() < 3) {
+int computeThresholdIntermodes(const std::vector<unsigned int> &hist) {
+  if (hist.size() < 3) {
     return -1;
   }
 
@@ -148,8 +421,8 @@ int computeThresholdIntermodes(const vpHistogram &hist) {
   // Images with histograms having extremely unequal peaks or a broad and
   // ﬂat valley are unsuitable for this method.
 
-  std::vector<float> hist_float(hist.getSize());
-  for (unsigned int cpt = 0; cpt < hist.getSize(); cpt++) {
+  std::vector<float> hist_float(hist.size());
+  for (unsigned int cpt = 0; cpt < hist.size(); cpt++) {
     hist_float[cpt] = hist[cpt];
   }
 
@@ -186,31 +459,54 @@ int computeThresholdIntermodes(const vpHistogram &hist) {
   return std::floor(tt / 2.0); //vpMath::round(tt / 2.0);
 }
 
-int computeThresholdIsoData(const vpHistogram &hist, const unsigned int imageSize) {
+/*
+  Mean below (MBT) and above (MAT) the threshold T of the IsoData method. Return false if T is lower than 2 or if a
+  side of the histogram is empty, for instance with few bins or a nearly black image.
+*/
+bool isoDataMeans(const std::vector<float> &sum_ip, const std::vector<float> &cumsum, const int T, float &MBT,
+                  float &MAT) {
+  if (T < 2 || T > (int) cumsum.size()) {
+    return false;
+  }
+
+  float countBelow = cumsum[(size_t) (T-2)], countAbove = cumsum.back() - cumsum[(size_t) (T-1)];
+  if (countBelow <= 0.0f || countAbove <= 0.0f) {
+    return false;
+  }
+
+  MBT = sum_ip[(size_t) (T-2)] / countBelow;
+  MAT = (sum_ip.back() - sum_ip[(size_t) (T-1)]) / countAbove;
+  return true;
+}
+
+int computeThresholdIsoData(const std::vector<unsigned int> &hist, const unsigned int imageSize) {
   int threshold = 0;
 
   //Code based on BSD Matlab isodata implementation by zephyr
   //STEP 1: Compute mean intensity of image from histogram, set T=mean(I)
-  std::vector<float> cumsum(hist.getSize(), 0.0f);
-  std::vector<float> sum_ip(hist.getSize(), 0.0f);
+  std::vector<float> cumsum(hist.size(), 0.0f);
+  std::vector<float> sum_ip(hist.size(), 0.0f);
   cumsum[0] = hist[0];
-  for (unsigned int cpt = 1; cpt < hist.getSize(); cpt++) {
+  for (unsigned int cpt = 1; cpt < hist.size(); cpt++) {
     sum_ip[cpt] = cpt * (float) hist[cpt] + sum_ip[cpt-1];
     cumsum[cpt] = (float) hist[cpt] + cumsum[cpt-1];
   }
 
-  int T = vpMath::round(sum_ip[255] / imageSize);
+  int T = vpMath::round(sum_ip.back() / imageSize);
 
   //STEP 2: compute Mean above T (MAT) and Mean below T (MBT) using T from
-  float MBT = sum_ip[ (size_t) (T-2) ] / cumsum[ (size_t) (T-2) ];
-  float MAT = ( sum_ip.back() - sum_ip[ (size_t) (T-1) ] ) / ( cumsum.back() - cumsum[ (size_t) (T-1) ] );
+  float MBT = 0.0f, MAT = 0.0f;
+  if (!isoDataMeans(sum_ip, cumsum, T, MBT, MAT)) {
+    return -1;
+  }
 
   int T2 = vpMath::round( (MAT + MBT) / 2.0f );
 
   //% STEP 3 to n: repeat step 2 if T(i)~=T(i-1)
   while ( std::fabs(T2-T) >= 1.0f ) {
-    MBT = sum_ip[ (size_t) (T2-2) ] / cumsum[ (size_t) (T2-2) ];
-    MAT = ( sum_ip.back() - sum_ip[ (size_t) (T2-1) ] ) / ( cumsum.back() - cumsum[ (size_t) (T2-1) ] );
+    if (!isoDataMeans(sum_ip, cumsum, T2, MBT, MAT)) {
+      return -1;
+    }
 
     T = T2;
     T2 = vpMath::round( (MAT + MBT) / 2.0f );
@@ -220,25 +516,25 @@ int computeThresholdIsoData(const vpHistogram &hist, const unsigned int imageSiz
   return threshold;
 }
 
-int computeThresholdMean(const vpHistogram &hist, const unsigned int imageSize) {
+int computeThresholdMean(const std::vector<unsigned int> &hist, const unsigned int imageSize) {
   // C. A. Glasbey, "An analysis of histogram-based thresholding algorithms,"
   // CVGIP: Graphical Models and Image Processing, vol. 55, pp. 532-537, 1993.
   // The threshold is the mean of the greyscale data
   float sum_ip = 0.0f;
-  for (unsigned int cpt = 0; cpt < hist.getSize(); cpt++) {
+  for (unsigned int cpt = 0; cpt < hist.size(); cpt++) {
     sum_ip += cpt * (float) hist[cpt];
   }
 
   return std::floor( sum_ip / imageSize );
 }
 
-int computeThresholdOtsu(const vpHistogram &hist, const unsigned int imageSize) {
+int computeThresholdOtsu(const std::vector<unsigned int> &hist, const unsigned int imageSize) {
   //Otsu, N (1979), "A threshold selection method from gray-level histograms",
   //IEEE Trans. Sys., Man., Cyber. 9: 62-66, doi:10.1109/TSMC.1979.4310076
 
   float mu_T = 0.0f;
-  float sum_ip_all[256];
-  for (int cpt = 0; cpt < (int) hist.getSize(); cpt++) {
+  std::vector<float> sum_ip_all(hist.size());
+  for (int cpt = 0; cpt < (int) hist.size(); cpt++) {
     mu_T += cpt * (float) hist[cpt];
     sum_ip_all[cpt] = mu_T;
   }
@@ -249,7 +545,7 @@ int computeThresholdOtsu(const vpHistogram &hist, const unsigned int imageSize)
   float max_sigma_b = 0.0f;
   int threshold = 0;
 
-  for (int cpt = 0; cpt < 256; cpt++) {
+  for (int cpt = 0; cpt < (int) hist.size(); cpt++) {
     w_B += hist[cpt];
     if (vpMath::nul(w_B, std::numeric_limits<float>::epsilon())) {
       continue;
@@ -275,7 +571,7 @@ int computeThresholdOtsu(const vpHistogram &hist, const unsigned int imageSize)
   return threshold;
 }
 
-int computeThresholdTriangle(vpHistogram &hist) {
+int computeThresholdTriangle(std::vector<unsigned int> &hist) {
   int threshold = 0;
 
   // Zack, G. W., Rogers, W. E. and Latt, S. A., 1977,
@@ -284,13 +580,13 @@ int computeThresholdTriangle(vpHistogram &hist) {
 
   int left_bound = -1, right_bound = -1, max_idx = -1, max_value = 0;
   //Find max value index and left / right most index
-  for (int cpt = 0; cpt < (int) hist.getSize(); cpt++) {
+  for (int cpt = 0; cpt < (int) hist.size(); cpt++) {
     if (left_bound == -1 && hist[cpt] > 0) {
       left_bound = (int) cpt;
     }
 
-    if (right_bound == -1 && hist[(int) hist.getSize()-1-cpt] > 0) {
-      right_bound = (int) hist.getSize()-1-cpt;
+    if (right_bound == -1 && hist[(int) hist.size()-1-cpt] > 0) {
+      right_bound = (int) hist.size()-1-cpt;
     }
 
     if ((int) hist[cpt] > max_value) {
@@ -301,7 +597,7 @@ int computeThresholdTriangle(vpHistogram &hist) {
 
   //First / last index when hist(cpt) == 0
   left_bound = left_bound > 0 ? left_bound-1 : left_bound;
-  right_bound = right_bound < (int) hist.getSize()-1 ? right_bound+1 : right_bound;
+  right_bound = right_bound < (int) hist.size()-1 ? right_bound+1 : right_bound;
 
   //Use the largest bound
   bool flip = false;
@@ -309,15 +605,13 @@ int computeThresholdTriangle(vpHistogram &hist) {
     //Flip histogram to get the largest bound to the left
     flip = true;
 
-    int cpt_left = 0, cpt_right = (int) hist.getSize() - 1;
+    int cpt_left = 0, cpt_right = (int) hist.size() - 1;
     for(; cpt_left < cpt_right; cpt_left++, cpt_right-- ) {
-      unsigned int temp = hist[cpt_left];
-      hist.set(cpt_left, hist[cpt_right]);
-      hist.set(cpt_right, temp);
+      std::swap(hist[cpt_left], hist[cpt_right]);
     }
 
-    left_bound = (int) hist.getSize() - 1 - right_bound;
-    max_idx = (int) hist.getSize() - 1 - max_idx;
+    left_bound = (int) hist.size() - 1 - right_bound;
+    max_idx = (int) hist.size() - 1 - max_idx;
   }
 
   //Distance from a point to a line defined by two points:
@@ -340,11 +634,252 @@ int computeThresholdTriangle(vpHistogram &hist) {
   threshold--;
 
   if (flip) {
-    threshold = (int) hist.getSize() - 1 - threshold;
+    threshold = (int) hist.size() - 1 - threshold;
   }
 
   return threshold;
 }
+//Maximum number of bins of the histogram smoothed by the Intermodes method
+const size_t INTERMODES_MAX_BINS = 256;
+
+//Threshold of the histogram of nbPixels pixels, -1 if the method fails
+int computeThreshold(const std::vector<unsigned int> &hist, const unsigned int nbPixels, const vp::vpAutoThresholdMethod &method) {
+  switch (method) {
+    case vp::AUTO_THRESHOLD_HUANG:
+      return computeThresholdHuang(hist);
+
+    case vp::AUTO_THRESHOLD_INTERMODES: {
+      if (hist.size() <= INTERMODES_MAX_BINS) {
+        return computeThresholdIntermodes(hist);
+      }
+
+      //The number of smoothing iterations grows with the square of the number of bins, merge the bins of the large
+      //histograms (16-bit images) and return the first bin of the merged threshold
+      const size_t factor = (hist.size() + INTERMODES_MAX_BINS - 1) / INTERMODES_MAX_BINS;
+      std::vector<unsigned int> histMerged((hist.size() + factor - 1) / factor, 0);
+      for (size_t cpt = 0; cpt < hist.size(); cpt++) {
+        histMerged[cpt / factor] += hist[cpt];
+      }
+
+      int threshold = computeThresholdIntermodes(histMerged);
+      return threshold < 0 ? threshold : (int) (threshold * factor);
+    }
+
+    case vp::AUTO_THRESHOLD_ISODATA:
+      return computeThresholdIsoData(hist, nbPixels);
+
+    case vp::AUTO_THRESHOLD_MEAN:
+      return computeThresholdMean(hist, nbPixels);
+
+    case vp::AUTO_THRESHOLD_OTSU:
+      return computeThresholdOtsu(hist, nbPixels);
+
+    case vp::AUTO_THRESHOLD_TRIANGLE: {
+      //The Triangle method flips the histogram
+      std::vector<unsigned int> histCopy(hist);
+      return computeThresholdTriangle(histCopy);
+    }
+
+    default:
+      break;
+  }
+
+  return -1;
+}
+
+unsigned int getNbPixels(const std::vector<unsigned int> &hist) {
+  unsigned int nbPixels = 0;
+  for (unsigned int cpt = 0; cpt < hist.size(); cpt++) {
+    nbPixels += hist[cpt];
+  }
+
+  return nbPixels;
+}
+
+void computeThresholds(const std::vector<unsigned int> &hist, const std::vector<vp::vpAutoThresholdMethod> &methods,
+                       std::vector<int> &thresholds) {
+  const unsigned int nbPixels = getNbPixels(hist);
+  thresholds.resize(methods.size());
+  for (size_t cpt = 0; cpt < methods.size(); cpt++) {
+    thresholds[cpt] = nbPixels == 0 ? -1 : computeThreshold(hist, nbPixels, methods[cpt]);
+  }
+}
+
+std::vector<unsigned int> getHistogram(const vpHistogram &hist) {
+  std::vector<unsigned int> histogram(hist.getSize());
+  for (unsigned int cpt = 0; cpt < hist.getSize(); cpt++) {
+    histogram[cpt] = hist[cpt];
+  }
+
+  return histogram;
+}
+
+/*
+  Histogram of a 16-bit image with nbBins bins, computed on one row and one column out of subsampling.
+*/
+void computeHistogram(const vpImage<unsigned short> &I, const unsigned int nbBins, const unsigned int subsampling,
+                      std::vector<unsigned int> &hist) {
+  if (subsampling == 0) {
+    throw vpException(vpException::badValue, "The subsampling step must be at least 1");
+  }
+  if (nbBins < 2 || nbBins > 65536) {
+    throw vpException(vpException::badValue, "The number of bins (%d) must be in [2, 65536]", nbBins);
+  }
+
+  hist.resize(nbBins);
+  if (subsampling == 1) {
+    vp::simd::computeHistogram(I.bitmap, I.getSize(), nbBins, &hist[0]);
+  } else {
+    std::fill(hist.begin(), hist.end(), 0);
+    for (unsigned int i = 0; i < I.getHeight(); i += subsampling) {
+      const unsigned short *ptr = I[i];
+      for (unsigned int j = 0; j < I.getWidth(); j += subsampling) {
+        hist[(ptr[j] * nbBins) >> 16]++;
+      }
+    }
+  }
+}
+
+//Smallest intensity of a bin, so that binarising at this intensity splits the image between the bins
+int getBinIntensity(const int bin, const unsigned int nbBins) {
+  return bin < 0 ? bin : (int) (((unsigned int) bin * 65536u + nbBins - 1) / nbBins);
+}
+
+struct vpBinariseJobs {
+  unsigned short *m_bitmap;
+  unsigned short m_threshold;
+  unsigned short m_backgroundValue;
+  unsigned short m_foregroundValue;
+};
+
+void binariseRange(void *data, const unsigned int begin, const unsigned int end) {
+  const vpBinariseJobs &jobs = *((const vpBinariseJobs *) data);
+  unsigned short *ptr = jobs.m_bitmap;
+  const unsigned short threshold = jobs.m_threshold, backgroundValue = jobs.m_backgroundValue,
+      foregroundValue = jobs.m_foregroundValue;
+  for (unsigned int i = begin; i < end; i++) {
+    ptr[i] = ptr[i] < threshold ? backgroundValue : foregroundValue;
+  }
+}
+
+//Number of pixels per job of the 16-bit binarisation
+const unsigned int BINARISE_GRAIN_SIZE = 1 << 15;
+
+struct vpIntegralImageJobs {
+  const vpImage<unsigned char> &m_I;
+  vp::vpIntegralImage &m_integral;
+  bool m_squares;
+
+  vpIntegralImageJobs(const vpImage<unsigned char> &I, vp::vpIntegralImage &integral, const bool squares) :
+    m_I(I), m_integral(integral), m_squares(squares) {
+  }
+
+private:
+  vpIntegralImageJobs &operator=(const vpIntegralImageJobs &);
+};
+
+//Cumulative sums along the rows [begin, end[ of the image
+void integralImageRowsRange(void *data, const unsigned int begin, const unsigned int end) {
+  vpIntegralImageJobs &jobs = *((vpIntegralImageJobs *) data);
+  const unsigned int width = jobs.m_I.getWidth();
+  for (unsigned int i = begin; i < end; i++) {
+    const unsigned char *src = jobs.m_I[i];
+    double *sum = jobs.m_integral.m_sum[i + 1];
+    double rowSum = 0.0;
+    sum[0] = 0.0;
+    for (unsigned int j = 0; j < width; j++) {
+      rowSum += src[j];
+      sum[j + 1] = rowSum;
+    }
+
+    if (jobs.m_squares) {
+      double *squareSum = jobs.m_integral.m_squareSum[i + 1];
+      double rowSquareSum = 0.0;
+      squareSum[0] = 0.0;
+      for (unsigned int j = 0; j < width; j++) {
+        rowSquareSum += src[j] * src[j];
+        squareSum[j + 1] = rowSquareSum;
+      }
+    }
+  }
+}
+
+//Cumulative sums along the columns [begin, end[ of the integral images, each job walks down its own columns
+void integralImageColumnsRange(void *data, const unsigned int begin, const unsigned int end) {
+  vpIntegralImageJobs &jobs = *((vpIntegralImageJobs *) data);
+  const unsigned int height = jobs.m_integral.m_sum.getHeight();
+  for (unsigned int i = 2; i < height; i++) {
+    const double *prev = jobs.m_integral.m_sum[i - 1];
+    double *sum = jobs.m_integral.m_sum[i];
+    for (unsigned int j = begin; j < end; j++) {
+      sum[j] += prev[j];
+    }
+
+    if (jobs.m_squares) {
+      const double *prevSquare = jobs.m_integral.m_squareSum[i - 1];
+      double *squareSum = jobs.m_integral.m_squareSum[i];
+      for (unsigned int j = begin; j < end; j++) {
+        squareSum[j] += prevSquare[j];
+      }
+    }
+  }
+}
+
+struct vpLocalThresholdJobs {
+  vpImage<unsigned char> &m_I;
+  const vp::vpIntegralImage &m_integral;
+  vp::vpLocalThresholdMethod m_method;
+  unsigned int m_halfSize;
+  double m_k;
+  unsigned char m_backgroundValue;
+  unsigned char m_foregroundValue;
+
+  vpLocalThresholdJobs(vpImage<unsigned char> &I, const vp::vpIntegralImage &integral,
+                       const vp::vpLocalThresholdMethod &method, const unsigned int halfSize, const double k,
+                       const unsigned char backgroundValue, const unsigned char foregroundValue) :
+    m_I(I), m_integral(integral), m_method(method), m_halfSize(halfSize), m_k(k), m_backgroundValue(backgroundValue),
+    m_foregroundValue(foregroundValue) {
+  }
+
+private:
+  vpLocalThresholdJobs &operator=(const vpLocalThresholdJobs &);
+};
+
+//Binarisation of the rows [begin, end[ with the local statistics of the window centered on each pixel
+void localThresholdRange(void *data, const unsigned int begin, const unsigned int end) {
+  vpLocalThresholdJobs &jobs = *((vpLocalThresholdJobs *) data);
+  const unsigned int height = jobs.m_I.getHeight(), width = jobs.m_I.getWidth(), halfSize = jobs.m_halfSize;
+  const double k = jobs.m_k;
+
+  for (unsigned int i = begin; i < end; i++) {
+    const unsigned int top = i > halfSize ? i - halfSize : 0;
+    const unsigned int bottom = std::min(height, i + halfSize + 1);
+    unsigned char *row = jobs.m_I[i];
+
+    for (unsigned int j = 0; j < width; j++) {
+      const unsigned int left = j > halfSize ? j - halfSize : 0;
+      const unsigned int right = std::min(width, j + halfSize + 1);
+      const double count = (double) ((bottom - top) * (right - left));
+      const double mean = jobs.m_integral.getSum(top, left, bottom, right) / count;
+
+      double threshold = 0.0;
+      if (jobs.m_method == vp::LOCAL_THRESHOLD_BRADLEY) {
+        threshold = mean * (1.0 - k);
+      } else {
+        const double variance = jobs.m_integral.getSquareSum(top, left, bottom, right) / count - mean * mean;
+        const double stdev = variance > 0.0 ? std::sqrt(variance) : 0.0;
+        threshold = jobs.m_method == vp::LOCAL_THRESHOLD_NIBLACK ? mean + k * stdev
+                                                                 : mean * (1.0 + k * (stdev / 128.0 - 1.0));
+      }
+
+      row[j] = row[j] <= threshold ? jobs.m_backgroundValue : jobs.m_foregroundValue;
+    }
+  }
+}
+
+//Number of rows (columns) per job of the integral image and of the local thresholding
+const unsigned int INTEGRAL_ROWS_GRAIN_SIZE = 16;
+const unsigned int INTEGRAL_COLUMNS_GRAIN_SIZE = 512;
 } //namespace
 
 /*!
@@ -364,42 +899,302 @@ unsigned char vp::autoThreshold(vpImage<unsigned char> &I, const vpAutoThreshold
   }
 
   //Compute image histogram
-  vpHistogram histogram(I);
-  int threshold = -1;
+  vpImageStatistics statistics(I);
+  return vp::autoThreshold(I, statistics, method, backgroundValue, foregroundValue);
+}
 
-  switch (method) {
-    case AUTO_THRESHOLD_HUANG:
-      threshold = computeThresholdHuang(histogram);
-      break;
+/*!
+  \ingroup group_imgproc_threshold
 
-    case AUTO_THRESHOLD_INTERMODES:
-      threshold = computeThresholdIntermodes(histogram);
-      break;
+  Automatic thresholding, using the already computed histogram of the image.
 
-    case AUTO_THRESHOLD_ISODATA:
-      threshold = computeThresholdIsoData(histogram, I.getSize());
-      break;
+  \param I : Input grayscale image.
+  \param statistics : Statistics of the input image.
+  \param method : Automatic thresholding method.
+  \param backgroundValue : Value to set to the background.
+  \param foregroundValue : Value to set to the foreground.
+*/
+unsigned char vp::autoThreshold(vpImage<unsigned char> &I, const vpImageStatistics &statistics, const vpAutoThresholdMethod &method,
+                                const unsigned char backgroundValue, const unsigned char foregroundValue) {
+  if (I.getSize() == 0) {
+    return 0;
+  }
 
-    case AUTO_THRESHOLD_MEAN:
-      threshold = computeThresholdMean(histogram, I.getSize());
-      break;
+  if (statistics.m_nbPixels != I.getSize()) {
+    throw vpException(vpException::dimensionError, "The image statistics (%d pixels) do not correspond to the image (%d pixels)",
+                      statistics.m_nbPixels, I.getSize());
+  }
 
-    case AUTO_THRESHOLD_OTSU:
-      threshold = computeThresholdOtsu(histogram, I.getSize());
-      break;
+  int threshold = vp::computeAutoThreshold(statistics, method);
+  if (threshold != -1) {
+    vp::binarise(I, (unsigned char) threshold, backgroundValue, foregroundValue);
+  }
 
-    case AUTO_THRESHOLD_TRIANGLE:
-      threshold = computeThresholdTriangle(histogram);
-      break;
+  return threshold;
+}
 
-    default:
-      break;
+/*!
+  \ingroup group_imgproc_threshold
+
+  Compute the automatic threshold of the statistics of an image, without binarising the image.
+
+  \param statistics : Statistics of the image.
+  \param method : Automatic thresholding method.
+  \return The threshold, -1 if the method fails or if the statistics are empty.
+*/
+int vp::computeAutoThreshold(const vpImageStatistics &statistics, const vpAutoThresholdMethod &method) {
+  if (statistics.m_nbPixels == 0) {
+    return -1;
   }
 
+  const std::vector<unsigned int> histogram(statistics.m_histogram, statistics.m_histogram + 256);
+  return computeThreshold(histogram, statistics.m_nbPixels, method);
+}
+
+/*!
+  \ingroup group_imgproc_threshold
+
+  Compute the automatic threshold of a histogram, without binarising the image. The number of pixels is the sum of
+  the histogram, so that the histogram can be computed on a subsampled image.
+
+  The AUTO_THRESHOLD_HUANG method gives the threshold of the former single precision implementation. The fuzziness
+  of every threshold is bounded from the prefix sums of the histogram without scanning the bins, and only the
+  thresholds whose fuzziness may be the smallest one, given the rounding errors of the single precision sums, are
+  accumulated over the non-empty bins.
+
+  \param hist : Histogram of the image.
+  \param method : Automatic thresholding method.
+  \return The threshold, -1 if the method fails or if the histogram is empty.
+*/
+int vp::computeAutoThreshold(const vpHistogram &hist, const vpAutoThresholdMethod &method) {
+  const std::vector<unsigned int> histogram = getHistogram(hist);
+  const unsigned int nbPixels = getNbPixels(histogram);
+  return nbPixels == 0 ? -1 : computeThreshold(histogram, nbPixels, method);
+}
+
+/*!
+  \ingroup group_imgproc_threshold
+
+  Compute the automatic thresholds of a histogram for several methods, without binarising the image.
+
+  \param hist : Histogram of the image.
+  \param methods : Automatic thresholding methods.
+  \param thresholds : Threshold of each method, -1 if the method fails or if the histogram is empty.
+*/
+void vp::computeAutoThresholds(const vpHistogram &hist, const std::vector<vpAutoThresholdMethod> &methods,
+                               std::vector<int> &thresholds) {
+  computeThresholds(getHistogram(hist), methods, thresholds);
+}
+
+/*!
+  \ingroup group_imgproc_threshold
+
+  Compute the automatic thresholds of an image for several methods from a single histogram, without binarising
+  the image. Use binarise() to apply one of the thresholds.
+
+  \param I : Input grayscale image.
+  \param methods : Automatic thresholding methods.
+  \param thresholds : Threshold of each method, -1 if the method fails or if the image is empty.
+  \param subsampling : The histogram is computed on one row and one column out of \e subsampling, to speed up the
+  thresholding of very large images.
+*/
+void vp::computeAutoThresholds(const vpImage<unsigned char> &I, const std::vector<vpAutoThresholdMethod> &methods,
+                               std::vector<int> &thresholds, const unsigned int subsampling) {
+  if (subsampling == 0) {
+    throw vpException(vpException::badValue, "The subsampling step must be at least 1");
+  }
+
+  std::vector<unsigned int> histogram(256, 0);
+  if (subsampling == 1) {
+    vpImageStatistics statistics(I);
+    histogram.assign(statistics.m_histogram, statistics.m_histogram + 256);
+  } else {
+    for (unsigned int i = 0; i < I.getHeight(); i += subsampling) {
+      const unsigned char *ptr = I[i];
+      for (unsigned int j = 0; j < I.getWidth(); j += subsampling) {
+        histogram[ptr[j]]++;
+      }
+    }
+  }
+
+  computeThresholds(histogram, methods, thresholds);
+}
+
+/*!
+  \ingroup group_imgproc_threshold
+
+  Binarise an image with a threshold, for instance computed with computeAutoThresholds(). Same result as
+  vpImageTools::binarise(I, threshold, 255, backgroundValue, foregroundValue, foregroundValue), computed with a
+  look-up table split over the threads of the module.
+
+  \param I : Grayscale image to binarise.
+  \param threshold : The pixels below the threshold are set to the background value, the other pixels to the
+  foreground value.
+  \param backgroundValue : Value to set to the background.
+  \param foregroundValue : Value to set to the foreground.
+*/
+void vp::binarise(vpImage<unsigned char> &I, const unsigned char threshold, const unsigned char backgroundValue,
+                  const unsigned char foregroundValue) {
+  unsigned char lut[256];
+  for (unsigned int cpt = 0; cpt < 256; cpt++) {
+    lut[cpt] = cpt < threshold ? backgroundValue : foregroundValue;
+  }
+
+  vp::simd::performLut(I, lut);
+}
+
+vp::vpIntegralImage::vpIntegralImage() : m_sum(), m_squareSum() {
+}
+
+vp::vpIntegralImage::vpIntegralImage(const vpImage<unsigned char> &I, const bool squares) : m_sum(), m_squareSum() {
+  compute(I, squares);
+}
+
+/*!
+  Compute the integral image of \e I and, if \e squares is true, the integral image of its squared intensities. The
+  rows are summed in parallel and then the columns, with the number of threads set with setNbThreads().
+
+  \param I : Input grayscale image.
+  \param squares : If true, also compute m_squareSum, needed for the local standard deviation.
+*/
+void vp::vpIntegralImage::compute(const vpImage<unsigned char> &I, const bool squares) {
+  //The buffers are only reallocated when the image size changes
+  m_sum.resize(I.getHeight() + 1, I.getWidth() + 1);
+  std::fill(m_sum[0], m_sum[0] + m_sum.getWidth(), 0.0);
+  if (squares) {
+    m_squareSum.resize(I.getHeight() + 1, I.getWidth() + 1);
+    std::fill(m_squareSum[0], m_squareSum[0] + m_squareSum.getWidth(), 0.0);
+  }
+
+  vpIntegralImageJobs jobs(I, *this, squares);
+  vp::parallelFor(0, I.getHeight(), INTEGRAL_ROWS_GRAIN_SIZE, integralImageRowsRange, &jobs);
+  vp::parallelFor(1, m_sum.getWidth(), INTEGRAL_COLUMNS_GRAIN_SIZE, integralImageColumnsRange, &jobs);
+}
+
+/*!
+  \ingroup group_imgproc_threshold
+
+  Local adaptive thresholding: each pixel is compared to a threshold computed from the mean and, for the Niblack
+  and Sauvola methods, the standard deviation of the intensities in the window centered on it. The local
+  statistics are read from integral images, so that the cost per pixel does not depend on the window size.
+
+  \param I : Grayscale image to binarise.
+  \param method : Local thresholding method.
+  \param windowSize : Size (should be odd) of the square window, clipped at the image borders.
+  \param k : Parameter of the method, see vpLocalThresholdMethod.
+  \param backgroundValue : Value to set to the pixels lower than or equal to their local threshold.
+  \param foregroundValue : Value to set to the other pixels.
+*/
+void vp::localThreshold(vpImage<unsigned char> &I, const vpLocalThresholdMethod &method, const unsigned int windowSize,
+                        const double k, const unsigned char backgroundValue, const unsigned char foregroundValue) {
+  vpIntegralImage integral;
+  vp::localThreshold(I, integral, method, windowSize, k, backgroundValue, foregroundValue);
+}
+
+/*!
+  \ingroup group_imgproc_threshold
+
+  Local adaptive thresholding with caller owned integral images, see
+  localThreshold(vpImage<unsigned char> &, const vpLocalThresholdMethod &, const unsigned int, const double, const unsigned char, const unsigned char).
+  The integral images of \e I are computed in \e integral, reusing it over successive frames avoids any memory
+  allocation. The rows are binarised in parallel with the number of threads set with setNbThreads().
+
+  \param I : Grayscale image to binarise.
+  \param integral : Integral images, computed from \e I before the binarisation.
+  \param method : Local thresholding method.
+  \param windowSize : Size (should be odd) of the square window, clipped at the image borders.
+  \param k : Parameter of the method, see vpLocalThresholdMethod.
+  \param backgroundValue : Value to set to the pixels lower than or equal to their local threshold.
+  \param foregroundValue : Value to set to the other pixels.
+*/
+void vp::localThreshold(vpImage<unsigned char> &I, vpIntegralImage &integral, const vpLocalThresholdMethod &method,
+                        const unsigned int windowSize, const double k, const unsigned char backgroundValue,
+                        const unsigned char foregroundValue) {
+  if (windowSize == 0) {
+    throw vpException(vpException::badValue, "The window size of the local thresholding must be at least 1");
+  }
+
+  if (I.getSize() == 0) {
+    return;
+  }
+
+  integral.compute(I, method != LOCAL_THRESHOLD_BRADLEY);
+
+  vpLocalThresholdJobs jobs(I, integral, method, windowSize / 2, k, backgroundValue, foregroundValue);
+  vp::parallelFor(0, I.getHeight(), INTEGRAL_ROWS_GRAIN_SIZE, localThresholdRange, &jobs);
+}
+
+/*!
+  \ingroup group_imgproc_threshold
+
+  Automatic thresholding of a 16-bit image. The histogram has 65536 bins by default, a smaller number of bins
+  keeps the histogram in cache and speeds up the methods whose cost grows with the number of bins (Huang,
+  Intermodes), the threshold being then rounded to the first intensity of its bin.
+
+  \param I : Input 16-bit grayscale image.
+  \param method : Automatic thresholding method.
+  \param backgroundValue : Value to set to the background.
+  \param foregroundValue : Value to set to the foreground.
+  \param nbBins : Number of bins of the histogram, in [2, 65536].
+  \return The threshold, -1 if the method fails or if the image is empty.
+*/
+int vp::autoThreshold(vpImage<unsigned short> &I, const vpAutoThresholdMethod &method,
+                      const unsigned short backgroundValue, const unsigned short foregroundValue,
+                      const unsigned int nbBins) {
+  std::vector<unsigned int> histogram;
+  computeHistogram(I, nbBins, 1, histogram);
+  if (I.getSize() == 0) {
+    return -1;
+  }
+
+  int threshold = getBinIntensity(computeThreshold(histogram, I.getSize(), method), nbBins);
   if (threshold != -1) {
-    //Threshold
-    vpImageTools::binarise(I, (unsigned char) threshold, (unsigned char) 255, backgroundValue, foregroundValue, foregroundValue);
+    vp::binarise(I, (unsigned short) std::min(threshold, 65535), backgroundValue, foregroundValue);
   }
 
   return threshold;
 }
+
+/*!
+  \ingroup group_imgproc_threshold
+
+  Compute the automatic thresholds of a 16-bit image for several methods from a single histogram, without
+  binarising the image. The thresholds are intensities, rounded to the first intensity of their bin.
+
+  \param I : Input 16-bit grayscale image.
+  \param methods : Automatic thresholding methods.
+  \param thresholds : Threshold of each method, -1 if the method fails or if the image is empty.
+  \param subsampling : The histogram is computed on one row and one column out of \e subsampling.
+  \param nbBins : Number of bins of the histogram, in [2, 65536].
+*/
+void vp::computeAutoThresholds(const vpImage<unsigned short> &I, const std::vector<vpAutoThresholdMethod> &methods,
+                               std::vector<int> &thresholds, const unsigned int subsampling,
+                               const unsigned int nbBins) {
+  std::vector<unsigned int> histogram;
+  computeHistogram(I, nbBins, subsampling, histogram);
+  computeThresholds(histogram, methods, thresholds);
+  for (size_t cpt = 0; cpt < thresholds.size(); cpt++) {
+    thresholds[cpt] = getBinIntensity(thresholds[cpt], nbBins);
+  }
+}
+
+/*!
+  \ingroup group_imgproc_threshold
+
+  Binarise a 16-bit image with a threshold, the image is split between the threads of the module.
+
+  \param I : 16-bit grayscale image to binarise.
+  \param threshold : The pixels below the threshold are set to the background value, the other pixels to the
+  foreground value.
+  \param backgroundValue : Value to set to the background.
+  \param foregroundValue : Value to set to the foreground.
+*/
+void vp::binarise(vpImage<unsigned short> &I, const unsigned short threshold, const unsigned short backgroundValue,
+                  const unsigned short foregroundValue) {
+  vpBinariseJobs jobs;
+  jobs.m_bitmap = I.bitmap;
+  jobs.m_threshold = threshold;
+  jobs.m_backgroundValue = backgroundValue;
+  jobs.m_foregroundValue = foregroundValue;
+  vp::parallelFor(0, I.getSize(), BINARISE_GRAIN_SIZE, binariseRange, &jobs);
+}
@@ -0,0 +1,121 @@
+/****************************************************************************
+ *
+ * This file is part of the ViSP software.
+ * Copyright (C) 2005 - 2015 by Inria. All rights reserved.
+ *
+ * This software is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * ("GPL") version 2 as published by the Free Software Foundation.
+ * See the file LICENSE.txt at the root directory of this source
+ * distribution for additional information about the GNU GPL.
+ *
+ * For using ViSP with software that can not be combined with the GNU
+ * GPL, please contact Inria about acquiring a ViSP Professional
+ * Edition License.
+ *
+ * See http://visp.inria.fr for more information.
+ *
+ * This software was developed at:
+ * Inria Rennes - Bretagne Atlantique
+ * Campus Universitaire de Beaulieu
+ * 35042 Rennes Cedex
+ * France
+ *
+ * If you have questions regarding the use of this file, please contact
+ * Inria at visp@inria.fr
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * Description:
+ * Tiled processing of images larger than the memory.
+ *
+ * Authors:
+ * ViSP contributors
+ *
+ *****************************************************************************/
+
+/*!
+  \file vpTiles.h
+  \brief Tiled processing of images read and written by blocks (private header).
+*/
+
+#ifndef __vpTiles_h__
+#define __vpTiles_h__
+
+#include <algorithm>
+
+#include <visp3/imgproc/vpBlockIo.h>
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+namespace vp {
+  namespace tiles {
+    /*!
+      Operation applied to each tile by processTiles().
+    */
+    template <class Type>
+    class vpTileOperation {
+    public:
+      virtual ~vpTileOperation() {
+      }
+
+      /*!
+        Process a tile read with its halo: the tile is the rectangle of size height x width whose top left corner
+        is at (top, left) in the block. Only this rectangle of the block is written to the output.
+      */
+      virtual void process(vpImage<Type> &block, const unsigned int top, const unsigned int left,
+                           const unsigned int height, const unsigned int width) = 0;
+    };
+
+    /*!
+      Split the image of the reader into square tiles of tileSize pixels processed in raster order. Each tile is
+      read with a halo of halo pixels on each side (clipped at the image borders), so that an operation whose
+      output pixel only depends on the input pixels within the halo distance gives the same result as on the
+      whole image. The memory is bounded by the size of a tile and its halo. Without a writer, the tiles are only
+      read, for a first pass that gathers global statistics.
+    */
+    template <class Type>
+    void processTiles(vpBlockReader<Type> &reader, vpBlockWriter<Type> *writer, const unsigned int tileSize,
+                      const unsigned int halo, vpTileOperation<Type> &operation) {
+      if (tileSize == 0) {
+        throw vpException(vpException::badValue, "The tile size must be at least 1 pixel");
+      }
+
+      const unsigned int height = reader.getHeight(), width = reader.getWidth();
+      vpImage<Type> block, tile;
+      for (unsigned int top = 0; top < height; top += tileSize) {
+        const unsigned int tileHeight = std::min(tileSize, height - top);
+        const unsigned int blockTop = top > halo ? top - halo : 0;
+        const unsigned int blockBottom = std::min(height, top + tileHeight + halo);
+
+        for (unsigned int left = 0; left < width; left += tileSize) {
+          const unsigned int tileWidth = std::min(tileSize, width - left);
+          const unsigned int blockLeft = left > halo ? left - halo : 0;
+          const unsigned int blockRight = std::min(width, left + tileWidth + halo);
+
+          block.resize(blockBottom - blockTop, blockRight - blockLeft);
+          reader.read(blockTop, blockLeft, block);
+          operation.process(block, top - blockTop, left - blockLeft, tileHeight, tileWidth);
+
+          if (writer != NULL) {
+            if (block.getHeight() == tileHeight && block.getWidth() == tileWidth) {
+              writer->write(top, left, block);
+            } else {
+              tile.resize(tileHeight, tileWidth);
+              for (unsigned int i = 0; i < tileHeight; i++) {
+                const Type *src = block[top - blockTop + i] + (left - blockLeft);
+                std::copy(src, src + tileWidth, tile[i]);
+              }
+              writer->write(top, left, tile);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+#endif
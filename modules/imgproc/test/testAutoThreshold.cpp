@@ -35,6 +35,10 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include <visp3/core/vpIoTools.h>
 #include <visp3/core/vpImageTools.h>
 #include <visp3/io/vpImageIo.h>
@@ -53,6 +57,9 @@
 
 void usage(const char *name, const char *badparam, std::string ipath, std::string opath, std::string user);
 bool getOptions(int argc, const char **argv, std::string &ipath, std::string &opath, std::string user);
+int computeThresholdHuangReference(const vpHistogram &hist);
+void localThresholdReference(vpImage<unsigned char> &I, const vp::vpLocalThresholdMethod &method,
+                             const unsigned int windowSize, const double k);
 
 /*
   Print the program options.
@@ -138,6 +145,92 @@ bool getOptions(int argc, const char **argv, std::string &ipath, std::string &op
 
   return true;
 }
+/*
+  Former implementation of the Huang method, accumulating in single precision the entropy of each threshold over all
+  the bins.
+
+  \param hist : Histogram.
+ */
+int computeThresholdHuangReference(const vpHistogram &hist)
+{
+  size_t first, last;
+  for (first = 0; first < (size_t) hist.getSize() && hist[(unsigned int) first] == 0; first++) {
+  }
+  for (last = (size_t) hist.getSize()-1; last > first && hist[(unsigned int) last] == 0; last--) {
+  }
+  if (first == last) {
+    return 0;
+  }
+
+  std::vector<float> S(last + 1), W(last + 1);
+  S[0] = (float) hist[0];
+  for (size_t i = std::max((size_t) 1, first); i <= last; i++) {
+    S[i] = S[i - 1] + hist[(unsigned int) i];
+    W[i] = W[i - 1] + i * (float) hist[(unsigned int) i];
+  }
+
+  float C = (float) (last - first);
+  std::vector<float> Smu(last + 1 - first);
+  for (size_t i = 1; i < Smu.size(); i++) {
+    float mu = 1 / (1 + i / C);
+    Smu[i] = -mu * std::log(mu) - (1 - mu) * std::log(1 - mu);
+  }
+
+  int bestThreshold = 0;
+  float bestEntropy = std::numeric_limits<float>::max();
+  for (size_t threshold = first; threshold <= last; threshold++) {
+    float entropy = 0;
+    int mu = vpMath::round(W[threshold] / S[threshold]);
+    for (size_t i = first; i <= threshold; i++) {
+      entropy += Smu[(size_t) std::abs((int) i - mu)] * hist[(unsigned int) i];
+    }
+
+    mu = vpMath::round((W[last] - W[threshold]) / (S[last] - S[threshold]));
+    for (size_t i = threshold + 1; i <= last; i++) {
+      entropy += Smu[(size_t) std::abs((int) i - mu)] * hist[(unsigned int) i];
+    }
+
+    if (bestEntropy > entropy) {
+      bestEntropy = entropy;
+      bestThreshold = (int) threshold;
+    }
+  }
+
+  return bestThreshold;
+}
+
+/*
+  Reference implementation of the local thresholding, summing the intensities of each window.
+
+  \param I : Grayscale image to binarise to 0 / 255.
+  \param method : Local thresholding method.
+  \param windowSize : Size of the window.
+  \param k : Parameter of the method.
+ */
+void localThresholdReference(vpImage<unsigned char> &I, const vp::vpLocalThresholdMethod &method,
+                             const unsigned int windowSize, const double k)
+{
+  const int halfSize = (int) windowSize / 2, height = (int) I.getHeight(), width = (int) I.getWidth();
+  vpImage<unsigned char> I_src = I;
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      double sum = 0.0, squareSum = 0.0, count = 0.0;
+      for (int u = std::max(0, i - halfSize); u <= std::min(height - 1, i + halfSize); u++) {
+        for (int v = std::max(0, j - halfSize); v <= std::min(width - 1, j + halfSize); v++) {
+          sum += I_src[u][v];
+          squareSum += I_src[u][v] * I_src[u][v];
+          count++;
+        }
+      }
+
+      double mean = sum / count, variance = squareSum / count - mean * mean;
+      double stdev = variance > 0.0 ? std::sqrt(variance) : 0.0;
+      double threshold = method == vp::LOCAL_THRESHOLD_NIBLACK ? mean + k * stdev :
+                         (method == vp::LOCAL_THRESHOLD_SAUVOLA ? mean * (1.0 + k * (stdev / 128.0 - 1.0)) : mean * (1.0 - k));
+      I[i][j] = I_src[i][j] <= threshold ? 0 : 255;
+    }
+  }
+}
 
 int
 main(int argc, const char ** argv)
@@ -306,6 +399,292 @@ main(int argc, const char ** argv)
     std::cout << "Write: " << filename << std::endl;
 
 
+    //Same thresholds with the image statistics computed once
+    vp::vpImageStatistics statistics(I);
+    for (int method = vp::AUTO_THRESHOLD_HUANG; method <= vp::AUTO_THRESHOLD_TRIANGLE; method++) {
+      vpImage<unsigned char> I_thresh_ref = I;
+      double threshold_ref = vp::autoThreshold(I_thresh_ref, (vp::vpAutoThresholdMethod) method);
+
+      I_thresh = I;
+      threshold = vp::autoThreshold(I_thresh, statistics, (vp::vpAutoThresholdMethod) method);
+      if (threshold != threshold_ref || I_thresh != I_thresh_ref) {
+        throw vpException(vpException::fatalError, "Problem with vp::autoThreshold() and vpImageStatistics (method %d)!", method);
+      }
+    }
+
+    //All the thresholds computed from a single histogram, without modifying the image
+    std::vector<vp::vpAutoThresholdMethod> methods;
+    for (int method = vp::AUTO_THRESHOLD_HUANG; method <= vp::AUTO_THRESHOLD_TRIANGLE; method++) {
+      methods.push_back((vp::vpAutoThresholdMethod) method);
+    }
+    std::vector<int> thresholds, thresholds_subsampled;
+    vpImage<unsigned char> I_copy = I;
+    t = vpTime::measureTimeMs();
+    vp::computeAutoThresholds(I, methods, thresholds);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to compute the thresholds of all the methods: " << t << " ms" << std::endl;
+    vp::computeAutoThresholds(I, methods, thresholds_subsampled, 2);
+    if (I != I_copy || thresholds.size() != methods.size() || thresholds_subsampled.size() != methods.size()) {
+      throw vpException(vpException::fatalError, "Problem with vp::computeAutoThresholds()!");
+    }
+
+    vpHistogram histogram(I);
+    for (size_t cpt = 0; cpt < methods.size(); cpt++) {
+      vpImage<unsigned char> I_thresh_ref = I;
+      int threshold_ref = vp::autoThreshold(I_thresh_ref, methods[cpt], 0, 255);
+      if (thresholds[cpt] != -1 && (unsigned char) thresholds[cpt] != threshold_ref) {
+        throw vpException(vpException::fatalError, "Problem with vp::computeAutoThresholds() (method %d)!", methods[cpt]);
+      }
+      if (vp::computeAutoThreshold(histogram, methods[cpt]) != thresholds[cpt]) {
+        throw vpException(vpException::fatalError, "Problem with vp::computeAutoThreshold() (method %d)!", methods[cpt]);
+      }
+
+      if (thresholds[cpt] != -1) {
+        I_thresh = I;
+        vp::binarise(I_thresh, (unsigned char) thresholds[cpt], 0, 255);
+        if (I_thresh != I_thresh_ref) {
+          throw vpException(vpException::fatalError, "Problem with vp::binarise() (method %d)!", methods[cpt]);
+        }
+      }
+      std::cout << "Method " << methods[cpt] << ": threshold " << thresholds[cpt] << ", on the subsampled image "
+                << thresholds_subsampled[cpt] << std::endl;
+    }
+
+    //The binarisation must match vpImageTools::binarise() and must not depend on the number of threads
+    vp::setNbThreads(4);
+    for (int method = vp::AUTO_THRESHOLD_HUANG; method <= vp::AUTO_THRESHOLD_TRIANGLE; method++) {
+      I_thresh = I;
+      threshold = vp::autoThreshold(I_thresh, (vp::vpAutoThresholdMethod) method, 10, 200);
+
+      vpImage<unsigned char> I_thresh_ref = I;
+      if (threshold != -1) {
+        vpImageTools::binarise(I_thresh_ref, (unsigned char) threshold, (unsigned char) 255, (unsigned char) 10,
+                               (unsigned char) 200, (unsigned char) 200);
+      }
+      if (I_thresh != I_thresh_ref) {
+        throw vpException(vpException::fatalError, "Problem with the multi-threaded binarisation of vp::autoThreshold() (method %d)!", method);
+      }
+    }
+    vp::setNbThreads(1);
+
+    //Local thresholding, the integral images are reused over the frames and the result must not depend on the
+    //number of threads
+    const double local_k[] = {-0.2, 0.34, 0.15};
+    const char *local_names[] = {"niblack", "sauvola", "bradley"};
+    vp::vpIntegralImage integral;
+    for (int method = vp::LOCAL_THRESHOLD_NIBLACK; method <= vp::LOCAL_THRESHOLD_BRADLEY; method++) {
+      vpImage<unsigned char> I_thresh_ref = I;
+      localThresholdReference(I_thresh_ref, (vp::vpLocalThresholdMethod) method, 15, local_k[method]);
+
+      I_thresh = I;
+      t = vpTime::measureTimeMs();
+      vp::localThreshold(I_thresh, integral, (vp::vpLocalThresholdMethod) method, 15, local_k[method]);
+      t = vpTime::measureTimeMs() - t;
+      std::cout << "\nLocal thresholding (" << local_names[method] << "): t=" << t << " ms" << std::endl;
+
+      filename = vpIoTools::createFilePath(opath, std::string("grid36-03_local_thresh_") + local_names[method] + ".pgm");
+      vpImageIo::write(I_thresh, filename);
+      std::cout << "Write: " << filename << std::endl;
+
+      vpImage<unsigned char> I_thresh_threads = I;
+      vp::setNbThreads(3);
+      vp::localThreshold(I_thresh_threads, (vp::vpLocalThresholdMethod) method, 15, local_k[method]);
+      vp::setNbThreads(1);
+      if (I_thresh != I_thresh_ref || I_thresh_threads != I_thresh_ref) {
+        throw vpException(vpException::fatalError, "Problem with vp::localThreshold() (method %d)!", method);
+      }
+
+      //Window larger than the image and odd sized images
+      vpImage<unsigned char> I_small(27, 41);
+      for (unsigned int cpt = 0; cpt < I_small.getSize(); cpt++) {
+        I_small.bitmap[cpt] = I.bitmap[cpt * 13];
+      }
+      I_thresh_ref = I_small;
+      localThresholdReference(I_thresh_ref, (vp::vpLocalThresholdMethod) method, 51, local_k[method]);
+      vp::localThreshold(I_small, integral, (vp::vpLocalThresholdMethod) method, 51, local_k[method]);
+      if (I_small != I_thresh_ref) {
+        throw vpException(vpException::fatalError, "Problem with vp::localThreshold() on small images (method %d)!", method);
+      }
+    }
+
+    //The Huang implementation bounding the entropies must give the thresholds of the former implementation
+    const unsigned int nbBins[] = {256, 200, 128, 64, 16};
+    for (size_t cpt = 0; cpt < sizeof(nbBins) / sizeof(nbBins[0]); cpt++) {
+      histogram.calculate(I, nbBins[cpt]);
+      for (int shift = 0; shift < 4; shift++) {
+        int threshold_ref = computeThresholdHuangReference(histogram);
+        t = vpTime::measureTimeMs();
+        threshold = vp::computeAutoThreshold(histogram, vp::AUTO_THRESHOLD_HUANG);
+        t = vpTime::measureTimeMs() - t;
+        if (threshold != threshold_ref) {
+          throw vpException(vpException::fatalError, "Problem with the Huang method (%d bins): %d != %d!", nbBins[cpt],
+                            (int) threshold, threshold_ref);
+        }
+        std::cout << "Huang threshold (" << nbBins[cpt] << " bins): " << threshold << " ; t=" << t << " ms" << std::endl;
+
+        //Distort the histogram to test other distributions
+        for (unsigned int i = 0; i < histogram.getSize(); i++) {
+          histogram.set(i, histogram[i] * (i % (shift + 2) + 1) + (histogram[i] > 0 ? i : 0));
+        }
+      }
+    }
+
+    //Dense large histograms split into several chunks of candidate thresholds, the 65536 bins histogram is
+    //restricted to 8192 bins so that the quadratic reference stays fast
+    const unsigned int nbBinsLarge[] = {4096, 65536};
+    for (size_t cpt = 0; cpt < sizeof(nbBinsLarge) / sizeof(nbBinsLarge[0]); cpt++) {
+      histogram.calculate(I, nbBinsLarge[cpt]);
+      const unsigned int begin = nbBinsLarge[cpt] == 65536 ? 16384 : 0;
+      const unsigned int end = nbBinsLarge[cpt] == 65536 ? 16384 + 8192 : nbBinsLarge[cpt];
+      for (unsigned int i = 0; i < histogram.getSize(); i++) {
+        histogram.set(i, (i >= begin && i < end) ? histogram[i] + (i * 7919) % 13 + 1 : 0);
+      }
+
+      int threshold_ref = computeThresholdHuangReference(histogram);
+      for (unsigned int nbThreads = 1; nbThreads <= 4; nbThreads += 3) {
+        vp::setNbThreads(nbThreads);
+        t = vpTime::measureTimeMs();
+        threshold = vp::computeAutoThreshold(histogram, vp::AUTO_THRESHOLD_HUANG);
+        t = vpTime::measureTimeMs() - t;
+        vp::setNbThreads(1);
+        if (threshold != threshold_ref) {
+          throw vpException(vpException::fatalError, "Problem with the Huang method (%d bins, %d threads): %d != %d!",
+                            nbBinsLarge[cpt], nbThreads, (int) threshold, threshold_ref);
+        }
+        std::cout << "Huang threshold (" << nbBinsLarge[cpt] << " bins, " << nbThreads << " threads): " << threshold
+                  << " ; t=" << t << " ms" << std::endl;
+      }
+    }
+
+    //Noisy 8-bit histograms, whose thresholds have nearly the same fuzziness, and sparse, flat and two peak ones
+    unsigned int seed = 1;
+    histogram.calculate(I, 256);
+    for (int cpt = 0; cpt < 250; cpt++) {
+      const int shape = cpt % 5;
+      for (unsigned int i = 0; i < histogram.getSize(); i++) {
+        seed = seed * 1103515245 + 12345;
+        const unsigned int random = (seed >> 16) & 0x7FFF;
+        unsigned int value = random % 1000;
+        if (shape == 1) {
+          value = random % 4 == 0 ? random % 50 : 0;
+        } else if (shape == 2) {
+          value = 5;
+        } else if (shape == 3) {
+          value = (i == 64 || i == 192) ? 1000 : 0;
+        } else if (shape == 4) {
+          value = (unsigned int) (100 * (1 + std::sin(i * 0.05))) + random % 5;
+        }
+        histogram.set(i, value);
+      }
+
+      int threshold_ref = computeThresholdHuangReference(histogram);
+      threshold = vp::computeAutoThreshold(histogram, vp::AUTO_THRESHOLD_HUANG);
+      if (threshold != threshold_ref) {
+        throw vpException(vpException::fatalError, "Problem with the Huang method (8-bit histogram %d): %d != %d!", cpt,
+                          (int) threshold, threshold_ref);
+      }
+    }
+
+    //Noisy 16-bit image with 65536 bins, its levels spanning 16384 bins so that the quadratic reference stays fast
+    vpImage<unsigned short> I_16_noisy(I.getHeight(), I.getWidth());
+    histogram.calculate(I, 65536);
+    for (unsigned int i = 0; i < histogram.getSize(); i++) {
+      histogram.set(i, 0);
+    }
+    for (unsigned int cpt = 0; cpt < I.getSize(); cpt++) {
+      seed = seed * 1103515245 + 12345;
+      I_16_noisy.bitmap[cpt] = (unsigned short) (16384 + I.bitmap[cpt] * 64 + ((seed >> 16) & 0x3F));
+      histogram.set(I_16_noisy.bitmap[cpt], histogram[I_16_noisy.bitmap[cpt]] + 1);
+    }
+
+    int threshold_ref = computeThresholdHuangReference(histogram);
+    for (unsigned int nbThreads = 1; nbThreads <= 4; nbThreads += 3) {
+      vp::setNbThreads(nbThreads);
+      std::vector<int> thresholds_noisy;
+      t = vpTime::measureTimeMs();
+      vp::computeAutoThresholds(I_16_noisy, std::vector<vp::vpAutoThresholdMethod>(1, vp::AUTO_THRESHOLD_HUANG),
+                                thresholds_noisy);
+      t = vpTime::measureTimeMs() - t;
+      vp::setNbThreads(1);
+      if (thresholds_noisy[0] != threshold_ref) {
+        throw vpException(vpException::fatalError, "Problem with the Huang method (16-bit image, %d threads): %d != %d!",
+                          nbThreads, thresholds_noisy[0], threshold_ref);
+      }
+      std::cout << "Huang threshold (16-bit image, " << nbThreads << " threads): " << thresholds_noisy[0] << " ; t="
+                << t << " ms" << std::endl;
+    }
+
+    //16-bit image I * 257: with 256 bins, the histogram and the thresholds are the ones of the 8-bit image
+    vpImage<unsigned short> I_16(I.getHeight(), I.getWidth());
+    for (unsigned int cpt = 0; cpt < I.getSize(); cpt++) {
+      I_16.bitmap[cpt] = (unsigned short) (I.bitmap[cpt] * 257);
+    }
+
+    std::vector<int> thresholds_16;
+    vp::computeAutoThresholds(I_16, methods, thresholds_16, 1, 256);
+    for (size_t cpt = 0; cpt < methods.size(); cpt++) {
+      vpImage<unsigned short> I_16_thresh = I_16;
+      t = vpTime::measureTimeMs();
+      int threshold_16 = vp::autoThreshold(I_16_thresh, methods[cpt], 10, 60000, 256);
+      t = vpTime::measureTimeMs() - t;
+      std::cout << "16-bit automatic thresholding (method " << methods[cpt] << ", 256 bins): " << threshold_16
+                << " ; t=" << t << " ms" << std::endl;
+
+      int threshold_ref = thresholds[cpt] == -1 ? -1 : 256 * thresholds[cpt];
+      if (threshold_16 != threshold_ref || thresholds_16[cpt] != threshold_ref) {
+        throw vpException(vpException::fatalError, "Problem with the 16-bit thresholds (method %d)!", methods[cpt]);
+      }
+
+      if (threshold_16 != -1) {
+        for (unsigned int i = 0; i < I.getSize(); i++) {
+          if (I_16_thresh.bitmap[i] != (I.bitmap[i] < thresholds[cpt] ? 10 : 60000)) {
+            throw vpException(vpException::fatalError, "Problem with the 16-bit binarisation (method %d)!", methods[cpt]);
+          }
+        }
+      }
+    }
+
+    //Full 16-bit histogram
+    vp::computeAutoThresholds(I_16, methods, thresholds_16);
+    for (size_t cpt = 0; cpt < methods.size(); cpt++) {
+      vpImage<unsigned short> I_16_thresh = I_16;
+      t = vpTime::measureTimeMs();
+      int threshold_16 = vp::autoThreshold(I_16_thresh, methods[cpt]);
+      t = vpTime::measureTimeMs() - t;
+      std::cout << "16-bit automatic thresholding (method " << methods[cpt] << "): " << threshold_16 << " ; t=" << t
+                << " ms" << std::endl;
+      if (threshold_16 != thresholds_16[cpt]) {
+        throw vpException(vpException::fatalError, "Problem with vp::computeAutoThresholds() on 16-bit images (method %d)!", methods[cpt]);
+      }
+    }
+
+    //Few bins and a nearly black image: the methods either fail with -1 or give a threshold that binarises the image
+    vpImage<unsigned short> I_16_dark(I.getHeight(), I.getWidth(), 0);
+    for (unsigned int cpt = 0; cpt < I.getSize(); cpt += 97) {
+      I_16_dark.bitmap[cpt] = (unsigned short) (I.bitmap[cpt] % 3);
+    }
+    const unsigned int smallNbBins[] = {2, 3, 4, 16};
+    for (size_t cpt = 0; cpt < methods.size(); cpt++) {
+      for (int image = 0; image < 2; image++) {
+        for (size_t bins = 0; bins < sizeof(smallNbBins) / sizeof(smallNbBins[0]) + 1; bins++) {
+          const unsigned int nbBins_16 = bins < sizeof(smallNbBins) / sizeof(smallNbBins[0]) ? smallNbBins[bins] : 65536;
+          vpImage<unsigned short> I_16_thresh = image == 0 ? I_16 : I_16_dark;
+          int threshold_16 = vp::autoThreshold(I_16_thresh, methods[cpt], 10, 60000, nbBins_16);
+          if (threshold_16 < -1 || threshold_16 > 65536) {
+            throw vpException(vpException::fatalError, "Problem with the 16-bit threshold with %d bins (method %d)!", nbBins_16, methods[cpt]);
+          }
+
+          const vpImage<unsigned short> &I_16_src = image == 0 ? I_16 : I_16_dark;
+          for (unsigned int i = 0; threshold_16 != -1 && i < I_16_src.getSize(); i++) {
+            if (I_16_thresh.bitmap[i] != (I_16_src.bitmap[i] < threshold_16 ? 10 : 60000)) {
+              throw vpException(vpException::fatalError, "Problem with the 16-bit binarisation with %d bins (method %d)!", nbBins_16, methods[cpt]);
+            }
+          }
+        }
+      }
+    }
+
+
     return EXIT_SUCCESS;
   }
   catch(vpException &e) {
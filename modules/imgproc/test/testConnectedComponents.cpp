@@ -273,6 +273,75 @@ main(int argc, const char ** argv)
     // Here starts really the test
     //
 
+    //Test labeling on test data
+    unsigned char image_data[8*8] = {
+      1, 1, 0, 0, 1, 0, 1, 1,
+      0, 1, 0, 1, 0, 0, 0, 1,
+      0, 0, 1, 0, 0, 1, 1, 1,
+      1, 0, 0, 0, 1, 0, 0, 0,
+      1, 1, 0, 1, 1, 1, 0, 1,
+      0, 0, 0, 0, 1, 0, 1, 0,
+      1, 0, 1, 0, 0, 0, 0, 1,
+      1, 1, 1, 0, 1, 1, 0, 1
+    };
+    vpImage<unsigned char> I_test_data(image_data, 8, 8, true);
+
+    int labels_data_check_4_connexity[8*8] = {
+       1,  1,  0,  0,  2,  0,  3,  3,
+       0,  1,  0,  4,  0,  0,  0,  3,
+       0,  0,  5,  0,  0,  3,  3,  3,
+       6,  0,  0,  0,  7,  0,  0,  0,
+       6,  6,  0,  7,  7,  7,  0,  8,
+       0,  0,  0,  0,  7,  0,  9,  0,
+      10,  0, 10,  0,  0,  0,  0, 11,
+      10, 10, 10,  0, 12, 12,  0, 11
+    };
+    vpImage<int> labels_check_4_connexity(labels_data_check_4_connexity, 8, 8, true);
+
+    int labels_data_check_8_connexity[8*8] = {
+      1, 1, 0, 0, 1, 0, 2, 2,
+      0, 1, 0, 1, 0, 0, 0, 2,
+      0, 0, 1, 0, 0, 2, 2, 2,
+      3, 0, 0, 0, 2, 0, 0, 0,
+      3, 3, 0, 2, 2, 2, 0, 2,
+      0, 0, 0, 0, 2, 0, 2, 0,
+      4, 0, 4, 0, 0, 0, 0, 2,
+      4, 4, 4, 0, 5, 5, 0, 2
+    };
+    vpImage<int> labels_check_8_connexity(labels_data_check_8_connexity, 8, 8, true);
+
+    vpImage<int> labels_test_data;
+    int nbComponents_test_data = 0;
+    vp::connectedComponents(I_test_data, labels_test_data, nbComponents_test_data, vpImageMorphology::CONNEXITY_4);
+    std::cout << "(labels_test_data == labels_check_4_connexity)? " << (labels_test_data == labels_check_4_connexity) << std::endl;
+    if (nbComponents_test_data != 12 || labels_test_data != labels_check_4_connexity) {
+      throw vpException(vpException::fatalError, "Problem with vp::connectedComponents() and 4-connexity!");
+    }
+
+    vp::connectedComponents(I_test_data, labels_test_data, nbComponents_test_data, vpImageMorphology::CONNEXITY_8);
+    std::cout << "(labels_test_data == labels_check_8_connexity)? " << (labels_test_data == labels_check_8_connexity) << std::endl;
+    if (nbComponents_test_data != 5 || labels_test_data != labels_check_8_connexity) {
+      throw vpException(vpException::fatalError, "Problem with vp::connectedComponents() and 8-connexity!");
+    }
+
+    //Test component statistics and area filtering on test data
+    std::vector<vp::vpConnectedComponent> components;
+    vp::connectedComponents(I_test_data, labels_test_data, nbComponents_test_data, components, vpImageMorphology::CONNEXITY_8);
+    if (nbComponents_test_data != 5 || components.size() != 5 || labels_test_data != labels_check_8_connexity ||
+        components[2].m_area != 3 || components[2].m_minRow != 3 || components[2].m_maxRow != 4 ||
+        components[2].m_minCol != 0 || components[2].m_maxCol != 1 ||
+        components[2].getCentroid() != vpImagePoint(11/3.0, 1/3.0)) {
+      throw vpException(vpException::fatalError, "Problem with vp::connectedComponents() statistics!");
+    }
+
+    vp::connectedComponents(I_test_data, labels_test_data, nbComponents_test_data, components, vpImageMorphology::CONNEXITY_8, 4);
+    std::cout << "nbComponents with an area >= 4: " << nbComponents_test_data << std::endl;
+    if (nbComponents_test_data != 3 || components.size() != 3 || components[2].m_area != 5 ||
+        labels_test_data[3][0] != 0 || labels_test_data[7][4] != 0 || labels_test_data[7][0] != 3) {
+      throw vpException(vpException::fatalError, "Problem with vp::connectedComponents() area filtering!");
+    }
+
+
     //Read Klimt.ppm
     filename = vpIoTools::createFilePath(ipath, "ViSP-images/Klimt/Klimt.pgm");
     vpImage<unsigned char> I;
@@ -298,6 +367,26 @@ main(int argc, const char ** argv)
     std::cout << "Time: " << t << " ms" << std::endl;
     std::cout << "nbComponents=" << nbComponents << std::endl;
 
+    //Multithreaded labeling must give the same result
+    for (int cpt = 0; cpt < 2; cpt++) {
+      vpImageMorphology::vpConnexityType connexity = cpt == 0 ? vpImageMorphology::CONNEXITY_4 : vpImageMorphology::CONNEXITY_8;
+      vpImage<int> labels_sequential, labels_parallel;
+      int nbComponents_sequential = 0, nbComponents_parallel = 0;
+      vp::connectedComponents(I, labels_sequential, nbComponents_sequential, connexity);
+
+      vp::setNbThreads(4);
+      t = vpTime::measureTimeMs();
+      vp::connectedComponents(I, labels_parallel, nbComponents_parallel, connexity, 4);
+      t = vpTime::measureTimeMs() - t;
+      vp::setNbThreads(1);
+      std::cout << "\n" << (cpt == 0 ? 4 : 8) << "-connexity connected components (4 threads):" << std::endl;
+      std::cout << "Time: " << t << " ms" << std::endl;
+
+      if (nbComponents_parallel != nbComponents_sequential || labels_parallel != labels_sequential) {
+        throw vpException(vpException::fatalError, "Multithreaded vp::connectedComponents() differs from the sequential version!");
+      }
+    }
+
 
     //Save results
     vpImage<vpRGBa> labels_connex4_color(labels_connex4.getHeight(), labels_connex4.getWidth(), vpRGBa(0,0,0,0));
@@ -35,6 +35,8 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
+#include <cstdlib>
 #include <iomanip>
 
 #include <visp3/core/vpIoTools.h>
@@ -51,10 +53,16 @@
 */
 
 // List of allowed command line options
-#define GETOPTARGS  "cdi:o:h"
+#define GETOPTARGS  "cdi:o:t:bh"
 
 void usage(const char *name, const char *badparam, std::string ipath, std::string opath, std::string user);
-bool getOptions(int argc, const char **argv, std::string &ipath, std::string &opath, std::string user);
+bool getOptions(int argc, const char **argv, std::string &ipath, std::string &opath, std::string &tpath, bool &benchmark,
+                std::string user);
+bool fromToReference(const vpImagePoint &from, const vpImagePoint &to, vpDirection &direction);
+void followBorderReference(vpImage<int> &I, const vpImagePoint &ij, const vpImagePoint &i2j2, std::vector<vpImagePoint> &points, const int nbd);
+void findContoursReference(const vpImage<unsigned char> &I_original, std::vector<std::vector<vpImagePoint> > &contours);
+void checkContours(const vpImage<unsigned char> &I, const std::string &name, bool benchmark);
+bool expandSimpleContour(const std::vector<vp::vpContourPoint> &points, std::vector<vpImagePoint> &expanded);
 
 /*
   Print the program options.
@@ -72,7 +80,7 @@ Test contours extraction.\n\
 \n\
 SYNOPSIS\n\
   %s [-i <input image path>] [-o <output image path>]\n\
-     [-h]\n                 \
+     [-t <contours tree image>] [-b] [-h]\n                 \
 ", name);
 
   fprintf(stdout, "\n\
@@ -90,6 +98,14 @@ OPTIONS:                                               Default\n\
      From this directory, creates the \"%s\"\n\
      subdirectory depending on the username, where \n\
      output result images are written.\n\
+\n\
+  -t <contours tree image>\n\
+     Set the path of the \"Contours_tree.pgm\" image of the\n\
+     contour tutorial to check the contours extraction.\n\
+\n\
+  -b\n\
+     Benchmark the contours extraction against the reference\n\
+     border following, including on a large synthetic image.\n\
 \n\
   -h\n\
      Print the help.\n\n",
@@ -106,11 +122,14 @@ OPTIONS:                                               Default\n\
   \param argv : Array of command line parameters.
   \param ipath: Input image path.
   \param opath : Output image path.
+  \param tpath : Contours tree image path.
+  \param benchmark : If true, time the contours extraction on larger images.
   \param user : Username.
   \return false if the program has to be stopped, true otherwise.
 
 */
-bool getOptions(int argc, const char **argv, std::string &ipath, std::string &opath, std::string user)
+bool getOptions(int argc, const char **argv, std::string &ipath, std::string &opath, std::string &tpath, bool &benchmark,
+                std::string user)
 {
   const char *optarg_;
   int c;
@@ -119,6 +138,8 @@ bool getOptions(int argc, const char **argv, std::string &ipath, std::string &op
     switch (c) {
     case 'i': ipath = optarg_; break;
       case 'o': opath = optarg_; break;
+      case 't': tpath = optarg_; break;
+      case 'b': benchmark = true; break;
       case 'h': usage(argv[0], NULL, ipath, opath, user); return false; break;
 
     case 'c':
@@ -172,6 +193,170 @@ void displayContourInfo(const vp::vpContour &contour, const int level) {
   }
 }
 
+/*
+  Expand a contour approximated with vp::CONTOUR_APPROX_SIMPLE back to all its points, by joining the consecutive
+  points, and the last one to the first one, with horizontal, vertical or diagonal segments.
+  Return false if two consecutive points cannot be joined by such a segment.
+*/
+bool expandSimpleContour(const std::vector<vp::vpContourPoint> &points, std::vector<vpImagePoint> &expanded) {
+  expanded.clear();
+  if (points.size() == 1) {
+    expanded.push_back(vpImagePoint(points.front().m_i, points.front().m_j));
+    return true;
+  }
+
+  for (size_t k = 0; k < points.size(); k++) {
+    const vp::vpContourPoint &from = points[k], &to = points[(k+1) % points.size()];
+    const int di = to.m_i - from.m_i, dj = to.m_j - from.m_j;
+    if ((di == 0 && dj == 0) || (di != 0 && dj != 0 && std::abs(di) != std::abs(dj))) {
+      return false;
+    }
+
+    const int stepI = (di > 0) - (di < 0), stepJ = (dj > 0) - (dj < 0);
+    const int nbSteps = std::max(std::abs(di), std::abs(dj));
+    for (int step = 0; step < nbSteps; step++) {
+      expanded.push_back(vpImagePoint(from.m_i + step*stepI, from.m_j + step*stepJ));
+    }
+  }
+
+  return true;
+}
+
+/*
+  Reference border following with vpDirection and vpImagePoint, without any hierarchy.
+  Used to check and benchmark vp::findContours().
+*/
+bool fromToReference(const vpImagePoint &from, const vpImagePoint &to, vpDirection &direction) {
+  if (from == to) {
+    return false;
+  }
+
+  int di = vpMath::round(to.get_i() - from.get_i()), dj = vpMath::round(to.get_j() - from.get_j());
+  const vpDirectionType directions[9] = {
+    NORTH_WEST, NORTH, NORTH_EAST, WEST, LAST_DIRECTION, EAST, SOUTH_WEST, SOUTH, SOUTH_EAST
+  };
+  direction.m_direction = directions[(di+1)*3 + dj+1];
+
+  return true;
+}
+
+void followBorderReference(vpImage<int> &I, const vpImagePoint &ij, const vpImagePoint &i2j2, std::vector<vpImagePoint> &points, const int nbd) {
+  vpDirection dir;
+  fromToReference(ij, i2j2, dir);
+
+  vpDirection trace = dir.clockwise();
+  vpImagePoint i1j1(-1, -1);
+  while (trace.m_direction != dir.m_direction) {
+    vpImagePoint activePixel = trace.active(I, ij);
+    if (activePixel.get_i() >= 0 && activePixel.get_j() >= 0) {
+      i1j1 = activePixel;
+      break;
+    }
+
+    trace = trace.clockwise();
+  }
+
+  if (i1j1.get_i() < 0 || i1j1.get_j() < 0) {
+    return;
+  }
+
+  vpImagePoint i2j2_ = i1j1, i3j3 = ij;
+  while (true) {
+    fromToReference(i3j3, i2j2_, dir);
+    trace = dir.counterClockwise();
+
+    bool checked[8] = { false, false, false, false, false, false, false, false };
+    vpImagePoint i4j4;
+    while (true) {
+      i4j4 = trace.active(I, i3j3);
+      if (i4j4.get_i() >= 0 && i4j4.get_j() >= 0) {
+        break;
+      }
+
+      checked[(int) trace.m_direction] = true;
+      trace = trace.counterClockwise();
+    }
+
+    points.push_back(vpImagePoint(i3j3.get_i()-1, i3j3.get_j()-1));
+    int &pixel = I[(unsigned int) i3j3.get_i()][(unsigned int) i3j3.get_j()];
+    if (checked[EAST]) {
+      pixel = -nbd;
+    } else if (pixel == 1) {
+      pixel = nbd;
+    }
+
+    if (i4j4 == ij && i3j3 == i1j1) {
+      break;
+    }
+
+    i2j2_ = i3j3;
+    i3j3 = i4j4;
+  }
+}
+
+void findContoursReference(const vpImage<unsigned char> &I_original, std::vector<std::vector<vpImagePoint> > &contours) {
+  contours.clear();
+
+  vpImage<int> I(I_original.getHeight() + 2, I_original.getWidth() + 2, 0);
+  for (unsigned int i = 0; i < I_original.getHeight(); i++) {
+    for (unsigned int j = 0; j < I_original.getWidth(); j++) {
+      I[i+1][j+1] = I_original[i][j];
+    }
+  }
+
+  int nbd = 1;
+  for (unsigned int i = 1; i < I.getHeight()-1; i++) {
+    for (unsigned int j = 1; j < I.getWidth()-1; j++) {
+      int fji = I[i][j];
+      bool isOuter = (fji == 1 && I[i][j-1] == 0);
+      bool isHole = (fji >= 1 && I[i][j+1] == 0);
+
+      if (isOuter || isHole) {
+        nbd++;
+        std::vector<vpImagePoint> points;
+        followBorderReference(I, vpImagePoint(i, j), vpImagePoint(i, isOuter ? j-1 : j+1), points, nbd);
+
+        if (points.empty()) {
+          points.push_back(vpImagePoint(i-1, j-1));
+          I[i][j] = -nbd;
+        }
+
+        contours.push_back(points);
+      }
+    }
+  }
+}
+
+void checkContours(const vpImage<unsigned char> &I, const std::string &name, bool benchmark) {
+  std::vector<std::vector<vpImagePoint> > contours_reference;
+  double t_reference = vpTime::measureTimeMs();
+  findContoursReference(I, contours_reference);
+  t_reference = vpTime::measureTimeMs() - t_reference;
+
+  vp::vpContourSet contour_set;
+  double t = vpTime::measureTimeMs();
+  vp::findContours(I, contour_set);
+  t = vpTime::measureTimeMs() - t;
+
+  if (benchmark) {
+    std::cout << "\nBenchmark on " << name << " (" << I.getWidth() << "x" << I.getHeight() << "): nb contours="
+              << contour_set.size() << " ; t_reference=" << t_reference << " ms ; t=" << t << " ms ; speedup="
+              << (t > 0 ? t_reference / t : 0) << std::endl;
+  }
+
+  if (contour_set.size() != contours_reference.size()) {
+    throw vpException(vpException::fatalError, "Problem with the number of contours on %s!", name.c_str());
+  }
+
+  std::vector<vpImagePoint> contour_points;
+  for (unsigned int index = 0; index < contour_set.size(); index++) {
+    contour_set.getContour(index, contour_points);
+    if (contour_points != contours_reference[index]) {
+      throw vpException(vpException::fatalError, "Problem with the contour points on %s!", name.c_str());
+    }
+  }
+}
+
 int
 main(int argc, const char ** argv)
 {
@@ -181,6 +366,8 @@ main(int argc, const char ** argv)
     std::string opt_opath;
     std::string ipath;
     std::string opath;
+    std::string tpath;
+    bool benchmark = false;
     std::string filename;
     std::string username;
 
@@ -202,7 +389,7 @@ main(int argc, const char ** argv)
     vpIoTools::getUserName(username);
 
     // Read the command line options
-    if (getOptions(argc, argv, opt_ipath, opt_opath, username) == false) {
+    if (getOptions(argc, argv, opt_ipath, opt_opath, tpath, benchmark, username) == false) {
       exit (EXIT_FAILURE);
     }
 
@@ -366,6 +553,75 @@ main(int argc, const char ** argv)
     vpImageIo::write(I_draw_contours_external, filename);
 
 
+    //Test flat contours storage
+    vp::findContours(I, vp_contours, contours);
+    vp::vpContourSet contour_set;
+    t = vpTime::measureTimeMs();
+    vp::findContours(I, contour_set);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "\nFlat contours: nb contours=" << contour_set.size() << " ; t=" << t << " ms" << std::endl;
+
+    if (contour_set.size() != contours.size()) {
+      throw vpException(vpException::fatalError, "Problem with the number of contours in vpContourSet!");
+    }
+
+    std::vector<vpImagePoint> contour_points;
+    size_t nb_top_level = 0;
+    for (unsigned int index = 0; index < contour_set.size(); index++) {
+      contour_set.getContour(index, contour_points);
+      if (contour_points != contours[index]) {
+        throw vpException(vpException::fatalError, "Problem with the contour points in vpContourSet!");
+      }
+
+      int parent = contour_set.m_parent[index];
+      if (parent < 0) {
+        nb_top_level++;
+      } else if (parent >= (int) index || contour_set.m_types[(size_t) parent] == contour_set.m_types[index]) {
+        throw vpException(vpException::fatalError, "Problem with the contour hierarchy in vpContourSet!");
+      }
+
+      for (int child = contour_set.m_firstChild[index]; child >= 0; child = contour_set.m_nextSibling[(size_t) child]) {
+        if (contour_set.m_parent[(size_t) child] != (int) index) {
+          throw vpException(vpException::fatalError, "Problem with the contour siblings in vpContourSet!");
+        }
+      }
+    }
+
+    if (nb_top_level != vp_contours.m_children.size()) {
+      throw vpException(vpException::fatalError, "Problem with the top-level contours in vpContourSet!");
+    }
+
+    //Test integer points, chain codes and simple approximation
+    vp::vpContourSet contour_set_int, contour_set_chain, contour_set_simple;
+    vp::findContours(I, contour_set_int, vp::CONTOUR_RETR_TREE, vp::CONTOUR_APPROX_NONE, vp::CONTOUR_STORE_INTEGER_POINTS);
+    vp::findContours(I, contour_set_chain, vp::CONTOUR_RETR_TREE, vp::CONTOUR_APPROX_NONE, vp::CONTOUR_STORE_CHAIN_CODES);
+    vp::findContours(I, contour_set_simple, vp::CONTOUR_RETR_TREE, vp::CONTOUR_APPROX_SIMPLE, vp::CONTOUR_STORE_INTEGER_POINTS);
+    std::cout << "Contour points: " << contour_set.m_points.size() << " ; chain codes: " << contour_set_chain.m_chainCodes.size()
+              << " ; simple approximation: " << contour_set_simple.m_intPoints.size() << std::endl;
+
+    std::vector<vpImagePoint> contour_points_int, contour_points_chain, contour_points_expanded;
+    std::vector<vp::vpContourPoint> contour_points_simple;
+    for (unsigned int index = 0; index < contour_set.size(); index++) {
+      contour_set_int.getContour(index, contour_points_int);
+      contour_set_chain.getContour(index, contour_points_chain);
+      if (contour_points_int != contours[index] || contour_points_chain != contours[index]) {
+        throw vpException(vpException::fatalError, "Problem with the contour points storage in vpContourSet!");
+      }
+
+      //The approximated contour has to expand back to the full contour
+      contour_set_simple.getContour(index, contour_points_simple);
+      if (contour_set_simple.getNbPoints(index) > contour_set.getNbPoints(index) ||
+          !expandSimpleContour(contour_points_simple, contour_points_expanded) || contour_points_expanded != contours[index]) {
+        throw vpException(vpException::fatalError, "Problem with the contour approximation in vpContourSet!");
+      }
+
+      if (contour_set.getPoints(index) == NULL || *contour_set.getPoints(index) != contours[index].front() ||
+          contour_set_int.getPoints(index) != NULL) {
+        throw vpException(vpException::fatalError, "Problem with vpContourSet::getPoints()!");
+      }
+    }
+
+
     //Test fillHoles
     vpImage<unsigned char> I_holes = I_draw_contours_external;
     vpImageTools::binarise(I_holes, (unsigned char) 127, (unsigned char) 255, (unsigned char) 0, (unsigned char) 255, (unsigned char) 255);
@@ -375,10 +631,98 @@ main(int argc, const char ** argv)
     t = vpTime::measureTimeMs() - t;
     std::cout << "\nFill Holes: " << t << " ms" << std::endl;
 
+    //Test fillHoles with a reused workspace
+    vp::vpFillHolesWorkspace workspace;
+    for (int cpt = 0; cpt < 2; cpt++) {
+      vpImage<unsigned char> I_holes_workspace = I_draw_contours_external;
+      vpImageTools::binarise(I_holes_workspace, (unsigned char) 127, (unsigned char) 255, (unsigned char) 0, (unsigned char) 255, (unsigned char) 255);
+
+      t = vpTime::measureTimeMs();
+      vp::fillHoles(I_holes_workspace, workspace);
+      t = vpTime::measureTimeMs() - t;
+      std::cout << "Fill Holes (workspace): " << t << " ms" << std::endl;
+
+      if (I_holes_workspace != I_holes) {
+        throw vpException(vpException::fatalError, "Problem with vp::fillHoles() and a workspace!");
+      }
+    }
+
+    //Test fillHoles with a 0 / 1 input, the foreground and the holes are set to 255
+    vpImage<unsigned char> I_holes_01 = I_draw_contours_external;
+    vpImageTools::binarise(I_holes_01, (unsigned char) 127, (unsigned char) 255, (unsigned char) 0, (unsigned char) 1, (unsigned char) 1);
+    vp::fillHoles(I_holes_01, workspace);
+    if (I_holes_01 != I_holes) {
+      throw vpException(vpException::fatalError, "Problem with vp::fillHoles() and a 0 / 1 image!");
+    }
+
+    //Test reconstruct: holes filled by reconstruction of the complemented image from its border
+    vpImage<unsigned char> I_holes_mask(I_holes.getHeight(), I_holes.getWidth()), I_holes_marker(I_holes.getHeight(), I_holes.getWidth(), 0);
+    vpImage<unsigned char> I_holes_binarise = I_draw_contours_external;
+    vpImageTools::binarise(I_holes_binarise, (unsigned char) 127, (unsigned char) 255, (unsigned char) 0, (unsigned char) 255, (unsigned char) 255);
+    for (unsigned int i = 0; i < I_holes_mask.getHeight(); i++) {
+      for (unsigned int j = 0; j < I_holes_mask.getWidth(); j++) {
+        I_holes_mask[i][j] = 255 - I_holes_binarise[i][j];
+        if (i == 0 || j == 0 || i == I_holes_mask.getHeight()-1 || j == I_holes_mask.getWidth()-1) {
+          I_holes_marker[i][j] = I_holes_mask[i][j];
+        }
+      }
+    }
+
+    vpImage<unsigned char> I_reconstruct;
+    t = vpTime::measureTimeMs();
+    vp::reconstruct(I_holes_marker, I_holes_mask, I_reconstruct, vpImageMorphology::CONNEXITY_4);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Reconstruct: " << t << " ms" << std::endl;
+
+    for (unsigned int cpt = 0; cpt < I_reconstruct.getSize(); cpt++) {
+      I_reconstruct.bitmap[cpt] = 255 - I_reconstruct.bitmap[cpt];
+    }
+    if (I_reconstruct != I_holes) {
+      throw vpException(vpException::fatalError, "Problem with vp::reconstruct()!");
+    }
+
     filename = vpIoTools::createFilePath(opath, "Klimt_contours_extracted_external_fill_holes.pgm");
     vpImageIo::write(I_holes, filename);
 
 
+    //Compare the border following with the reference implementation
+    checkContours(I, "Klimt", benchmark);
+
+    if (!tpath.empty()) {
+      vpImage<unsigned char> I_tree;
+      std::cout << "\nRead image: " << tpath << std::endl;
+      vpImageIo::read(I_tree, tpath);
+      vpImageTools::binarise(I_tree, (unsigned char) 127, (unsigned char) 255, (unsigned char) 0, (unsigned char) 1, (unsigned char) 1);
+      checkContours(I_tree, "Contours_tree", benchmark);
+    }
+
+    //Synthetic image with nested rings and noise, large only when benchmarking
+    const unsigned int synthetic_size = benchmark ? 4000 : 300;
+    vpImage<unsigned char> I_synthetic(synthetic_size, synthetic_size, 0);
+    for (unsigned int i = 0; i < I_synthetic.getHeight(); i++) {
+      for (unsigned int j = 0; j < I_synthetic.getWidth(); j++) {
+        int di = (int) (i % 100) - 50, dj = (int) (j % 100) - 50;
+        int r2 = di*di + dj*dj;
+        I_synthetic[i][j] = ( (r2 > 30*30 && r2 < 45*45) || (r2 > 10*10 && r2 < 20*20) || (i*7 + j*13) % 61 == 0 ) ? 1 : 0;
+      }
+    }
+    checkContours(I_synthetic, "synthetic image", benchmark);
+
+    //Foreground touching the last row and the corners, the border following relies on the zero padding rows
+    vpImage<unsigned char> I_last_row(9, 11, 0);
+    for (unsigned int j = 0; j < I_last_row.getWidth(); j++) {
+      I_last_row[I_last_row.getHeight()-1][j] = 1;
+      I_last_row[I_last_row.getHeight()-2][j] = (j % 3 == 0) ? 1 : 0;
+    }
+    I_last_row[0][0] = 1;
+    I_last_row[0][I_last_row.getWidth()-1] = 1;
+    I_last_row[4][5] = 1;
+    checkContours(I_last_row, "last row image", benchmark);
+
+    vpImage<unsigned char> I_full(5, 6, 1);
+    checkContours(I_full, "full image", benchmark);
+
+
 #if VISP_HAVE_OPENCV_VERSION >= 0x030000
     cv::Mat matImg;
     vpImageConvert::convert(I, matImg);
@@ -310,6 +310,17 @@ main(int argc, const char ** argv)
     }
     std::cout << "\n(I_test_flood_fill_8_connexity == I_check_8_connexity)? " << (I_test_flood_fill_8_connexity == I_check_8_connexity) << std::endl;
 
+    //Test flood fill with a segment stack reused across calls
+    std::vector<int> stack;
+    for (int cpt = 0; cpt < 2; cpt++) {
+      vpImage<unsigned char> I_test_flood_fill_stack(image_data, 8, 8, true);
+      vp::floodFill(I_test_flood_fill_stack, vpImagePoint(2,2), 0, 1, vpImageMorphology::CONNEXITY_8, stack);
+
+      if (I_test_flood_fill_stack != I_check_8_connexity) {
+        throw vpException(vpException::fatalError, "Problem with vp::floodFill() and a reused segment stack!");
+      }
+    }
+
 
     //Read Klimt.ppm
     filename = vpIoTools::createFilePath(ipath, "ViSP-images/Klimt/Klimt.pgm");
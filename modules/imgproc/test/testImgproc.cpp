@@ -35,14 +35,20 @@
  *
  *****************************************************************************/
 
+#include <algorithm>
+#include <vector>
+
 #include <visp3/core/vpImage.h>
 #include <visp3/io/vpImageIo.h>
 #include <visp3/io/vpParseArgv.h>
 #include <visp3/core/vpIoTools.h>
+#include <visp3/core/vpImageConvert.h>
+#include <visp3/core/vpImageFilter.h>
 #include <visp3/core/vpMath.h>
 #include <visp3/imgproc/vpImgproc.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 
 /*!
@@ -156,6 +162,238 @@ void lut_method(vpImage<vpRGBa> &I, const vpRGBa (&lut)[256]) {
   I.performLut(lut);
 }
 
+/*!
+  Check that the result of an imgproc function matches the scalar look-up
+  table path of vpImage::performLut().
+
+  \param I : Input image.
+  \param I_res : Image returned by the imgproc function.
+  \param lut : Look-up table equivalent to the imgproc function.
+  \return true if both images are identical.
+*/
+template <typename Type>
+bool check_lut(const vpImage<Type> &I, const vpImage<Type> &I_res, const Type (&lut)[256]) {
+  vpImage<Type> I_ref = I;
+  I_ref.performLut(lut);
+  return I_ref == I_res;
+}
+
+/*!
+  Reference unsharp mask computed with a Gaussian blur in double precision.
+
+  \param I : Input grayscale image.
+  \param size : Size of the Gaussian blur kernel.
+  \param weight : Weight for the sharpening process.
+  \return The sharpened image.
+*/
+vpImage<unsigned char> unsharp_mask_reference(const vpImage<unsigned char> &I, const unsigned int size, const double weight) {
+  vpImage<double> I_blurred;
+  vpImageFilter::gaussianBlur(I, I_blurred, size);
+
+  vpImage<unsigned char> I_res(I.getHeight(), I.getWidth());
+  for (unsigned int cpt = 0; cpt < I.getSize(); cpt++) {
+    I_res.bitmap[cpt] = vpMath::saturate<unsigned char>( (I.bitmap[cpt] - weight*I_blurred.bitmap[cpt]) / (1 - weight) );
+  }
+
+  return I_res;
+}
+
+/*!
+  Neighbouring tiles and weight of the second one for the coordinate x, the tile t spanning [bounds[t], bounds[t+1][.
+*/
+void clahe_interpolation_reference(const std::vector<unsigned int> &bounds, const unsigned int x, unsigned int &t0,
+                                   unsigned int &t1, double &w) {
+  const unsigned int nbTiles = (unsigned int) bounds.size() - 1;
+  t0 = t1 = 0;
+  w = 0.0;
+  for (unsigned int t = 0; t < nbTiles; t++) {
+    double center = (bounds[t] + bounds[t+1] - 1) / 2.0;
+    if (x >= center) {
+      t0 = t1 = t;
+      if (t + 1 < nbTiles) {
+        double next_center = (bounds[t+1] + bounds[t+2] - 1) / 2.0;
+        if (x < next_center) {
+          t1 = t + 1;
+          w = (x - center) / (next_center - center);
+        }
+      }
+    }
+  }
+}
+
+/*!
+  Reference CLAHE with the interpolation of the tile look-up tables in double precision.
+
+  \param I : Input grayscale image.
+  \param nbTilesX : Number of tiles along the columns.
+  \param nbTilesY : Number of tiles along the rows.
+  \param clipLimit : Contrast limit.
+  \return The equalized image.
+*/
+vpImage<unsigned char> clahe_reference(const vpImage<unsigned char> &I, const unsigned int nbTilesX,
+                                       const unsigned int nbTilesY, const double clipLimit) {
+  std::vector<unsigned int> cols(nbTilesX + 1), rows(nbTilesY + 1);
+  for (unsigned int t = 0; t <= nbTilesX; t++) {
+    cols[t] = t * I.getWidth() / nbTilesX;
+  }
+  for (unsigned int t = 0; t <= nbTilesY; t++) {
+    rows[t] = t * I.getHeight() / nbTilesY;
+  }
+
+  std::vector<std::vector<double> > luts(nbTilesX * nbTilesY, std::vector<double>(256));
+  for (unsigned int ty = 0; ty < nbTilesY; ty++) {
+    for (unsigned int tx = 0; tx < nbTilesX; tx++) {
+      std::vector<unsigned int> hist(256);
+      for (unsigned int i = rows[ty]; i < rows[ty+1]; i++) {
+        for (unsigned int j = cols[tx]; j < cols[tx+1]; j++) {
+          hist[I[i][j]]++;
+        }
+      }
+
+      unsigned int area = (rows[ty+1] - rows[ty]) * (cols[tx+1] - cols[tx]);
+      if (clipLimit > 0) {
+        unsigned int limit = std::max(1u, (unsigned int) (clipLimit * area / 256.0)), excess = 0;
+        for (unsigned int x = 0; x < 256; x++) {
+          if (hist[x] > limit) {
+            excess += hist[x] - limit;
+            hist[x] = limit;
+          }
+        }
+        for (unsigned int x = 0; x < 256; x++) {
+          hist[x] += excess / 256;
+        }
+        unsigned int residual = excess % 256;
+        if (residual > 0) {
+          unsigned int step = std::max(256 / residual, 1u);
+          for (unsigned int x = 0; residual > 0 && x < 256; x += step, residual--) {
+            hist[x]++;
+          }
+        }
+      }
+
+      unsigned int cdf = 0;
+      for (unsigned int x = 0; x < 256; x++) {
+        cdf += hist[x];
+        luts[ty * nbTilesX + tx][x] = vpMath::round(cdf * 255.0 / area);
+      }
+    }
+  }
+
+  vpImage<unsigned char> I_res(I.getHeight(), I.getWidth());
+  for (unsigned int i = 0; i < I.getHeight(); i++) {
+    unsigned int ty0, ty1;
+    double wy;
+    clahe_interpolation_reference(rows, i, ty0, ty1, wy);
+    for (unsigned int j = 0; j < I.getWidth(); j++) {
+      unsigned int tx0, tx1;
+      double wx;
+      clahe_interpolation_reference(cols, j, tx0, tx1, wx);
+      unsigned char v = I[i][j];
+      double top = (1 - wx) * luts[ty0 * nbTilesX + tx0][v] + wx * luts[ty0 * nbTilesX + tx1][v];
+      double bottom = (1 - wx) * luts[ty1 * nbTilesX + tx0][v] + wx * luts[ty1 * nbTilesX + tx1][v];
+      I_res[i][j] = (unsigned char) vpMath::round((1 - wy) * top + wy * bottom);
+    }
+  }
+
+  return I_res;
+}
+
+/*!
+  Check that two grayscale images differ by at most one intensity level, the accepted discrepancy between the
+  float and the double precision computations.
+*/
+bool check_max_difference(const vpImage<unsigned char> &I1, const vpImage<unsigned char> &I2) {
+  if (I1.getHeight() != I2.getHeight() || I1.getWidth() != I2.getWidth()) {
+    return false;
+  }
+
+  for (unsigned int cpt = 0; cpt < I1.getSize(); cpt++) {
+    if (abs((int) I1.bitmap[cpt] - (int) I2.bitmap[cpt]) > 1) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*!
+  Run the look-up table functions with the scalar kernel and each vector kernel supported by the CPU, which must
+  give identical images, also on the pixels left over by the vector width.
+
+  \return true if all the kernels give the same images.
+*/
+bool check_simd_kernels() {
+  //Sizes that are not multiples of the vector width, the last one is split into several parallel chunks
+  const unsigned int sizes[5][2] = { {1, 1}, {3, 5}, {7, 13}, {31, 67}, {257, 259} };
+  const vp::vpSimdKernel kernels[3] = { vp::SIMD_KERNEL_AVX2, vp::SIMD_KERNEL_AVX512VBMI, vp::SIMD_KERNEL_NEON };
+  const char *names[3] = { "AVX2", "AVX-512 VBMI", "NEON" };
+
+  for (unsigned int s = 0; s < 5; s++) {
+    vpImage<unsigned char> I(sizes[s][0], sizes[s][1]);
+    vpImage<vpRGBa> I_color(sizes[s][0], sizes[s][1]);
+    for (unsigned int cpt = 0; cpt < I.getSize(); cpt++) {
+      I.bitmap[cpt] = (unsigned char) ((cpt * 151 + cpt / 7) & 0xFF);
+      I_color.bitmap[cpt] = vpRGBa((unsigned char) ((cpt * 37) & 0xFF), (unsigned char) ((cpt * 11 + 3) & 0xFF),
+                                   (unsigned char) ((cpt * 101) & 0xFF), (unsigned char) (cpt & 0xFF));
+    }
+
+    //Out of place and in place gray level look-up, same and per-channel tables on the color image
+    vp::setSimdKernel(vp::SIMD_KERNEL_SCALAR);
+    vpImage<unsigned char> I_gamma, I_adjust = I;
+    vpImage<vpRGBa> I_color_adjust = I_color, I_color_equalize = I_color;
+    vp::gammaCorrection(I, I_gamma, 1.7);
+    vp::adjust(I_adjust, 1.3, -20);
+    vp::adjust(I_color_adjust, 1.3, -20);
+    vp::equalizeHistogram(I_color_equalize);
+
+    for (unsigned int k = 0; k < 3; k++) {
+      if (!vp::setSimdKernel(kernels[k])) {
+        if (s == 0) {
+          std::cout << "The " << names[k] << " kernel is not supported" << std::endl;
+        }
+        continue;
+      }
+
+      vpImage<unsigned char> I_gamma_simd, I_adjust_simd = I;
+      vpImage<vpRGBa> I_color_adjust_simd = I_color, I_color_equalize_simd = I_color;
+      vp::gammaCorrection(I, I_gamma_simd, 1.7);
+      vp::adjust(I_adjust_simd, 1.3, -20);
+      vp::adjust(I_color_adjust_simd, 1.3, -20);
+      vp::equalizeHistogram(I_color_equalize_simd);
+      if (I_gamma_simd != I_gamma || I_adjust_simd != I_adjust || I_color_adjust_simd != I_color_adjust ||
+          I_color_equalize_simd != I_color_equalize) {
+        std::cerr << "The " << names[k] << " kernel differs from the scalar one on a " << sizes[s][1] << "x"
+                  << sizes[s][0] << " image" << std::endl;
+        vp::setSimdKernel(vp::SIMD_KERNEL_AUTO);
+        return false;
+      }
+      if (s == 0) {
+        std::cout << "The " << names[k] << " kernel is checked against the scalar one" << std::endl;
+      }
+    }
+  }
+
+  vp::setSimdKernel(vp::SIMD_KERNEL_AUTO);
+  return true;
+}
+
+/*!
+  Compute the largest and the mean absolute differences of the R, G, B channels of two color images of the same size.
+*/
+void color_difference(const vpImage<vpRGBa> &I1, const vpImage<vpRGBa> &I2, int &max_diff, double &mean_diff) {
+  max_diff = 0;
+  mean_diff = 0.0;
+  for (unsigned int cpt = 0; cpt < I1.getSize(); cpt++) {
+    const int diffs[3] = { abs(I1.bitmap[cpt].R - I2.bitmap[cpt].R), abs(I1.bitmap[cpt].G - I2.bitmap[cpt].G),
+                           abs(I1.bitmap[cpt].B - I2.bitmap[cpt].B) };
+    for (unsigned int c = 0; c < 3; c++) {
+      max_diff = std::max(max_diff, diffs[c]);
+      mean_diff += diffs[c];
+    }
+  }
+  mean_diff /= 3.0 * std::max(I1.getSize(), 1u);
+}
+
 int
 main(int argc, const char ** argv)
 {
@@ -268,6 +506,16 @@ main(int argc, const char ** argv)
     filename = vpIoTools::createFilePath(opath, "Klimt_adjust.ppm");
     vpImageIo::write(I_color_adjust, filename);
 
+    //The vectorized look-up must be bit-exact with the scalar path
+    vpRGBa lut_color[256];
+    for (unsigned int i = 0; i < 256; i++) {
+      unsigned char value = vpMath::saturate<unsigned char>(alpha * i + beta);
+      lut_color[i] = vpRGBa(value, value, value, value);
+    }
+    if (!check_lut(I_color, I_color_adjust, lut_color)) {
+      throw vpException(vpException::fatalError, "Problem with color adjust!");
+    }
+
 
     //Equalize Histogram
     vpImage<vpRGBa> I_color_equalize_histogram;
@@ -280,6 +528,39 @@ main(int argc, const char ** argv)
     filename = vpIoTools::createFilePath(opath, "Klimt_equalize_histogram.ppm");
     vpImageIo::write(I_color_equalize_histogram, filename);
 
+    //The color histogram equalization is the equalization of the R, G, B channels, alpha is kept
+    vpImage<unsigned char> I_R, I_G, I_B, I_a, I_R_res, I_G_res, I_B_res, I_a_res;
+    vpImageConvert::split(I_color, &I_R, &I_G, &I_B, &I_a);
+    vpImageConvert::split(I_color_equalize_histogram, &I_R_res, &I_G_res, &I_B_res, &I_a_res);
+    vp::equalizeHistogram(I_R);
+    vp::equalizeHistogram(I_G);
+    vp::equalizeHistogram(I_B);
+    if (I_R != I_R_res || I_G != I_G_res || I_B != I_B_res || I_a != I_a_res) {
+      throw vpException(vpException::fatalError, "Problem with color histogram equalization!");
+    }
+
+    //CLAHE, each channel is processed independently, alpha is kept
+    vpImage<vpRGBa> I_color_clahe, I_color_clahe_HSV;
+    t = vpTime::measureTimeMs();
+    vp::clahe(I_color, I_color_clahe);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do color CLAHE: " << t << " ms" << std::endl;
+    vp::clahe(I_color, I_color_clahe_HSV, 8, 8, 2.0, true);
+
+    filename = vpIoTools::createFilePath(opath, "Klimt_clahe.ppm");
+    vpImageIo::write(I_color_clahe, filename);
+    filename = vpIoTools::createFilePath(opath, "Klimt_clahe_HSV.ppm");
+    vpImageIo::write(I_color_clahe_HSV, filename);
+
+    vpImageConvert::split(I_color, &I_R, &I_G, &I_B, &I_a);
+    vpImageConvert::split(I_color_clahe, &I_R_res, &I_G_res, &I_B_res, &I_a_res);
+    vp::clahe(I_R);
+    vp::clahe(I_G);
+    vp::clahe(I_B);
+    if (I_R != I_R_res || I_G != I_G_res || I_B != I_B_res || I_a != I_a_res) {
+      throw vpException(vpException::fatalError, "Problem with color CLAHE!");
+    }
+
 
     //Gamma correction
     vpImage<vpRGBa> I_color_gamma_correction;
@@ -293,6 +574,14 @@ main(int argc, const char ** argv)
     filename = vpIoTools::createFilePath(opath, "Klimt_gamma_correction.ppm");
     vpImageIo::write(I_color_gamma_correction, filename);
 
+    for (unsigned int i = 0; i < 256; i++) {
+      unsigned char value = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, 1.0 / gamma ) * 255.0 );
+      lut_color[i] = vpRGBa(value, value, value, value);
+    }
+    if (!check_lut(I_color, I_color_gamma_correction, lut_color)) {
+      throw vpException(vpException::fatalError, "Problem with color gamma correction!");
+    }
+
 
     //Retinex
     vpImage<vpRGBa> I_color_retinex;
@@ -305,6 +594,52 @@ main(int argc, const char ** argv)
     filename = vpIoTools::createFilePath(opath, "Klimt_retinex.ppm");
     vpImageIo::write(I_color_retinex, filename);
 
+    //Retinex with the recursive Gaussian filter
+    vpImage<vpRGBa> I_color_retinex_recursive, I_color_retinex_pyramid;
+    t = vpTime::measureTimeMs();
+    vp::retinex(I_color, I_color_retinex_recursive, 240, 3, vp::RETINEX_UNIFORM, 1.2, -1, vp::RETINEX_BLUR_RECURSIVE);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do color retinex (recursive Gaussian): " << t << " ms" << std::endl;
+
+    t = vpTime::measureTimeMs();
+    vp::retinex(I_color, I_color_retinex_pyramid, 240, 3, vp::RETINEX_UNIFORM, 1.2, -1, vp::RETINEX_BLUR_RECURSIVE_PYRAMID);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do color retinex (recursive Gaussian + pyramid): " << t << " ms" << std::endl;
+
+    filename = vpIoTools::createFilePath(opath, "Klimt_retinex_recursive.ppm");
+    vpImageIo::write(I_color_retinex_recursive, filename);
+    filename = vpIoTools::createFilePath(opath, "Klimt_retinex_pyramid.ppm");
+    vpImageIo::write(I_color_retinex_pyramid, filename);
+
+    //With a kernel large enough not to be truncated, the three blur methods must give close results
+    vpImage<vpRGBa> I_color_pattern(120, 160), I_retinex_kernel, I_retinex_recursive, I_retinex_pyramid;
+    for (unsigned int i = 0; i < I_color_pattern.getHeight(); i++) {
+      for (unsigned int j = 0; j < I_color_pattern.getWidth(); j++) {
+        I_color_pattern[i][j] = vpRGBa((unsigned char) (20 + (3*i + j) % 90), (unsigned char) (10 + j / 2),
+                                       (unsigned char) (((i / 8 + j / 8) % 2) * 60 + 30), 255);
+      }
+    }
+    vp::retinex(I_color_pattern, I_retinex_kernel, 16, 1, vp::RETINEX_UNIFORM, 1.2, 49, vp::RETINEX_BLUR_KERNEL);
+    vp::retinex(I_color_pattern, I_retinex_recursive, 16, 1, vp::RETINEX_UNIFORM, 1.2, -1, vp::RETINEX_BLUR_RECURSIVE);
+    vp::retinex(I_color_pattern, I_retinex_pyramid, 16, 1, vp::RETINEX_UNIFORM, 1.2, -1, vp::RETINEX_BLUR_RECURSIVE_PYRAMID);
+
+    double mean_diff_recursive = 0.0, mean_diff_pyramid = 0.0;
+    for (unsigned int cpt = 0; cpt < I_color_pattern.getSize(); cpt++) {
+      mean_diff_recursive += abs(I_retinex_kernel.bitmap[cpt].R - I_retinex_recursive.bitmap[cpt].R) +
+          abs(I_retinex_kernel.bitmap[cpt].G - I_retinex_recursive.bitmap[cpt].G) +
+          abs(I_retinex_kernel.bitmap[cpt].B - I_retinex_recursive.bitmap[cpt].B);
+      mean_diff_pyramid += abs(I_retinex_pyramid.bitmap[cpt].R - I_retinex_recursive.bitmap[cpt].R) +
+          abs(I_retinex_pyramid.bitmap[cpt].G - I_retinex_recursive.bitmap[cpt].G) +
+          abs(I_retinex_pyramid.bitmap[cpt].B - I_retinex_recursive.bitmap[cpt].B);
+    }
+    mean_diff_recursive /= 3.0 * I_color_pattern.getSize();
+    mean_diff_pyramid /= 3.0 * I_color_pattern.getSize();
+    std::cout << "Retinex mean difference kernel / recursive: " << mean_diff_recursive
+              << " ; recursive / pyramid: " << mean_diff_pyramid << std::endl;
+    if (mean_diff_recursive > 3.0 || mean_diff_pyramid > 1.0) {
+      throw vpException(vpException::fatalError, "Problem with the recursive Gaussian retinex!");
+    }
+
 
     //Stretch contrast
     vpImage<vpRGBa> I_color_stretch_contrast;
@@ -317,6 +652,17 @@ main(int argc, const char ** argv)
     filename = vpIoTools::createFilePath(opath, "Klimt_stretch_contrast.ppm");
     vpImageIo::write(I_color_stretch_contrast, filename);
 
+    //The color contrast stretching is the stretching of each channel
+    vpImageConvert::split(I_color, &I_R, &I_G, &I_B, &I_a);
+    vpImageConvert::split(I_color_stretch_contrast, &I_R_res, &I_G_res, &I_B_res, &I_a_res);
+    vp::stretchContrast(I_R);
+    vp::stretchContrast(I_G);
+    vp::stretchContrast(I_B);
+    vp::stretchContrast(I_a);
+    if (I_R != I_R_res || I_G != I_G_res || I_B != I_B_res || I_a != I_a_res) {
+      throw vpException(vpException::fatalError, "Problem with color contrast stretching!");
+    }
+
 
     //Stretch Contrast HSV
     vpImage<vpRGBa> I_color_stretch_contrast_HSV;
@@ -341,6 +687,97 @@ main(int argc, const char ** argv)
     filename = vpIoTools::createFilePath(opath, "Klimt_unsharp_mask.ppm");
     vpImageIo::write(I_color_unsharp_mask, filename);
 
+    //Each channel is sharpened independently, alpha is kept
+    vpImageConvert::split(I_color, &I_R, &I_G, &I_B, &I_a);
+    vpImageConvert::split(I_color_unsharp_mask, &I_R_res, &I_G_res, &I_B_res, &I_a_res);
+    if (!check_max_difference(unsharp_mask_reference(I_R, 7, 0.6), I_R_res) ||
+        !check_max_difference(unsharp_mask_reference(I_G, 7, 0.6), I_G_res) ||
+        !check_max_difference(unsharp_mask_reference(I_B, 7, 0.6), I_B_res) || I_a != I_a_res) {
+      throw vpException(vpException::fatalError, "Problem with color unsharp mask!");
+    }
+
+    //The multi-threaded retinex and unsharp mask must give the same results as the single-threaded ones
+    vpImage<vpRGBa> I_color_retinex_threads, I_color_retinex_recursive_threads, I_color_unsharp_mask_threads;
+    vp::setNbThreads(4);
+    t = vpTime::measureTimeMs();
+    vp::retinex(I_color, I_color_retinex_threads);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do color retinex with " << vp::getNbThreads() << " threads: " << t << " ms" << std::endl;
+    vp::setNbThreads(5);
+    vp::retinex(I_color, I_color_retinex_recursive_threads, 240, 3, vp::RETINEX_UNIFORM, 1.2, -1, vp::RETINEX_BLUR_RECURSIVE);
+    t = vpTime::measureTimeMs();
+    vp::unsharpMask(I_color, I_color_unsharp_mask_threads);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do color unsharp mask with " << vp::getNbThreads() << " threads: " << t << " ms" << std::endl;
+    vpImage<vpRGBa> I_color_adjust_threads, I_color_equalize_histogram_threads, I_color_gamma_correction_threads,
+        I_color_stretch_contrast_threads;
+    vp::adjust(I_color, I_color_adjust_threads, alpha, beta);
+    vp::equalizeHistogram(I_color, I_color_equalize_histogram_threads);
+    vp::gammaCorrection(I_color, I_color_gamma_correction_threads, gamma);
+    vp::stretchContrast(I_color, I_color_stretch_contrast_threads);
+    vp::setNbThreads(1);
+    if (I_color_adjust_threads != I_color_adjust || I_color_equalize_histogram_threads != I_color_equalize_histogram ||
+        I_color_gamma_correction_threads != I_color_gamma_correction || I_color_stretch_contrast_threads != I_color_stretch_contrast) {
+      throw vpException(vpException::fatalError, "Problem with multi-threaded color pixel-wise functions!");
+    }
+    if (I_color_retinex_threads != I_color_retinex || I_color_retinex_recursive_threads != I_color_retinex_recursive) {
+      throw vpException(vpException::fatalError, "Problem with multi-threaded retinex!");
+    }
+    if (I_color_unsharp_mask_threads != I_color_unsharp_mask) {
+      throw vpException(vpException::fatalError, "Problem with multi-threaded color unsharp mask!");
+    }
+
+    //Tiled processing, the tiles are read with the halo of the blur
+    vpImage<vpRGBa> I_color_unsharp_mask_tiles, I_retinex_kernel_tiles;
+    vp::vpImageBlockReader<vpRGBa> color_reader(I_color);
+    vp::vpImageBlockWriter<vpRGBa> color_writer(I_color_unsharp_mask_tiles, I_color.getHeight(), I_color.getWidth());
+    vp::unsharpMask(color_reader, color_writer, 7, 0.6, 64);
+    if (I_color_unsharp_mask_tiles != I_color_unsharp_mask) {
+      throw vpException(vpException::fatalError, "Problem with tiled color unsharp mask!");
+    }
+
+    //The statistics of the tiles are merged in a different order
+    vp::vpImageBlockReader<vpRGBa> pattern_reader(I_color_pattern);
+    vp::vpImageBlockWriter<vpRGBa> pattern_writer(I_retinex_kernel_tiles, I_color_pattern.getHeight(), I_color_pattern.getWidth());
+    vp::retinex(pattern_reader, pattern_writer, 16, 1, vp::RETINEX_UNIFORM, 1.2, 49, vp::RETINEX_BLUR_KERNEL, 50);
+    for (unsigned int cpt = 0; cpt < I_retinex_kernel.getSize(); cpt++) {
+      if (abs(I_retinex_kernel.bitmap[cpt].R - I_retinex_kernel_tiles.bitmap[cpt].R) > 1 ||
+          abs(I_retinex_kernel.bitmap[cpt].G - I_retinex_kernel_tiles.bitmap[cpt].G) > 1 ||
+          abs(I_retinex_kernel.bitmap[cpt].B - I_retinex_kernel_tiles.bitmap[cpt].B) > 1) {
+        throw vpException(vpException::fatalError, "Problem with tiled retinex!");
+      }
+    }
+
+    //With kernelSize=-1 the tiled kernel is capped at 6 standard deviations: the single scale 16 gives a standard
+    //deviation of 8 and a 49 kernel instead of the 61 one computed from the 120x160 image
+    vpImage<vpRGBa> I_retinex_auto_tiles;
+    vp::vpImageBlockReader<vpRGBa> auto_reader(I_color_pattern);
+    vp::vpImageBlockWriter<vpRGBa> auto_writer(I_retinex_auto_tiles, I_color_pattern.getHeight(), I_color_pattern.getWidth());
+    vp::retinex(auto_reader, auto_writer, 16, 1, vp::RETINEX_UNIFORM, 1.2, -1, vp::RETINEX_BLUR_KERNEL, 50);
+    int max_diff = 0;
+    double mean_diff = 0.0;
+    color_difference(I_retinex_kernel, I_retinex_auto_tiles, max_diff, mean_diff);
+    if (max_diff > 1) {
+      throw vpException(vpException::fatalError, "Problem with tiled retinex and the kernel size computed from the image!");
+    }
+
+    //The recursive filters have an infinite support approximated within the halo of 3 standard deviations
+    const vp::vpRetinexBlurMethod recursive_methods[2] = { vp::RETINEX_BLUR_RECURSIVE, vp::RETINEX_BLUR_RECURSIVE_PYRAMID };
+    const vpImage<vpRGBa> *recursive_full[2] = { &I_retinex_recursive, &I_retinex_pyramid };
+    for (unsigned int m = 0; m < 2; m++) {
+      vpImage<vpRGBa> I_retinex_recursive_tiles;
+      vp::vpImageBlockReader<vpRGBa> recursive_reader(I_color_pattern);
+      vp::vpImageBlockWriter<vpRGBa> recursive_writer(I_retinex_recursive_tiles, I_color_pattern.getHeight(),
+                                                      I_color_pattern.getWidth());
+      vp::retinex(recursive_reader, recursive_writer, 16, 1, vp::RETINEX_UNIFORM, 1.2, -1, recursive_methods[m], 50);
+      color_difference(*recursive_full[m], I_retinex_recursive_tiles, max_diff, mean_diff);
+      std::cout << "Tiled / full retinex with recursive method " << m << ": max difference " << max_diff
+                << " ; mean difference " << mean_diff << std::endl;
+      if (max_diff > 2 || mean_diff > 0.1) {
+        throw vpException(vpException::fatalError, "Problem with tiled recursive retinex!");
+      }
+    }
+
 
 
     //
@@ -367,6 +804,14 @@ main(int argc, const char ** argv)
     filename = vpIoTools::createFilePath(opath, "image0000_adjust.pgm");
     vpImageIo::write(I_adjust, filename);
 
+    unsigned char lut[256];
+    for (unsigned int i = 0; i < 256; i++) {
+      lut[i] = vpMath::saturate<unsigned char>(alpha * i + beta);
+    }
+    if (!check_lut(I, I_adjust, lut)) {
+      throw vpException(vpException::fatalError, "Problem with grayscale adjust!");
+    }
+
 
     //Equalize Histogram
     vpImage<unsigned char> I_equalize_histogram;
@@ -380,6 +825,45 @@ main(int argc, const char ** argv)
     vpImageIo::write(I_equalize_histogram, filename);
 
 
+    //CLAHE
+    vpImage<unsigned char> I_clahe, I_clahe_threads;
+    t = vpTime::measureTimeMs();
+    vp::clahe(I, I_clahe);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do grayscale CLAHE: " << t << " ms" << std::endl;
+
+    filename = vpIoTools::createFilePath(opath, "image0000_clahe.pgm");
+    vpImageIo::write(I_clahe, filename);
+
+    vp::setNbThreads(4);
+    vp::clahe(I, I_clahe_threads);
+    vp::setNbThreads(1);
+    if (!check_max_difference(clahe_reference(I, 8, 8, 2.0), I_clahe) || I_clahe_threads != I_clahe) {
+      throw vpException(vpException::fatalError, "Problem with grayscale CLAHE!");
+    }
+
+    //Without clipping and with a single tile, the CLAHE is a global equalization
+    vpImage<unsigned char> I_clahe_global = I, I_clahe_grid;
+    vp::clahe(I_clahe_global, 1, 1, 0.0);
+    vp::clahe(I, I_clahe_grid, 3, 5, 4.0);
+    if (!check_max_difference(clahe_reference(I, 1, 1, 0.0), I_clahe_global) ||
+        !check_max_difference(clahe_reference(I, 3, 5, 4.0), I_clahe_grid)) {
+      throw vpException(vpException::fatalError, "Problem with grayscale CLAHE parameters!");
+    }
+
+    //Full HD frame
+    vpImage<unsigned char> I_full_hd(1080, 1920), I_full_hd_clahe;
+    for (unsigned int i = 0; i < I_full_hd.getHeight(); i++) {
+      for (unsigned int j = 0; j < I_full_hd.getWidth(); j++) {
+        I_full_hd[i][j] = I[i % I.getHeight()][j % I.getWidth()];
+      }
+    }
+    t = vpTime::measureTimeMs();
+    vp::clahe(I_full_hd, I_full_hd_clahe);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do grayscale CLAHE on a 1920x1080 image: " << t << " ms" << std::endl;
+
+
     //Gamma correction
     vpImage<unsigned char> I_gamma_correction;
     gamma = 1.8;
@@ -392,6 +876,13 @@ main(int argc, const char ** argv)
     filename = vpIoTools::createFilePath(opath, "image0000_gamma_correction.pgm");
     vpImageIo::write(I_gamma_correction, filename);
 
+    for (unsigned int i = 0; i < 256; i++) {
+      lut[i] = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, 1.0 / gamma ) * 255.0 );
+    }
+    if (!check_lut(I, I_gamma_correction, lut)) {
+      throw vpException(vpException::fatalError, "Problem with grayscale gamma correction!");
+    }
+
 
     //Stretch contrast
     vpImage<unsigned char> I_stretch_contrast;
@@ -405,6 +896,132 @@ main(int argc, const char ** argv)
     vpImageIo::write(I_stretch_contrast, filename);
 
 
+    //Image statistics computed once and reused
+    t = vpTime::measureTimeMs();
+    vp::vpImageStatistics statistics(I);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to compute grayscale image statistics: " << t << " ms" << std::endl;
+
+    unsigned char min_value, max_value;
+    I.getMinMaxValue(min_value, max_value);
+    if (statistics.m_min != min_value || statistics.m_max != max_value || statistics.m_nbPixels != I.getSize()) {
+      throw vpException(vpException::fatalError, "Problem with vpImageStatistics!");
+    }
+
+    vpImage<unsigned char> I_equalize_histogram_statistics, I_stretch_contrast_statistics;
+    vp::equalizeHistogram(I, I_equalize_histogram_statistics, statistics);
+    vp::stretchContrast(I, I_stretch_contrast_statistics, statistics);
+    if (I_equalize_histogram_statistics != I_equalize_histogram || I_stretch_contrast_statistics != I_stretch_contrast) {
+      throw vpException(vpException::fatalError, "Problem with vpImageStatistics overloads!");
+    }
+
+
+    //Odd sized images covering every intensity, for the pixels left after the vectorized loops
+    vpImage<unsigned char> I_odd(37, 61);
+    vpImage<vpRGBa> I_color_odd(37, 61);
+    for (unsigned int k = 0; k < I_odd.getSize(); k++) {
+      I_odd.bitmap[k] = (unsigned char) ((7 * k) % 256);
+      I_color_odd.bitmap[k] = vpRGBa((unsigned char) (10 + k % 200), (unsigned char) (30 + (3 * k) % 150),
+                                     (unsigned char) ((5 * k) % 256), (unsigned char) (100 + (11 * k) % 100));
+    }
+
+    vpImage<unsigned char> I_odd_res;
+    vpImage<vpRGBa> I_color_odd_res;
+    vp::gammaCorrection(I_odd, I_odd_res, gamma);
+    vp::gammaCorrection(I_color_odd, I_color_odd_res, gamma);
+    for (unsigned int i = 0; i < 256; i++) {
+      lut[i] = vpMath::saturate<unsigned char>( pow( (double) i / 255.0, 1.0 / gamma ) * 255.0 );
+      lut_color[i] = vpRGBa(lut[i], lut[i], lut[i], lut[i]);
+    }
+    if (!check_lut(I_odd, I_odd_res, lut) || !check_lut(I_color_odd, I_color_odd_res, lut_color)) {
+      throw vpException(vpException::fatalError, "Problem with gamma correction on odd sized images!");
+    }
+
+    //Per channel look-up table
+    vp::stretchContrast(I_color_odd, I_color_odd_res);
+    vpImage<unsigned char> I_R_odd, I_G_odd, I_B_odd, I_a_odd, I_R_odd_res, I_G_odd_res, I_B_odd_res, I_a_odd_res;
+    vpImageConvert::split(I_color_odd, &I_R_odd, &I_G_odd, &I_B_odd, &I_a_odd);
+    vpImageConvert::split(I_color_odd_res, &I_R_odd_res, &I_G_odd_res, &I_B_odd_res, &I_a_odd_res);
+    vp::stretchContrast(I_R_odd);
+    vp::stretchContrast(I_G_odd);
+    vp::stretchContrast(I_B_odd);
+    vp::stretchContrast(I_a_odd);
+    if (I_R_odd != I_R_odd_res || I_G_odd != I_G_odd_res || I_B_odd != I_B_odd_res || I_a_odd != I_a_odd_res) {
+      throw vpException(vpException::fatalError, "Problem with color contrast stretching on odd sized images!");
+    }
+
+
+    //Streaming contrast enhancement, same result as the per-frame functions without subsampling and smoothing
+    vp::vpStreamingContrast streaming_equalize(vp::STREAMING_EQUALIZE_HISTOGRAM);
+    vp::vpStreamingContrast streaming_stretch(vp::STREAMING_STRETCH_CONTRAST);
+    vpImage<unsigned char> I_streaming;
+    streaming_equalize.apply(I, I_streaming);
+    if (I_streaming != I_equalize_histogram) {
+      throw vpException(vpException::fatalError, "Problem with streaming histogram equalization!");
+    }
+    streaming_stretch.apply(I, I_streaming);
+    if (I_streaming != I_stretch_contrast) {
+      throw vpException(vpException::fatalError, "Problem with streaming contrast stretching!");
+    }
+
+    //Between two refreshes the look-up table of the last refreshed frame is applied
+    vp::vpStreamingContrast streaming(vp::STREAMING_EQUALIZE_HISTOGRAM, 2, 3, 0.25);
+    vpImage<unsigned char> I_streaming_res;
+    streaming.apply(I, I_streaming);
+    memcpy(lut, streaming.getLut(), sizeof(lut));
+    streaming.apply(I_odd, I_streaming_res);
+    if (!check_lut(I_odd, I_streaming_res, lut)) {
+      throw vpException(vpException::fatalError, "Problem with the refresh period of the streaming contrast enhancement!");
+    }
+
+    //The smoothed look-up table stays monotonic
+    streaming.apply(I_odd, I_streaming_res);
+    for (unsigned int i = 1; i < 256; i++) {
+      if (streaming.getLut()[i] < streaming.getLut()[i-1]) {
+        throw vpException(vpException::fatalError, "Problem with the smoothing of the streaming contrast enhancement!");
+      }
+    }
+    t = vpTime::measureTimeMs();
+    for (unsigned int cpt = 0; cpt < 10; cpt++) {
+      streaming.apply(I, I_streaming);
+    }
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do 10 streaming histogram equalizations: " << t << " ms" << std::endl;
+
+
+    //Chain of point operations fused into a single look-up table
+    vpImage<unsigned char> I_chain, I_pipeline;
+    t = vpTime::measureTimeMs();
+    vp::adjust(I, I_chain, alpha, beta);
+    vp::gammaCorrection(I_chain, gamma);
+    vp::stretchContrast(I_chain);
+    unsigned char chain_threshold = vp::autoThreshold(I_chain, vp::AUTO_THRESHOLD_OTSU);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do adjust, gamma correction, contrast stretching and thresholding: " << t << " ms" << std::endl;
+
+    vp::vpLutPipeline pipeline;
+    pipeline.adjust(alpha, beta).gammaCorrection(gamma).stretchContrast().autoThreshold(vp::AUTO_THRESHOLD_OTSU);
+    t = vpTime::measureTimeMs();
+    pipeline.apply(I, I_pipeline);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do the same chain with vpLutPipeline: " << t << " ms" << std::endl;
+    if (I_pipeline != I_chain || pipeline.getThresholds().size() != 1 || pipeline.getThresholds()[0] != chain_threshold) {
+      throw vpException(vpException::fatalError, "Problem with vpLutPipeline!");
+    }
+
+    vp::equalizeHistogram(I, I_chain);
+    vp::gammaCorrection(I_chain, gamma);
+    vp::equalizeHistogram(I_chain);
+    pipeline.clear();
+    pipeline.equalizeHistogram().gammaCorrection(gamma).equalizeHistogram();
+    I_pipeline = I;
+    pipeline.apply(I_pipeline);
+    memcpy(lut, pipeline.getLut(), sizeof(lut));
+    if (I_pipeline != I_chain || !check_lut(I, I_pipeline, lut)) {
+      throw vpException(vpException::fatalError, "Problem with in place vpLutPipeline!");
+    }
+
+
     //Unsharp Mask
     vpImage<unsigned char> I_unsharp_mask;
     t = vpTime::measureTimeMs();
@@ -416,6 +1033,108 @@ main(int argc, const char ** argv)
     filename = vpIoTools::createFilePath(opath, "image0000_unsharp_mask.pgm");
     vpImageIo::write(I_unsharp_mask, filename);
 
+    if (!check_max_difference(unsharp_mask_reference(I, 7, 0.6), I_unsharp_mask)) {
+      throw vpException(vpException::fatalError, "Problem with grayscale unsharp mask!");
+    }
+
+    vp::unsharpMask(I_odd, I_odd_res, 11, 0.8);
+    if (!check_max_difference(unsharp_mask_reference(I_odd, 11, 0.8), I_odd_res)) {
+      throw vpException(vpException::fatalError, "Problem with grayscale unsharp mask on odd sized images!");
+    }
+
+    //Tiled histogram equalization and unsharp mask of an image streamed from and to PNM files
+    filename = vpIoTools::createFilePath(opath, "image0000_tiles.pgm");
+    {
+      vp::vpImageBlockReader<unsigned char> reader(I);
+      vp::vpPnmBlockWriter<unsigned char> writer(filename, I.getHeight(), I.getWidth());
+      vp::unsharpMask(reader, writer, 7, 0.6, 100);
+    }
+    vpImage<unsigned char> I_tiles;
+    {
+      vp::vpPnmBlockReader<unsigned char> reader(filename);
+      I_tiles.resize(reader.getHeight(), reader.getWidth());
+      reader.read(0, 0, I_tiles);
+    }
+    if (I_tiles != I_unsharp_mask) {
+      throw vpException(vpException::fatalError, "Problem with tiled grayscale unsharp mask!");
+    }
+
+    vpImage<unsigned char> I_equalize_histogram_tiles;
+    {
+      vp::vpPnmBlockReader<unsigned char> reader(filename);
+      vp::vpImageBlockWriter<unsigned char> writer(I_equalize_histogram_tiles, reader.getHeight(), reader.getWidth());
+      vp::equalizeHistogram(reader, writer, 33);
+    }
+    vp::equalizeHistogram(I_unsharp_mask);
+    if (I_equalize_histogram_tiles != I_unsharp_mask) {
+      throw vpException(vpException::fatalError, "Problem with tiled histogram equalization!");
+    }
+
+
+    //16-bit images: I * 257 covers the full range, I * 100 + 1000 a narrow one
+    vpImage<unsigned short> I_16(I.getHeight(), I.getWidth()), I_16_narrow(I.getHeight(), I.getWidth());
+    for (unsigned int cpt = 0; cpt < I.getSize(); cpt++) {
+      I_16.bitmap[cpt] = (unsigned short) (I.bitmap[cpt] * 257);
+      I_16_narrow.bitmap[cpt] = (unsigned short) (I.bitmap[cpt] * 100 + 1000);
+    }
+
+    vpImage<unsigned short> I_16_gamma_correction;
+    t = vpTime::measureTimeMs();
+    vp::gammaCorrection(I_16, I_16_gamma_correction, gamma);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do 16-bit gamma correction: " << t << " ms" << std::endl;
+    for (unsigned int cpt = 0; cpt < I_16.getSize(); cpt++) {
+      if (I_16_gamma_correction.bitmap[cpt] !=
+          vpMath::saturate<unsigned short>( pow( (double) I_16.bitmap[cpt] / 65535.0, 1.0 / gamma ) * 65535.0 )) {
+        throw vpException(vpException::fatalError, "Problem with 16-bit gamma correction!");
+      }
+    }
+
+    vpImage<unsigned short> I_16_stretch_contrast;
+    t = vpTime::measureTimeMs();
+    vp::stretchContrast(I_16_narrow, I_16_stretch_contrast);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do 16-bit contrast stretching: " << t << " ms" << std::endl;
+    unsigned int min_value_16 = 1000 + 100 * min_value, range_16 = 100 * (unsigned int) (max_value - min_value);
+    for (unsigned int cpt = 0; cpt < I_16.getSize(); cpt++) {
+      if (range_16 > 0 && I_16_stretch_contrast.bitmap[cpt] != 65535 * (I_16_narrow.bitmap[cpt] - min_value_16) / range_16) {
+        throw vpException(vpException::fatalError, "Problem with 16-bit contrast stretching!");
+      }
+    }
+
+    //The image only has multiples of 257, with 256 bins the equalization is the 8-bit one at a finer precision
+    vpImage<unsigned short> I_16_equalize_histogram, I_16_equalize_histogram_binned;
+    t = vpTime::measureTimeMs();
+    vp::equalizeHistogram(I_16, I_16_equalize_histogram);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do 16-bit histogram equalization: " << t << " ms" << std::endl;
+    t = vpTime::measureTimeMs();
+    vp::equalizeHistogram(I_16, I_16_equalize_histogram_binned, 256);
+    t = vpTime::measureTimeMs() - t;
+    std::cout << "Time to do 16-bit histogram equalization (256 bins): " << t << " ms" << std::endl;
+    if (I_16_equalize_histogram_binned != I_16_equalize_histogram) {
+      throw vpException(vpException::fatalError, "Problem with the binned 16-bit histogram equalization!");
+    }
+    for (unsigned int cpt = 0; cpt < I_16.getSize(); cpt++) {
+      if (std::abs((int) I_16_equalize_histogram.bitmap[cpt] - 257 * (int) I_equalize_histogram.bitmap[cpt]) > 129) {
+        throw vpException(vpException::fatalError, "Problem with 16-bit histogram equalization!");
+      }
+    }
+
+    vpImage<unsigned short> I_16_gamma_correction_threads, I_16_stretch_contrast_threads, I_16_equalize_histogram_threads;
+    vp::setNbThreads(4);
+    vp::gammaCorrection(I_16, I_16_gamma_correction_threads, gamma);
+    vp::stretchContrast(I_16_narrow, I_16_stretch_contrast_threads);
+    vp::equalizeHistogram(I_16, I_16_equalize_histogram_threads);
+    vp::setNbThreads(1);
+    if (I_16_gamma_correction_threads != I_16_gamma_correction || I_16_stretch_contrast_threads != I_16_stretch_contrast ||
+        I_16_equalize_histogram_threads != I_16_equalize_histogram) {
+      throw vpException(vpException::fatalError, "Problem with multi-threaded 16-bit functions!");
+    }
+
+    if (!check_simd_kernels()) {
+      throw vpException(vpException::fatalError, "Problem with the SIMD look-up table kernels!");
+    }
 
     return 0;
   }